@@ -0,0 +1,301 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the synthetic package generator for turborpm_bench.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "packagegen.h"
+
+#include <QDateTime>
+#include <QSet>
+#include <QTimeZone>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+// Shapes roughly follow a Fedora workstation rpmdb: many short C library names,
+// long language-ecosystem prefixes, a heavy-tailed size distribution.
+struct Weighted {
+    const char *value;
+    int weight;
+};
+
+const Weighted kPrefixes[] = {
+    {"", 45}, {"python3-", 14}, {"perl-", 9}, {"lib", 8}, {"rust-", 5},
+    {"nodejs-", 4}, {"texlive-", 5}, {"golang-github-", 4}, {"ghc-", 2},
+    {"google-noto-", 2}, {"gnome-", 2},
+};
+
+const Weighted kSuffixes[] = {
+    {"", 60}, {"-libs", 12}, {"-devel", 10}, {"-common", 6}, {"-doc", 4},
+    {"-data", 3}, {"-fonts", 2}, {"-tools", 3},
+};
+
+const Weighted kArches[] = {
+    {"x86_64", 78}, {"noarch", 20}, {"i686", 2},
+};
+
+const Weighted kRepos[] = {
+    {"fedora", 62}, {"updates", 33}, {"@commandline", 1}, {"rpmfusion-free", 2},
+    {"copr:copr.fedorainfracloud.org:group_kdesig:kf6", 1}, {"<unknown>", 1},
+};
+
+const Weighted kLicenses[] = {
+    {"MIT", 25}, {"GPL-2.0-or-later", 20}, {"LGPL-2.1-or-later", 15},
+    {"Apache-2.0", 15}, {"BSD-3-Clause", 10},
+    {"GPL-3.0-or-later AND LGPL-3.0-or-later AND GFDL-1.3-or-later", 5},
+    {"(MIT OR Apache-2.0) AND Unicode-DFS-2016", 10},
+};
+
+const char *const kSyllables[] = {
+    "ba", "co", "de", "fi", "gu", "ha", "ji", "ke", "lo", "mu", "ne", "po",
+    "qu", "ra", "si", "tu", "vo", "wa", "xe", "yo", "zu", "str", "gl", "sh",
+    "x", "k", "b", "m", "n", "d",
+};
+
+const char *const kWords[] = {
+    "library", "for", "the", "and", "of", "files", "development", "support",
+    "tools", "GNU", "Python", "module", "bindings", "a", "to", "data", "utility",
+    "implementation", "with", "fast", "parser", "XML", "server", "client",
+    "documentation", "shared", "font", "plugin", "runtime", "kernel", "network",
+    "graphics", "compression", "collection", "Perl", "Rust", "crate", "interface",
+};
+
+class Rng
+{
+public:
+    explicit Rng(quint64 seed) : m_engine(seed) {}
+
+    // std::*_distribution are implementation-defined; keep everything on the raw engine
+    double uniform() { return double(m_engine() >> 11) * (1.0 / 9007199254740992.0); }
+    int range(int lo, int hi) { return lo + int(uniform() * double(hi - lo + 1)); }
+
+    double normal()
+    {
+        const double u1 = std::max(uniform(), 1e-300);
+        const double u2 = uniform();
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+    }
+
+    double logNormal(double median, double sigma) { return median * std::exp(sigma * normal()); }
+
+    template<size_t N>
+    const char *pick(const Weighted (&table)[N])
+    {
+        int total = 0;
+        for (const Weighted &w : table)
+            total += w.weight;
+        int roll = range(0, total - 1);
+        for (const Weighted &w : table) {
+            if (roll < w.weight)
+                return w.value;
+            roll -= w.weight;
+        }
+        return table[0].value;
+    }
+
+    template<typename T, size_t N>
+    T pickUniform(T const (&table)[N]) { return table[range(0, int(N) - 1)]; }
+
+private:
+    std::mt19937_64 m_engine;
+};
+
+QString makeStem(Rng &rng)
+{
+    const int target = qBound(2, int(rng.logNormal(7.0, 0.45)), 32);
+    QString stem;
+    while (stem.size() < target)
+        stem += QLatin1String(rng.pickUniform(kSyllables));
+    return stem.left(target);
+}
+
+QString makeWords(Rng &rng, int minWords, int maxWords)
+{
+    const int count = rng.range(minWords, maxWords);
+    QStringList words;
+    for (int i = 0; i < count; ++i)
+        words << QLatin1String(rng.pickUniform(kWords));
+    QString text = words.join(QLatin1Char(' '));
+    if (!text.isEmpty())
+        text[0] = text.at(0).toUpper();
+    return text;
+}
+
+QString makeVersion(Rng &rng)
+{
+    const double roll = rng.uniform();
+    if (roll < 0.05) // snapshot style
+        return QStringLiteral("0^%1git%2").arg(20200101 + rng.range(0, 50000)).arg(rng.range(0, 0xfffff), 5, 16, QLatin1Char('0'));
+    if (roll < 0.08)
+        return QStringLiteral("%1.%2~rc%3").arg(rng.range(0, 9)).arg(rng.range(0, 20)).arg(rng.range(1, 4));
+
+    const int parts = rng.range(1, 4);
+    QStringList components;
+    for (int i = 0; i < parts; ++i)
+        components << QString::number(i == 0 ? rng.range(0, 40) : rng.range(0, 120));
+    return components.join(QLatin1Char('.'));
+}
+
+QString makeRelease(Rng &rng)
+{
+    const int fedora = rng.uniform() < 0.7 ? 40 : rng.range(36, 39);
+    QString release = QString::number(rng.range(1, 30));
+    if (rng.uniform() < 0.15)
+        release += QStringLiteral(".%1").arg(rng.range(1, 9));
+    return release + QStringLiteral(".fc%1").arg(fedora);
+}
+
+QString makeDescription(Rng &rng)
+{
+    const int lines = rng.range(1, 8);
+    QStringList out;
+    for (int i = 0; i < lines; ++i)
+        out << makeWords(rng, 6, 12);
+    return out.join(QLatin1Char('\n'));
+}
+
+QString formatRpmQi(const PackageInfo &pkg, const QString &license, const QString &description,
+                    const QDateTime &installed)
+{
+    const int dash = pkg.version.lastIndexOf(QLatin1Char('-'));
+    const QString version = pkg.version.left(dash);
+    const QString release = pkg.version.mid(dash + 1);
+    const QString date = installed.toString(QStringLiteral("ddd dd MMM yyyy hh:mm:ss AP t"));
+
+    QString text;
+    text += QStringLiteral("Name        : %1\n").arg(pkg.name);
+    if (pkg.epoch != QLatin1String("0"))
+        text += QStringLiteral("Epoch       : %1\n").arg(pkg.epoch);
+    text += QStringLiteral("Version     : %1\n").arg(version);
+    text += QStringLiteral("Release     : %1\n").arg(release);
+    text += QStringLiteral("Architecture: %1\n").arg(pkg.arch);
+    text += QStringLiteral("Install Date: %1\n").arg(date);
+    text += QStringLiteral("Group       : %1\n").arg(pkg.group);
+    text += QStringLiteral("Size        : %1\n").arg(pkg.sizeBytes);
+    text += QStringLiteral("License     : %1\n").arg(license);
+    text += QStringLiteral("Signature   : RSA/SHA256, %1, Key ID 0727707ea15b79cc\n").arg(date);
+    text += QStringLiteral("Source RPM  : %1-%2.src.rpm\n").arg(pkg.name, pkg.version);
+    text += QStringLiteral("Build Date  : %1\n").arg(date);
+    text += QStringLiteral("Build Host  : buildhw-x86-%1.iad2.fedoraproject.org\n").arg(pkg.name.size() % 16, 2, 10, QLatin1Char('0'));
+    text += QStringLiteral("Packager    : Fedora Project\n");
+    text += QStringLiteral("Vendor      : Fedora Project\n");
+    text += QStringLiteral("URL         : https://example.org/%1\n").arg(pkg.name);
+    text += QStringLiteral("Bug URL     : https://bugz.fedoraproject.org/%1\n").arg(pkg.name);
+    text += QStringLiteral("Summary     : %1\n").arg(pkg.summary);
+    text += QStringLiteral("Description :\n%1\n").arg(description);
+    return text;
+}
+
+} // namespace
+
+SyntheticPackageSet::SyntheticPackageSet(int count, quint64 seed)
+{
+    Rng rng(seed);
+    QSet<QString> names;
+    names.reserve(count);
+    m_pkgs.reserve(count);
+    m_rpmQi.reserve(count);
+
+    const QDateTime base(QDate(2024, 4, 23), QTime(10, 0), QTimeZone::utc());
+
+    for (int i = 0; i < count; ++i) {
+        PackageInfo pkg;
+        QString name = QLatin1String(rng.pick(kPrefixes)) + makeStem(rng)
+                       + QLatin1String(rng.pick(kSuffixes));
+        if (names.contains(name))
+            name += QString::number(i);
+        names.insert(name);
+
+        pkg.name = name;
+        pkg.epoch = rng.uniform() < 0.08 ? QString::number(rng.range(1, 3)) : QStringLiteral("0");
+        pkg.version = makeVersion(rng) + QLatin1Char('-') + makeRelease(rng);
+        pkg.arch = QLatin1String(rng.pick(kArches));
+
+        const QDateTime installed = base.addSecs(qint64(rng.range(0, 200 * 24 * 3600)));
+        pkg.installDate = installed.toString(QStringLiteral("yyyy-MM-dd HH:mm"));
+        pkg.group = rng.uniform() < 0.9 ? QStringLiteral("Unspecified")
+                                        : QStringLiteral("System Environment/Libraries");
+        pkg.sizeBytes = qBound<qint64>(0, qint64(rng.logNormal(180.0 * 1024, 2.0)),
+                                       qint64(2) * 1024 * 1024 * 1024);
+        pkg.size = QString::number(pkg.sizeBytes);
+        pkg.repo = QLatin1String(rng.pick(kRepos));
+        pkg.summary = makeWords(rng, 3, 12);
+
+        const QString license = QLatin1String(rng.pick(kLicenses));
+        m_rpmQi << formatRpmQi(pkg, license, makeDescription(rng), installed);
+        m_pkgs << pkg;
+    }
+}
+
+QByteArray SyntheticPackageSet::repoqueryOutput() const
+{
+    QByteArray out;
+    out.reserve(m_pkgs.size() * 160);
+    // dnf prints this to stdout on RHEL-family hosts; the parser has to skip it
+    out += "Not root, Subscription Management repositories not updated\n";
+    for (const PackageInfo &pkg : m_pkgs) {
+        const QStringList fields{pkg.name, pkg.version, pkg.arch, pkg.installDate, pkg.group,
+                                 pkg.size, pkg.repo, pkg.summary, pkg.epoch};
+        out += fields.join(QChar(u'\x1F')).toUtf8();
+        out += '\n';
+    }
+    return out;
+}
+
+QString SyntheticPackageSet::checkUpdateOutput() const
+{
+    QString out = QStringLiteral("Last metadata expiration check: 0:12:04 ago.\n\n");
+    for (int i = 0; i < m_pkgs.size(); i += 8) {
+        const PackageInfo &pkg = m_pkgs.at(i);
+        const QString evr = (pkg.epoch == QLatin1String("0") ? QString() : pkg.epoch + QLatin1Char(':'))
+                            + pkg.version + QStringLiteral(".1");
+        out += QStringLiteral("%1.%2  %3  updates\n").arg(pkg.name, pkg.arch, evr);
+    }
+    return out;
+}
+
+QByteArray SyntheticPackageSet::rpmDependencyDump() const
+{
+    // Requires only point at earlier packages, so the graph is acyclic and the
+    // first package, standing in for bash, owns the /usr/bin/sh many require.
+    Rng rng(DefaultSeed ^ quint64(m_pkgs.size()));
+    QByteArray out;
+    out.reserve(m_pkgs.size() * 1200);
+    for (int i = 0; i < m_pkgs.size(); ++i) {
+        const PackageInfo &pkg = m_pkgs.at(i);
+        const QByteArray name = pkg.name.toUtf8();
+        out += '@' + name + '\x1F' + pkg.arch.toLatin1() + '\x1F' + QByteArray::number(pkg.sizeBytes) + '\n';
+        out += 'P' + name + '\n';
+        out += 'P' + name + "(x86-64)\n";
+        if (i % 3 == 0)
+            out += "Plib" + name + ".so.1()(64bit)\n";
+
+        if (i > 0) {
+            const int requireCount = rng.range(1, 6);
+            for (int r = 0; r < requireCount; ++r) {
+                const int dep = rng.range(0, i - 1);
+                const QByteArray depName = m_pkgs.at(dep).name.toUtf8();
+                if (dep % 3 == 0 && rng.uniform() < 0.5)
+                    out += "Rlib" + depName + ".so.1()(64bit)\n";
+                else if (rng.uniform() < 0.05)
+                    out += "R/usr/share/" + depName + "/file0\n";
+                else
+                    out += 'R' + depName + '\n';
+            }
+            if (rng.uniform() < 0.2)
+                out += "R/usr/bin/sh\n";
+        }
+        out += "Rrpmlib(CompressedFileNames) <= 3.0.4-1\n";
+
+        if (i == 0)
+            out += "F/usr/bin/sh\n";
+        const int files = rng.range(2, 60);
+        for (int f = 0; f < files; ++f)
+            out += "F/usr/share/" + name + "/file" + QByteArray::number(f) + '\n';
+    }
+    return out;
+}
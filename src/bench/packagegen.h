@@ -0,0 +1,39 @@
+/**
+ * @file packagegen.h
+ * @author Nikolay Yevik
+ * @brief Deterministic synthetic package sets for turborpm_bench; no dnf or rpm needed.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "packagemodel.h"
+
+class SyntheticPackageSet
+{
+public:
+    /** Same @p count and @p seed always give byte-identical output */
+    explicit SyntheticPackageSet(int count, quint64 seed = DefaultSeed);
+
+    static constexpr quint64 DefaultSeed = 0x7475726270726d31ULL;
+
+    const QVector<PackageInfo> &packages() const { return m_pkgs; }
+
+    /** stdout of "dnf repoquery --installed --qf InstalledPackageQuery::queryFormat()" */
+    QByteArray repoqueryOutput() const;
+    /** stdout of "rpm -qi <name>", one entry per package */
+    const QStringList &rpmQiOutputs() const { return m_rpmQi; }
+    /** stdout of "dnf check-update" offering a newer release for every 8th package */
+    QString checkUpdateOutput() const;
+    /** stdout of "rpm -qa" with RemovalImpactAnalyzer::dependencyQueryArguments() */
+    QByteArray rpmDependencyDump() const;
+
+private:
+    QVector<PackageInfo> m_pkgs;
+    QStringList m_rpmQi;
+};
@@ -0,0 +1,376 @@
+/**
+ * @file turborpm_bench.cpp
+ * @author Nikolay Yevik
+ * @brief Microbenchmarks of the package engine on synthetic data; results as JSON
+ * so runs can be compared across commits.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTemporaryDir>
+
+#include "packagegen.h"
+#include "../fleetmatrix.h"
+#include "../fleetsnapshot.h"
+#include "../packagefilterproxy.h"
+#include "../packagemodel.h"
+#include "../packagequery.h"
+#include "../removalimpact.h"
+#include "../rpminfo.h"
+#include "../sizeformat.h"
+#include "../updateset.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+namespace {
+
+struct BenchResult {
+    QString name;
+    int packages = 0;
+    QVector<qint64> samplesNs;
+};
+
+class Bench
+{
+public:
+    Bench(int iterations, const QString &filter) : m_iterations(iterations), m_filter(filter) {}
+
+    /** Times @p body @p m_iterations times after one warm-up run; @p setup is not timed */
+    void run(const QString &name, int packages, const std::function<void()> &body,
+             const std::function<void()> &setup = {})
+    {
+        if (!m_filter.isEmpty() && !name.contains(m_filter))
+            return;
+
+        BenchResult result{name, packages, {}};
+        for (int i = 0; i <= m_iterations; ++i) {
+            if (setup)
+                setup();
+            QElapsedTimer timer;
+            timer.start();
+            body();
+            const qint64 elapsed = timer.nsecsElapsed();
+            if (i > 0) // first run is warm-up
+                result.samplesNs.append(elapsed);
+        }
+
+        std::cerr << qPrintable(name) << " [" << packages << "]: "
+                  << double(median(result.samplesNs)) / 1e6 << " ms" << std::endl;
+        m_results.append(result);
+    }
+
+    QJsonObject toJson() const
+    {
+        QJsonArray results;
+        for (const BenchResult &r : m_results) {
+            QVector<qint64> sorted = r.samplesNs;
+            std::sort(sorted.begin(), sorted.end());
+            qint64 total = 0;
+            for (qint64 ns : sorted)
+                total += ns;
+            const qint64 med = median(sorted);
+
+            QJsonArray samples;
+            for (qint64 ns : r.samplesNs)
+                samples.append(ns);
+
+            results.append(QJsonObject{
+                {QStringLiteral("name"), r.name},
+                {QStringLiteral("packages"), r.packages},
+                {QStringLiteral("iterations"), int(sorted.size())},
+                {QStringLiteral("min_ns"), sorted.isEmpty() ? 0 : sorted.first()},
+                {QStringLiteral("median_ns"), med},
+                {QStringLiteral("mean_ns"), sorted.isEmpty() ? 0 : total / sorted.size()},
+                {QStringLiteral("max_ns"), sorted.isEmpty() ? 0 : sorted.last()},
+                {QStringLiteral("median_ns_per_package"),
+                 r.packages > 0 ? double(med) / r.packages : 0.0},
+                {QStringLiteral("samples_ns"), samples},
+            });
+        }
+
+        return QJsonObject{
+            {QStringLiteral("schema"), 1},
+            {QStringLiteral("timestamp"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+            {QStringLiteral("qt"), QLatin1String(qVersion())},
+            {QStringLiteral("cpu"), QSysInfo::currentCpuArchitecture()},
+            {QStringLiteral("host"), QSysInfo::machineHostName()},
+            {QStringLiteral("seed"), QString::number(SyntheticPackageSet::DefaultSeed, 16)},
+            {QStringLiteral("results"), results},
+        };
+    }
+
+private:
+    static qint64 median(QVector<qint64> samples)
+    {
+        if (samples.isEmpty())
+            return 0;
+        std::sort(samples.begin(), samples.end());
+        return samples.at(samples.size() / 2);
+    }
+
+    int m_iterations;
+    QString m_filter;
+    QVector<BenchResult> m_results;
+};
+
+void benchPackageSet(Bench &bench, int count)
+{
+    const SyntheticPackageSet set(count);
+    const QByteArray repoquery = set.repoqueryOutput();
+    const QStringList &rpmQi = set.rpmQiOutputs();
+    const QString checkUpdate = set.checkUpdateOutput();
+
+    // Keep results alive so the optimizer cannot drop the work
+    qsizetype sink = 0;
+
+    bench.run(QStringLiteral("parse/repoquery"), count, [&]() {
+        sink += InstalledPackageQuery::parseRepoqueryOutput(repoquery).size();
+    });
+
+    bench.run(QStringLiteral("parse/rpm-qi"), count, [&]() {
+        for (const QString &block : rpmQi)
+            sink += parseRpmQueryOutput(block).size();
+    });
+
+    bench.run(QStringLiteral("parse/check-update"), count, [&]() {
+        sink += UpdateSet::parseCheckUpdateOutput(checkUpdate).size();
+    });
+
+    PackageTableModel model;
+    bench.run(QStringLiteral("model/setPackages"), count, [&]() {
+        model.setPackages(set.packages());
+    });
+
+    const UpdateSet updates = UpdateSet::parseCheckUpdateOutput(checkUpdate);
+    bench.run(QStringLiteral("model/setUpdates"), count, [&]() {
+        model.setUpdates(updates);
+    });
+
+    // What sizing the columns costs the view after a reset: one pass per column
+    bench.run(QStringLiteral("model/widestTexts"), count,
+              [&]() {
+                  for (int column = 0; column < PackageTableModel::ColumnCount; ++column)
+                      sink += model.widestTexts(column).size();
+              },
+              [&]() {
+                  model.setPackages(set.packages());
+                  model.setUpdates(updates);
+              });
+
+    PackageFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.setFilterCaseSensitivity(Qt::CaseInsensitive);
+    proxy.setFilterKeyColumn(PackageTableModel::NameColumn);
+
+    for (int column = 0; column < PackageTableModel::ColumnCount; ++column) {
+        const QString header = model.headerData(column, Qt::Horizontal).toString();
+        bench.run(QStringLiteral("proxy/sort/%1").arg(header), count,
+                  [&proxy, column]() { proxy.sort(column, Qt::AscendingOrder); },
+                  [&proxy]() { proxy.sort(-1); });
+    }
+    proxy.sort(-1);
+
+    for (const char *needle : {"py", "lib", "a", "zzzz"}) {
+        bench.run(QStringLiteral("proxy/filter/%1").arg(QLatin1String(needle)), count,
+                  [&proxy, needle]() { proxy.setFilterFixedString(QLatin1String(needle)); },
+                  [&proxy]() { proxy.setFilterFixedString(QString()); });
+    }
+    bench.run(QStringLiteral("proxy/filter/updates-only"), count,
+              [&proxy]() { proxy.setUpdatesOnly(true); },
+              [&proxy]() {
+                  proxy.setFilterFixedString(QString());
+                  proxy.setUpdatesOnly(false);
+              });
+
+    for (const auto &[label, unit] : {std::pair{"KB", SizeUnit::Kilobytes},
+                                      std::pair{"MB", SizeUnit::Megabytes}}) {
+        bench.run(QStringLiteral("size/format/%1").arg(QLatin1String(label)), count, [&, unit]() {
+            for (const PackageInfo &pkg : set.packages())
+                sink += formatSizeValue(pkg.sizeBytes, unit).size();
+        });
+    }
+
+    if (sink == 0)
+        std::cerr << "unexpected: benchmarks produced no output" << std::endl;
+}
+
+/** @p hosts snapshots of a @p count package set, each drifted a little from the first */
+void benchFleet(Bench &bench, int hosts, int count)
+{
+    const SyntheticPackageSet set(count);
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        std::cerr << "fleet: no temporary directory" << std::endl;
+        return;
+    }
+
+    QStringList paths;
+    qint64 bytes = 0;
+    for (int h = 0; h < hosts; ++h) {
+        QVector<PackageInfo> pkgs;
+        pkgs.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            const int pattern = (i * 31 + h * 7) % 211;
+            if (h > 0 && pattern == 0)
+                continue; // not installed on this host
+            PackageInfo pkg = set.packages().at(i);
+            if (h > 0 && pattern < 3)
+                pkg.version += QStringLiteral(".h%1").arg(h % 5); // drifted release
+            pkgs.append(pkg);
+        }
+        const QString path = dir.filePath(QStringLiteral("host%1.%2").arg(h).arg(FleetSnapshot::suffix()));
+        if (!FleetSnapshot::write(path, pkgs, QStringLiteral("host%1").arg(h), h)) {
+            std::cerr << "fleet: cannot write " << qPrintable(path) << std::endl;
+            return;
+        }
+        bytes += QFileInfo(path).size();
+        paths << path;
+    }
+    std::cerr << "fleet: " << hosts << " snapshots, " << bytes / hosts << " bytes each" << std::endl;
+
+    qsizetype sink = 0;
+    bench.run(QStringLiteral("fleet/encode"), count, [&]() {
+        sink += FleetSnapshot::encode(set.packages(), QStringLiteral("host"), 0).size();
+    });
+
+    FleetMatrix matrix;
+    bench.run(QStringLiteral("fleet/load/%1-hosts").arg(hosts), hosts * count, [&]() {
+        matrix.load(paths);
+        sink += matrix.keyCount();
+    });
+
+    bench.run(QStringLiteral("fleet/diff/%1-hosts").arg(hosts), hosts * count, [&]() {
+        sink += FleetMatrix::differingKeys(matrix.diffAll(0)).size();
+    });
+
+    if (sink == 0)
+        std::cerr << "unexpected: fleet benchmarks produced no output" << std::endl;
+}
+
+/** The removal preview: dependency dump parse, graph build, then typical queries */
+void benchRemovalImpact(Bench &bench, int count)
+{
+    const SyntheticPackageSet set(count);
+    const QByteArray dump = set.rpmDependencyDump();
+    std::cerr << "removal: " << dump.size() / 1024 << " KiB dependency dump" << std::endl;
+
+    qsizetype sink = 0;
+    bench.run(QStringLiteral("removal/parse"), count, [&]() {
+        sink += RemovalImpactAnalyzer::parseDependencyDump(dump).size();
+    });
+
+    const QVector<PackageDependencies> deps = RemovalImpactAnalyzer::parseDependencyDump(dump);
+    RemovalImpactAnalyzer analyzer;
+    bench.run(QStringLiteral("removal/setPackages"), count, [&]() {
+        analyzer.setPackages(deps);
+        sink += analyzer.packageCount();
+    });
+
+    // Package 0 is required by much of the set; the last one by nothing
+    const QString root = deps.first().name;
+    const QString leaf = deps.last().name;
+    bench.run(QStringLiteral("removal/analyze/root"), count, [&]() {
+        sink += analyzer.analyze({root}).dependents.size();
+    });
+    bench.run(QStringLiteral("removal/analyze/leaf"), count, [&]() {
+        sink += analyzer.analyze({leaf}).targets.size();
+    });
+
+    if (sink == 0)
+        std::cerr << "unexpected: removal benchmarks produced no output" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("turborpm_bench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "TurboRPM engine microbenchmarks on deterministic synthetic package sets."));
+    parser.addHelpOption();
+    const QCommandLineOption sizesOption(QStringLiteral("sizes"),
+        QStringLiteral("Comma separated package counts (default 1000,10000,100000)."),
+        QStringLiteral("list"), QStringLiteral("1000,10000,100000"));
+    const QCommandLineOption iterationsOption(QStringLiteral("iterations"),
+        QStringLiteral("Timed iterations per benchmark after one warm-up (default 5)."),
+        QStringLiteral("n"), QStringLiteral("5"));
+    const QCommandLineOption filterOption(QStringLiteral("filter"),
+        QStringLiteral("Only run benchmarks whose name contains <text>."), QStringLiteral("text"));
+    const QCommandLineOption outputOption(QStringLiteral("output"),
+        QStringLiteral("Write JSON to <file> instead of stdout."), QStringLiteral("file"));
+    const QCommandLineOption fleetHostsOption(QStringLiteral("fleet-hosts"),
+        QStringLiteral("Snapshots in the fleet benchmarks, 0 to skip them (default 1000)."),
+        QStringLiteral("n"), QStringLiteral("1000"));
+    const QCommandLineOption fleetPackagesOption(QStringLiteral("fleet-packages"),
+        QStringLiteral("Packages per fleet snapshot (default 6000)."),
+        QStringLiteral("n"), QStringLiteral("6000"));
+    const QCommandLineOption graphPackagesOption(QStringLiteral("graph-packages"),
+        QStringLiteral("Packages in the removal-impact graph, 0 to skip it (default 6000)."),
+        QStringLiteral("n"), QStringLiteral("6000"));
+    parser.addOptions({sizesOption, iterationsOption, filterOption, outputOption,
+                       fleetHostsOption, fleetPackagesOption, graphPackagesOption});
+    parser.process(app);
+
+    bool ok = false;
+    const int iterations = parser.value(iterationsOption).toInt(&ok);
+    if (!ok || iterations < 1) {
+        std::cerr << "--iterations must be a positive number" << std::endl;
+        return 2;
+    }
+
+    Bench bench(iterations, parser.value(filterOption));
+    for (const QString &size : parser.value(sizesOption).split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        const int count = size.trimmed().toInt(&ok);
+        if (!ok || count <= 0) {
+            std::cerr << "invalid size: " << qPrintable(size) << std::endl;
+            return 2;
+        }
+        benchPackageSet(bench, count);
+    }
+
+    const int fleetHosts = parser.value(fleetHostsOption).toInt(&ok);
+    const int fleetPackages = ok ? parser.value(fleetPackagesOption).toInt(&ok) : 0;
+    if (!ok || fleetHosts < 0 || fleetPackages <= 0) {
+        std::cerr << "--fleet-hosts and --fleet-packages must be numbers" << std::endl;
+        return 2;
+    }
+    if (fleetHosts > 0)
+        benchFleet(bench, fleetHosts, fleetPackages);
+
+    const int graphPackages = parser.value(graphPackagesOption).toInt(&ok);
+    if (!ok || graphPackages < 0) {
+        std::cerr << "--graph-packages must be a number" << std::endl;
+        return 2;
+    }
+    if (graphPackages > 0)
+        benchRemovalImpact(bench, graphPackages);
+
+    const QByteArray json = QJsonDocument(bench.toJson()).toJson(QJsonDocument::Indented);
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::cerr << "cannot write " << qPrintable(file.fileName()) << std::endl;
+            return 1;
+        }
+        file.write(json);
+    } else {
+        std::cout << json.constData();
+    }
+    return 0;
+}
@@ -0,0 +1,419 @@
+/**
+ * @file turborpm_uibench.cpp
+ * @author Nikolay Yevik
+ * @brief Per-frame cost of scrolling, sorting, filtering and resizing the package
+ * table on the offscreen platform; p50/p99 as JSON so UI-path regressions show
+ * up between commits.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QAbstractSlider>
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFile>
+#include <QFontMetrics>
+#include <QHeaderView>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLineEdit>
+#include <QScrollBar>
+#include <QSysInfo>
+#include <QTableView>
+#include <QTest>
+#include <QVBoxLayout>
+#include <QWidget>
+
+#include "packagegen.h"
+#include "../elidedtextdelegate.h"
+#include "../packagefilterproxy.h"
+#include "../packagemodel.h"
+#include "../updateset.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+namespace {
+
+constexpr int WindowWidth {1280};
+constexpr int WindowHeight {800};
+constexpr int MaxSampledColumnWidthPx {480}; // as MainWindow
+const char FilterKeystrokes[] = "python3-lib";
+
+struct FrameResult {
+    QString name;
+    int rows = 0;
+    QVector<qint64> framesNs;
+};
+
+/** Counts paint events so a frame repaints exactly once */
+class PaintCounter : public QObject
+{
+public:
+    int paints = 0;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if (event->type() == QEvent::Paint)
+            ++paints;
+        return QObject::eventFilter(watched, event);
+    }
+};
+
+/** The package table as MainWindow sets it up, minus everything that talks to dnf */
+class TableWindow : public QWidget
+{
+public:
+    TableWindow()
+    {
+        m_proxy.setSourceModel(&m_model);
+        m_proxy.setFilterCaseSensitivity(Qt::CaseInsensitive);
+        m_proxy.setFilterKeyColumn(PackageTableModel::NameColumn);
+
+        auto *layout = new QVBoxLayout(this);
+        search = new QLineEdit(this);
+        view = new QTableView(this);
+        layout->addWidget(search);
+        layout->addWidget(view);
+
+        view->setModel(&m_proxy);
+        view->setItemDelegate(new ElidedTextDelegate(view));
+        ElidedTextDelegate::setUniformRowHeight(view);
+        view->setSelectionBehavior(QAbstractItemView::SelectRows);
+        view->setSelectionMode(QAbstractItemView::ExtendedSelection);
+        view->setSortingEnabled(true);
+        view->horizontalHeader()->setStretchLastSection(true);
+
+        QObject::connect(search, &QLineEdit::textChanged, &m_proxy,
+                         &PackageFilterProxyModel::setFilterFixedString);
+        view->viewport()->installEventFilter(&m_paints);
+        resize(WindowWidth, WindowHeight);
+    }
+
+    PackageTableModel &model() { return m_model; }
+
+    /**
+     * One frame: @p action, then whatever the event loop does with it (delayed
+     * layouts, the repaint), forcing the repaint if the loop did not paint.
+     */
+    qint64 frame(const std::function<void()> &action)
+    {
+        const int paintsBefore = m_paints.paints;
+        QElapsedTimer timer;
+        timer.start();
+        action();
+        QCoreApplication::processEvents();
+        if (m_paints.paints == paintsBefore)
+            view->viewport()->repaint();
+        return timer.nsecsElapsed();
+    }
+
+    /** Same column widths as MainWindow::resizeColumnsFromSamples() */
+    void resizeColumnsFromSamples()
+    {
+        const QFontMetrics metrics(view->font());
+        QHeaderView *header = view->horizontalHeader();
+        for (int column = 0; column < PackageTableModel::ColumnCount; ++column) {
+            const int width = ElidedTextDelegate::columnWidth(metrics, m_model.widestTexts(column),
+                                                              MaxSampledColumnWidthPx);
+            view->setColumnWidth(column, std::max(width, header->sectionSizeHint(column)));
+        }
+    }
+
+    QLineEdit *search = nullptr;
+    QTableView *view = nullptr;
+
+private:
+    PackageTableModel m_model;
+    PackageFilterProxyModel m_proxy;
+    PaintCounter m_paints;
+};
+
+qint64 percentile(const QVector<qint64> &sorted, double p)
+{
+    if (sorted.isEmpty())
+        return 0;
+    // Nearest rank
+    const int rank = int(std::ceil(p * sorted.size()));
+    return sorted.at(std::clamp(rank - 1, 0, int(sorted.size()) - 1));
+}
+
+class FrameBench
+{
+public:
+    FrameBench(int frames, int rounds, const QString &filter)
+        : m_frames(frames), m_rounds(rounds), m_filter(filter) {}
+
+    int frames() const { return m_frames; }
+    int rounds() const { return m_rounds; }
+
+    bool wants(const QString &name) const { return m_filter.isEmpty() || name.contains(m_filter); }
+
+    void add(const QString &name, int rows, QVector<qint64> framesNs)
+    {
+        QVector<qint64> sorted = framesNs;
+        std::sort(sorted.begin(), sorted.end());
+        std::cerr << qPrintable(name) << " [" << rows << "]: p50 "
+                  << double(percentile(sorted, 0.50)) / 1e6 << " ms, p99 "
+                  << double(percentile(sorted, 0.99)) / 1e6 << " ms" << std::endl;
+        m_results.append({name, rows, std::move(framesNs)});
+    }
+
+    QJsonObject toJson(double budgetMs) const
+    {
+        QJsonArray results;
+        for (const FrameResult &r : m_results) {
+            QVector<qint64> sorted = r.framesNs;
+            std::sort(sorted.begin(), sorted.end());
+            qint64 total = 0;
+            for (qint64 ns : sorted)
+                total += ns;
+
+            QJsonArray frames;
+            for (qint64 ns : r.framesNs)
+                frames.append(ns);
+
+            const qint64 p99 = percentile(sorted, 0.99);
+            results.append(QJsonObject{
+                {QStringLiteral("name"), r.name},
+                {QStringLiteral("rows"), r.rows},
+                {QStringLiteral("frames"), int(sorted.size())},
+                {QStringLiteral("p50_ns"), percentile(sorted, 0.50)},
+                {QStringLiteral("p99_ns"), p99},
+                {QStringLiteral("max_ns"), sorted.isEmpty() ? 0 : sorted.last()},
+                {QStringLiteral("mean_ns"), sorted.isEmpty() ? 0 : total / sorted.size()},
+                {QStringLiteral("within_budget"), double(p99) / 1e6 <= budgetMs},
+                {QStringLiteral("frames_ns"), frames},
+            });
+        }
+
+        return QJsonObject{
+            {QStringLiteral("schema"), 1},
+            {QStringLiteral("timestamp"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+            {QStringLiteral("qt"), QLatin1String(qVersion())},
+            {QStringLiteral("platform"), QGuiApplication::platformName()},
+            {QStringLiteral("cpu"), QSysInfo::currentCpuArchitecture()},
+            {QStringLiteral("host"), QSysInfo::machineHostName()},
+            {QStringLiteral("seed"), QString::number(SyntheticPackageSet::DefaultSeed, 16)},
+            {QStringLiteral("budget_ms"), budgetMs},
+            {QStringLiteral("results"), results},
+        };
+    }
+
+    /** Names of the budgeted results whose p99 is over @p budgetMs */
+    QStringList overBudget(double budgetMs, const QStringList &prefixes) const
+    {
+        QStringList names;
+        for (const FrameResult &r : m_results) {
+            QVector<qint64> sorted = r.framesNs;
+            std::sort(sorted.begin(), sorted.end());
+            const bool budgeted = std::any_of(prefixes.cbegin(), prefixes.cend(),
+                                              [&r](const QString &prefix) { return r.name.startsWith(prefix); });
+            if (budgeted && double(percentile(sorted, 0.99)) / 1e6 > budgetMs)
+                names << QStringLiteral("%1 [%2]").arg(r.name).arg(r.rows);
+        }
+        return names;
+    }
+
+private:
+    int m_frames;
+    int m_rounds;
+    QString m_filter;
+    QVector<FrameResult> m_results;
+};
+
+void benchTable(FrameBench &bench, int count)
+{
+    const SyntheticPackageSet set(count);
+    TableWindow window;
+    window.model().setPackages(set.packages());
+    window.model().setUpdates(UpdateSet::parseCheckUpdateOutput(set.checkUpdateOutput()));
+    window.show();
+    if (!QTest::qWaitForWindowExposed(&window)) {
+        std::cerr << "window was not exposed" << std::endl;
+        return;
+    }
+    QTableView *view = window.view;
+    QHeaderView *header = view->horizontalHeader();
+    window.resizeColumnsFromSamples();
+    QCoreApplication::processEvents();
+
+    // Full pages down, back to the top when the end is reached
+    if (bench.wants(QStringLiteral("scroll/page"))) {
+        QScrollBar *bar = view->verticalScrollBar();
+        QVector<qint64> frames;
+        for (int i = 0; i < bench.frames(); ++i) {
+            frames.append(window.frame([bar]() {
+                if (bar->value() >= bar->maximum())
+                    bar->setValue(bar->minimum());
+                else
+                    bar->triggerAction(QAbstractSlider::SliderPageStepAdd);
+            }));
+        }
+        bench.add(QStringLiteral("scroll/page"), count, frames);
+        bar->setValue(bar->minimum());
+    }
+
+    // Long jumps, as when the scroll bar handle is dragged
+    if (bench.wants(QStringLiteral("scroll/jump"))) {
+        QScrollBar *bar = view->verticalScrollBar();
+        QVector<qint64> frames;
+        for (int i = 0; i < bench.frames(); ++i) {
+            const int value = int((qint64(i) * 7919) % (qint64(bar->maximum()) + 1));
+            frames.append(window.frame([bar, value]() { bar->setValue(value); }));
+        }
+        bench.add(QStringLiteral("scroll/jump"), count, frames);
+        bar->setValue(bar->minimum());
+    }
+
+    // Two clicks per column: ascending, then descending
+    for (int column = 0; column < PackageTableModel::ColumnCount; ++column) {
+        const QString name = QStringLiteral("sort/header-click/%1")
+                                 .arg(window.model().headerData(column, Qt::Horizontal).toString());
+        if (!bench.wants(name))
+            continue;
+        view->horizontalScrollBar()->setValue(header->sectionPosition(column));
+        QCoreApplication::processEvents();
+        QVector<qint64> frames;
+        for (int round = 0; round < bench.rounds(); ++round) {
+            for (int click = 0; click < 2; ++click) {
+                const QPoint pos(header->sectionViewportPosition(column) + header->sectionSize(column) / 2,
+                                 header->height() / 2);
+                frames.append(window.frame([header, pos]() {
+                    QTest::mouseClick(header->viewport(), Qt::LeftButton, Qt::NoModifier, pos);
+                }));
+            }
+        }
+        bench.add(name, count, frames);
+    }
+    view->horizontalScrollBar()->setValue(0);
+    view->sortByColumn(PackageTableModel::NameColumn, Qt::AscendingOrder);
+
+    // Typing into the search box and deleting it again, one frame per key
+    if (bench.wants(QStringLiteral("filter/keystroke"))) {
+        QVector<qint64> frames;
+        for (int round = 0; round < bench.rounds(); ++round) {
+            for (const char *key = FilterKeystrokes; *key; ++key) {
+                frames.append(window.frame([&window, key]() { QTest::keyClick(window.search, *key); }));
+            }
+            while (!window.search->text().isEmpty()) {
+                frames.append(window.frame([&window]() {
+                    QTest::keyClick(window.search, Qt::Key_Backspace);
+                }));
+            }
+        }
+        bench.add(QStringLiteral("filter/keystroke"), count, frames);
+    }
+
+    // The path MainWindow takes after a refresh, and the one it replaced
+    if (bench.wants(QStringLiteral("resize/columns-from-samples"))) {
+        QVector<qint64> frames;
+        for (int round = 0; round < bench.rounds(); ++round)
+            frames.append(window.frame([&window]() { window.resizeColumnsFromSamples(); }));
+        bench.add(QStringLiteral("resize/columns-from-samples"), count, frames);
+    }
+    if (bench.wants(QStringLiteral("resize/columns-to-contents"))) {
+        QVector<qint64> frames;
+        for (int round = 0; round < bench.rounds(); ++round)
+            frames.append(window.frame([view]() { view->resizeColumnsToContents(); }));
+        bench.add(QStringLiteral("resize/columns-to-contents"), count, frames);
+        window.resizeColumnsFromSamples();
+    }
+
+    // The window dragged narrower and wider again
+    if (bench.wants(QStringLiteral("resize/window"))) {
+        QVector<qint64> frames;
+        for (int i = 0; i < bench.frames(); ++i) {
+            const int width = WindowWidth - 8 * (i % 40);
+            frames.append(window.frame([&window, width]() { window.resize(width, WindowHeight); }));
+        }
+        bench.add(QStringLiteral("resize/window"), count, frames);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Measures the widgets, not a compositor; a real display can still be asked for
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("turborpm_uibench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "TurboRPM package table frame timings (scroll, sort, filter, resize) on synthetic data."));
+    parser.addHelpOption();
+    const QCommandLineOption sizesOption(QStringLiteral("sizes"),
+        QStringLiteral("Comma separated row counts (default 10000,100000)."),
+        QStringLiteral("list"), QStringLiteral("10000,100000"));
+    const QCommandLineOption framesOption(QStringLiteral("frames"),
+        QStringLiteral("Frames per scroll and window-resize benchmark (default 200)."),
+        QStringLiteral("n"), QStringLiteral("200"));
+    const QCommandLineOption roundsOption(QStringLiteral("rounds"),
+        QStringLiteral("Repeats of each sort, filter and column-resize sequence (default 5)."),
+        QStringLiteral("n"), QStringLiteral("5"));
+    const QCommandLineOption filterOption(QStringLiteral("filter"),
+        QStringLiteral("Only run benchmarks whose name contains <text>."), QStringLiteral("text"));
+    const QCommandLineOption budgetOption(QStringLiteral("budget-ms"),
+        QStringLiteral("Frame budget for scroll and resize p99 (default 8)."),
+        QStringLiteral("ms"), QStringLiteral("8"));
+    const QCommandLineOption strictOption(QStringLiteral("strict"),
+        QStringLiteral("Exit with 1 when a scroll or window-resize p99 is over the budget."));
+    const QCommandLineOption outputOption(QStringLiteral("output"),
+        QStringLiteral("Write JSON to <file> instead of stdout."), QStringLiteral("file"));
+    parser.addOptions({sizesOption, framesOption, roundsOption, filterOption, budgetOption,
+                       strictOption, outputOption});
+    parser.process(app);
+
+    bool ok = false;
+    const int frames = parser.value(framesOption).toInt(&ok);
+    const int rounds = ok ? parser.value(roundsOption).toInt(&ok) : 0;
+    if (!ok || frames < 1 || rounds < 1) {
+        std::cerr << "--frames and --rounds must be positive numbers" << std::endl;
+        return 2;
+    }
+    const double budgetMs = parser.value(budgetOption).toDouble(&ok);
+    if (!ok || budgetMs <= 0) {
+        std::cerr << "--budget-ms must be a positive number" << std::endl;
+        return 2;
+    }
+
+    FrameBench bench(frames, rounds, parser.value(filterOption));
+    for (const QString &size : parser.value(sizesOption).split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        const int count = size.trimmed().toInt(&ok);
+        if (!ok || count <= 0) {
+            std::cerr << "invalid size: " << qPrintable(size) << std::endl;
+            return 2;
+        }
+        benchTable(bench, count);
+    }
+
+    const QByteArray json = QJsonDocument(bench.toJson(budgetMs)).toJson(QJsonDocument::Indented);
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::cerr << "cannot write " << qPrintable(file.fileName()) << std::endl;
+            return 1;
+        }
+        file.write(json);
+    } else {
+        std::cout << json.constData();
+    }
+
+    // Sorting and filtering re-map the whole proxy and are not held to a frame budget
+    const QStringList over = bench.overBudget(budgetMs, {QStringLiteral("scroll/"),
+                                                         QStringLiteral("resize/window")});
+    for (const QString &name : over)
+        std::cerr << "over the " << budgetMs << " ms budget: " << qPrintable(name) << std::endl;
+    return parser.isSet(strictOption) && !over.isEmpty() ? 1 : 0;
+}
@@ -0,0 +1,548 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the headless batch mode for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "cli.h"
+#include "fileverifier.h"
+#include "fleetsnapshot.h"
+#include "packagecache.h"
+#include "packagequery.h"
+#include "repoindexer.h"
+#include "rpminfo.h"
+#include "trace.h"
+#include "updateresolver.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QSysInfo>
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+// File-local constants go here:
+namespace {
+    constexpr int WaitForStartedTimeoutMs {5000};   // 5 s
+    constexpr int WaitForFinishedTimeoutMs {60000};  // 60 s
+    constexpr qsizetype OutputFlushBytes {64 * 1024};
+
+    constexpr int ExitOk {0};
+    constexpr int ExitFailed {1}; // query failed or nothing matched
+    constexpr int ExitUsage {2};
+}
+
+namespace {
+
+enum class OutputFormat {
+    JsonLines,
+    Tsv
+};
+
+/** Buffered stdout writer; a pipe into head/grep should not cost one write(2) per line */
+class LineWriter
+{
+public:
+    explicit LineWriter(OutputFormat format) : m_format(format) {}
+    ~LineWriter() { flush(); }
+
+    OutputFormat format() const { return m_format; }
+
+    void writeJson(const QJsonObject &object)
+    {
+        m_buffer += QJsonDocument(object).toJson(QJsonDocument::Compact);
+        endLine();
+    }
+
+    void writeTsv(const QStringList &fields)
+    {
+        for (qsizetype i = 0; i < fields.size(); ++i) {
+            if (i)
+                m_buffer += '\t';
+            m_buffer += escapeTsv(fields.at(i)).toUtf8();
+        }
+        endLine();
+    }
+
+    void flush()
+    {
+        if (!m_buffer.isEmpty())
+            std::fwrite(m_buffer.constData(), 1, size_t(m_buffer.size()), stdout);
+        m_buffer.clear();
+        std::fflush(stdout);
+    }
+
+private:
+    static QString escapeTsv(QString value)
+    {
+        value.replace(QLatin1Char('\\'), QStringLiteral("\\\\"));
+        value.replace(QLatin1Char('\t'), QStringLiteral("\\t"));
+        value.replace(QLatin1Char('\n'), QStringLiteral("\\n"));
+        return value;
+    }
+
+    void endLine()
+    {
+        m_buffer += '\n';
+        if (m_buffer.size() >= OutputFlushBytes)
+            flush();
+    }
+
+    OutputFormat m_format;
+    QByteArray m_buffer;
+};
+
+void printError(const QString &message)
+{
+    std::fprintf(stderr, "turborpm: %s\n", qPrintable(message));
+}
+
+bool runProcess(const QString &program, const QStringList &arguments,
+                QByteArray &out, int &exitCode, QString *error)
+{
+    TraceSpan span("process", program + QLatin1Char(' ') + arguments.join(QLatin1Char(' ')));
+    QProcess proc;
+    proc.setProcessChannelMode(QProcess::SeparateChannels);
+    proc.start(program, arguments);
+
+    if (!proc.waitForStarted(WaitForStartedTimeoutMs)) {
+        *error = QCoreApplication::translate("HeadlessCli", "Failed to start %1.").arg(program);
+        return false;
+    }
+    if (!proc.waitForFinished(WaitForFinishedTimeoutMs)) {
+        proc.kill();
+        *error = QCoreApplication::translate("HeadlessCli", "Timed out while running %1.").arg(program);
+        return false;
+    }
+    if (proc.exitStatus() != QProcess::NormalExit) {
+        *error = QCoreApplication::translate("HeadlessCli", "%1 crashed while running.").arg(program);
+        return false;
+    }
+
+    out = proc.readAllStandardOutput();
+    exitCode = proc.exitCode();
+    span.arg("exitCode", exitCode);
+    span.arg("stdoutBytes", out.size());
+    if (exitCode != 0)
+        *error = QString::fromLocal8Bit(proc.readAllStandardError()).trimmed();
+    return true;
+}
+
+/**
+ * Cached snapshot when the rpmdb is unchanged. Otherwise rpm -qa, which skips
+ * dnf's startup; repos are carried over from the stale snapshot for the
+ * packages it still lists. Only @p useCache false asks dnf, the one source of
+ * every repo, and refreshes the snapshot with the result.
+ */
+bool loadInstalled(QVector<PackageInfo> &pkgs, bool useCache, QString *error)
+{
+    if (!useCache) {
+        const QByteArray stamp = PackageCache::rpmdbStamp();
+        if (!InstalledPackageQuery::run(pkgs, error))
+            return false;
+        PackageCache::save(pkgs, stamp);
+        return true;
+    }
+
+    QVector<PackageInfo> cached;
+    bool fresh = false;
+    const bool haveCache = PackageCache::load(cached, PackageCache::defaultPath(), false, &fresh);
+    if (haveCache && fresh) {
+        pkgs = std::move(cached);
+        return true;
+    }
+
+    TraceSpan span("cli", "loadInstalled (rpm)");
+    if (!InstalledPackageQuery::runRpm(pkgs, error))
+        return false;
+    // Not saved: a snapshot without repos would blank the GUI's repo column
+    QHash<QString, QString> repos;
+    repos.reserve(cached.size());
+    for (const PackageInfo &pkg : std::as_const(cached))
+        repos.insert(PackageTableModel::nevraKey(pkg), pkg.repo);
+    for (PackageInfo &pkg : pkgs)
+        pkg.repo = repos.value(PackageTableModel::nevraKey(pkg));
+    span.arg("packages", pkgs.size());
+    span.arg("reposFromSnapshot", repos.size());
+    return true;
+}
+
+void writePackage(LineWriter &writer, const PackageInfo &pkg)
+{
+    if (writer.format() == OutputFormat::Tsv) {
+        writer.writeTsv({pkg.name, pkg.epoch, pkg.version, pkg.arch, pkg.installDate,
+                         pkg.group, pkg.sizeBytes >= 0 ? QString::number(pkg.sizeBytes) : QString(),
+                         pkg.repo, pkg.summary});
+        return;
+    }
+
+    QJsonObject object;
+    object.insert(QStringLiteral("name"), pkg.name);
+    object.insert(QStringLiteral("epoch"), pkg.epoch);
+    object.insert(QStringLiteral("version"), pkg.version);
+    object.insert(QStringLiteral("arch"), pkg.arch);
+    object.insert(QStringLiteral("installtime"), pkg.installDate);
+    object.insert(QStringLiteral("group"), pkg.group);
+    if (pkg.sizeBytes >= 0)
+        object.insert(QStringLiteral("size"), pkg.sizeBytes);
+    else
+        object.insert(QStringLiteral("size"), QJsonValue());
+    object.insert(QStringLiteral("repo"), pkg.repo);
+    object.insert(QStringLiteral("summary"), pkg.summary);
+    writer.writeJson(object);
+}
+
+int listPackages(LineWriter &writer, const QString &pattern, bool useCache)
+{
+    QVector<PackageInfo> pkgs;
+    QString error;
+    if (!loadInstalled(pkgs, useCache, &error)) {
+        printError(error);
+        return ExitFailed;
+    }
+
+    // Same glob semantics as "rpm -qa <pattern>"
+    const QRegularExpression match(QRegularExpression::wildcardToRegularExpression(pattern));
+    int written = 0;
+    for (const PackageInfo &pkg : std::as_const(pkgs)) {
+        if (!pattern.isEmpty() && !match.match(pkg.name).hasMatch())
+            continue;
+        writePackage(writer, pkg);
+        ++written;
+    }
+    return (pattern.isEmpty() || written > 0) ? ExitOk : ExitFailed;
+}
+
+int whatProvides(LineWriter &writer, const QStringList &paths)
+{
+    static constexpr char kFieldSep = '\x1F';
+    int result = ExitOk;
+
+    for (const QString &path : paths) {
+        const QString absolutePath = QFileInfo(path).absoluteFilePath();
+        QByteArray out;
+        int exitCode = 0;
+        QString error;
+        const bool ran = runProcess(QStringLiteral("rpm"),
+                                    {QStringLiteral("-qf"), QStringLiteral("--qf"),
+                                     QStringLiteral("%{name}\x1F%{epoch}\x1F%{version}-%{release}\x1F%{arch}\n"),
+                                     absolutePath},
+                                    out, exitCode, &error);
+        if (!ran || exitCode != 0) {
+            // rpm prints "file ... is not owned by any package" on stdout
+            if (error.isEmpty())
+                error = QString::fromLocal8Bit(out).trimmed();
+            if (writer.format() == OutputFormat::Tsv) {
+                writer.writeTsv({absolutePath, QString(), QString(), QString(), QString(), error});
+            } else {
+                QJsonObject object;
+                object.insert(QStringLiteral("path"), absolutePath);
+                object.insert(QStringLiteral("error"), error);
+                writer.writeJson(object);
+            }
+            result = ExitFailed;
+            continue;
+        }
+
+        // A path can be owned by several packages (shared directories, multilib)
+        for (const QByteArray &line : out.split('\n')) {
+            const QList<QByteArray> fields = line.split(kFieldSep);
+            if (fields.size() < 4)
+                continue;
+            QString epoch = QString::fromUtf8(fields.at(1));
+            if (epoch == QLatin1String("(none)"))
+                epoch = QStringLiteral("0");
+
+            if (writer.format() == OutputFormat::Tsv) {
+                writer.writeTsv({absolutePath, QString::fromUtf8(fields.at(0)), epoch,
+                                 QString::fromUtf8(fields.at(2)), QString::fromUtf8(fields.at(3))});
+            } else {
+                QJsonObject object;
+                object.insert(QStringLiteral("path"), absolutePath);
+                object.insert(QStringLiteral("name"), QString::fromUtf8(fields.at(0)));
+                object.insert(QStringLiteral("epoch"), epoch);
+                object.insert(QStringLiteral("version"), QString::fromUtf8(fields.at(2)));
+                object.insert(QStringLiteral("arch"), QString::fromUtf8(fields.at(3)));
+                writer.writeJson(object);
+            }
+        }
+    }
+    return result;
+}
+
+int packageInfo(LineWriter &writer, const QString &name)
+{
+    QByteArray out;
+    int exitCode = 0;
+    QString error;
+    if (!runProcess(QStringLiteral("rpm"), {QStringLiteral("-qi"), name}, out, exitCode, &error)) {
+        printError(error);
+        return ExitFailed;
+    }
+    if (exitCode != 0) {
+        printError(error.isEmpty() ? QString::fromLocal8Bit(out).trimmed() : error);
+        return ExitFailed;
+    }
+
+    // rpm -qi prints one block per installed instance (multilib, installonly kernels)
+    const QString text = QString::fromLocal8Bit(out);
+    static const QRegularExpression blockStart(QStringLiteral("\n(?=Name\\s*:)"));
+    for (const QString &block : text.split(blockStart, Qt::SkipEmptyParts)) {
+        const InfoRows rows = parseRpmQueryOutput(block);
+        if (rows.isEmpty())
+            continue;
+
+        if (writer.format() == OutputFormat::Tsv) {
+            for (const InfoRow &row : rows)
+                writer.writeTsv({row.first, row.second});
+            continue;
+        }
+        QJsonObject object;
+        for (const InfoRow &row : rows)
+            object.insert(row.first, row.second);
+        writer.writeJson(object);
+    }
+    return ExitOk;
+}
+
+/** rpm -V semantics: one line per mismatch, exit 1 when anything differs */
+int verifyPackages(LineWriter &writer, const QStringList &packages)
+{
+    QVector<ExpectedFile> files;
+    QString error;
+    if (!FileVerifier::query(files, packages, &error)) {
+        printError(error);
+        return ExitFailed;
+    }
+
+    FileVerifier verifier;
+    const VerifyStats stats = verifier.verify(files, [&writer](const VerifyResult &result) {
+        if (writer.format() == OutputFormat::Tsv) {
+            writer.writeTsv({result.flags, result.config ? QStringLiteral("c") : QString(),
+                             result.path, result.package, result.detail});
+            return;
+        }
+        QJsonObject object;
+        object.insert(QStringLiteral("package"), result.package);
+        object.insert(QStringLiteral("path"), result.path);
+        object.insert(QStringLiteral("flags"), result.flags);
+        object.insert(QStringLiteral("config"), result.config);
+        object.insert(QStringLiteral("missing"), result.missing);
+        object.insert(QStringLiteral("detail"), result.detail);
+        writer.writeJson(object);
+    });
+    return stats.mismatches == 0 ? ExitOk : ExitFailed;
+}
+
+/** Writes the installed set as a FleetSnapshot for the fleet view */
+int exportSnapshot(const QString &path, bool useCache)
+{
+    QVector<PackageInfo> pkgs;
+    QString error;
+    if (!loadInstalled(pkgs, useCache, &error)) {
+        printError(error);
+        return ExitFailed;
+    }
+    if (!FleetSnapshot::write(path, pkgs, QSysInfo::machineHostName(),
+                              QDateTime::currentMSecsSinceEpoch(), &error)) {
+        printError(QCoreApplication::translate("HeadlessCli", "Cannot write %1: %2").arg(path, error));
+        return ExitFailed;
+    }
+    return ExitOk;
+}
+
+/** dnf check-update from the cached metadata: one line per name.arch with a newer build */
+int checkUpdates(LineWriter &writer, bool useCache)
+{
+    QVector<PackageInfo> pkgs;
+    QString error;
+    if (!loadInstalled(pkgs, useCache, &error)) {
+        printError(error);
+        return ExitFailed;
+    }
+
+    UpdateResolver resolver;
+    QStringList errors;
+    resolver.loadCache(&errors);
+    for (const QString &failure : std::as_const(errors))
+        printError(failure);
+    if (resolver.isEmpty()) {
+        printError(QCoreApplication::translate("HeadlessCli", "No cached repository metadata found. "
+                                                              "Run \"dnf makecache\" once."));
+        return ExitFailed;
+    }
+
+    QVector<UpdateEntry> updates = resolver.resolve(pkgs).entries();
+    std::sort(updates.begin(), updates.end(), [](const UpdateEntry &a, const UpdateEntry &b) {
+        return UpdateSet::keyFor(a.name, a.arch) < UpdateSet::keyFor(b.name, b.arch);
+    });
+    for (const UpdateEntry &update : std::as_const(updates)) {
+        if (writer.format() == OutputFormat::Tsv) {
+            writer.writeTsv({update.name, update.arch, update.evr, update.repo});
+            continue;
+        }
+        QJsonObject object;
+        object.insert(QStringLiteral("name"), update.name);
+        object.insert(QStringLiteral("arch"), update.arch);
+        object.insert(QStringLiteral("evr"), update.evr);
+        object.insert(QStringLiteral("repo"), update.repo);
+        writer.writeJson(object);
+    }
+    return ExitOk;
+}
+
+/** createrepo for a directory of .rpm files; prints one stats object, failures to stderr */
+int indexRepository(LineWriter &writer, const QString &directory, bool useCache)
+{
+    RepoIndexer::Options options;
+    options.useCache = useCache;
+    RepoIndexer indexer(options);
+    RepoIndexStats stats;
+    QString error;
+    if (!indexer.index(directory, &stats, &error)) {
+        printError(QCoreApplication::translate("HeadlessCli", "Cannot index %1: %2").arg(directory, error));
+        return ExitFailed;
+    }
+    for (const QString &failure : std::as_const(stats.errors))
+        printError(failure);
+
+    if (writer.format() == OutputFormat::Tsv) {
+        writer.writeTsv({QString::number(stats.packages), QString::number(stats.reused),
+                         QString::number(stats.parsed), QString::number(stats.failed),
+                         QString::number(stats.bytesHashed), QString::number(stats.elapsedMs)});
+        return stats.failed == 0 ? ExitOk : ExitFailed;
+    }
+    QJsonObject object;
+    object.insert(QStringLiteral("packages"), stats.packages);
+    object.insert(QStringLiteral("reused"), stats.reused);
+    object.insert(QStringLiteral("parsed"), stats.parsed);
+    object.insert(QStringLiteral("failed"), stats.failed);
+    object.insert(QStringLiteral("bytesHashed"), stats.bytesHashed);
+    object.insert(QStringLiteral("elapsedMs"), stats.elapsedMs);
+    writer.writeJson(object);
+    return stats.failed == 0 ? ExitOk : ExitFailed;
+}
+
+} // namespace
+
+bool HeadlessCli::wantsHeadless(int argc, char *argv[])
+{
+    static const char *const headlessOptions[] = {
+        "--list", "--query", "--what-provides", "--info", "--verify", "--export-snapshot", "--index-repo", "--check-update", "--help", "-h", "--version", "-v",
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        const QByteArray arg(argv[i]);
+        for (const char *option : headlessOptions) {
+            if (arg == option || arg.startsWith(QByteArray(option) + '='))
+                return true;
+        }
+    }
+    return false;
+}
+
+int HeadlessCli::run(QCoreApplication &app)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        QCoreApplication::translate("HeadlessCli", "TurboRPM batch mode. Without any of the "
+                                                   "options below the graphical interface starts."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption listOption(QStringLiteral("list"),
+        QCoreApplication::translate("HeadlessCli", "List installed packages: the snapshot when current, else rpm -qa."));
+    const QCommandLineOption queryOption(QStringLiteral("query"),
+        QCoreApplication::translate("HeadlessCli", "List installed packages whose name matches <pattern> (glob)."),
+        QStringLiteral("pattern"));
+    const QCommandLineOption providesOption(QStringLiteral("what-provides"),
+        QCoreApplication::translate("HeadlessCli", "Show which package owns each <path> given as argument."));
+    const QCommandLineOption infoOption(QStringLiteral("info"),
+        QCoreApplication::translate("HeadlessCli", "Show rpm -qi fields of an installed <package>."),
+        QStringLiteral("package"));
+    const QCommandLineOption verifyOption(QStringLiteral("verify"),
+        QCoreApplication::translate("HeadlessCli", "Check installed files of the packages given as arguments "
+                                                   "(all packages if none) like rpm -V, in parallel."));
+    const QCommandLineOption exportOption(QStringLiteral("export-snapshot"),
+        QCoreApplication::translate("HeadlessCli", "Write the installed package list to <file> for the fleet view."),
+        QStringLiteral("file"));
+    const QCommandLineOption indexOption(QStringLiteral("index-repo"),
+        QCoreApplication::translate("HeadlessCli", "Write repodata/ for the .rpm files under <dir>, "
+                                                   "re-reading only packages changed since the last run."),
+        QStringLiteral("dir"));
+    const QCommandLineOption checkUpdateOption(QStringLiteral("check-update"),
+        QCoreApplication::translate("HeadlessCli", "List available upgrades of installed packages "
+                                                   "from the cached repository metadata."));
+    const QCommandLineOption formatOption(QStringLiteral("format"),
+        QCoreApplication::translate("HeadlessCli", "Output format: jsonl (default) or tsv."),
+        QStringLiteral("format"), QStringLiteral("jsonl"));
+    const QCommandLineOption noCacheOption(QStringLiteral("no-cache"),
+        QCoreApplication::translate("HeadlessCli", "Query dnf instead of the package snapshot or rpm; "
+                                                   "slower, but the only way to get every repo."));
+    // Consumed by Trace::startFromEnvironment() in main(); declared so the parser accepts it
+    const QCommandLineOption traceOption(QStringLiteral("trace"),
+        QCoreApplication::translate("HeadlessCli", "Write a Chrome trace-event file (also: TURBORPM_TRACE)."),
+        QStringLiteral("file"));
+
+    parser.addOptions({listOption, queryOption, providesOption, infoOption, verifyOption, exportOption,
+                       indexOption, checkUpdateOption, formatOption, noCacheOption, traceOption});
+    parser.addPositionalArgument(QStringLiteral("paths"),
+        QCoreApplication::translate("HeadlessCli", "Files for --what-provides, packages for --verify."),
+        QStringLiteral("[paths...]"));
+    parser.process(app); // handles --help/--version and exits on unknown options
+
+    const QString formatName = parser.value(formatOption);
+    OutputFormat format;
+    if (formatName == QLatin1String("jsonl") || formatName == QLatin1String("json")) {
+        format = OutputFormat::JsonLines;
+    } else if (formatName == QLatin1String("tsv")) {
+        format = OutputFormat::Tsv;
+    } else {
+        printError(QCoreApplication::translate("HeadlessCli", "Unknown format \"%1\".").arg(formatName));
+        return ExitUsage;
+    }
+
+    const int modes = int(parser.isSet(listOption)) + int(parser.isSet(queryOption))
+                      + int(parser.isSet(providesOption)) + int(parser.isSet(infoOption))
+                      + int(parser.isSet(verifyOption)) + int(parser.isSet(exportOption))
+                      + int(parser.isSet(indexOption)) + int(parser.isSet(checkUpdateOption));
+    if (modes != 1) {
+        printError(QCoreApplication::translate("HeadlessCli",
+                                               "Use exactly one of --list, --query, --what-provides, --info, --verify, "
+                                               "--export-snapshot, --index-repo, --check-update."));
+        return ExitUsage;
+    }
+
+    LineWriter writer(format);
+    const bool useCache = !parser.isSet(noCacheOption);
+
+    if (parser.isSet(listOption))
+        return listPackages(writer, QString(), useCache);
+    if (parser.isSet(queryOption))
+        return listPackages(writer, parser.value(queryOption), useCache);
+    if (parser.isSet(infoOption))
+        return packageInfo(writer, parser.value(infoOption).trimmed());
+    if (parser.isSet(verifyOption))
+        return verifyPackages(writer, parser.positionalArguments());
+    if (parser.isSet(exportOption))
+        return exportSnapshot(parser.value(exportOption), useCache);
+    if (parser.isSet(indexOption))
+        return indexRepository(writer, parser.value(indexOption), useCache);
+    if (parser.isSet(checkUpdateOption))
+        return checkUpdates(writer, useCache);
+
+    const QStringList paths = parser.positionalArguments();
+    if (paths.isEmpty()) {
+        printError(QCoreApplication::translate("HeadlessCli", "--what-provides needs at least one path."));
+        return ExitUsage;
+    }
+    return whatProvides(writer, paths);
+}
@@ -0,0 +1,20 @@
+/**
+ * @file cli.h
+ * @author Nikolay Yevik
+ * @brief Headless (QCoreApplication-only) batch mode for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+class QCoreApplication;
+
+class HeadlessCli
+{
+public:
+    /** True if argv asks for a batch mode (--list, --verify, --export-snapshot, ...), --help or --version */
+    static bool wantsHeadless(int argc, char *argv[]);
+
+    /** Parses the command line of @p app and writes results to stdout; returns the exit code */
+    static int run(QCoreApplication &app);
+};
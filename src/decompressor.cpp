@@ -0,0 +1,440 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the StreamDecompressor for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "decompressor.h"
+
+#include <QIODevice>
+#include <QObject>
+
+#include <lzma.h>
+#include <zlib.h>
+#include <zstd.h>
+
+#include <climits>
+#include <cstring>
+
+namespace {
+    constexpr qint64 InputChunkBytes {256 * 1024};
+    constexpr qsizetype OutputChunkBytes {256 * 1024};
+    // Balanced levels: metadata is written once per index run and fetched by every client
+    constexpr int DefaultGzipLevel {6};
+    constexpr uint32_t DefaultXzPreset {6};
+    constexpr int DefaultZstdLevel {10};
+}
+
+struct StreamDecompressor::Backend {
+    z_stream zs {};
+    bool zInit = false;
+    lzma_stream xz = LZMA_STREAM_INIT;
+    bool xzInit = false;
+    ZSTD_DStream *zstd = nullptr;
+    bool frameComplete = false; // the last frame/member ended cleanly
+
+    ~Backend()
+    {
+        if (zInit)
+            inflateEnd(&zs);
+        if (xzInit)
+            lzma_end(&xz);
+        if (zstd)
+            ZSTD_freeDStream(zstd);
+    }
+};
+
+StreamDecompressor::StreamDecompressor(QIODevice *source, Format format)
+    : m_source(source)
+    , m_format(format)
+{
+}
+
+StreamDecompressor::~StreamDecompressor() = default;
+
+StreamDecompressor::Format StreamDecompressor::detect(const QByteArray &magic)
+{
+    const auto *b = reinterpret_cast<const uchar *>(magic.constData());
+    const qsizetype n = magic.size();
+    if (n >= 2 && b[0] == 0x1f && b[1] == 0x8b)
+        return Format::Gzip;
+    if (n >= 6 && std::memcmp(b, "\xFD" "7zXZ\x00", 6) == 0)
+        return Format::Xz;
+    if (n >= 4 && b[0] == 0x28 && b[1] == 0xb5 && b[2] == 0x2f && b[3] == 0xfd)
+        return Format::Zstd;
+    return Format::None;
+}
+
+StreamDecompressor::Format StreamDecompressor::fromName(const QString &name)
+{
+    const QString lower = name.toLower();
+    if (lower == QLatin1String("gzip") || lower == QLatin1String("gz"))
+        return Format::Gzip;
+    if (lower == QLatin1String("xz") || lower == QLatin1String("lzma"))
+        return Format::Xz;
+    if (lower == QLatin1String("zstd") || lower == QLatin1String("zst"))
+        return Format::Zstd;
+    if (lower.isEmpty() || lower == QLatin1String("identity"))
+        return Format::None;
+    return Format::Auto;
+}
+
+bool StreamDecompressor::fillInput()
+{
+    if (m_inPos < m_in.size())
+        return true;
+    if (m_sourceEof || !m_source)
+        return false;
+
+    m_in = m_source->read(InputChunkBytes);
+    m_inPos = 0;
+    if (m_in.isEmpty()) {
+        m_sourceEof = true;
+        return false;
+    }
+    m_compressedRead += m_in.size();
+    return true;
+}
+
+bool StreamDecompressor::initBackend()
+{
+    if (m_format == Format::Auto) {
+        fillInput();
+        m_format = detect(m_in.mid(m_inPos, 8));
+    }
+
+    m_backend = std::make_unique<Backend>();
+    switch (m_format) {
+    case Format::Auto:
+    case Format::None:
+        return true;
+    case Format::Gzip:
+        // 15 window bits + 32: accept both zlib and gzip headers
+        if (inflateInit2(&m_backend->zs, 15 + 32) != Z_OK) {
+            m_error = QObject::tr("Failed to initialize gzip decoder.");
+            return false;
+        }
+        m_backend->zInit = true;
+        return true;
+    case Format::Xz:
+        if (lzma_stream_decoder(&m_backend->xz, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) {
+            m_error = QObject::tr("Failed to initialize xz decoder.");
+            return false;
+        }
+        m_backend->xzInit = true;
+        return true;
+    case Format::Zstd:
+        m_backend->zstd = ZSTD_createDStream();
+        if (!m_backend->zstd || ZSTD_isError(ZSTD_initDStream(m_backend->zstd))) {
+            m_error = QObject::tr("Failed to initialize zstd decoder.");
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+qint64 StreamDecompressor::read(char *data, qint64 maxSize)
+{
+    if (!m_error.isEmpty())
+        return -1;
+    if (m_finished || maxSize <= 0)
+        return 0;
+    if (!m_backend && !initBackend())
+        return -1;
+
+    qint64 produced = 0;
+    while (produced < maxSize && !m_finished) {
+        const bool haveInput = fillInput();
+        const char *in = haveInput ? m_in.constData() + m_inPos : nullptr;
+        const size_t inLen = haveInput ? size_t(m_in.size() - m_inPos) : 0;
+        char *out = data + produced;
+        const size_t outLen = size_t(qMin<qint64>(maxSize - produced, UINT_MAX));
+        size_t inUsed = 0;
+        size_t outUsed = 0;
+        bool streamEnd = false;
+
+        switch (m_format) {
+        case Format::Auto:
+        case Format::None: {
+            if (!haveInput) {
+                m_finished = true;
+                break;
+            }
+            outUsed = qMin(inLen, outLen);
+            std::memcpy(out, in, outUsed);
+            inUsed = outUsed;
+            break;
+        }
+        case Format::Gzip: {
+            z_stream &zs = m_backend->zs;
+            zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in));
+            zs.avail_in = uInt(inLen);
+            zs.next_out = reinterpret_cast<Bytef *>(out);
+            zs.avail_out = uInt(outLen);
+            const int rc = inflate(&zs, Z_NO_FLUSH);
+            inUsed = inLen - zs.avail_in;
+            outUsed = outLen - zs.avail_out;
+            if (rc == Z_STREAM_END) {
+                streamEnd = true;
+                inflateReset(&zs); // concatenated gzip members continue
+            } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+                m_error = QObject::tr("gzip data error: %1")
+                              .arg(QString::fromLatin1(zs.msg ? zs.msg : "unknown"));
+            }
+            break;
+        }
+        case Format::Xz: {
+            lzma_stream &xz = m_backend->xz;
+            xz.next_in = reinterpret_cast<const uint8_t *>(in);
+            xz.avail_in = inLen;
+            xz.next_out = reinterpret_cast<uint8_t *>(out);
+            xz.avail_out = outLen;
+            const lzma_ret rc = lzma_code(&xz, haveInput ? LZMA_RUN : LZMA_FINISH);
+            inUsed = inLen - xz.avail_in;
+            outUsed = outLen - xz.avail_out;
+            if (rc == LZMA_STREAM_END) {
+                streamEnd = true;
+                m_finished = true;
+            } else if (rc != LZMA_OK && rc != LZMA_BUF_ERROR) {
+                m_error = QObject::tr("xz data error (%1).").arg(int(rc));
+            }
+            break;
+        }
+        case Format::Zstd: {
+            ZSTD_inBuffer zin {in, inLen, 0};
+            ZSTD_outBuffer zout {out, outLen, 0};
+            const size_t rc = ZSTD_decompressStream(m_backend->zstd, &zout, &zin);
+            inUsed = zin.pos;
+            outUsed = zout.pos;
+            if (ZSTD_isError(rc)) {
+                m_error = QObject::tr("zstd data error: %1")
+                              .arg(QString::fromLatin1(ZSTD_getErrorName(rc)));
+            } else {
+                streamEnd = (rc == 0);
+            }
+            break;
+        }
+        }
+
+        m_inPos += qsizetype(inUsed);
+        produced += qint64(outUsed);
+
+        if (!m_error.isEmpty())
+            return produced > 0 ? produced : -1;
+
+        if (streamEnd)
+            m_backend->frameComplete = true;
+        else if (inUsed > 0 || outUsed > 0)
+            m_backend->frameComplete = false;
+
+        if (!haveInput && outUsed == 0 && !m_finished) {
+            // Nothing left to feed and nothing left to drain
+            if (!m_backend->frameComplete) {
+                m_error = QObject::tr("Compressed stream is truncated.");
+                return produced > 0 ? produced : -1;
+            }
+            m_finished = true;
+        }
+    }
+
+    return produced;
+}
+
+struct StreamCompressor::Backend {
+    z_stream zs {};
+    bool zInit = false;
+    lzma_stream xz = LZMA_STREAM_INIT;
+    bool xzInit = false;
+    ZSTD_CStream *zstd = nullptr;
+
+    ~Backend()
+    {
+        if (zInit)
+            deflateEnd(&zs);
+        if (xzInit)
+            lzma_end(&xz);
+        if (zstd)
+            ZSTD_freeCStream(zstd);
+    }
+};
+
+StreamCompressor::StreamCompressor(QIODevice *sink, Format format, int level)
+    : m_sink(sink)
+    , m_format(format == Format::Auto ? Format::None : format)
+    , m_level(level)
+{
+}
+
+StreamCompressor::~StreamCompressor() = default;
+
+QString StreamCompressor::suffix(Format format)
+{
+    switch (format) {
+    case Format::Gzip:
+        return QStringLiteral(".gz");
+    case Format::Xz:
+        return QStringLiteral(".xz");
+    case Format::Zstd:
+        return QStringLiteral(".zst");
+    case Format::Auto:
+    case Format::None:
+        break;
+    }
+    return {};
+}
+
+bool StreamCompressor::initBackend()
+{
+    m_backend = std::make_unique<Backend>();
+    m_out.resize(OutputChunkBytes);
+    switch (m_format) {
+    case Format::Auto:
+    case Format::None:
+        return true;
+    case Format::Gzip:
+        // 15 window bits + 16: gzip header and trailer, not zlib
+        if (deflateInit2(&m_backend->zs, m_level < 0 ? DefaultGzipLevel : m_level, Z_DEFLATED,
+                         15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            m_error = QObject::tr("Failed to initialize gzip encoder.");
+            return false;
+        }
+        m_backend->zInit = true;
+        return true;
+    case Format::Xz:
+        if (lzma_easy_encoder(&m_backend->xz, m_level < 0 ? DefaultXzPreset : uint32_t(m_level),
+                              LZMA_CHECK_CRC64) != LZMA_OK) {
+            m_error = QObject::tr("Failed to initialize xz encoder.");
+            return false;
+        }
+        m_backend->xzInit = true;
+        return true;
+    case Format::Zstd:
+        m_backend->zstd = ZSTD_createCStream();
+        if (!m_backend->zstd
+            || ZSTD_isError(ZSTD_initCStream(m_backend->zstd, m_level < 0 ? DefaultZstdLevel : m_level))) {
+            m_error = QObject::tr("Failed to initialize zstd encoder.");
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool StreamCompressor::flushOutput(qsizetype used)
+{
+    if (used <= 0)
+        return true;
+    if (m_sink->write(m_out.constData(), used) != used) {
+        m_error = m_sink->errorString();
+        return false;
+    }
+    m_bytesOut += used;
+    return true;
+}
+
+bool StreamCompressor::compress(const char *data, qint64 size, bool end)
+{
+    if (!m_error.isEmpty())
+        return false;
+    if (m_finished) {
+        m_error = QObject::tr("Write after the end of the compressed stream.");
+        return false;
+    }
+    if (!m_backend && !initBackend())
+        return false;
+
+    if (m_format == Format::None || m_format == Format::Auto) {
+        if (size > 0 && m_sink->write(data, size) != size) {
+            m_error = m_sink->errorString();
+            return false;
+        }
+        m_bytesOut += size;
+        return true;
+    }
+
+    // The encoders take at most UINT_MAX at a time; write() chunks before calling
+    char *out = m_out.data();
+    const size_t outLen = size_t(m_out.size());
+    switch (m_format) {
+    case Format::Gzip: {
+        z_stream &zs = m_backend->zs;
+        zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        zs.avail_in = uInt(size);
+        int rc = Z_OK;
+        do {
+            zs.next_out = reinterpret_cast<Bytef *>(out);
+            zs.avail_out = uInt(outLen);
+            rc = deflate(&zs, end ? Z_FINISH : Z_NO_FLUSH);
+            if (rc == Z_STREAM_ERROR) {
+                m_error = QObject::tr("gzip encoder error.");
+                return false;
+            }
+            if (!flushOutput(qsizetype(outLen - zs.avail_out)))
+                return false;
+        } while (zs.avail_out == 0 || (end && rc != Z_STREAM_END));
+        return true;
+    }
+    case Format::Xz: {
+        lzma_stream &xz = m_backend->xz;
+        xz.next_in = reinterpret_cast<const uint8_t *>(data);
+        xz.avail_in = size_t(size);
+        lzma_ret rc = LZMA_OK;
+        do {
+            xz.next_out = reinterpret_cast<uint8_t *>(out);
+            xz.avail_out = outLen;
+            rc = lzma_code(&xz, end ? LZMA_FINISH : LZMA_RUN);
+            if (rc != LZMA_OK && rc != LZMA_STREAM_END) {
+                m_error = QObject::tr("xz encoder error (%1).").arg(int(rc));
+                return false;
+            }
+            if (!flushOutput(qsizetype(outLen - xz.avail_out)))
+                return false;
+        } while (xz.avail_out == 0 || (end && rc != LZMA_STREAM_END));
+        return true;
+    }
+    case Format::Zstd: {
+        ZSTD_inBuffer zin {data, size_t(size), 0};
+        size_t rc = 0;
+        do {
+            ZSTD_outBuffer zout {out, outLen, 0};
+            rc = end ? ZSTD_endStream(m_backend->zstd, &zout)
+                     : ZSTD_compressStream(m_backend->zstd, &zout, &zin);
+            if (ZSTD_isError(rc)) {
+                m_error = QObject::tr("zstd encoder error: %1")
+                              .arg(QString::fromLatin1(ZSTD_getErrorName(rc)));
+                return false;
+            }
+            if (!flushOutput(qsizetype(zout.pos)))
+                return false;
+        } while (end ? rc != 0 : zin.pos < zin.size);
+        return true;
+    }
+    case Format::Auto:
+    case Format::None:
+        break;
+    }
+    return true;
+}
+
+bool StreamCompressor::write(const char *data, qint64 size)
+{
+    m_bytesIn += size;
+    while (size > 0) {
+        const qint64 chunk = qMin<qint64>(size, INT_MAX);
+        if (!compress(data, chunk, false))
+            return false;
+        data += chunk;
+        size -= chunk;
+    }
+    return m_error.isEmpty();
+}
+
+bool StreamCompressor::finish()
+{
+    if (m_finished)
+        return m_error.isEmpty();
+    const bool ok = compress(nullptr, 0, true);
+    m_finished = true;
+    return ok;
+}
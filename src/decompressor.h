@@ -0,0 +1,108 @@
+/**
+ * @file decompressor.h
+ * @author Nikolay Yevik
+ * @brief Streaming gzip/xz/zstd decompression and compression for TurboRPM Package Manager Prototype.
+ * Reads from / writes to any QIODevice in fixed-size chunks, so memory stays
+ * constant no matter how large the stream is.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include <memory>
+
+class QIODevice;
+
+class StreamDecompressor
+{
+public:
+    enum class Format {
+        Auto,
+        None,
+        Gzip,
+        Xz,
+        Zstd
+    };
+
+    /** @p source must stay open and alive while reading */
+    explicit StreamDecompressor(QIODevice *source, Format format = Format::Auto);
+    ~StreamDecompressor();
+
+    StreamDecompressor(const StreamDecompressor &) = delete;
+    StreamDecompressor &operator=(const StreamDecompressor &) = delete;
+
+    /** Detects the format from the first bytes of a stream */
+    static Format detect(const QByteArray &magic);
+    /** Maps rpm's PAYLOADCOMPRESSOR / a file suffix ("zstd", "xz", "gzip", ...) */
+    static Format fromName(const QString &name);
+
+    /** Reads up to @p maxSize decompressed bytes; 0 at end of stream, -1 on error */
+    qint64 read(char *data, qint64 maxSize);
+    bool atEnd() const { return m_finished; }
+    Format format() const { return m_format; }
+    QString errorString() const { return m_error; }
+    /** Total compressed bytes consumed from the source so far */
+    qint64 compressedBytesRead() const { return m_compressedRead; }
+
+private:
+    struct Backend;
+
+    bool fillInput();
+    bool initBackend();
+
+    QIODevice *m_source = nullptr;
+    Format m_format = Format::Auto;
+    QByteArray m_in; // compressed input window
+    qsizetype m_inPos = 0;
+    qint64 m_compressedRead = 0;
+    bool m_sourceEof = false;
+    bool m_finished = false;
+    QString m_error;
+    std::unique_ptr<Backend> m_backend;
+};
+
+/** The write side: compresses everything passed to write() straight into @p sink */
+class StreamCompressor
+{
+public:
+    using Format = StreamDecompressor::Format;
+
+    /** @p sink must stay open and alive until finish(); Auto and None store uncompressed */
+    explicit StreamCompressor(QIODevice *sink, Format format, int level = -1);
+    ~StreamCompressor();
+
+    StreamCompressor(const StreamCompressor &) = delete;
+    StreamCompressor &operator=(const StreamCompressor &) = delete;
+
+    /** ".gz", ".xz", ".zst" or "" */
+    static QString suffix(Format format);
+
+    bool write(const char *data, qint64 size);
+    bool write(const QByteArray &data) { return write(data.constData(), data.size()); }
+    /** Writes the end of the stream; nothing may be written after it */
+    bool finish();
+
+    QString errorString() const { return m_error; }
+    qint64 bytesIn() const { return m_bytesIn; }
+    qint64 bytesOut() const { return m_bytesOut; }
+
+private:
+    struct Backend;
+
+    bool initBackend();
+    bool compress(const char *data, qint64 size, bool end);
+    bool flushOutput(qsizetype used);
+
+    QIODevice *m_sink = nullptr;
+    Format m_format = Format::None;
+    int m_level = -1;
+    QByteArray m_out; // compressed output window
+    qint64 m_bytesIn = 0;
+    qint64 m_bytesOut = 0;
+    bool m_finished = false;
+    QString m_error;
+    std::unique_ptr<Backend> m_backend;
+};
@@ -0,0 +1,114 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the cached-text item delegate for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "elidedtextdelegate.h"
+
+#include <QApplication>
+#include <QFontMetrics>
+#include <QHeaderView>
+#include <QPainter>
+#include <QStyle>
+#include <QTableView>
+
+#include <algorithm>
+
+namespace {
+    constexpr int MaxCachedLines {8192}; // several screens of cells; rebuilt after that
+    constexpr int RowPaddingPx {6}; // above and below the text together
+    constexpr int TextMarginPx {4}; // each side; the style's inset plus a pixel of air
+}
+
+ElidedTextDelegate::ElidedTextDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void ElidedTextDelegate::clearCache()
+{
+    m_lines.clear();
+}
+
+void ElidedTextDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                               const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    if (!(opt.features & QStyleOptionViewItem::HasDisplay)
+        || (opt.features & (QStyleOptionViewItem::HasCheckIndicator | QStyleOptionViewItem::HasDecoration))) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    const QWidget *widget = opt.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+
+    // Background, selection and focus from the style; the text is ours
+    const QString text = opt.text;
+    opt.text.clear();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+    if (text.isEmpty())
+        return;
+
+    // Same inset QCommonStyle gives item text
+    const int margin = style->pixelMetric(QStyle::PM_FocusFrameHMargin, nullptr, widget) + 1;
+    const QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &opt, widget)
+                               .adjusted(margin, 0, -margin, 0);
+    if (textRect.width() <= 0)
+        return;
+
+    if (m_lines.size() >= MaxCachedLines)
+        m_lines.clear();
+    Line &line = m_lines[(quint64(quint32(index.row())) << 32) | quint32(index.column())];
+    if (line.width != textRect.width() || line.text != text || line.font != opt.font) {
+        const QFontMetrics metrics(opt.font);
+        line.text = text;
+        line.width = textRect.width();
+        line.font = opt.font;
+        line.elided.setTextFormat(Qt::PlainText);
+        line.elided.setText(metrics.elidedText(text, opt.textElideMode, textRect.width()));
+        line.elided.prepare(QTransform(), opt.font);
+    }
+
+    QPalette::ColorGroup group = QPalette::Normal;
+    if (!(opt.state & QStyle::State_Enabled))
+        group = QPalette::Disabled;
+    else if (!(opt.state & QStyle::State_Active))
+        group = QPalette::Inactive;
+    const QPalette::ColorRole role = (opt.state & QStyle::State_Selected) ? QPalette::HighlightedText
+                                                                         : QPalette::Text;
+
+    const QSizeF size = line.elided.size();
+    qreal x = textRect.left();
+    if (opt.displayAlignment & Qt::AlignRight)
+        x = textRect.right() + 1 - size.width();
+    else if (opt.displayAlignment & Qt::AlignHCenter)
+        x = textRect.left() + (textRect.width() - size.width()) / 2;
+    const qreal y = textRect.top() + (textRect.height() - size.height()) / 2;
+
+    painter->save();
+    painter->setFont(opt.font);
+    painter->setPen(opt.palette.color(group, role));
+    painter->drawStaticText(QPointF(x, y), line.elided);
+    painter->restore();
+}
+
+void ElidedTextDelegate::setUniformRowHeight(QTableView *view)
+{
+    const int height = view->fontMetrics().height() + RowPaddingPx;
+    QHeaderView *rows = view->verticalHeader();
+    rows->setMinimumSectionSize(height);
+    rows->setDefaultSectionSize(height);
+    rows->setSectionResizeMode(QHeaderView::Fixed);
+    view->setWordWrap(false);
+}
+
+int ElidedTextDelegate::columnWidth(const QFontMetrics &metrics, const QStringList &samples, int maxWidth)
+{
+    int width = 0;
+    for (const QString &sample : samples)
+        width = std::max(width, metrics.horizontalAdvance(sample));
+    return std::min(width + 2 * TextMarginPx, maxWidth);
+}
@@ -0,0 +1,53 @@
+/**
+ * @file elidedtextdelegate.h
+ * @author Nikolay Yevik
+ * @brief Item delegate that draws plain single-line cells from cached, pre-elided
+ * text for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QFont>
+#include <QHash>
+#include <QStaticText>
+#include <QStringList>
+#include <QStyledItemDelegate>
+
+class QFontMetrics;
+class QTableView;
+
+/**
+ * The default delegate lays the display text out again on every paint, so a
+ * scroll frame over a wide table spends most of its time eliding summaries.
+ * This one keeps the elided QStaticText per visible (row, column) and only
+ * redoes it when the text, the width or the font changed. Cells with a check
+ * box or an icon still go through QStyledItemDelegate.
+ */
+class ElidedTextDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit ElidedTextDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+
+    /** Drops every cached layout, e.g. after a font or model change */
+    void clearCache();
+
+    /** Rows as tall as one line of @p view's font, never measured per row */
+    static void setUniformRowHeight(QTableView *view);
+    /** Width that fits the widest of @p samples in @p metrics plus cell margins, at most @p maxWidth */
+    static int columnWidth(const QFontMetrics &metrics, const QStringList &samples, int maxWidth);
+
+private:
+    struct Line {
+        QString text; // as the model returned it
+        int width = 0; // elided for this many pixels
+        QFont font;
+        QStaticText elided;
+    };
+
+    mutable QHash<quint64, Line> m_lines; // (row, column) -> layout
+};
@@ -0,0 +1,523 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the parallel installed-file verifier for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "fileverifier.h"
+#include "sha256.h"
+#include "trace.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QObject>
+#include <QProcess>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+// File-local constants go here:
+namespace {
+    constexpr int WaitForStartedTimeoutMs {5000};   // 5 s
+    constexpr int QueryTimeoutMs {600000}; // 10 min: rpm -qa with every file list
+    constexpr int QueryFieldCount {10};
+    constexpr int ReadChunkBytes {256 * 1024};
+    constexpr int DigestSha256 {8};
+    constexpr int FileStateNormal {0};
+    constexpr int FileStateReplaced {1};
+}
+
+namespace {
+
+/** SHA-256 through Sha256, the legacy algorithms through QCryptographicHash */
+class Digest
+{
+public:
+    explicit Digest(int algo)
+    {
+        if (algo == DigestSha256) {
+            m_valid = true;
+            return;
+        }
+        QCryptographicHash::Algorithm qtAlgo;
+        switch (algo) {
+        case 1: qtAlgo = QCryptographicHash::Md5; break;
+        case 2: qtAlgo = QCryptographicHash::Sha1; break;
+        case 9: qtAlgo = QCryptographicHash::Sha384; break;
+        case 10: qtAlgo = QCryptographicHash::Sha512; break;
+        case 11: qtAlgo = QCryptographicHash::Sha224; break;
+        default: return;
+        }
+        m_qt = std::make_unique<QCryptographicHash>(qtAlgo);
+        m_valid = true;
+    }
+
+    bool isValid() const { return m_valid; }
+
+    void add(const char *data, qint64 length)
+    {
+        if (m_qt)
+            m_qt->addData(QByteArrayView(data, length));
+        else
+            m_sha.update(data, std::size_t(length));
+    }
+
+    QByteArray hex() { return m_qt ? m_qt->result().toHex() : m_sha.finalize().toHex(); }
+
+private:
+    Sha256 m_sha;
+    std::unique_ptr<QCryptographicHash> m_qt;
+    bool m_valid = false;
+};
+
+int openForHashing(const QByteArray &path)
+{
+    // Auditing must not rewrite the atime of every file; O_NOATIME needs ownership or root
+    int fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC | O_NOATIME);
+    if (fd < 0 && errno == EPERM)
+        fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+    return fd;
+}
+
+/** Sysfs directory of the whole disk behind block device @p major:@p minor, or empty */
+QString sysfsDisk(unsigned major, unsigned minor)
+{
+    const QString node = QFileInfo(QStringLiteral("/sys/dev/block/%1:%2").arg(major).arg(minor))
+                             .canonicalFilePath();
+    if (node.isEmpty())
+        return {};
+    // Partitions sit below their disk; the queue settings live on the disk
+    if (QFileInfo::exists(node + QStringLiteral("/partition")))
+        return QFileInfo(node).path();
+    return node;
+}
+
+/** Block device listed as the source of the mount with st_dev @p major:@p minor (btrfs, ...) */
+quint64 mountSourceDevice(unsigned major, unsigned minor)
+{
+    QFile mountInfo(QStringLiteral("/proc/self/mountinfo"));
+    if (!mountInfo.open(QIODevice::ReadOnly))
+        return 0;
+    const QByteArray wanted = QByteArray::number(major) + ':' + QByteArray::number(minor);
+    for (const QByteArray &line : mountInfo.readAll().split('\n')) {
+        // id parent major:minor root mountpoint options... - fstype source superoptions
+        const QList<QByteArray> fields = line.split(' ');
+        if (fields.size() < 3 || fields.at(2) != wanted)
+            continue;
+        const int separator = fields.indexOf("-");
+        if (separator < 0 || separator + 2 >= fields.size())
+            continue;
+        const QByteArray source = fields.at(separator + 2);
+        struct stat st;
+        if (source.startsWith("/dev/") && ::stat(source.constData(), &st) == 0 && S_ISBLK(st.st_mode))
+            return quint64(st.st_rdev);
+    }
+    return 0;
+}
+
+/** One semaphore per physical disk, shared by every st_dev that lives on it */
+class DiskGates
+{
+public:
+    DiskGates(int rotationalLimit, int solidStateLimit)
+        : m_rotationalLimit(rotationalLimit), m_solidStateLimit(solidStateLimit) {}
+
+    ~DiskGates() { qDeleteAll(m_byDisk); }
+
+    QSemaphore *gateFor(quint64 device)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (QSemaphore *gate = m_byDevice.value(device))
+            return gate;
+        bool rotational = false;
+        const QString disk = FileVerifier::diskKey(device, &rotational);
+        QSemaphore *&gate = m_byDisk[disk];
+        if (!gate) {
+            gate = new QSemaphore(rotational ? m_rotationalLimit : m_solidStateLimit);
+            Trace::instant("verify", "FileVerifier::disk",
+                           {{QStringLiteral("disk"), disk},
+                            {QStringLiteral("rotational"), rotational}});
+        }
+        m_byDevice.insert(device, gate);
+        return gate;
+    }
+
+private:
+    QMutex m_mutex;
+    QHash<quint64, QSemaphore *> m_byDevice;
+    QHash<QString, QSemaphore *> m_byDisk;
+    int m_rotationalLimit;
+    int m_solidStateLimit;
+};
+
+QString octalMode(quint32 mode)
+{
+    return QStringLiteral("0%1").arg(mode, 0, 8);
+}
+
+QString formatTime(qint64 seconds)
+{
+    return QDateTime::fromSecsSinceEpoch(seconds).toString(Qt::ISODate);
+}
+
+QString typeName(quint32 mode)
+{
+    switch (mode & S_IFMT) {
+    case S_IFREG: return QObject::tr("regular file");
+    case S_IFDIR: return QObject::tr("directory");
+    case S_IFLNK: return QObject::tr("symlink");
+    default: return QObject::tr("special file");
+    }
+}
+
+/** verifyFile() with content reads optionally going through @p gates */
+bool checkFile(const ExpectedFile &file, VerifyResult &result, const QString &root,
+               qint64 *bytesHashed, DiskGates *gates)
+{
+    if (file.flags & FileVerifier::GhostFile)
+        return false;
+    // Not installed (%lang, --excludedocs), netshared or the wrong multilib color
+    if (file.state != FileStateNormal && file.state != FileStateReplaced)
+        return false;
+
+    result = VerifyResult();
+    result.package = file.package;
+    result.path = file.path;
+    result.config = file.flags & FileVerifier::ConfigFile;
+
+    const QByteArray native = QFile::encodeName(root + file.path);
+    struct stat st;
+    if (::lstat(native.constData(), &st) != 0) {
+        const int err = errno;
+        if ((err == ENOENT || err == ENOTDIR) && (file.flags & FileVerifier::MissingOk))
+            return false;
+        result.missing = err == ENOENT || err == ENOTDIR;
+        result.flags = result.missing ? QStringLiteral("missing") : QStringLiteral("?????????");
+        result.detail = QString::fromLocal8Bit(std::strerror(err));
+        return true;
+    }
+    // Overwritten by another package: only its existence can be checked
+    if (file.state == FileStateReplaced)
+        return false;
+
+    QByteArray flags(9, '.'); // S M 5 D L U G T P
+    QStringList details;
+    const quint32 expectedType = file.mode & S_IFMT;
+    const quint32 actualType = quint32(st.st_mode) & S_IFMT;
+
+    if (expectedType != actualType) {
+        flags[1] = 'M';
+        details << QObject::tr("%1, expected %2").arg(typeName(st.st_mode), typeName(file.mode));
+    } else if (expectedType != S_IFLNK && (quint32(st.st_mode) & 07777) != (file.mode & 07777)) {
+        flags[1] = 'M';
+        details << QObject::tr("mode %1, expected %2")
+                       .arg(octalMode(st.st_mode & 07777), octalMode(file.mode & 07777));
+    }
+
+    if (expectedType == S_IFREG && actualType == S_IFREG) {
+        if (qint64(st.st_size) != file.size) {
+            // Different length, different content: no need to read it
+            flags[0] = 'S';
+            flags[2] = '5';
+            details << QObject::tr("size %1, expected %2").arg(qint64(st.st_size)).arg(file.size);
+        } else if (!file.digest.isEmpty()) {
+            QSemaphore *gate = gates ? gates->gateFor(quint64(st.st_dev)) : nullptr;
+            if (gate)
+                gate->acquire();
+            QString error;
+            const QByteArray digest = FileVerifier::fileDigest(QString::fromLocal8Bit(native),
+                                                               file.digestAlgo, bytesHashed, &error);
+            if (gate)
+                gate->release();
+            if (digest.isEmpty()) {
+                flags[2] = '?';
+                details << error;
+            } else if (digest != file.digest) {
+                flags[2] = '5';
+                details << QObject::tr("content differs");
+            }
+        }
+        if (qint64(st.st_mtime) != file.mtime) {
+            flags[7] = 'T';
+            details << QObject::tr("modified %1, expected %2")
+                           .arg(formatTime(st.st_mtime), formatTime(file.mtime));
+        }
+    } else if (expectedType == S_IFLNK) {
+        QByteArray target(PATH_MAX, Qt::Uninitialized);
+        const ssize_t n = actualType == S_IFLNK
+                              ? ::readlink(native.constData(), target.data(), size_t(target.size()))
+                              : -1;
+        const QString actual = n >= 0 ? QFile::decodeName(target.left(n)) : QString();
+        if (n < 0 || actual != file.linkTarget) {
+            flags[4] = 'L';
+            details << QObject::tr("points to %1, expected %2")
+                           .arg(n < 0 ? QStringLiteral("-") : actual, file.linkTarget);
+        }
+    }
+
+    if (flags == QByteArray(9, '.'))
+        return false;
+    result.flags = QString::fromLatin1(flags);
+    result.detail = details.join(QStringLiteral("; "));
+    return true;
+}
+
+} // namespace
+
+QString FileVerifier::queryFormat()
+{
+    // Scalars (NEVRA, FILEDIGESTALGO) repeat on every line of the [] iteration
+    return QStringLiteral(
+        "[%{NEVRA}\x1F"
+        "%{FILENAMES}\x1F"
+        "%{FILEDIGESTS}\x1F"
+        "%{FILESIZES}\x1F"
+        "%{FILEMODES}\x1F"
+        "%{FILEMTIMES}\x1F"
+        "%{FILEFLAGS}\x1F"
+        "%{FILESTATES}\x1F"
+        "%{FILELINKTOS}\x1F"
+        "%{FILEDIGESTALGO}\n]");
+}
+
+QStringList FileVerifier::arguments(const QStringList &packages)
+{
+    QStringList args{packages.isEmpty() ? QStringLiteral("-qa") : QStringLiteral("-q"),
+                     QStringLiteral("--qf"), queryFormat()};
+    return args + packages;
+}
+
+QVector<ExpectedFile> FileVerifier::parseQueryOutput(const QByteArray &out)
+{
+    TraceSpan span("parse", "FileVerifier::parseQueryOutput");
+    span.arg("bytes", out.size());
+
+    QVector<ExpectedFile> files;
+    files.reserve(int(out.count('\n')));
+
+    qsizetype start = 0;
+    while (start < out.size()) {
+        qsizetype end = out.indexOf('\n', start);
+        if (end < 0)
+            end = out.size();
+        const QByteArray line = out.mid(start, end - start);
+        start = end + 1;
+
+        // "package foo is not installed" and other rpm chatter lack the separators
+        const QList<QByteArray> fields = line.split('\x1F');
+        if (fields.size() != QueryFieldCount)
+            continue;
+
+        ExpectedFile file;
+        file.package = QString::fromLocal8Bit(fields.at(0));
+        file.path = QFile::decodeName(fields.at(1));
+        file.digest = fields.at(2).toLower();
+        file.size = fields.at(3).toLongLong();
+        file.mode = quint32(fields.at(4).toLongLong()) & 0xFFFF;
+        file.mtime = fields.at(5).toLongLong();
+        file.flags = quint32(fields.at(6).toLongLong());
+        file.state = fields.at(7).toInt();
+        file.linkTarget = QFile::decodeName(fields.at(8));
+        bool ok = false;
+        const int algo = fields.at(9).toInt(&ok);
+        file.digestAlgo = ok ? algo : 1; // no tag: pre-4.6 package, MD5
+        if (file.path.isEmpty())
+            continue;
+        files.push_back(file);
+    }
+
+    span.arg("files", files.size());
+    return files;
+}
+
+bool FileVerifier::query(QVector<ExpectedFile> &out, const QStringList &packages, QString *error)
+{
+    TraceSpan span("process", packages.isEmpty() ? QStringLiteral("rpm -qa --qf <files>")
+                                                 : QStringLiteral("rpm -q --qf <files>"));
+    QProcess proc;
+    proc.setProcessChannelMode(QProcess::SeparateChannels);
+    proc.start(QStringLiteral("rpm"), arguments(packages));
+
+    if (!proc.waitForStarted(WaitForStartedTimeoutMs)) {
+        if (error)
+            *error = QObject::tr("Failed to start rpm.");
+        return false;
+    }
+    if (!proc.waitForFinished(QueryTimeoutMs)) {
+        proc.kill();
+        if (error)
+            *error = QObject::tr("Timed out while running rpm.");
+        return false;
+    }
+    if (proc.exitStatus() != QProcess::NormalExit) {
+        if (error)
+            *error = QObject::tr("rpm crashed while running.");
+        return false;
+    }
+
+    const QByteArray stdoutBytes = proc.readAllStandardOutput();
+    span.arg("exitCode", proc.exitCode());
+    span.arg("stdoutBytes", stdoutBytes.size());
+    out = parseQueryOutput(stdoutBytes);
+
+    // rpm exits non-zero when one of several packages is not installed; keep the rest
+    if (proc.exitCode() != 0 && out.isEmpty()) {
+        if (error) {
+            *error = QObject::tr("rpm exited with %1.\n%2")
+                         .arg(proc.exitCode())
+                         .arg(QString::fromLocal8Bit(stdoutBytes + proc.readAllStandardError())
+                                  .trimmed());
+        }
+        return false;
+    }
+    return true;
+}
+
+QByteArray FileVerifier::fileDigest(const QString &path, int digestAlgo, qint64 *bytesHashed,
+                                    QString *error)
+{
+    Digest digest(digestAlgo);
+    if (!digest.isValid()) {
+        if (error)
+            *error = QObject::tr("unsupported digest algorithm %1").arg(digestAlgo);
+        return {};
+    }
+
+    const QByteArray native = QFile::encodeName(path);
+    const int fd = openForHashing(native);
+    if (fd < 0) {
+        if (error)
+            *error = QString::fromLocal8Bit(std::strerror(errno));
+        return {};
+    }
+
+    // Read, not mapped: a file truncated underneath a mapping raises SIGBUS
+    qint64 hashed = 0;
+    bool ok = true;
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    thread_local QByteArray buffer(ReadChunkBytes, Qt::Uninitialized);
+    for (;;) {
+        const ssize_t n = ::read(fd, buffer.data(), size_t(buffer.size()));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0) {
+            ok = false;
+            break;
+        }
+        if (n == 0)
+            break;
+        digest.add(buffer.constData(), n);
+        hashed += n;
+    }
+    const int savedErrno = errno;
+    ::close(fd);
+
+    if (!ok) {
+        if (error)
+            *error = QString::fromLocal8Bit(std::strerror(savedErrno));
+        return {};
+    }
+    if (bytesHashed)
+        *bytesHashed += hashed;
+    return digest.hex();
+}
+
+QString FileVerifier::diskKey(quint64 device, bool *rotational)
+{
+    const unsigned devMajor = ::major(dev_t(device));
+    const unsigned devMinor = ::minor(dev_t(device));
+
+    QString disk = sysfsDisk(devMajor, devMinor);
+    if (disk.isEmpty()) {
+        // btrfs and friends report an anonymous st_dev; the mount source names the disk
+        const quint64 source = mountSourceDevice(devMajor, devMinor);
+        if (source)
+            disk = sysfsDisk(::major(dev_t(source)), ::minor(dev_t(source)));
+    }
+
+    if (rotational) {
+        QFile flag(disk + QStringLiteral("/queue/rotational"));
+        *rotational = !disk.isEmpty() && flag.open(QIODevice::ReadOnly)
+                      && flag.readAll().trimmed() == "1";
+    }
+    // tmpfs, overlay, NFS...: each st_dev gets its own, ungated-as-SSD, key
+    return disk.isEmpty() ? QStringLiteral("dev-%1:%2").arg(devMajor).arg(devMinor) : disk;
+}
+
+VerifyStats FileVerifier::verify(const QVector<ExpectedFile> &files, const Sink &sink)
+{
+    const int threads = m_options.threads > 0 ? m_options.threads : QThread::idealThreadCount();
+    const int solidStateLimit = m_options.solidStateConcurrency > 0
+                                    ? m_options.solidStateConcurrency : threads;
+    TraceSpan span("verify", "FileVerifier::verify");
+    span.arg("files", files.size());
+    span.arg("threads", threads);
+
+    QElapsedTimer timer;
+    timer.start();
+    m_checked.store(0);
+
+    DiskGates gates(qMax(1, m_options.rotationalConcurrency), solidStateLimit);
+    std::atomic<qsizetype> next{0};
+    std::atomic<qint64> bytesHashed{0};
+    std::atomic<qint64> mismatches{0};
+    QMutex sinkMutex;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (int t = 0; t < threads; ++t) {
+        pool.start([&]() {
+            Trace::setThreadName("FileVerifier");
+            qint64 hashed = 0;
+            VerifyResult result;
+            for (;;) {
+                if (m_cancelled.load(std::memory_order_relaxed))
+                    break;
+                const qsizetype index = next.fetch_add(1);
+                if (index >= files.size())
+                    break;
+                if (checkFile(files.at(index), result, m_options.root, &hashed, &gates)) {
+                    mismatches.fetch_add(1);
+                    QMutexLocker locker(&sinkMutex);
+                    if (sink)
+                        sink(result);
+                }
+                m_checked.fetch_add(1, std::memory_order_relaxed);
+            }
+            bytesHashed.fetch_add(hashed);
+        });
+    }
+    pool.waitForDone();
+
+    VerifyStats stats;
+    stats.files = m_checked.load();
+    stats.bytesHashed = bytesHashed.load();
+    stats.mismatches = mismatches.load();
+    stats.elapsedMs = timer.elapsed();
+    stats.cancelled = m_cancelled.load();
+    span.arg("bytes", stats.bytesHashed);
+    span.arg("mismatches", stats.mismatches);
+    Trace::counter("verify.bytes", stats.bytesHashed);
+    return stats;
+}
+
+bool FileVerifier::verifyFile(const ExpectedFile &file, VerifyResult &result, const QString &root,
+                              qint64 *bytesHashed)
+{
+    return checkFile(file, result, root, bytesHashed, nullptr);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file fileverifier.h
+ * @author Nikolay Yevik
+ * @brief Parallel verification of installed files against the rpmdb (rpm -V
+ * without the single thread) for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+/** One file as the rpmdb recorded it at install time */
+struct ExpectedFile {
+    QString package; /** NEVRA of the owning package */
+    QString path; /** Absolute path as installed */
+    QByteArray digest; /** Lowercase hex; empty for directories, symlinks and ghosts */
+    int digestAlgo = 8; /** rpm PGPHASHALGO_* value, 8 = SHA-256 */
+    qint64 size = 0;
+    quint32 mode = 0; /** st_mode including the file type bits */
+    qint64 mtime = 0;
+    quint32 flags = 0; /** RPMFILE_* bits (config, ghost, missingok, ...) */
+    int state = 0; /** RPMFILE_STATE_*; only normal and replaced files are on disk */
+    QString linkTarget; /** Expected target of a symlink */
+};
+
+/** A file that does not match, in rpm -V terms */
+struct VerifyResult {
+    QString package; /** NEVRA of the owning package */
+    QString path;
+    QString flags; /** "SM5DLUGTP" with '.' for passed and '?' for untestable, or "missing" */
+    bool config = false; /** %config file: local edits are usually intended */
+    bool missing = false;
+    QString detail; /** What differs, for the tooltip/results table */
+};
+
+struct VerifyStats {
+    qint64 files = 0; /** Entries looked at, skipped ones included */
+    qint64 bytesHashed = 0;
+    qint64 mismatches = 0;
+    qint64 elapsedMs = 0;
+    bool cancelled = false;
+};
+
+/**
+ * Files are checked by a pool of threads; each read of file content goes
+ * through a per-disk gate so a spinning disk sees one sequential reader while
+ * SSDs get the whole pool. Metadata (lstat, readlink) is not gated. Content
+ * is read in chunks and hashed as it arrives; SHA-256, what
+ * every current rpm writes, uses Sha256 and its SHA-NI path, the older MD5
+ * and SHA-1 digests go through QCryptographicHash. Owner, group, device and
+ * capability checks are left to rpm -V.
+ */
+class FileVerifier
+{
+public:
+    enum FileFlag : quint32 {
+        ConfigFile = 1 << 0, /** RPMFILE_CONFIG */
+        MissingOk = 1 << 3, /** RPMFILE_MISSINGOK */
+        GhostFile = 1 << 6 /** RPMFILE_GHOST */
+    };
+
+    struct Options {
+        int threads = 0; /** 0: QThread::idealThreadCount() */
+        int rotationalConcurrency = 1; /** Concurrent readers per spinning disk */
+        int solidStateConcurrency = 0; /** Concurrent readers per SSD/NVMe, 0: threads */
+        QString root; /** Prefix for every path; empty for the running system */
+    };
+
+    /** Called once per mismatch, serialized, from the worker threads */
+    using Sink = std::function<void(const VerifyResult &result)>;
+
+    /** rpm --qf format, one line per file; fields are separated by \x1F */
+    static QString queryFormat();
+    /** Empty @p packages means every installed package (rpm -qa) */
+    static QStringList arguments(const QStringList &packages = {});
+    static QVector<ExpectedFile> parseQueryOutput(const QByteArray &out);
+    /** Runs rpm synchronously; returns false and fills @p error on failure */
+    static bool query(QVector<ExpectedFile> &out, const QStringList &packages = {},
+                      QString *error = nullptr);
+
+    /** Checks one file; false when it matches or is not expected on disk */
+    static bool verifyFile(const ExpectedFile &file, VerifyResult &result,
+                           const QString &root = QString(), qint64 *bytesHashed = nullptr);
+
+    /** Lowercase hex digest of @p path with rpm's algorithm number; empty on error */
+    static QByteArray fileDigest(const QString &path, int digestAlgo, qint64 *bytesHashed = nullptr,
+                                 QString *error = nullptr);
+
+    /** Identifies the physical disk behind @p device (st_dev) for the I/O gates */
+    static QString diskKey(quint64 device, bool *rotational = nullptr);
+
+    FileVerifier() = default;
+    explicit FileVerifier(const Options &options) : m_options(options) {}
+
+    /** Blocks until every file was checked or cancel() was called */
+    VerifyStats verify(const QVector<ExpectedFile> &files, const Sink &sink);
+
+    /** Safe from any thread */
+    void cancel() { m_cancelled.store(true); }
+    qint64 filesChecked() const { return m_checked.load(std::memory_order_relaxed); }
+
+private:
+    Options m_options;
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<qint64> m_checked{0};
+};
+
+Q_DECLARE_METATYPE(VerifyStats)
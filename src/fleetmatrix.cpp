@@ -0,0 +1,196 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the fleet version matrix for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "fleetmatrix.h"
+#include "fleetsnapshot.h"
+#include "parallelfor.h"
+#include "trace.h"
+
+#include <QFileInfo>
+
+#include <algorithm>
+
+quint32 StringInterner::intern(QByteArrayView text)
+{
+    // fromRawData: no copy for the (common) hit
+    const QByteArray probe = QByteArray::fromRawData(text.data(), text.size());
+    const size_t hash = qHash(probe);
+    Shard &shard = m_shards[hash & ShardMask];
+
+    QMutexLocker locker(&shard.mutex);
+    const auto it = shard.ids.constFind(probe);
+    if (it != shard.ids.cend())
+        return it.value();
+
+    const quint32 id = (quint32(shard.values.size()) << ShardBits) | quint32(hash & ShardMask);
+    const QByteArray copy(text.data(), text.size());
+    shard.values.append(copy);
+    shard.ids.insert(copy, id);
+    return id;
+}
+
+QByteArray StringInterner::value(quint32 id) const
+{
+    const Shard &shard = m_shards[id & ShardMask];
+    return shard.values.value(qsizetype(id >> ShardBits));
+}
+
+QVector<QPair<QByteArray, quint32>> StringInterner::entries() const
+{
+    QVector<QPair<QByteArray, quint32>> all;
+    all.reserve(size());
+    for (quint32 s = 0; s < m_shards.size(); ++s) {
+        const Shard &shard = m_shards[s];
+        QMutexLocker locker(&shard.mutex);
+        for (qsizetype i = 0; i < shard.values.size(); ++i)
+            all.append({shard.values.at(i), (quint32(i) << ShardBits) | s});
+    }
+    return all;
+}
+
+int StringInterner::size() const
+{
+    int total = 0;
+    for (const Shard &shard : m_shards) {
+        QMutexLocker locker(&shard.mutex);
+        total += int(shard.values.size());
+    }
+    return total;
+}
+
+bool FleetMatrix::load(const QStringList &paths, QStringList *errors, int threads)
+{
+    TraceSpan span("fleet", "FleetMatrix::load");
+    span.arg("snapshots", paths.size());
+
+    QVector<Host> hosts(paths.size());
+    QVector<QString> failures(paths.size());
+    QVector<bool> loaded(paths.size(), false);
+    StringInterner keys;
+    auto evrs = std::make_unique<StringInterner>();
+
+    // Phase 1: read and intern in parallel; cell keys are still interner ids
+    parallelFor(int(paths.size()), threads, [&](int i) {
+        Host &host = hosts[i];
+        host.path = paths.at(i);
+        FleetSnapshot::Header header;
+        QVector<Cell> cells;
+        const bool ok = FleetSnapshot::read(paths.at(i), header,
+                                            [&](QByteArrayView key, QByteArrayView evr) {
+                                                cells.append({keys.intern(key), evrs->intern(evr)});
+                                            },
+                                            &failures[i]);
+        if (!ok)
+            return;
+        host.name = header.host.isEmpty() ? QFileInfo(paths.at(i)).completeBaseName() : header.host;
+        host.capturedAtMs = header.capturedAtMs;
+        host.cells = std::move(cells);
+        loaded[i] = true;
+    });
+
+    // Phase 2: interner ids -> bytewise ranks
+    QVector<QPair<QByteArray, quint32>> keyEntries = keys.entries();
+    std::sort(keyEntries.begin(), keyEntries.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    quint32 maxId = 0;
+    for (const auto &entry : std::as_const(keyEntries))
+        maxId = std::max(maxId, entry.second);
+    QVector<quint32> rankOf(keyEntries.isEmpty() ? 0 : qsizetype(maxId) + 1, Absent);
+    QVector<QByteArray> sortedKeys;
+    sortedKeys.reserve(keyEntries.size());
+    for (qsizetype rank = 0; rank < keyEntries.size(); ++rank) {
+        rankOf[keyEntries.at(rank).second] = quint32(rank);
+        sortedKeys.append(keyEntries.at(rank).first);
+    }
+
+    parallelFor(int(hosts.size()), threads, [&](int i) {
+        QVector<Cell> &cells = hosts[i].cells;
+        for (Cell &cell : cells)
+            cell.key = rankOf.at(cell.key);
+        // Snapshots from this code are already sorted; anything else still works
+        const auto byKey = [](const Cell &a, const Cell &b) { return a.key < b.key; };
+        if (!std::is_sorted(cells.cbegin(), cells.cend(), byKey))
+            std::sort(cells.begin(), cells.end(), byKey);
+    });
+
+    QVector<Host> kept;
+    kept.reserve(hosts.size());
+    for (qsizetype i = 0; i < hosts.size(); ++i) {
+        if (loaded.at(i))
+            kept.append(std::move(hosts[i]));
+        else if (errors)
+            errors->append(QStringLiteral("%1: %2").arg(paths.at(i), failures.at(i)));
+    }
+
+    m_hosts = std::move(kept);
+    m_keys = std::move(sortedKeys);
+    m_evrs = std::move(evrs);
+    span.arg("hosts", int(m_hosts.size()));
+    span.arg("keys", int(m_keys.size()));
+    return !m_hosts.isEmpty() || paths.isEmpty();
+}
+
+quint32 FleetMatrix::evrAt(int host, quint32 key) const
+{
+    const QVector<Cell> &cells = m_hosts.at(host).cells;
+    const auto it = std::lower_bound(cells.cbegin(), cells.cend(), key,
+                                     [](const Cell &cell, quint32 k) { return cell.key < k; });
+    return (it != cells.cend() && it->key == key) ? it->evr : Absent;
+}
+
+FleetMatrix::HostDiff FleetMatrix::diff(int baseline, int host) const
+{
+    HostDiff result;
+    result.host = host;
+    const QVector<Cell> &base = m_hosts.at(baseline).cells;
+    const QVector<Cell> &other = m_hosts.at(host).cells;
+
+    qsizetype i = 0;
+    qsizetype j = 0;
+    while (i < base.size() && j < other.size()) {
+        const Cell &a = base.at(i);
+        const Cell &b = other.at(j);
+        if (a.key < b.key) {
+            result.missing.append(a.key);
+            ++i;
+        } else if (b.key < a.key) {
+            result.extra.append(b.key);
+            ++j;
+        } else {
+            if (a.evr != b.evr) // interned: equal ids <=> equal strings
+                result.changed.append(a.key);
+            ++i;
+            ++j;
+        }
+    }
+    for (; i < base.size(); ++i)
+        result.missing.append(base.at(i).key);
+    for (; j < other.size(); ++j)
+        result.extra.append(other.at(j).key);
+    return result;
+}
+
+QVector<FleetMatrix::HostDiff> FleetMatrix::diffAll(int baseline, int threads) const
+{
+    TraceSpan span("fleet", "FleetMatrix::diffAll");
+    span.arg("hosts", hostCount());
+    QVector<HostDiff> diffs(m_hosts.size());
+    parallelFor(hostCount(), threads, [&](int i) { diffs[i] = diff(baseline, i); });
+    return diffs;
+}
+
+QVector<quint32> FleetMatrix::differingKeys(const QVector<HostDiff> &diffs)
+{
+    QVector<quint32> keys;
+    for (const HostDiff &d : diffs) {
+        keys += d.missing;
+        keys += d.extra;
+        keys += d.changed;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file fleetmatrix.h
+ * @author Nikolay Yevik
+ * @brief Package x host version matrix over many FleetSnapshot files, with
+ * baseline diffs, for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <array>
+#include <memory>
+
+/**
+ * Byte string -> dense id, safe to call from many threads at once. The table
+ * is split into shards with their own lock so parallel loaders rarely wait on
+ * each other. value() is unsynchronized: only call it once interning is done.
+ */
+class StringInterner
+{
+public:
+    static constexpr quint32 None = 0xFFFFFFFFu;
+
+    quint32 intern(QByteArrayView text);
+    QByteArray value(quint32 id) const;
+    /** Every interned string with its id, in no particular order */
+    QVector<QPair<QByteArray, quint32>> entries() const;
+    int size() const;
+
+private:
+    static constexpr int ShardBits = 6;
+    static constexpr quint32 ShardMask = (1u << ShardBits) - 1;
+
+    struct Shard {
+        mutable QMutex mutex;
+        QHash<QByteArray, quint32> ids;
+        QVector<QByteArray> values;
+    };
+    std::array<Shard, 1u << ShardBits> m_shards;
+};
+
+/**
+ * Hosts keep their packages as (key, evr) cells sorted by key, where key is
+ * the rank of name.arch among every key in the fleet and evr an interned id.
+ * Since snapshots are stored in the same bytewise order, ranks come out
+ * sorted without a per-host sort, and a diff is a linear merge of two rows.
+ */
+class FleetMatrix
+{
+public:
+    static constexpr quint32 Absent = StringInterner::None;
+
+    struct Cell {
+        quint32 key = 0; /** Rank of name.arch, see key() */
+        quint32 evr = 0; /** Interned EVR, see evr() */
+    };
+
+    struct Host {
+        QString name; /** Host name recorded in the snapshot */
+        QString path; /** Snapshot file it came from */
+        qint64 capturedAtMs = 0;
+        QVector<Cell> cells; /** Sorted by key */
+    };
+
+    /** How one host differs from the baseline; every vector holds keys, ascending */
+    struct HostDiff {
+        int host = -1;
+        QVector<quint32> missing; /** On the baseline, not on the host */
+        QVector<quint32> extra; /** On the host, not on the baseline */
+        QVector<quint32> changed; /** On both, different EVR */
+        bool isIdentical() const { return missing.isEmpty() && extra.isEmpty() && changed.isEmpty(); }
+    };
+
+    /**
+     * Replaces the matrix with the snapshots in @p paths, read on @p threads
+     * threads (0: ideal count). Unreadable files are skipped and reported in
+     * @p errors; returns false only if none could be loaded.
+     */
+    bool load(const QStringList &paths, QStringList *errors = nullptr, int threads = 0);
+
+    int hostCount() const { return int(m_hosts.size()); }
+    const Host &host(int index) const { return m_hosts.at(index); }
+    int keyCount() const { return int(m_keys.size()); }
+    const QByteArray &key(quint32 rank) const { return m_keys.at(rank); }
+    QByteArray evr(quint32 id) const { return id == Absent || !m_evrs ? QByteArray() : m_evrs->value(id); }
+
+    /** EVR id of @p key on @p host, Absent if not installed there */
+    quint32 evrAt(int host, quint32 key) const;
+
+    HostDiff diff(int baseline, int host) const;
+    /** diff() of every host against @p baseline, in parallel; index = host */
+    QVector<HostDiff> diffAll(int baseline, int threads = 0) const;
+    /** Union of the keys any host differs on, ascending */
+    static QVector<quint32> differingKeys(const QVector<HostDiff> &diffs);
+
+private:
+    QVector<Host> m_hosts;
+    QVector<QByteArray> m_keys; // rank -> name.arch
+    std::unique_ptr<StringInterner> m_evrs; // not movable (mutexes), hence the pointer
+};
@@ -0,0 +1,57 @@
+/**
+ * @file fleetsnapshot.h
+ * @author Nikolay Yevik
+ * @brief Compact per-host package list snapshots (export/import) for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+#include "packagemodel.h"
+
+/**
+ * One host's installed set as name.arch -> EVR pairs, sorted bytewise by
+ * name.arch so readers can merge snapshots without sorting. Installonly
+ * packages (kernels) keep all their versions in one EVR, space separated in
+ * rpm order. On disk: a QDataStream header (magic, version, host, capture
+ * time, entry count) followed by a zstd frame of prefix-coded keys and
+ * length-prefixed EVRs.
+ */
+class FleetSnapshot
+{
+public:
+    struct Header {
+        QString host; /** Host name at export time */
+        qint64 capturedAtMs = 0; /** Export time, ms since the epoch (UTC) */
+        quint32 entries = 0; /** name.arch keys in the snapshot */
+    };
+
+    /** Receives one entry; both views are only valid during the call */
+    using EntrySink = std::function<void(QByteArrayView key, QByteArrayView evr)>;
+
+    /** Default file suffix, without the dot */
+    static QString suffix();
+
+    /** "name.arch" */
+    static QByteArray keyFor(const PackageInfo &pkg);
+    /** "[epoch:]version-release", epoch omitted when 0 */
+    static QByteArray evrFor(const PackageInfo &pkg);
+
+    static QByteArray encode(const QVector<PackageInfo> &pkgs, const QString &host,
+                             qint64 capturedAtMs);
+    static bool write(const QString &path, const QVector<PackageInfo> &pkgs, const QString &host,
+                      qint64 capturedAtMs, QString *error = nullptr);
+
+    /** Streams the entries of @p data in key order; false and @p error on corrupt input */
+    static bool decode(const QByteArray &data, Header &header, const EntrySink &sink,
+                       QString *error = nullptr);
+    static bool read(const QString &path, Header &header, const EntrySink &sink,
+                     QString *error = nullptr);
+};
@@ -0,0 +1,390 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the fleet view for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "fleetview.h"
+#include "fleetsnapshot.h"
+#include "trace.h"
+
+#include <QCheckBox>
+#include <QColor>
+#include <QComboBox>
+#include <QDateTime>
+#include <QDialogButtonBox>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFont>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QSplitter>
+#include <QStandardItemModel>
+#include <QTableView>
+#include <QThread>
+#include <QVBoxLayout>
+
+namespace {
+    const QColor MissingColor {255, 205, 210}; // on the baseline, not on the host
+    const QColor ExtraColor {200, 230, 201}; // on the host, not on the baseline
+    const QColor ChangedColor {255, 236, 179}; // different EVR
+}
+
+/** Runs in a QThread; fills the matrix it was given and reports the errors */
+class FleetLoadWorker : public QObject
+{
+    Q_OBJECT
+public:
+    FleetLoadWorker(const QStringList &paths, std::shared_ptr<FleetMatrix> matrix,
+                    QObject *parent = nullptr)
+        : QObject(parent), m_paths(paths), m_matrix(std::move(matrix)) {}
+
+signals:
+    void finished(const QStringList &errors, qint64 elapsedMs);
+
+public slots:
+    void run()
+    {
+        Trace::setThreadName("FleetLoadWorker");
+        QElapsedTimer timer;
+        timer.start();
+        QStringList errors;
+        m_matrix->load(m_paths, &errors);
+        emit finished(errors, timer.elapsed());
+    }
+
+private:
+    QStringList m_paths;
+    std::shared_ptr<FleetMatrix> m_matrix;
+};
+
+FleetMatrixModel::FleetMatrixModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int FleetMatrixModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(m_rows.size());
+}
+
+int FleetMatrixModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !m_matrix)
+        return 0;
+    return 1 + m_matrix->hostCount();
+}
+
+QVariant FleetMatrixModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || !m_matrix || index.row() >= m_rows.size())
+        return {};
+
+    const quint32 key = m_rows.at(index.row());
+    if (index.column() == 0) {
+        if (role == Qt::DisplayRole)
+            return QString::fromUtf8(m_matrix->key(key));
+        return {};
+    }
+
+    const int host = index.column() - 1;
+    const quint32 evr = m_matrix->evrAt(host, key);
+    switch (role) {
+    case Qt::DisplayRole:
+        return QString::fromUtf8(m_matrix->evr(evr));
+    case Qt::ToolTipRole:
+        return evr == FleetMatrix::Absent ? tr("Not installed on %1").arg(m_matrix->host(host).name)
+                                          : QString::fromUtf8(m_matrix->evr(evr));
+    case Qt::BackgroundRole: {
+        if (host == m_baseline)
+            return {};
+        const quint32 base = m_matrix->evrAt(m_baseline, key);
+        if (base == evr)
+            return {};
+        if (evr == FleetMatrix::Absent)
+            return MissingColor;
+        return base == FleetMatrix::Absent ? ExtraColor : ChangedColor;
+    }
+    default:
+        return {};
+    }
+}
+
+QVariant FleetMatrixModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || !m_matrix)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    if (section == 0)
+        return role == Qt::DisplayRole ? QVariant(tr("Package")) : QVariant();
+
+    const FleetMatrix::Host &host = m_matrix->host(section - 1);
+    switch (role) {
+    case Qt::DisplayRole:
+        return host.name;
+    case Qt::ToolTipRole:
+        return tr("%1\nCaptured %2")
+            .arg(host.path, QDateTime::fromMSecsSinceEpoch(host.capturedAtMs).toString(Qt::ISODate));
+    case Qt::FontRole:
+        if (section - 1 == m_baseline) {
+            QFont bold;
+            bold.setBold(true);
+            return bold;
+        }
+        return {};
+    default:
+        return {};
+    }
+}
+
+void FleetMatrixModel::setMatrix(std::shared_ptr<const FleetMatrix> matrix)
+{
+    beginResetModel();
+    m_matrix = std::move(matrix);
+    m_baseline = 0;
+    m_diffs = m_matrix && m_matrix->hostCount() > 0 ? m_matrix->diffAll(m_baseline)
+                                                    : QVector<FleetMatrix::HostDiff>();
+    rebuildRows();
+    endResetModel();
+}
+
+void FleetMatrixModel::setBaseline(int host)
+{
+    if (!m_matrix || host < 0 || host >= m_matrix->hostCount() || host == m_baseline)
+        return;
+    beginResetModel();
+    m_baseline = host;
+    m_diffs = m_matrix->diffAll(m_baseline);
+    rebuildRows();
+    endResetModel();
+}
+
+void FleetMatrixModel::setDifferencesOnly(bool on)
+{
+    if (on == m_differencesOnly)
+        return;
+    beginResetModel();
+    m_differencesOnly = on;
+    rebuildRows();
+    endResetModel();
+}
+
+void FleetMatrixModel::rebuildRows()
+{
+    m_rows.clear();
+    if (!m_matrix)
+        return;
+    if (m_differencesOnly) {
+        m_rows = FleetMatrix::differingKeys(m_diffs);
+        return;
+    }
+    m_rows.resize(m_matrix->keyCount());
+    for (int i = 0; i < m_rows.size(); ++i)
+        m_rows[i] = quint32(i);
+}
+
+FleetDialog::FleetDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setObjectName(QStringLiteral("fleetDialog"));
+    setWindowTitle(tr("Fleet view"));
+    resize(1100, 700);
+
+    auto *layout = new QVBoxLayout(this);
+
+    auto *topLayout = new QHBoxLayout();
+    m_btnAddFiles = new QPushButton(tr("Add snapshots..."), this);
+    m_btnAddFolder = new QPushButton(tr("Add folder..."), this);
+    m_baselineCombo = new QComboBox(this);
+    m_baselineCombo->setObjectName(QStringLiteral("fleetBaselineCombo"));
+    m_baselineCombo->setToolTip(tr("Every other host is compared against this one"));
+    m_baselineCombo->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+    m_differencesOnlyCheck = new QCheckBox(tr("Only differences"), this);
+    m_differencesOnlyCheck->setToolTip(tr("Hide packages every host has at the baseline's version"));
+    topLayout->addWidget(m_btnAddFiles);
+    topLayout->addWidget(m_btnAddFolder);
+    topLayout->addWidget(new QLabel(tr("Baseline:"), this));
+    topLayout->addWidget(m_baselineCombo);
+    topLayout->addWidget(m_differencesOnlyCheck);
+    topLayout->addStretch();
+    layout->addLayout(topLayout);
+
+    m_statusLabel = new QLabel(tr("Add %1 snapshots exported from each host.")
+                                   .arg(FleetSnapshot::suffix()), this);
+    layout->addWidget(m_statusLabel);
+
+    auto *splitter = new QSplitter(Qt::Vertical, this);
+
+    m_hostsView = new QTableView(splitter);
+    m_hostsView->setObjectName(QStringLiteral("fleetHostsView"));
+    m_hostsModel = new QStandardItemModel(m_hostsView);
+    m_hostsModel->setHorizontalHeaderLabels({tr("Host"), tr("Captured"), tr("Packages"),
+                                             tr("Missing"), tr("Extra"), tr("Changed")});
+    m_hostsView->setModel(m_hostsModel);
+    m_hostsView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_hostsView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_hostsView->setSortingEnabled(true);
+    m_hostsView->verticalHeader()->hide();
+    m_hostsView->horizontalHeader()->setStretchLastSection(true);
+
+    m_matrixView = new QTableView(splitter);
+    m_matrixView->setObjectName(QStringLiteral("fleetMatrixView"));
+    m_model = new FleetMatrixModel(m_matrixView);
+    m_matrixView->setModel(m_model);
+    m_matrixView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_matrixView->verticalHeader()->hide();
+    // Hundreds of host columns: size from the header, not from every cell
+    m_matrixView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_matrixView->horizontalHeader()->setDefaultSectionSize(140);
+
+    splitter->setStretchFactor(1, 3);
+    layout->addWidget(splitter, /*stretch*/ 1);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    layout->addWidget(buttons);
+
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(m_btnAddFiles, &QPushButton::clicked, this, &FleetDialog::onAddFiles);
+    connect(m_btnAddFolder, &QPushButton::clicked, this, &FleetDialog::onAddFolder);
+    connect(m_baselineCombo, &QComboBox::currentIndexChanged, this, &FleetDialog::onBaselineChanged);
+    connect(m_differencesOnlyCheck, &QCheckBox::toggled, m_model, &FleetMatrixModel::setDifferencesOnly);
+}
+
+void FleetDialog::addSnapshots(const QStringList &paths)
+{
+    bool added = false;
+    for (const QString &path : paths) {
+        const QString absolute = QFileInfo(path).absoluteFilePath();
+        if (!m_paths.contains(absolute)) {
+            m_paths << absolute;
+            added = true;
+        }
+    }
+    if (added)
+        startLoad();
+}
+
+void FleetDialog::onAddFiles()
+{
+    const QStringList paths = QFileDialog::getOpenFileNames(
+        this, tr("Add package snapshots"), QString(),
+        tr("Package snapshots (*.%1);;All files (*)").arg(FleetSnapshot::suffix()));
+    addSnapshots(paths);
+}
+
+void FleetDialog::onAddFolder()
+{
+    const QString dir = QFileDialog::getExistingDirectory(this, tr("Add every snapshot in a folder"));
+    if (dir.isEmpty())
+        return;
+
+    QStringList paths;
+    QDirIterator it(dir, {QStringLiteral("*.") + FleetSnapshot::suffix()}, QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext())
+        paths << it.next();
+    paths.sort();
+    if (paths.isEmpty()) {
+        m_statusLabel->setText(tr("No .%1 files in %2").arg(FleetSnapshot::suffix(), dir));
+        return;
+    }
+    addSnapshots(paths);
+}
+
+void FleetDialog::startLoad()
+{
+    if (m_loading) {
+        m_reloadPending = true;
+        return;
+    }
+    m_loading = true;
+    m_reloadPending = false;
+    m_btnAddFiles->setEnabled(false);
+    m_btnAddFolder->setEnabled(false);
+    m_statusLabel->setText(tr("Loading %1 snapshots...").arg(m_paths.size()));
+
+    auto matrix = std::make_shared<FleetMatrix>();
+    auto *worker = new FleetLoadWorker(m_paths, matrix);
+    auto *thread = new QThread(this);
+    worker->moveToThread(thread);
+
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    connect(thread, &QThread::started, worker, &FleetLoadWorker::run);
+    connect(worker, &FleetLoadWorker::finished, this,
+            [this, thread, matrix](const QStringList &errors, qint64 elapsedMs) {
+                thread->quit();
+                m_loading = false;
+                m_btnAddFiles->setEnabled(true);
+                m_btnAddFolder->setEnabled(true);
+
+                m_model->setMatrix(matrix);
+                {
+                    const QSignalBlocker blocker(m_baselineCombo);
+                    m_baselineCombo->clear();
+                    for (int i = 0; i < matrix->hostCount(); ++i)
+                        m_baselineCombo->addItem(matrix->host(i).name);
+                }
+                updateSummary();
+
+                QString status = tr("%1 hosts, %2 packages, loaded in %3 ms")
+                                     .arg(matrix->hostCount())
+                                     .arg(matrix->keyCount())
+                                     .arg(elapsedMs);
+                if (!errors.isEmpty()) {
+                    status += tr("; %n snapshot(s) could not be read", nullptr, int(errors.size()));
+                    m_statusLabel->setToolTip(errors.join(QLatin1Char('\n')));
+                } else {
+                    m_statusLabel->setToolTip(QString());
+                }
+                m_statusLabel->setText(status);
+
+                if (m_reloadPending)
+                    startLoad();
+            });
+
+    thread->start();
+}
+
+void FleetDialog::onBaselineChanged(int index)
+{
+    TraceSpan span("ui", "FleetDialog::onBaselineChanged");
+    m_model->setBaseline(index);
+    updateSummary();
+}
+
+void FleetDialog::updateSummary()
+{
+    const FleetMatrix *matrix = m_model->matrix();
+    m_hostsView->setSortingEnabled(false);
+    m_hostsModel->setRowCount(0);
+    if (!matrix)
+        return;
+
+    const QVector<FleetMatrix::HostDiff> &diffs = m_model->diffs();
+    for (int i = 0; i < matrix->hostCount(); ++i) {
+        const FleetMatrix::Host &host = matrix->host(i);
+        auto number = [](qsizetype value) {
+            auto *item = new QStandardItem();
+            item->setData(qlonglong(value), Qt::DisplayRole);
+            return item;
+        };
+        auto *name = new QStandardItem(i == m_model->baseline() ? tr("%1 (baseline)").arg(host.name)
+                                                                : host.name);
+        name->setToolTip(host.path);
+        auto *captured = new QStandardItem(
+            QDateTime::fromMSecsSinceEpoch(host.capturedAtMs).toString(QStringLiteral("yyyy-MM-dd HH:mm")));
+        const FleetMatrix::HostDiff &diff = diffs.at(i);
+        m_hostsModel->appendRow({name, captured, number(host.cells.size()), number(diff.missing.size()),
+                                 number(diff.extra.size()), number(diff.changed.size())});
+    }
+    m_hostsView->setSortingEnabled(true);
+    m_hostsView->resizeColumnsToContents();
+}
+
+#include "fleetview.moc"
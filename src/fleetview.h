@@ -0,0 +1,95 @@
+/**
+ * @file fleetview.h
+ * @author Nikolay Yevik
+ * @brief Fleet view: package x host version table over many snapshots for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QDialog>
+#include <QStringList>
+#include <QVector>
+
+#include <memory>
+
+#include "fleetmatrix.h"
+
+class QCheckBox;
+class QComboBox;
+class QLabel;
+class QPushButton;
+class QStandardItemModel;
+class QTableView;
+
+/**
+ * Rows are name.arch keys, column 0 the key and one column per host after
+ * it. Cells are colored against the baseline host: missing, extra or a
+ * different EVR. Lookups are a binary search in the host row, so only the
+ * visible cells cost anything.
+ */
+class FleetMatrixModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit FleetMatrixModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    void setMatrix(std::shared_ptr<const FleetMatrix> matrix);
+    const FleetMatrix *matrix() const { return m_matrix.get(); }
+
+    /** Recomputes every host's diff against @p host */
+    void setBaseline(int host);
+    int baseline() const { return m_baseline; }
+    const QVector<FleetMatrix::HostDiff> &diffs() const { return m_diffs; }
+
+    /** Hide keys every host agrees on */
+    void setDifferencesOnly(bool on);
+
+private:
+    void rebuildRows();
+
+    std::shared_ptr<const FleetMatrix> m_matrix;
+    int m_baseline = 0;
+    bool m_differencesOnly = false;
+    QVector<FleetMatrix::HostDiff> m_diffs; // index = host
+    QVector<quint32> m_rows; // row -> key rank
+};
+
+/** Non-modal; snapshots are loaded and diffed on a worker thread */
+class FleetDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit FleetDialog(QWidget *parent = nullptr);
+
+    /** Adds @p paths to the loaded set and reloads */
+    void addSnapshots(const QStringList &paths);
+
+private:
+    void onAddFiles();
+    void onAddFolder();
+    void onBaselineChanged(int index);
+    void startLoad();
+    void updateSummary();
+
+    QStringList m_paths;
+    bool m_loading = false;
+    bool m_reloadPending = false;
+
+    FleetMatrixModel *m_model = nullptr;
+    QStandardItemModel *m_hostsModel = nullptr;
+    QTableView *m_matrixView = nullptr;
+    QTableView *m_hostsView = nullptr;
+    QComboBox *m_baselineCombo = nullptr;
+    QCheckBox *m_differencesOnlyCheck = nullptr;
+    QPushButton *m_btnAddFiles = nullptr;
+    QPushButton *m_btnAddFolder = nullptr;
+    QLabel *m_statusLabel = nullptr;
+};
@@ -0,0 +1,213 @@
+/**
+ * @file turborpm_helper.cpp
+ * @author Nikolay Yevik
+ * @brief turborpm-helper: started once through sudo by the GUI, runs whitelisted
+ * dnf operations for the rest of the admin session and streams their output back
+ * over stdin/stdout (see HelperProtocol).
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QProcess>
+#include <QSocketNotifier>
+
+#include "../helperprotocol.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+
+class Helper : public QObject
+{
+public:
+    Helper() : m_input(STDIN_FILENO, QSocketNotifier::Read)
+    {
+        m_uptime.start();
+        connect(&m_input, &QSocketNotifier::activated, this, &Helper::onReadable);
+        send({{QStringLiteral("type"), QStringLiteral("hello")},
+              {QStringLiteral("version"), HelperProtocol::Version},
+              {QStringLiteral("uid"), qint64(::geteuid())},
+              {QStringLiteral("pid"), qint64(::getpid())}});
+    }
+
+private:
+    void onReadable()
+    {
+        char buffer[64 * 1024];
+        const ssize_t n = ::read(STDIN_FILENO, buffer, sizeof buffer);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN))
+            return;
+        if (n <= 0) {
+            // The GUI is gone; a running transaction still finishes first
+            m_input.setEnabled(false);
+            m_inputClosed = true;
+            quitWhenIdle();
+            return;
+        }
+
+        QByteArray data(buffer, n);
+        if (!m_synced) {
+            // Drop whatever precedes the sync line: a password sudo did not need
+            m_preamble += data;
+            std::memset(buffer, 0, sizeof buffer);
+            const qsizetype sync = m_preamble.indexOf(HelperProtocol::SyncLine);
+            if (sync < 0)
+                return;
+            data = m_preamble.mid(sync + qsizetype(std::strlen(HelperProtocol::SyncLine)));
+            m_preamble.fill('\0');
+            m_preamble.clear();
+            m_synced = true;
+        }
+
+        m_reader.append(data);
+        QJsonObject request;
+        QString error;
+        while (m_reader.next(request, &error))
+            handle(request);
+        if (m_reader.hasError()) {
+            sendError(0, error);
+            m_input.setEnabled(false);
+            m_inputClosed = true;
+            quitWhenIdle();
+        }
+    }
+
+    void handle(const QJsonObject &request)
+    {
+        const int id = request.value(QStringLiteral("id")).toInt();
+        const QString op = request.value(QStringLiteral("op")).toString();
+
+        if (op == QLatin1String("ping")) {
+            send({{QStringLiteral("id"), id},
+                  {QStringLiteral("type"), QStringLiteral("pong")},
+                  {QStringLiteral("uid"), qint64(::geteuid())},
+                  {QStringLiteral("busy"), m_proc != nullptr},
+                  {QStringLiteral("uptimeMs"), m_uptime.elapsed()}});
+            return;
+        }
+        if (op == QLatin1String("shutdown")) {
+            m_shutdown = true;
+            quitWhenIdle();
+            return;
+        }
+        // dnf serializes on its own lock anyway; one operation at a time
+        if (m_proc) {
+            sendError(id, QObject::tr("Another operation is still running."));
+            return;
+        }
+
+        QStringList args;
+        for (const QJsonValue &value : request.value(QStringLiteral("args")).toArray())
+            args << value.toString();
+
+        HelperProtocol::Command command;
+        QString error;
+        if (!HelperProtocol::commandFor(op, args, command, &error)) {
+            sendError(id, error);
+            return;
+        }
+
+        m_proc = new QProcess(this);
+        m_procId = id;
+        m_proc->setProcessChannelMode(QProcess::MergedChannels);
+        m_proc->setStandardInputFile(QProcess::nullDevice());
+        connect(m_proc, &QProcess::readyReadStandardOutput, this, [this]() {
+            send({{QStringLiteral("id"), m_procId},
+                  {QStringLiteral("type"), QStringLiteral("output")},
+                  {QStringLiteral("data"), QString::fromLatin1(m_proc->readAllStandardOutput().toBase64())}});
+        });
+        connect(m_proc, &QProcess::finished, this, [this](int exitCode, QProcess::ExitStatus status) {
+            const QByteArray rest = m_proc->readAllStandardOutput();
+            if (!rest.isEmpty()) {
+                send({{QStringLiteral("id"), m_procId},
+                      {QStringLiteral("type"), QStringLiteral("output")},
+                      {QStringLiteral("data"), QString::fromLatin1(rest.toBase64())}});
+            }
+            send({{QStringLiteral("id"), m_procId},
+                  {QStringLiteral("type"), QStringLiteral("finished")},
+                  {QStringLiteral("exitCode"), status == QProcess::NormalExit ? exitCode : -1}});
+            m_proc->deleteLater();
+            m_proc = nullptr;
+            quitWhenIdle();
+        });
+        connect(m_proc, &QProcess::errorOccurred, this, [this](QProcess::ProcessError processError) {
+            if (processError != QProcess::FailedToStart)
+                return;
+            sendError(m_procId, QObject::tr("Failed to start %1.").arg(m_proc->program()));
+            m_proc->deleteLater();
+            m_proc = nullptr;
+            quitWhenIdle();
+        });
+        m_proc->start(command.program, command.arguments);
+    }
+
+    void quitWhenIdle()
+    {
+        if ((m_inputClosed || m_shutdown) && !m_proc)
+            QCoreApplication::exit(0);
+    }
+
+    void sendError(int id, const QString &message)
+    {
+        send({{QStringLiteral("id"), id},
+              {QStringLiteral("type"), QStringLiteral("error")},
+              {QStringLiteral("message"), message}});
+    }
+
+    void send(const QJsonObject &message)
+    {
+        // Blocking writes: frames must never interleave, and the GUI drains promptly
+        const QByteArray frame = HelperProtocol::encode(message);
+        qsizetype written = 0;
+        while (written < frame.size()) {
+            const ssize_t n = ::write(STDOUT_FILENO, frame.constData() + written,
+                                      size_t(frame.size() - written));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return; // reader is gone; stdin EOF will follow
+            written += n;
+        }
+    }
+
+    QSocketNotifier m_input;
+    HelperFrameReader m_reader;
+    QByteArray m_preamble;
+    QElapsedTimer m_uptime;
+    QProcess *m_proc = nullptr;
+    int m_procId = 0;
+    bool m_synced = false;
+    bool m_inputClosed = false;
+    bool m_shutdown = false;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // The stand-in used by the tests runs unprivileged; real sudo resets the
+    // environment, so this cannot be smuggled into a privileged start.
+    if (::geteuid() != 0 && qgetenv("TURBORPM_HELPER_UNPRIVILEGED") != "1") {
+        std::cerr << "turborpm-helper must be started through sudo" << std::endl;
+        return 1;
+    }
+    // A vanished GUI must not kill us halfway through an rpm transaction
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGHUP, SIG_IGN);
+    std::signal(SIGINT, SIG_IGN);
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("turborpm-helper"));
+
+    Helper helper;
+    return app.exec();
+}
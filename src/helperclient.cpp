@@ -0,0 +1,250 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the turborpm-helper client for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "helperclient.h"
+#include "ringlog.h"
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include <unistd.h>
+
+namespace {
+    constexpr int StopTimeoutMs {5000};
+}
+
+HelperClient::HelperClient(QObject *parent)
+    : QObject(parent)
+{
+    m_proc.setProcessChannelMode(QProcess::SeparateChannels);
+    connect(&m_proc, &QProcess::readyReadStandardOutput, this, &HelperClient::onReadyRead);
+    connect(&m_proc, &QProcess::readyReadStandardError, this, &HelperClient::onStandardError);
+    connect(&m_proc, &QProcess::finished, this, &HelperClient::onProcessFinished);
+
+    m_pingTimer.setInterval(PingIntervalMs);
+    connect(&m_pingTimer, &QTimer::timeout, this, &HelperClient::ping);
+}
+
+HelperClient::~HelperClient()
+{
+    if (m_proc.state() == QProcess::NotRunning)
+        return;
+    // Closing stdin lets the helper finish a running transaction and exit;
+    // never kill it mid-transaction.
+    stop();
+    m_proc.waitForFinished(StopTimeoutMs);
+}
+
+QString HelperClient::defaultProgram()
+{
+    const QString fromEnv = qEnvironmentVariable("TURBORPM_HELPER");
+    if (!fromEnv.isEmpty())
+        return QFileInfo(fromEnv).isExecutable() ? fromEnv : QString();
+
+    const QString sibling = QCoreApplication::applicationDirPath()
+                            + QStringLiteral("/turborpm-helper");
+    return QFileInfo(sibling).isExecutable() ? sibling : QString();
+}
+
+bool HelperClient::start(const QString &program, const QByteArray &password, QString *error,
+                         int timeoutMs)
+{
+    TraceSpan span("process", "sudo turborpm-helper");
+    if (m_proc.state() != QProcess::NotRunning) {
+        if (error)
+            *error = tr("The helper is already running.");
+        return m_alive;
+    }
+
+    m_reader = HelperFrameReader();
+    m_helloSeen = false;
+    m_helloRejected = false;
+    m_passwordRejected = false;
+    m_stopRequested = false;
+    m_lastError.clear();
+
+    // -k: always read the password, a cached timestamp would hand it to the helper
+    m_proc.start(QStringLiteral("sudo"),
+                 {QStringLiteral("-k"), QStringLiteral("-S"), QStringLiteral("-p"),
+                  QStringLiteral(" "), QStringLiteral("--"), program});
+    if (!m_proc.waitForStarted(StopTimeoutMs)) {
+        if (error)
+            *error = tr("Could not start sudo.");
+        return false;
+    }
+    m_proc.write(password);
+    m_proc.write("\n");
+
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot(true);
+    connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+    connect(&m_proc, &QProcess::finished, &loop, &QEventLoop::quit);
+    // Connected after onReadyRead(), so the hello has been handled by now
+    connect(&m_proc, &QProcess::readyReadStandardOutput, &loop, [this, &loop]() {
+        if (m_helloSeen)
+            loop.quit();
+    });
+    timeout.start(timeoutMs);
+    if (!m_helloSeen && !m_passwordRejected && m_proc.state() != QProcess::NotRunning)
+        loop.exec(QEventLoop::ExcludeUserInputEvents);
+
+    if (!m_helloSeen || m_helloRejected) {
+        if (m_proc.state() != QProcess::NotRunning) {
+            m_proc.kill();
+            m_proc.waitForFinished(StopTimeoutMs);
+        }
+        if (error) {
+            if (m_passwordRejected)
+                *error = tr("Root password was rejected.");
+            else if (m_helloRejected)
+                *error = tr("The privileged helper was refused: %1").arg(m_lastError);
+            else if (!m_lastError.isEmpty())
+                *error = m_lastError;
+            else
+                *error = tr("The privileged helper did not start.");
+        }
+        return false;
+    }
+
+    m_proc.write(HelperProtocol::SyncLine);
+    m_alive = true;
+    m_pingTimer.start();
+    emit healthChanged(true);
+    return true;
+}
+
+void HelperClient::stop()
+{
+    if (m_proc.state() == QProcess::NotRunning)
+        return;
+    m_pingTimer.stop();
+    m_stopRequested = true;
+    QJsonObject request{{QStringLiteral("id"), 0}, {QStringLiteral("op"), QStringLiteral("shutdown")}};
+    m_proc.write(HelperProtocol::encode(request));
+    m_proc.closeWriteChannel();
+}
+
+int HelperClient::send(const QString &op, const QStringList &args)
+{
+    if (!m_alive)
+        return -1;
+    const int id = m_nextId++;
+    const QJsonObject request{
+        {QStringLiteral("id"), id},
+        {QStringLiteral("op"), op},
+        {QStringLiteral("args"), QJsonArray::fromStringList(args)},
+    };
+    m_proc.write(HelperProtocol::encode(request));
+    return id;
+}
+
+void HelperClient::onReadyRead()
+{
+    m_reader.append(m_proc.readAllStandardOutput());
+    QJsonObject message;
+    QString error;
+    while (m_reader.next(message, &error))
+        handleMessage(message);
+    if (m_reader.hasError()) {
+        markDead(error);
+        m_proc.kill();
+    }
+}
+
+void HelperClient::onStandardError()
+{
+    const QString text = QString::fromLocal8Bit(m_proc.readAllStandardError());
+    if (!m_helloSeen) {
+        // sudo re-prompts on a wrong password; do not feed it anything else
+        if (text.contains(QStringLiteral("try again"), Qt::CaseInsensitive)
+            || text.contains(QStringLiteral("incorrect password"), Qt::CaseInsensitive)) {
+            m_passwordRejected = true;
+            m_proc.kill();
+        }
+    }
+    const QString trimmed = text.trimmed();
+    if (!trimmed.isEmpty())
+        m_lastError = trimmed;
+}
+
+void HelperClient::onProcessFinished()
+{
+    markDead(m_lastError.isEmpty() ? tr("exit code %1").arg(m_proc.exitCode()) : m_lastError);
+}
+
+void HelperClient::handleMessage(const QJsonObject &message)
+{
+    const QString type = message.value(QStringLiteral("type")).toString();
+    const int id = message.value(QStringLiteral("id")).toInt();
+
+    if (type == QLatin1String("output")) {
+        emit output(id, QByteArray::fromBase64(message.value(QStringLiteral("data")).toString().toLatin1()));
+    } else if (type == QLatin1String("finished")) {
+        emit finished(id, message.value(QStringLiteral("exitCode")).toInt());
+    } else if (type == QLatin1String("error")) {
+        emit failed(id, message.value(QStringLiteral("message")).toString());
+    } else if (type == QLatin1String("pong")) {
+        m_pingOutstanding = false;
+        m_lastPingMs = m_pingClock.elapsed();
+        Trace::counter("helper.ping.ms", m_lastPingMs);
+    } else if (type == QLatin1String("hello")) {
+        m_helloSeen = true;
+        m_helperPid = message.value(QStringLiteral("pid")).toInteger();
+        // start() fails on either; the hello is the only proof of what answered
+        const int version = message.value(QStringLiteral("version")).toInt();
+        const qint64 uid = message.value(QStringLiteral("uid")).toInteger(-1);
+        if (version != HelperProtocol::Version) {
+            m_helloRejected = true;
+            m_lastError = tr("protocol version %1, expected %2").arg(version).arg(HelperProtocol::Version);
+        } else if (uid != expectedUid()) {
+            m_helloRejected = true;
+            m_lastError = tr("running as uid %1, expected %2").arg(uid).arg(expectedUid());
+        }
+    }
+}
+
+qint64 HelperClient::expectedUid()
+{
+    // The unprivileged stand-in of the tests runs as the caller
+    if (qEnvironmentVariable("TURBORPM_HELPER_UNPRIVILEGED") == QLatin1String("1"))
+        return qint64(::geteuid());
+    return 0;
+}
+
+void HelperClient::ping()
+{
+    // The previous ping is still unanswered after a whole interval: the helper hangs
+    if (m_pingOutstanding) {
+        markDead(tr("no answer to ping"));
+        m_proc.kill();
+        return;
+    }
+    m_pingOutstanding = true;
+    m_pingClock.start();
+    m_proc.write(HelperProtocol::encode(
+        {{QStringLiteral("id"), 0}, {QStringLiteral("op"), QStringLiteral("ping")}}));
+}
+
+void HelperClient::markDead(const QString &reason)
+{
+    m_pingTimer.stop();
+    m_pingOutstanding = false;
+    if (!reason.isEmpty())
+        m_lastError = reason;
+    if (!m_alive)
+        return;
+    m_alive = false;
+    if (m_stopRequested)
+        RingLog::write(RingLog::Info, "helper: pid %1 stopped", m_helperPid);
+    else
+        RingLog::write(RingLog::Error, "helper: pid %1 lost: %2", m_helperPid, m_lastError);
+    emit healthChanged(false);
+}
@@ -0,0 +1,87 @@
+/**
+ * @file helperclient.h
+ * @author Nikolay Yevik
+ * @brief GUI side of the long-lived privileged turborpm-helper for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include "helperprotocol.h"
+
+/**
+ * Starts turborpm-helper once through "sudo -S" and keeps it for the whole
+ * admin session: no sudo spawn or re-authentication per operation. Health is
+ * explicit: the helper must answer a ping every PingIntervalMs, and exiting
+ * or missing a pong reports healthChanged(false).
+ */
+class HelperClient : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HelperClient(QObject *parent = nullptr);
+    ~HelperClient() override;
+
+    static constexpr int PingIntervalMs = 30000;
+
+    /** $TURBORPM_HELPER, else turborpm-helper next to the executable; empty when neither exists */
+    static QString defaultProgram();
+
+    /**
+     * Runs @p program under sudo with @p password and waits (painting, no user
+     * input) until the helper says hello, sudo gives up, or @p timeoutMs passes.
+     * A hello with another protocol version, or not from root, fails the start.
+     */
+    bool start(const QString &program, const QByteArray &password, QString *error = nullptr,
+               int timeoutMs = 30000);
+    /** Asks the helper to exit after the running operation; does not wait */
+    void stop();
+
+    bool isAlive() const { return m_alive; }
+    qint64 helperPid() const { return m_helperPid; }
+
+    /** Queues one whitelisted operation; returns its id, or -1 if the helper is gone */
+    int send(const QString &op, const QStringList &args = {});
+
+    /** Round-trip time of the last ping, -1 before the first pong */
+    qint64 lastPingMs() const { return m_lastPingMs; }
+
+signals:
+    void output(int id, const QByteArray &data);
+    void finished(int id, int exitCode);
+    void failed(int id, const QString &message);
+    void healthChanged(bool alive);
+
+private:
+    void onReadyRead();
+    void onStandardError();
+    void onProcessFinished();
+    void handleMessage(const QJsonObject &message);
+    void ping();
+    void markDead(const QString &reason);
+    /** What the hello must report: root, or the caller for the unprivileged test stand-in */
+    static qint64 expectedUid();
+
+    QProcess m_proc;
+    HelperFrameReader m_reader;
+    QTimer m_pingTimer;
+    QElapsedTimer m_pingClock;
+    bool m_pingOutstanding = false;
+    qint64 m_lastPingMs = -1;
+    bool m_alive = false;
+    bool m_helloSeen = false;
+    bool m_helloRejected = false; // wrong protocol version or uid; start() fails
+    bool m_passwordRejected = false;
+    bool m_stopRequested = false; // the exit that follows is not logged as a loss
+    qint64 m_helperPid = 0;
+    int m_nextId = 1;
+    QString m_lastError;
+};
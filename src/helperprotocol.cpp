@@ -0,0 +1,132 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the turborpm-helper protocol for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "helperprotocol.h"
+
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QObject>
+#include <QRegularExpression>
+#include <QtEndian>
+
+namespace {
+    constexpr int HeaderBytes {4};
+
+    // dnf verbs that take package specs; each runs non-interactively
+    const char *const kPackageOps[] = {"install", "remove", "reinstall", "upgrade", "downgrade"};
+
+    bool isPackageOp(const QString &op)
+    {
+        for (const char *known : kPackageOps) {
+            if (op == QLatin1String(known))
+                return true;
+        }
+        return false;
+    }
+
+    // NEVRA specs, globs and provides; a leading '-' would be parsed as an option
+    bool isSafeSpec(const QString &spec)
+    {
+        static const QRegularExpression allowed(
+            QStringLiteral("^[A-Za-z0-9_+.:~^*?@\\[\\]][A-Za-z0-9_+.:~^*?@\\[\\]()=<>/ -]*$"));
+        if (!allowed.match(spec).hasMatch())
+            return false;
+        // Absolute paths only for local packages, never "../" games
+        if (spec.startsWith(QLatin1Char('/')))
+            return spec.endsWith(QLatin1String(".rpm")) && !spec.contains(QLatin1String("/../"));
+        return !spec.contains(QLatin1Char('/'));
+    }
+}
+
+QByteArray HelperProtocol::encode(const QJsonObject &message)
+{
+    const QByteArray payload = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    QByteArray frame(HeaderBytes, Qt::Uninitialized);
+    qToBigEndian<quint32>(quint32(payload.size()), frame.data());
+    frame += payload;
+    return frame;
+}
+
+bool HelperProtocol::commandFor(const QString &op, const QStringList &args, Command &out,
+                                QString *error)
+{
+    // Metadata operations: the system cache, no package arguments
+    if (op == QLatin1String("makecache") || op == QLatin1String("check-update")) {
+        if (!args.isEmpty()) {
+            if (error)
+                *error = QObject::tr("%1 takes no arguments.").arg(op);
+            return false;
+        }
+        out = {QStringLiteral("dnf"), {op}};
+        return true;
+    }
+
+    if (!isPackageOp(op)) {
+        if (error)
+            *error = QObject::tr("Operation \"%1\" is not allowed.").arg(op);
+        return false;
+    }
+    // upgrade without arguments is a full system upgrade, the rest need targets
+    if (args.isEmpty() && op != QLatin1String("upgrade")) {
+        if (error)
+            *error = QObject::tr("%1 needs at least one package.").arg(op);
+        return false;
+    }
+    for (const QString &spec : args) {
+        if (!isSafeSpec(spec)) {
+            if (error)
+                *error = QObject::tr("Refusing package argument \"%1\".").arg(spec);
+            return false;
+        }
+    }
+
+    out.program = QStringLiteral("dnf");
+    out.arguments = QStringList{op, QStringLiteral("-y")} + args;
+    return true;
+}
+
+bool HelperFrameReader::next(QJsonObject &message, QString *error)
+{
+    if (m_failed)
+        return false;
+
+    const qsizetype available = m_buffer.size() - m_pos;
+    if (available < HeaderBytes)
+        return false;
+
+    const quint32 length = qFromBigEndian<quint32>(m_buffer.constData() + m_pos);
+    if (length > quint32(HelperProtocol::MaxFrameBytes)) {
+        m_failed = true;
+        if (error)
+            *error = QObject::tr("Frame of %1 bytes exceeds the protocol limit.").arg(length);
+        return false;
+    }
+    if (available < HeaderBytes + qsizetype(length))
+        return false;
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(
+        QByteArray::fromRawData(m_buffer.constData() + m_pos + HeaderBytes, length), &parseError);
+    m_pos += HeaderBytes + length;
+
+    // Compact once the consumed prefix dominates, so streaming stays linear
+    if (m_pos == m_buffer.size()) {
+        m_buffer.clear();
+        m_pos = 0;
+    } else if (m_pos > m_buffer.size() / 2) {
+        m_buffer.remove(0, m_pos);
+        m_pos = 0;
+    }
+
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        m_failed = true;
+        if (error)
+            *error = QObject::tr("Malformed frame: %1").arg(parseError.errorString());
+        return false;
+    }
+    message = doc.object();
+    return true;
+}
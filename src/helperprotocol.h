@@ -0,0 +1,75 @@
+/**
+ * @file helperprotocol.h
+ * @author Nikolay Yevik
+ * @brief Framing and operation whitelist shared by turborpm-helper and the GUI for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+/**
+ * Frames are a 4-byte big-endian payload length followed by one compact JSON
+ * object. Requests carry "id", "op" and "args"; replies carry the request
+ * "id" and a "type":
+ *   hello     sent once by the helper on startup ("uid", "pid", "version")
+ *   pong      answer to op "ping" ("uid", "busy", "uptimeMs")
+ *   output    a chunk of the running command's merged stdout/stderr ("data"),
+ *             base64 of the raw bytes: a pipe read may end inside a UTF-8 sequence
+ *   finished  the command exited ("exitCode")
+ *   error     the request was refused or failed to start ("message")
+ */
+class HelperProtocol
+{
+public:
+    static constexpr int Version = 2;
+    /** Frames above this are a protocol violation, not a large answer */
+    static constexpr int MaxFrameBytes = 16 * 1024 * 1024;
+    /**
+     * The client writes this line once the helper said hello. Everything the
+     * helper reads before it (a password sudo did not consume because of
+     * NOPASSWD) is discarded, so frames always start on a clean stream.
+     */
+    static constexpr char SyncLine[] = "TURBORPM-HELPER-SYNC\n";
+
+    static QByteArray encode(const QJsonObject &message);
+
+    /** A fully specified command line; the helper never runs anything else */
+    struct Command {
+        QString program; /** Executable looked up in PATH */
+        QStringList arguments; /** Complete argument list */
+    };
+
+    /**
+     * Maps a whitelisted operation (install, remove, reinstall, upgrade,
+     * downgrade, makecache, check-update) and its package specs to the
+     * command the helper runs. Refuses anything else, including specs that
+     * look like options.
+     */
+    static bool commandFor(const QString &op, const QStringList &args, Command &out,
+                           QString *error = nullptr);
+};
+
+/** Incremental decoder: feed whatever the pipe delivered, take whole frames out */
+class HelperFrameReader
+{
+public:
+    void append(const QByteArray &data) { m_buffer += data; }
+
+    /**
+     * Returns true and fills @p message when a complete frame is buffered.
+     * A malformed or oversized frame sets @p error; the stream is then unusable.
+     */
+    bool next(QJsonObject &message, QString *error = nullptr);
+
+    bool hasError() const { return m_failed; }
+
+private:
+    QByteArray m_buffer;
+    qsizetype m_pos = 0; // start of the first unread frame in m_buffer
+    bool m_failed = false;
+};
@@ -0,0 +1,238 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the package history timeline for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "historyview.h"
+#include "sizeformat.h"
+#include "trace.h"
+
+#include <QCheckBox>
+#include <QDateTime>
+#include <QDateTimeEdit>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QItemSelectionModel>
+#include <QLabel>
+#include <QPushButton>
+#include <QSplitter>
+#include <QStandardItemModel>
+#include <QTableView>
+#include <QVBoxLayout>
+
+namespace {
+    constexpr int RecordRole {Qt::UserRole + 1}; // index into PackageJournal::records()
+    constexpr int DefaultInstallRangeDays {7};
+
+    QString formatTime(qint64 msecs)
+    {
+        return QDateTime::fromMSecsSinceEpoch(msecs).toString(QStringLiteral("yyyy-MM-dd HH:mm"));
+    }
+
+    QString formatInstallTime(qint64 seconds)
+    {
+        return seconds > 0 ? formatTime(seconds * 1000) : QString();
+    }
+
+    QStandardItem *numberItem(int value)
+    {
+        auto *item = new QStandardItem();
+        item->setData(value, Qt::DisplayRole);
+        return item;
+    }
+}
+
+HistoryDialog::HistoryDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setObjectName(QStringLiteral("historyDialog"));
+    setWindowTitle(tr("Package history"));
+    resize(1000, 600);
+
+    auto *layout = new QVBoxLayout(this);
+    m_statusLabel = new QLabel(this);
+    layout->addWidget(m_statusLabel);
+
+    auto *splitter = new QSplitter(Qt::Horizontal, this);
+
+    auto *left = new QWidget(splitter);
+    auto *leftLayout = new QVBoxLayout(left);
+    leftLayout->setContentsMargins(0, 0, 0, 0);
+    m_recordsView = new QTableView(left);
+    m_recordsView->setObjectName(QStringLiteral("historyRecordsView"));
+    m_recordsModel = new QStandardItemModel(m_recordsView);
+    m_recordsModel->setHorizontalHeaderLabels({tr("Refresh"), tr("Packages"), tr("Added"),
+                                               tr("Removed"), tr("Changed")});
+    m_recordsView->setModel(m_recordsModel);
+    m_recordsView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_recordsView->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_recordsView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_recordsView->verticalHeader()->hide();
+    leftLayout->addWidget(m_recordsView);
+    m_compareNowCheck = new QCheckBox(tr("Compare with now"), left);
+    m_compareNowCheck->setToolTip(tr("Show everything that changed between the selected refresh "
+                                     "and the latest one"));
+    leftLayout->addWidget(m_compareNowCheck);
+
+    auto *right = new QWidget(splitter);
+    auto *rightLayout = new QVBoxLayout(right);
+    rightLayout->setContentsMargins(0, 0, 0, 0);
+    m_changesView = new QTableView(right);
+    m_changesView->setObjectName(QStringLiteral("historyChangesView"));
+    m_changesModel = new QStandardItemModel(m_changesView);
+    m_changesView->setModel(m_changesModel);
+    m_changesView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_changesView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_changesView->setSortingEnabled(true);
+    m_changesView->verticalHeader()->hide();
+    m_changesView->horizontalHeader()->setStretchLastSection(true);
+    rightLayout->addWidget(m_changesView);
+
+    auto *rangeLayout = new QHBoxLayout();
+    const QDateTime now = QDateTime::currentDateTime();
+    m_fromEdit = new QDateTimeEdit(now.addDays(-DefaultInstallRangeDays), right);
+    m_toEdit = new QDateTimeEdit(now, right);
+    for (QDateTimeEdit *edit : {m_fromEdit, m_toEdit}) {
+        edit->setCalendarPopup(true);
+        edit->setDisplayFormat(QStringLiteral("yyyy-MM-dd HH:mm"));
+    }
+    auto *installsButton = new QPushButton(tr("Show installs"), right);
+    installsButton->setToolTip(tr("Every package version installed in this period, "
+                                  "including ones removed since"));
+    rangeLayout->addWidget(new QLabel(tr("Installed from"), right));
+    rangeLayout->addWidget(m_fromEdit);
+    rangeLayout->addWidget(new QLabel(tr("to"), right));
+    rangeLayout->addWidget(m_toEdit);
+    rangeLayout->addWidget(installsButton);
+    rangeLayout->addStretch();
+    rightLayout->addLayout(rangeLayout);
+
+    splitter->setStretchFactor(1, 2);
+    layout->addWidget(splitter, /*stretch*/ 1);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton *reloadButton = buttons->addButton(tr("Reload"), QDialogButtonBox::ActionRole);
+    layout->addWidget(buttons);
+
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(reloadButton, &QPushButton::clicked, this, &HistoryDialog::reload);
+    connect(installsButton, &QPushButton::clicked, this, &HistoryDialog::showInstalls);
+    connect(m_compareNowCheck, &QCheckBox::toggled, this, &HistoryDialog::showSelectedRecord);
+    connect(m_recordsView->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+            &HistoryDialog::showSelectedRecord);
+
+    reload();
+}
+
+void HistoryDialog::reload()
+{
+    TraceSpan span("ui", "HistoryDialog::reload");
+    const QModelIndex current = m_recordsView->currentIndex();
+    const QVariant selected = current.isValid() ? current.siblingAtColumn(0).data(RecordRole) : QVariant();
+
+    QString error;
+    if (!m_journal.open(&error)) {
+        m_statusLabel->setText(error);
+        return;
+    }
+
+    const QVector<PackageJournal::Record> &records = m_journal.records();
+    m_recordsModel->setRowCount(0);
+    // Newest first: the usual question is "what changed lately"
+    for (int i = int(records.size()) - 1; i >= 0; --i) {
+        const PackageJournal::Record &record = records.at(i);
+        auto *when = new QStandardItem(formatTime(record.timestampMs));
+        when->setData(i, RecordRole);
+        if (record.checkpoint)
+            when->setToolTip(tr("Full checkpoint"));
+        m_recordsModel->appendRow({when, numberItem(record.packages), numberItem(record.added),
+                                   numberItem(record.removed), numberItem(record.changed)});
+    }
+    m_recordsView->resizeColumnsToContents();
+
+    if (records.isEmpty()) {
+        m_statusLabel->setText(tr("No history yet: every refresh of the installed list is recorded "
+                                  "from now on."));
+        return;
+    }
+    m_statusLabel->setText(tr("%1 refreshes since %2, journal size %3")
+                               .arg(records.size())
+                               .arg(formatTime(records.first().timestampMs))
+                               .arg(formatSizeValue(m_journal.fileSize(), SizeUnit::Kilobytes)));
+
+    int row = 0;
+    if (selected.isValid())
+        row = int(records.size()) - 1 - selected.toInt();
+    m_recordsView->setCurrentIndex(m_recordsModel->index(row, 0));
+}
+
+void HistoryDialog::showSelectedRecord()
+{
+    const QModelIndex current = m_recordsView->currentIndex();
+    if (!current.isValid())
+        return;
+    const int record = current.siblingAtColumn(0).data(RecordRole).toInt();
+
+    QString error;
+    PackageJournal::Diff diff;
+    if (m_compareNowCheck->isChecked()) {
+        PackageJournal::State then;
+        if (!m_journal.stateAt(record, then, &error)) {
+            m_statusLabel->setText(error);
+            return;
+        }
+        diff = PackageJournal::diff(then, m_journal.latest());
+    } else if (!m_journal.changesAt(record, diff, &error)) {
+        m_statusLabel->setText(error);
+        return;
+    }
+    showDiff(diff);
+}
+
+void HistoryDialog::showDiff(const PackageJournal::Diff &diff)
+{
+    m_changesView->setSortingEnabled(false);
+    m_changesModel->clear();
+    m_changesModel->setHorizontalHeaderLabels({tr("Change"), tr("Package"), tr("Before"), tr("After"),
+                                               tr("Installed")});
+
+    auto addRow = [this](const QString &change, const PackageJournal::Entry &entry,
+                         const QByteArray &before, const QByteArray &after) {
+        m_changesModel->appendRow({new QStandardItem(change),
+                                   new QStandardItem(QString::fromUtf8(entry.key)),
+                                   new QStandardItem(QString::fromUtf8(before)),
+                                   new QStandardItem(QString::fromUtf8(after)),
+                                   new QStandardItem(formatInstallTime(entry.installTime))});
+    };
+    for (const auto &change : diff.changed)
+        addRow(change.first.evr == change.second.evr ? tr("reinstalled") : tr("changed"),
+               change.second, change.first.evr, change.second.evr);
+    for (const PackageJournal::Entry &entry : diff.added)
+        addRow(tr("added"), entry, QByteArray(), entry.evr);
+    for (const PackageJournal::Entry &entry : diff.removed)
+        addRow(tr("removed"), entry, entry.evr, QByteArray());
+
+    m_changesView->setSortingEnabled(true);
+    m_changesView->resizeColumnsToContents();
+}
+
+void HistoryDialog::showInstalls()
+{
+    const QVector<PackageJournal::Entry> installs = m_journal.installedBetween(
+        m_fromEdit->dateTime().toSecsSinceEpoch(), m_toEdit->dateTime().toSecsSinceEpoch());
+
+    m_changesView->setSortingEnabled(false);
+    m_changesModel->clear();
+    m_changesModel->setHorizontalHeaderLabels({tr("Installed"), tr("Package"), tr("Version")});
+    for (const PackageJournal::Entry &entry : installs) {
+        m_changesModel->appendRow({new QStandardItem(formatInstallTime(entry.installTime)),
+                                   new QStandardItem(QString::fromUtf8(entry.key)),
+                                   new QStandardItem(QString::fromUtf8(entry.evr))});
+    }
+    m_changesView->setSortingEnabled(true);
+    m_changesView->resizeColumnsToContents();
+    m_statusLabel->setText(tr("%n package version(s) installed in this period", nullptr,
+                              int(installs.size())));
+}
@@ -0,0 +1,48 @@
+/**
+ * @file historyview.h
+ * @author Nikolay Yevik
+ * @brief Timeline of the installed package set from PackageJournal for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QDialog>
+
+#include "packagejournal.h"
+
+class QCheckBox;
+class QDateTimeEdit;
+class QLabel;
+class QStandardItemModel;
+class QTableView;
+
+/**
+ * Left: one row per journal record. Right: what the selected record
+ * changed, or everything that changed between it and now, or the versions
+ * installed in a time range (from the journal's installtime index).
+ */
+class HistoryDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit HistoryDialog(QWidget *parent = nullptr);
+
+    /** Re-reads the journal; records appended since keep the selection */
+    void reload();
+
+private:
+    void showSelectedRecord();
+    void showInstalls();
+    void showDiff(const PackageJournal::Diff &diff);
+
+    PackageJournal m_journal;
+    QStandardItemModel *m_recordsModel = nullptr;
+    QStandardItemModel *m_changesModel = nullptr;
+    QTableView *m_recordsView = nullptr;
+    QTableView *m_changesView = nullptr;
+    QCheckBox *m_compareNowCheck = nullptr;
+    QDateTimeEdit *m_fromEdit = nullptr;
+    QDateTimeEdit *m_toEdit = nullptr;
+    QLabel *m_statusLabel = nullptr;
+};
@@ -0,0 +1,109 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the log panel for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "logpanel.h"
+#include "ringlog.h"
+
+#include <QComboBox>
+#include <QDir>
+#include <QFontDatabase>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QTimer>
+#include <QVBoxLayout>
+
+namespace {
+    constexpr int PollMs {500}; // twice the flush interval is plenty for reading
+    constexpr int MaxShownLines {RingLog::HistorySize};
+}
+
+LogPanel::LogPanel(QWidget *parent)
+    : QWidget(parent)
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+
+    auto *top = new QHBoxLayout();
+    m_levelCombo = new QComboBox(this);
+    for (const RingLog::Level level : {RingLog::Debug, RingLog::Info, RingLog::Warning, RingLog::Error})
+        m_levelCombo->addItem(RingLog::levelName(level));
+    m_levelCombo->setCurrentIndex(RingLog::Info);
+    m_levelCombo->setToolTip(tr("Lowest level shown; the log file has every level"));
+    m_pathLabel = new QLabel(this);
+    m_pathLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    auto *copyButton = new QPushButton(tr("Copy"), this);
+    top->addWidget(m_levelCombo);
+    top->addWidget(m_pathLabel, /*stretch*/ 1);
+    top->addWidget(copyButton);
+    layout->addLayout(top);
+
+    m_text = new QPlainTextEdit(this);
+    m_text->setObjectName(QStringLiteral("logPanelText"));
+    m_text->setReadOnly(true);
+    m_text->setLineWrapMode(QPlainTextEdit::NoWrap);
+    m_text->setMaximumBlockCount(MaxShownLines);
+    m_text->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    layout->addWidget(m_text);
+
+    m_pollTimer = new QTimer(this);
+    m_pollTimer->setInterval(PollMs);
+    connect(m_pollTimer, &QTimer::timeout, this, &LogPanel::poll);
+    connect(m_levelCombo, &QComboBox::currentIndexChanged, this, &LogPanel::reload);
+    connect(copyButton, &QPushButton::clicked, this, [this]() {
+        m_text->selectAll();
+        m_text->copy();
+    });
+}
+
+void LogPanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    const QString path = RingLog::filePath();
+    m_pathLabel->setText(path.isEmpty() ? tr("Not written to a file")
+                                        : QDir::toNativeSeparators(path));
+    poll();
+    m_pollTimer->start();
+}
+
+void LogPanel::hideEvent(QHideEvent *event)
+{
+    m_pollTimer->stop();
+    QWidget::hideEvent(event);
+}
+
+void LogPanel::poll()
+{
+    const QVector<RingLog::Entry> entries = RingLog::recent(m_lastSeq);
+    if (entries.isEmpty())
+        return;
+    m_lastSeq = entries.last().seq;
+
+    const int minLevel = m_levelCombo->currentIndex();
+    QStringList lines;
+    for (const RingLog::Entry &entry : entries) {
+        if (entry.level >= minLevel)
+            lines << RingLog::formatLine(entry);
+    }
+    if (lines.isEmpty())
+        return;
+
+    // Follow the end unless the user scrolled up to read
+    QScrollBar *bar = m_text->verticalScrollBar();
+    const bool atEnd = bar->value() == bar->maximum();
+    m_text->appendPlainText(lines.join(QLatin1Char('\n')));
+    if (atEnd)
+        bar->setValue(bar->maximum());
+}
+
+void LogPanel::reload()
+{
+    m_text->clear();
+    m_lastSeq = 0;
+    poll();
+}
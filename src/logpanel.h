@@ -0,0 +1,41 @@
+/**
+ * @file logpanel.h
+ * @author Nikolay Yevik
+ * @brief In-app view of the RingLog history for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QWidget>
+
+class QComboBox;
+class QLabel;
+class QPlainTextEdit;
+class QTimer;
+
+/**
+ * Shows what the log flusher has written, newest at the bottom. Polls
+ * RingLog::recent() while visible only, so a closed panel costs nothing;
+ * the level box hides entries below the chosen level.
+ */
+class LogPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit LogPanel(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void poll();
+    void reload();
+
+    QComboBox *m_levelCombo = nullptr; // items in RingLog::Level order
+    QPlainTextEdit *m_text = nullptr;
+    QLabel *m_pathLabel = nullptr;
+    QTimer *m_pollTimer = nullptr;
+    quint64 m_lastSeq = 0;
+};
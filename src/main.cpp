@@ -6,64 +6,77 @@
  * @date 2025-12-6
  */
 #include <QApplication>
-#include <QDebug>
-#include <QFile>
 #include <QIcon>
 #include <QCoreApplication>
 #include <QSysInfo>
 #include <QLoggingCategory>
 #include "mainwindow.h"
+#include "cli.h"
+#include "ringlog.h"
+#include "startupreport.h"
+#include "trace.h"
 
-#ifdef QT_DEBUG
-static inline QDebug DBG()
+#include <cstring>
+
+/** Shared by GUI and headless mode so both resolve the same cache and settings paths */
+static void setApplicationIdentity()
 {
-    return qDebug().noquote().nospace();
+    QCoreApplication::setApplicationName("TurboRPM");
+    QCoreApplication::setOrganizationName("YEVIK"); 
+    QCoreApplication::setApplicationVersion("0.0.1");
+    QCoreApplication::setOrganizationDomain("yevik.com");
 }
-#endif
+
 int main(int argc, char *argv[])
 {  
+    // Before anything else so the trace covers startup too
+    Trace::startFromEnvironment(argc, argv);
+
+    // Batch mode never needs a display server, so decide before QApplication exists
+    if (HeadlessCli::wantsHeadless(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        setApplicationIdentity();
+        RingLog::start(RingLog::defaultPath());
+        const int rc = HeadlessCli::run(app);
+        RingLog::stop();
+        Trace::stop();
+        return rc;
+    }
+
+    bool startupReport = false;
+    for (int i = 1; i < argc; ++i)
+        startupReport = startupReport || std::strcmp(argv[i], "--startup-report") == 0;
+    StartupReport::begin(startupReport);
+
     QApplication app(argc, argv);
+    StartupReport::mark("QApplication");
     QApplication::setApplicationDisplayName("TurboRPM Package Manager Prototype");
     const QIcon appIcon(":/src/icons/yumex.png");
     QApplication::setWindowIcon(appIcon);
     QApplication::setQuitOnLastWindowClosed(true);
-    QCoreApplication::setApplicationName("TurboRPM");
-    QCoreApplication::setOrganizationName("YEVIK"); 
-    QCoreApplication::setApplicationVersion("0.0.1");
-    QCoreApplication::setOrganizationDomain("yevik.com");
+    setApplicationIdentity();
     QString appName = QCoreApplication::applicationName();
-    QString orgName = QCoreApplication::organizationName();
     QString appVersion = QCoreApplication::applicationVersion();
 
-    #ifdef QT_DEBUG
-    DBG() << "=== TurboRPM Package Manager Prototype Debug Info ===\n";
-    DBG() << "Main Icon exists? " << QFile(":/src/icons/yumex.png").exists();
-    DBG() << "Main Icon isNull? " << appIcon.isNull();
-    DBG() << "Application Name: " << appName;
-    DBG() << "Organization Name: " << orgName;
-    DBG() << "TurboRPM Application Version: " << appVersion;
-    DBG() << "Qt Version: " << QT_VERSION_STR;
-    DBG() << "C++ Standard Version: " << __cplusplus;
-    DBG() << "Platform: " << QSysInfo::prettyProductName();
-    DBG() << "Build CPU Architecture: " << QSysInfo::buildCpuArchitecture();
-    DBG() << "Current CPU Architecture: " << QSysInfo::currentCpuArchitecture();
-    DBG() << "Kernel Type: " << QSysInfo::kernelType();
-    DBG() << "Kernel Version: " << QSysInfo::kernelVersion();
-    DBG() << "Word Size (bits): " << QSysInfo::WordSize;
-    DBG() << "Byte Order: "
-         << (QSysInfo::ByteOrder == QSysInfo::BigEndian ? "Big Endian" : "Little Endian")
-         << "\n";
-    DBG() << "Machine Host Name: " << QSysInfo::machineHostName() << "\n";
-    DBG() << "Machine Unique ID (hex): " << QSysInfo::machineUniqueId().toHex();
-    DBG() << "Boot Unique ID (hex): " << QSysInfo::bootUniqueId().toHex();
-    DBG() << "Product Version: " << QSysInfo::productVersion();
-    DBG() << "Product Type: " << QSysInfo::productType();
-
-    #endif
+    // Always on, release builds included; read back in the log panel
+    RingLog::start(RingLog::defaultPath());
+    RingLog::write(RingLog::Info, "start: %2 %1 bits", QSysInfo::WordSize,
+                   appName + QLatin1Char(' ') + appVersion + QStringLiteral(" on Qt ") + QLatin1String(qVersion()));
+    RingLog::write(RingLog::Info, "start: %1",
+                   QSysInfo::prettyProductName() + QLatin1Char(' ') + QSysInfo::kernelVersion()
+                       + QLatin1Char(' ') + QSysInfo::currentCpuArchitecture());
+    if (appIcon.isNull())
+        RingLog::write(RingLog::Warning, "start: application icon did not load");
     
+    // Widgets only; package data, admin state and the drop zone follow after the first paint
     MainWindow w;
     w.setAcceptDrops(true); //obscured by central widget and QTableView, JIC.
+    StartupReport::mark("window constructed");
     w.show();
+    StartupReport::mark("window shown");
 
-    return app.exec();
+    const int rc = app.exec();
+    RingLog::stop();
+    Trace::stop();
+    return rc;
 }
@@ -8,6 +8,29 @@
 
 #include "mainwindow.h"
 #include "packagemodel.h"
+#include "packagefilterproxy.h"
+#include "repometadata.h"
+#include "packagequery.h"
+#include "packagecache.h"
+#include "rpminfo.h"
+#include "sizeformat.h"
+#include "startupreport.h"
+#include "trace.h"
+#include "helperclient.h"
+#include "operationqueue.h"
+#include "fileverifier.h"
+#include "fleetsnapshot.h"
+#include "fleetview.h"
+#include "historyview.h"
+#include "packagejournal.h"
+#include "rpmdbwatcher.h"
+#include "rpmfileview.h"
+#include "repoindexer.h"
+#include "updateresolver.h"
+#include "elidedtextdelegate.h"
+#include "stallwatchdog.h"
+#include "logpanel.h"
+#include "ringlog.h"
 
 #include <QHeaderView>
 #include <QApplication>
@@ -39,6 +62,7 @@
 #include <QItemSelectionModel>
 #include <QMimeData>
 #include <QUrl>
+#include <QDir>
 #include <QFileInfo>
 #include <QFrame>
 #include <QLabel>
@@ -47,13 +71,30 @@
 #include <QDragMoveEvent>
 #include <QDropEvent>
 #include <QStandardItemModel>
+#include <QFontDatabase>
+#include <QFontMetrics>
 #include <QMetaType>
 #include <QDesktopServices>
 #include <QBrush>
+#include <QRegularExpression>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QSettings>
+#include <QTimer>
+#include <QDockWidget>
+#include <QToolButton>
+#include <QStatusBar>
+#include <QHash>
+#include <QMutex>
+#include <QSysInfo>
 
 #include <iostream>
 #include <chrono>
 #include <algorithm>
+#include <utility>
+#include <functional>
+#include <memory>
+#include <atomic>
 #include <unistd.h>
 
 //using Milliseconds = std::chrono::milliseconds;
@@ -62,30 +103,17 @@
 namespace {
     constexpr int WaitForStartedTimeoutMs {5000};   // 5 s
     constexpr int WaitForFinishedTimeoutMs {60000};  // 60 s
+    constexpr int QueryTimeoutMs {60000}; // rpm -qf/-ql/-qi run without blocking, but not forever
+    constexpr int DefaultUpdateRefreshMinutes {60};
+    constexpr int DnfCheckUpdateHasUpdates {100}; // dnf check-update exit code
+    constexpr int InstalledView {0};
+    constexpr int AvailableView {1};
+    constexpr int StartupFallbackMs {250}; // deferred init if no paint event arrives (e.g. minimized)
+    constexpr int StatusMessageMs {10000};
+    constexpr int VerifyPollMs {200}; // results dialog refresh while FileVerifier runs
+    constexpr int MaxSampledColumnWidthPx {480}; // long summaries elide instead of widening the table
 }
 namespace {
-QString formatSizeValue(qint64 bytes, SizeUnit unit)
-{
-    if (bytes < 0)
-        return QObject::tr("N/A");
-
-    double value = static_cast<double>(bytes);
-    QString unitLabel;
-
-    switch (unit) {
-    case SizeUnit::Kilobytes:
-        value /= 1024.0;
-        unitLabel = QObject::tr("KB");
-        break;
-    case SizeUnit::Megabytes:
-        value /= (1024.0 * 1024.0);
-        unitLabel = QObject::tr("MB");
-        break;
-    }
-
-    return QObject::tr("%1 %2").arg(value, 0, 'f', 2).arg(unitLabel);
-}
-
 bool mimeHasLocalUrls(const QMimeData *mimeData)
 {
     if (!mimeData || !mimeData->hasUrls())
@@ -111,102 +139,16 @@ QStringList extractLocalPaths(const QMimeData *mimeData)
     }
     return paths;
 }
-} // namespace
 
-using InfoRow = QPair<QString, QString>;
-using InfoRows = QVector<InfoRow>;
-Q_DECLARE_METATYPE(InfoRows);
-
-static InfoRows parseRpmQueryOutput(const QString &output)
+/** Package names typed or pasted into the batch prompts: whitespace or comma separated */
+QStringList splitPackageList(const QString &text)
 {
-    InfoRows rows;
-    QString currentKey;
-    QStringList currentLines;
-    bool inDescription = false;
-    bool awaitingSignatureValue = false;
-    bool signatureStored = false;
-
-    auto commitCurrent = [&]() {
-        if (currentKey.isEmpty() || currentLines.isEmpty())
-            return;
-
-        const QString value = inDescription
-                                  ? currentLines.join(QStringLiteral("\n"))
-                                  : currentLines.join(QStringLiteral(" ")).trimmed();
-        rows.append(qMakePair(currentKey, value));
-
-        currentKey.clear();
-        currentLines.clear();
-        inDescription = false;
-        awaitingSignatureValue = false;
-    };
-
-    const QStringList lines = output.split(QLatin1Char('\n'));
-    for (const QString &rawLine : lines) {
-        const QString trimmed = rawLine.trimmed();
-
-        if (inDescription) {
-            currentLines.append(rawLine);
-            continue;
-        }
-
-        if (awaitingSignatureValue) {
-            if (!trimmed.isEmpty()) {
-                currentLines.append(trimmed);
-                commitCurrent();
-                signatureStored = true;
-            }
-            continue;
-        }
-
-        const int colonPos = rawLine.indexOf(QLatin1Char(':'));
-        if (colonPos <= 0)
-            continue;
-
-        commitCurrent();
-
-        const QString key = rawLine.left(colonPos).trimmed();
-        if (key.isEmpty())
-            continue;
-
-        const QString valuePart = rawLine.mid(colonPos + 1);
-        const QString trimmedValue = valuePart.trimmed();
-
-        if (key.compare(QStringLiteral("Description"), Qt::CaseInsensitive) == 0) {
-            currentKey = key;
-            currentLines.clear();
-            if (!trimmedValue.isEmpty())
-                currentLines.append(trimmedValue);
-            inDescription = true;
-            continue;
-        }
-
-        if (key.compare(QStringLiteral("Signature"), Qt::CaseInsensitive) == 0) {
-            if (signatureStored)
-                continue; // drop duplicates entirely
-
-            currentKey = key;
-            currentLines.clear();
-            if (!trimmedValue.isEmpty()) {
-                currentLines.append(trimmedValue);
-                commitCurrent();
-                signatureStored = true;
-            } else {
-                awaitingSignatureValue = true;
-            }
-            continue;
-        }
-
-        currentKey = key;
-        currentLines.clear();
-        if (!trimmedValue.isEmpty())
-            currentLines.append(trimmedValue);
-        commitCurrent();
-    }
-
-    commitCurrent();
-    return rows;
+    QStringList names = text.split(QRegularExpression(QStringLiteral("[\\s,]+")),
+                                   Qt::SkipEmptyParts);
+    names.removeDuplicates();
+    return names;
 }
+} // namespace
 
 /** Runs in a QThread */
 class SizeConversionWorker : public QObject
@@ -221,6 +163,9 @@ signals:
 public slots:
     void perform(QVector<qint64> bytes, SizeUnit unit)
     {
+        Trace::setThreadName("SizeConversionWorker");
+        TraceSpan span("worker", "SizeConversionWorker::perform");
+        span.arg("rows", bytes.size());
         QStringList results;
         results.reserve(bytes.size());
 
@@ -251,6 +196,8 @@ public slots:
             return;
         }
 
+        Trace::setThreadName("RpmInfoWorker");
+        TraceSpan span("process", QStringLiteral("rpm -qi %1").arg(trimmedName));
         QProcess proc;
         proc.setProcessChannelMode(QProcess::MergedChannels);
         proc.start(QStringLiteral("rpm"), {QStringLiteral("-qi"), trimmedName});
@@ -272,7 +219,10 @@ public slots:
         }
 
         const int exitCode = proc.exitCode();
-        const QString output = QString::fromLocal8Bit(proc.readAll());
+        const QByteArray raw = proc.readAll();
+        const QString output = QString::fromLocal8Bit(raw);
+        span.arg("exitCode", exitCode);
+        span.arg("stdoutBytes", raw.size());
 
         if (exitCode != 0) {
             emit failed(trimmedName,
@@ -290,6 +240,254 @@ public slots:
     }
 };
 
+/** Runs in a QThread: dnf repoquery, then the snapshot the next startup paints from */
+class InstalledPackagesWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit InstalledPackagesWorker(QObject *parent = nullptr) : QObject(parent) {}
+
+signals:
+    void loaded(const QVector<PackageInfo> &pkgs, const QString &error);
+
+public slots:
+    void load()
+    {
+        Trace::setThreadName("InstalledPackagesWorker");
+        TraceSpan span("worker", "InstalledPackagesWorker::load");
+        QVector<PackageInfo> pkgs;
+        QString error;
+        // Stamp first: an rpm transaction racing the query must invalidate the snapshot
+        const QByteArray stamp = PackageCache::rpmdbStamp();
+        if (InstalledPackageQuery::run(pkgs, &error)) {
+            PackageCache::save(pkgs, stamp);
+            recordHistory(pkgs);
+        }
+        emit loaded(pkgs, error);
+    }
+
+private:
+    /** Journal write failures only cost history, never the refresh */
+    static void recordHistory(const QVector<PackageInfo> &pkgs)
+    {
+        PackageJournal journal;
+        QString error;
+        if (!journal.open(&error)
+            || !journal.append(PackageJournal::stateFor(pkgs), QDateTime::currentMSecsSinceEpoch(),
+                               nullptr, &error))
+            RingLog::write(RingLog::Warning, "journal: append failed: %1", error);
+    }
+};
+
+/** Runs in a QThread: the rpm -qa dependency dump and the graph built from it */
+class DependencyGraphWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DependencyGraphWorker(QObject *parent = nullptr) : QObject(parent) {}
+
+signals:
+    void loaded(const RemovalImpactAnalyzer &analyzer, const QString &error);
+
+public slots:
+    void load()
+    {
+        Trace::setThreadName("DependencyGraphWorker");
+        TraceSpan span("worker", "DependencyGraphWorker::load");
+        QVector<PackageDependencies> deps;
+        QString error;
+        RemovalImpactAnalyzer analyzer;
+        if (RemovalImpactAnalyzer::queryInstalled(deps, &error))
+            analyzer.setPackages(deps);
+        emit loaded(analyzer, error);
+    }
+};
+
+/** Runs in a QThread: streams every cached primary.xml, no dnf round-trip */
+class AvailablePackagesWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AvailablePackagesWorker(QObject *parent = nullptr) : QObject(parent) {}
+
+signals:
+    void loaded(const QVector<PackageInfo> &pkgs, const QStringList &errors);
+
+public slots:
+    void load()
+    {
+        Trace::setThreadName("AvailablePackagesWorker");
+        TraceSpan span("worker", "AvailablePackagesWorker::load");
+        QVector<PackageInfo> pkgs;
+        QStringList errors;
+
+        const QVector<RepoMetadataFile> files = RepoMetadataCache::find(QStringLiteral("primary"));
+        if (files.isEmpty())
+            errors << tr("No cached repository metadata found. Run \"dnf makecache\" once.");
+
+        PrimaryMetadataReader reader;
+        for (const RepoMetadataFile &file : files) {
+            const bool ok = reader.readFile(file.path, file.repoId,
+                                            [&pkgs](const RepoPackage &pkg) {
+                                                pkgs.push_back(pkg.info);
+                                            });
+            if (!ok)
+                errors << QStringLiteral("%1: %2").arg(file.repoId, reader.errorString());
+        }
+
+        emit loaded(pkgs, errors);
+    }
+};
+
+/** Runs in a QThread: upgrades for @p installed from the cached primary.xml files, no dnf */
+class UpdateResolveWorker : public QObject
+{
+    Q_OBJECT
+public:
+    UpdateResolveWorker(const QVector<PackageInfo> &installed, std::shared_ptr<UpdateSet> updates,
+                        QObject *parent = nullptr)
+        : QObject(parent), m_installed(installed), m_updates(std::move(updates)) {}
+
+signals:
+    /** @p ok is false when no usable metadata was cached */
+    void resolved(bool ok, const QStringList &errors);
+
+public slots:
+    void resolve()
+    {
+        Trace::setThreadName("UpdateResolveWorker");
+        TraceSpan span("worker", "UpdateResolveWorker::resolve");
+        QStringList errors;
+
+        UpdateResolver resolver;
+        resolver.loadCache(&errors);
+        if (!resolver.isEmpty())
+            *m_updates = resolver.resolve(m_installed);
+
+        emit resolved(!resolver.isEmpty(), errors);
+    }
+
+private:
+    QVector<PackageInfo> m_installed;
+    std::shared_ptr<UpdateSet> m_updates;
+};
+
+/** Runs in a QThread: reads every cached updateinfo.xml into @p index */
+class AdvisoriesWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AdvisoriesWorker(std::shared_ptr<AdvisoryIndex> index, QObject *parent = nullptr)
+        : QObject(parent), m_index(std::move(index)) {}
+
+signals:
+    void loaded(const QStringList &errors);
+
+public slots:
+    void load()
+    {
+        Trace::setThreadName("AdvisoriesWorker");
+        TraceSpan span("worker", "AdvisoriesWorker::load");
+        QStringList errors;
+
+        UpdateInfoReader reader;
+        const QVector<RepoMetadataFile> files = RepoMetadataCache::find(QStringLiteral("updateinfo"));
+        for (const RepoMetadataFile &file : files) {
+            if (!reader.readFile(file.path, file.repoId, *m_index))
+                errors << QStringLiteral("%1: %2").arg(file.repoId, reader.errorString());
+        }
+        span.arg("advisories", m_index->size());
+        span.arg("fixes", m_index->fixCount());
+
+        emit loaded(errors);
+    }
+
+private:
+    std::shared_ptr<AdvisoryIndex> m_index;
+};
+
+/** Shared by VerifyWorker and the results dialog, whichever goes away last frees it */
+struct VerifySession {
+    FileVerifier verifier;
+    std::atomic<qint64> total{0}; // files in the rpmdb list, 0 until the query returned
+    QMutex mutex;
+    QVector<VerifyResult> pending; // mismatches the dialog has not shown yet
+
+    QVector<VerifyResult> take()
+    {
+        QMutexLocker locker(&mutex);
+        return std::exchange(pending, {});
+    }
+};
+
+/**
+ * Runs in a QThread: rpm file lists, then FileVerifier's own pool. The dialog
+ * polls the session instead of taking one queued signal per mismatch.
+ */
+class VerifyWorker : public QObject
+{
+    Q_OBJECT
+public:
+    VerifyWorker(const QStringList &packages, std::shared_ptr<VerifySession> session,
+                 QObject *parent = nullptr)
+        : QObject(parent), m_packages(packages), m_session(std::move(session)) {}
+
+signals:
+    void finished(const VerifyStats &stats, const QString &error);
+
+public slots:
+    void run()
+    {
+        Trace::setThreadName("VerifyWorker");
+        TraceSpan span("worker", "VerifyWorker::run");
+        QVector<ExpectedFile> files;
+        QString error;
+        if (!FileVerifier::query(files, m_packages, &error)) {
+            emit finished(VerifyStats(), error);
+            return;
+        }
+        m_session->total.store(files.size());
+
+        VerifySession *session = m_session.get();
+        const VerifyStats stats = session->verifier.verify(files, [session](const VerifyResult &result) {
+            QMutexLocker locker(&session->mutex);
+            session->pending.push_back(result);
+        });
+        emit finished(stats, QString());
+    }
+
+private:
+    QStringList m_packages;
+    std::shared_ptr<VerifySession> m_session;
+};
+
+/** Runs in a QThread; the indexer has its own pool and is polled for progress */
+class RepoIndexWorker : public QObject
+{
+    Q_OBJECT
+public:
+    RepoIndexWorker(const QString &directory, std::shared_ptr<RepoIndexer> indexer,
+                    QObject *parent = nullptr)
+        : QObject(parent), m_directory(directory), m_indexer(std::move(indexer)) {}
+
+signals:
+    void finished(const RepoIndexStats &stats, const QString &error);
+
+public slots:
+    void run()
+    {
+        Trace::setThreadName("RepoIndexWorker");
+        RepoIndexStats stats;
+        QString error;
+        m_indexer->index(m_directory, &stats, &error);
+        emit finished(stats, error);
+    }
+
+private:
+    QString m_directory;
+    std::shared_ptr<RepoIndexer> m_indexer;
+};
+
 /** Constructor */
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -329,8 +527,13 @@ MainWindow::MainWindow(QWidget *parent)
 
     mainLayout->addWidget(m_accessBanner);
 
-    /** Top bar: search + refresh */
+    /** Top bar: view selector + search + refresh */
     auto *topLayout = new QHBoxLayout();
+    m_viewCombo = new QComboBox(central);
+    m_viewCombo->addItem(tr("Installed"));
+    m_viewCombo->addItem(tr("Available (cached metadata)"));
+    m_viewCombo->setToolTip(tr("Available packages are read from the local dnf metadata cache; "
+                               "installed ones are checked."));
     m_searchEdit = new QLineEdit(central);
     m_searchEdit->setPlaceholderText(QStringLiteral("Search package name..."));
     QFont baseFont = m_searchEdit->font();
@@ -350,15 +553,30 @@ MainWindow::MainWindow(QWidget *parent)
 
 
     m_btnRefresh = new QPushButton(QStringLiteral("Refresh installed"), central);
-
+    m_btnRefresh->setObjectName(QStringLiteral("refreshButton"));
+    m_updatesOnlyCheck = new QCheckBox(tr("Updates only"), central);
+    m_updatesOnlyCheck->setToolTip(tr("Show only packages with an update from the last check-update"));
+    m_advisoryFilterCombo = new QComboBox(central);
+    m_advisoryFilterCombo->addItem(tr("All packages"));
+    m_advisoryFilterCombo->addItem(tr("With advisories"));
+    m_advisoryFilterCombo->addItem(tr("Security advisories"));
+    m_advisoryFilterCombo->addItem(tr("Important or critical"));
+    m_advisoryFilterCombo->setToolTip(tr("Filter by advisories in the cached updateinfo metadata"));
+    m_updateStatusLabel = new QLabel(central);
+
+    topLayout->addWidget(m_viewCombo);
     topLayout->addWidget(m_searchEdit, /*stretch*/ 1);
+    topLayout->addWidget(m_updatesOnlyCheck);
+    topLayout->addWidget(m_advisoryFilterCombo);
+    topLayout->addWidget(m_updateStatusLabel);
     topLayout->addWidget(m_btnRefresh);
 
     mainLayout->addLayout(topLayout);
 
     /** Table view */
     m_model = new PackageTableModel(this);
-    m_proxy = new QSortFilterProxyModel(this);
+    m_availableModel = new PackageTableModel(this);
+    m_proxy = new PackageFilterProxyModel(this);
     m_proxy->setSourceModel(m_model);
     m_proxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
     m_proxy->setFilterKeyColumn(PackageTableModel::NameColumn);
@@ -373,8 +591,11 @@ MainWindow::MainWindow(QWidget *parent)
     m_tableView->setDefaultDropAction(Qt::MoveAction);
 
     m_tableView->setModel(m_proxy);
+    // Cells are laid out once per visible row, rows are never measured
+    m_tableView->setItemDelegate(new ElidedTextDelegate(m_tableView));
+    ElidedTextDelegate::setUniformRowHeight(m_tableView);
     m_tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
-    m_tableView->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_tableView->setSelectionMode(QAbstractItemView::ExtendedSelection);
     m_tableView->setSortingEnabled(true);
     m_tableView->horizontalHeader()->setStretchLastSection(true);
     m_tableView->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -391,6 +612,24 @@ MainWindow::MainWindow(QWidget *parent)
     m_btnPkgDesc = new QPushButton(QStringLiteral("Description of selected pkg"), central);
     m_btnWhatProvides = new QPushButton(QStringLiteral("What provides file..."), central);
     m_btnWhatProvidesDnD = new QPushButton(QStringLiteral("What rpm provides file by DnD "), central);
+    m_btnVerify = new QPushButton(QStringLiteral("Verify files..."), central);
+    m_btnVerify->setObjectName(QStringLiteral("verifyButton"));
+    m_btnVerify->setToolTip(tr("Check the files of the selected installed packages, or of every "
+                               "package when nothing is selected, against the rpm database"));
+    m_btnHistory = new QPushButton(QStringLiteral("History..."), central);
+    m_btnHistory->setObjectName(QStringLiteral("historyButton"));
+    m_btnHistory->setToolTip(tr("What was installed, removed or updated on this machine, per refresh"));
+    m_btnFleet = new QPushButton(QStringLiteral("Fleet..."), central);
+    m_btnFleet->setObjectName(QStringLiteral("fleetButton"));
+    auto *fleetMenu = new QMenu(m_btnFleet);
+    connect(fleetMenu->addAction(tr("Export package snapshot...")), &QAction::triggered,
+            this, &MainWindow::onExportSnapshot);
+    connect(fleetMenu->addAction(tr("Fleet view...")), &QAction::triggered,
+            this, &MainWindow::onShowFleetView);
+    fleetMenu->addSeparator();
+    connect(fleetMenu->addAction(tr("Index .rpm directory as a repository...")), &QAction::triggered,
+            this, &MainWindow::onIndexRepository);
+    m_btnFleet->setMenu(fleetMenu);
 
     bottomLayout->addWidget(m_btnCheckUpdate);
     bottomLayout->addWidget(m_btnInstall);
@@ -399,28 +638,17 @@ MainWindow::MainWindow(QWidget *parent)
     bottomLayout->addWidget(m_btnPkgDesc);
     bottomLayout->addWidget(m_btnWhatProvides);
     bottomLayout->addWidget(m_btnWhatProvidesDnD);
+    bottomLayout->addWidget(m_btnVerify);
+    bottomLayout->addWidget(m_btnHistory);
+    bottomLayout->addWidget(m_btnFleet);
     bottomLayout->addStretch();
 
     mainLayout->addLayout(bottomLayout);
 
-    m_dropArea = new QFrame(central);
-    m_dropArea->setFrameShape(QFrame::StyledPanel);
-    m_dropArea->setFrameShadow(QFrame::Sunken);
-    m_dropArea->setMinimumHeight(80);
-    m_dropArea->setAcceptDrops(true);
-    m_dropArea->setToolTip(tr("Drop a file or directory to run rpm -qf"));
-    auto *dropLayout = new QVBoxLayout(m_dropArea);
-    dropLayout->setContentsMargins(8, 8, 8, 8);
-
-    m_dropLabel = new QLabel(tr("Drag a file or directory here to see which RPM provides it.\nMultiple items are supported."), m_dropArea);
-    m_dropLabel->setAlignment(Qt::AlignCenter);
-    m_dropLabel->setWordWrap(true);
-    dropLayout->addWidget(m_dropLabel);
-
-    m_dropArea->installEventFilter(this);
-    mainLayout->addWidget(m_dropArea);
 
     setCentralWidget(central);
+    buildQueueDock();
+    buildLogDock();
 
     /** Connections -> Slots to signals */
     connect(m_btnRefresh, &QPushButton::clicked, this, &MainWindow::refreshPackages);
@@ -433,22 +661,167 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_btnPkgDesc, &QPushButton::clicked, this, &MainWindow::onShowPackageDescription);
     connect(m_btnWhatProvides, &QPushButton::clicked, this, &MainWindow::onWhatProvides);
     connect(m_btnWhatProvidesDnD, &QPushButton::clicked, this, &MainWindow::onWhatProvidesDnD);
+    connect(m_btnVerify, &QPushButton::clicked, this, &MainWindow::onVerifyPackages);
+    connect(m_btnHistory, &QPushButton::clicked, this, &MainWindow::onShowHistory);
     connect(m_tableView, &QTableView::customContextMenuRequested,
             this, &MainWindow::onTableContextMenu);
+    connect(m_updatesOnlyCheck, &QCheckBox::toggled, m_proxy,
+            &PackageFilterProxyModel::setUpdatesOnly);
+    connect(m_advisoryFilterCombo, &QComboBox::currentIndexChanged, this, [this](int index) {
+        // Items are listed in AdvisoryFilter order
+        m_proxy->setAdvisoryFilter(static_cast<PackageFilterProxyModel::AdvisoryFilter>(index));
+    });
+    connect(m_viewCombo, &QComboBox::currentIndexChanged, this, &MainWindow::onViewModeChanged);
 
     updateAccessBanner();
 
-    // Initial load
-    refreshPackages();
+    /**
+     * Staged startup: paint the last snapshot now, everything slow happens in
+     * finishStartup() once the table has been painted.
+     */
+    QVector<PackageInfo> cached;
+    if (PackageCache::load(cached, PackageCache::defaultPath(), /*requireFresh*/ false,
+                           &m_cacheWasFresh))
+        applyInstalledPackages(cached);
+    m_tableView->viewport()->installEventFilter(this);
+    QTimer::singleShot(StartupFallbackMs, this, &MainWindow::finishStartup);
+
+    /** Background check-update: the last result stays in the table until new data lands */
+    QSettings settings;
+    const int refreshMinutes = settings.value(QStringLiteral("updates/refreshIntervalMinutes"),
+                                              DefaultUpdateRefreshMinutes).toInt();
+    m_updateTimer = new QTimer(this);
+    connect(m_updateTimer, &QTimer::timeout, this, [this]() { startUpdateCheck(false); });
+    if (refreshMinutes > 0)
+        m_updateTimer->start(refreshMinutes * 60 * 1000);
+    updateCheckStatusLabel();
+}
+
+void MainWindow::finishStartup()
+{
+    if (m_startupFinished)
+        return;
+    m_startupFinished = true;
+    m_tableView->viewport()->removeEventFilter(this);
+    startStallWatchdog();
+    OperationScope scope("MainWindow::finishStartup");
+
+    buildDropArea();
+    updateAccessBanner(); // now with the scaled lock pixmap
+
+    // A snapshot taken at the current rpmdb state is as good as a dnf round-trip
+    if (m_cacheWasFresh) {
+        StartupReport::mark("data ready (snapshot)");
+        StartupReport::finish();
+        resolveUpdatesFromCache();
+    } else {
+        refreshPackages(); // resolves updates once the installed list is in
+    }
+
+    if (m_updateTimer->isActive())
+        startUpdateCheck(false);
+    else
+        loadAdvisories();
+
+    // rpm/dnf run from a terminal: pick their changes up without a manual refresh
+    m_rpmdbWatcher = new RpmdbWatcher(this);
+    connect(m_rpmdbWatcher, &RpmdbWatcher::changed, this, &MainWindow::refreshPackages);
+    m_rpmdbWatcher->start();
+}
+
+void MainWindow::buildDropArea()
+{
+    auto *mainLayout = qobject_cast<QVBoxLayout *>(centralWidget()->layout());
+    QWidget *central = centralWidget();
+
+    m_dropArea = new QFrame(central);
+    m_dropArea->setFrameShape(QFrame::StyledPanel);
+    m_dropArea->setFrameShadow(QFrame::Sunken);
+    m_dropArea->setMinimumHeight(80);
+    m_dropArea->setAcceptDrops(true);
+    m_dropArea->setToolTip(tr("Drop a file or directory to run rpm -qf, or .rpm files to inspect them"));
+    auto *dropLayout = new QVBoxLayout(m_dropArea);
+    dropLayout->setContentsMargins(8, 8, 8, 8);
+
+    m_dropLabel = new QLabel(tr("Drag a file or directory here to see which RPM provides it.\nDrop .rpm files or a directory of them to inspect the packages."), m_dropArea);
+    m_dropLabel->setAlignment(Qt::AlignCenter);
+    m_dropLabel->setWordWrap(true);
+    dropLayout->addWidget(m_dropLabel);
+
+    m_dropArea->installEventFilter(this);
+    mainLayout->addWidget(m_dropArea);
 }
 
 void MainWindow::refreshPackages()
 {
-    QVector<PackageInfo> pkgs = queryInstalledPackages();
+    if (m_installedLoading) {
+        // The running query may predate the transaction that asked for this one
+        m_installedRefreshPending = true;
+        return;
+    }
+    m_installedLoading = true;
+    m_btnRefresh->setEnabled(false);
+    m_btnRefresh->setText(tr("Refreshing..."));
+    // Taken before the query, so a transaction racing it still counts as a change
+    const QByteArray stamp = PackageCache::rpmdbStamp();
+
+    auto *worker = new InstalledPackagesWorker;
+    auto *thread = new QThread(this);
+    worker->moveToThread(thread);
+
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    connect(thread, &QThread::started, worker, &InstalledPackagesWorker::load);
+
+    connect(worker, &InstalledPackagesWorker::loaded, this,
+            [this, thread, stamp](const QVector<PackageInfo> &pkgs, const QString &error) {
+                thread->quit();
+                m_installedLoading = false;
+                m_btnRefresh->setEnabled(true);
+                m_btnRefresh->setText(QStringLiteral("Refresh installed"));
+                if (m_installedRefreshPending) {
+                    m_installedRefreshPending = false;
+                    refreshPackages();
+                }
+
+                if (!error.isEmpty()) {
+                    StartupReport::finish();
+                    QMessageBox::warning(this, tr("Error"), error);
+                    return;
+                }
+                if (m_rpmdbWatcher)
+                    m_rpmdbWatcher->setKnownStamp(stamp);
+                if (m_model->rowCount() > 0) {
+                    // Only the rows that changed: selection and scroll position survive
+                    m_model->syncPackages(pkgs);
+                    m_dependencyGraphStale = true;
+                    if (m_availableLoaded)
+                        m_availableModel->markInstalled(m_model->nevraKeys());
+                } else {
+                    applyInstalledPackages(pkgs);
+                }
+                StartupReport::mark("data ready (dnf)");
+                StartupReport::finish();
+                resolveUpdatesFromCache();
+            },
+            Qt::QueuedConnection);
+
+    thread->start();
+}
+
+void MainWindow::applyInstalledPackages(const QVector<PackageInfo> &pkgs)
+{
+    OperationScope scope("MainWindow::applyInstalledPackages");
     m_model->setPackages(pkgs);
+    m_dependencyGraphStale = true;
+    if (m_availableLoaded)
+        m_availableModel->markInstalled(m_model->nevraKeys());
+
+    // Sizing to contents only makes sense for the installed view
+    if (currentModel() != m_model)
+        return;
 
-    /** Table should be resized to show all contents */
-    m_tableView->resizeColumnsToContents();
+    resizeColumnsFromSamples();
 
     const auto *screen = QGuiApplication::primaryScreen();
     const QRect available = screen ? screen->availableGeometry() : QRect();
@@ -472,247 +845,310 @@ void MainWindow::refreshPackages()
     resize(finalWidth, finalHeight);
 }
 
-void MainWindow::onSearchTextChanged(const QString &text)
+void MainWindow::resizeColumnsFromSamples()
 {
-    m_proxy->setFilterFixedString(text);
+    TraceSpan span("ui", "resizeColumnsFromSamples");
+    const PackageTableModel *model = currentModel();
+    const QFontMetrics metrics(m_tableView->font());
+    QHeaderView *header = m_tableView->horizontalHeader();
+    for (int column = 0; column < PackageTableModel::ColumnCount; ++column) {
+        int width = ElidedTextDelegate::columnWidth(metrics, model->widestTexts(column),
+                                                    MaxSampledColumnWidthPx);
+        if (column == PackageTableModel::NameColumn && model == m_availableModel) {
+            // Room for the "installed" check mark
+            width += m_tableView->style()->pixelMetric(QStyle::PM_IndicatorWidth, nullptr, m_tableView)
+                     + m_tableView->style()->pixelMetric(QStyle::PM_CheckBoxLabelSpacing, nullptr, m_tableView);
+        }
+        m_tableView->setColumnWidth(column, std::max(width, header->sectionSizeHint(column)));
+    }
+    span.arg("rows", model->rowCount());
 }
 
-QVector<PackageInfo> MainWindow::queryInstalledPackages() const
-{
-#ifdef QT_DEBUG
-    QDebug dbg(QtDebugMsg);//on stack
-    
-    dbg.setVerbosity(QDebug::MaximumVerbosity);
-    dbg << "Entering MainWindow::queryInstalledPackages()";
-
-    //std::unique_ptr<QDebug> uni_qdebugobj_ptr = std::make_unique<QDebug>(QtDebugMsg);
-    //QDebug *raw_qdebugobj_ptr = uni_qdebugobj_ptr.get(); //raw pointer for easier use below
-    //std::cout << "QDebug verbosity from  uni_qdebugobj_ptr" << uni_qdebugobj_ptr->verbosity() << std::endl;
-    //std::cout << "QDebug verbosity from raw_qdebugobj_ptr" << raw_qdebugobj_ptr->verbosity( << std::endl;
-    
-    dbg.setVerbosity(QDebug::MaximumVerbosity);
-    dbg << "QDebug verbosity from dbg object " << dbg.verbosity() << "\n";
-    
-#endif
-
-    //QThread *currentThread = QThread::currentThread();
-    QVector<PackageInfo> result;
-
-    static constexpr QChar kFieldSep(u'\x1F'); // unit separator to avoid clashing with tabs/spaces in fields
-
-    QProcess proc; /** to run the command I need */
-    proc.setProcessChannelMode(QProcess::SeparateChannels); //* we want to read stdout and stderr separately */
-    
-    QStringList args;
-    //const bool hasRepoTag = rpmSupportsFromRepoTag();
-    //const QString repoField = hasRepoTag ? QString::fromLatin1("\x1F%{repoid}")
-   //                                      : QString::fromLatin1("\x1F");
-    /*args << "-qa"
-         << "--qf"
-         << QString::fromLatin1("%{NAME}\x1F%{VERSION}-%{RELEASE}\x1F%{ARCH}\x1F%{INSTALLTIME:date}\x1F%{GROUP}\x1F%{SIZE}")
-                //+ repoField
-                + QString::fromLatin1("\x1F%{SUMMARY}\n");*/
-
-    QString command = QStringLiteral("dnf");
-
-    //Better to use DNF to get more accurate info about installed packages
-    const QString queryFormat = QStringLiteral(
-        "%{name}\x1F" // rpm package name
-        "%{version}-%{release}\x1F"
-        "%{arch}\x1F"
-        "%{installtime}\x1F"
-        "%{group}\x1F"
-        "%{size}\x1F" //size in bytes
-        "%{from_repo}\x1F" //attempt to resolve what repo this package is coming from
-        "%{summary}");
-
-    args << QStringLiteral("repoquery")
-         << QStringLiteral("--installed")
-         << QStringLiteral("--qf") << queryFormat;
-
-
-    /**command might not start so we set a timeout */
-    proc.start(command, args); /** START THE PROCESS */
+void MainWindow::startStallWatchdog()
+{
+    const int thresholdMs = StallWatchdog::thresholdFromEnvironment();
+    if (thresholdMs <= 0)
+        return;
 
-    if (!proc.waitForStarted(WaitForStartedTimeoutMs)) {
-        QMessageBox::warning(nullptr, tr("Error"),
-                             tr("Failed to start dnf process."));
-        return result;
-    }
-    /** command might be slow or hang, so we set a timeout */
-    if (!proc.waitForFinished(WaitForFinishedTimeoutMs)) { // 60 s timeout
-        QMessageBox::warning(nullptr, tr("Error"),
-                             tr("Timed out while running dnf"));
-        return result;
-    }
-    if (proc.exitStatus() != QProcess::NormalExit) {
-        QMessageBox::warning(nullptr, tr("Error"),
-                             tr("dnf crashed while running."));
-        return result;
-    }
-
-    const QByteArray out = proc.readAllStandardOutput(); //* read stdout  into QByteArray */
-    const QByteArray err = proc.readAllStandardError();  //* read stderr into QByteArray */
-   
-    #ifdef QT_DEBUG
-    qDebug() << "dnf repoquery output bytes:" << out.size() << "stderr bytes:" << err.size();
-    if (!err.isEmpty())
-        qDebug() << "dnf repoquery stderr:" << err;
-    #endif
-
-    QString data = QString::fromLocal8Bit(out);
-    QTextStream stream(&data, QIODevice::ReadOnly);
-
-    QString line;
-    int lineIndex = 0;
-    // for deduplicating (name, version, arch)
-    QSet<QString> seenKeys;
-
-    while (stream.readLineInto(&line)) {
-        const QString trimmed = line.trimmed();
-        if (trimmed.isEmpty()) {
-#ifdef QT_DEBUG
-            dbg << "Skipping empty line at index "<< lineIndex << " because it is empty \n";
-#endif
-            ++lineIndex;
-            continue;
-        }
-        // Filter known dnf informational noise printed to stdout
-        if (trimmed.startsWith(
-                QStringLiteral("Not root, Subscription Management repositories not updated"))) {
-#ifdef QT_DEBUG
-            dbg << "Skipping dnf info line at index because it is informational: " << lineIndex << ":" << trimmed << "\n";
-#endif
-            ++lineIndex;
-            continue;
-        }
-        const QStringList fields = trimmed.split(kFieldSep, Qt::KeepEmptyParts);
-        // Allow partially filled records, but require at least:
-        //   0: name, 1: version-release, 2: arch
-        if (fields.size() < 3) {
-#ifdef QT_DEBUG
-            dbg << "Skipping line with too few fields at index" << lineIndex << ":" << trimmed << "\n";
-#endif
-            ++lineIndex;
-            continue;
-        }
+    m_stallWatchdog = new StallWatchdog(this);
+    m_stallWatchdog->setThreshold(thresholdMs);
+
+    // Stalls always go to the log; the label only when asked for
+    QSettings settings;
+    if (settings.value(QStringLiteral("diagnostics/showWorstStall"), true).toBool()) {
+        m_stallLabel = new QLabel(this);
+        m_stallLabel->hide();
+        statusBar()->addPermanentWidget(m_stallLabel);
+        connect(m_stallWatchdog, &StallWatchdog::stallRecorded, this, [this](const StallRecord &stall) {
+            const StallRecord worst = m_stallWatchdog->worstStall();
+            if (stall.durationMs < worst.durationMs && m_stallLabel->isVisible())
+                return;
+            m_stallLabel->setText(worst.durationMs < 1000
+                                      ? tr("Worst stall: %1 ms").arg(worst.durationMs)
+                                      : tr("Worst stall: %1 s").arg(worst.durationMs / 1000.0, 0, 'f', 1));
+            m_stallLabel->setToolTip(tr("The window stopped responding at %1 during:\n%2\n\nEvery stall is logged to %3")
+                                         .arg(worst.startedAt.toString(Qt::ISODate), worst.blame(),
+                                              QDir::toNativeSeparators(RingLog::filePath())));
+            m_stallLabel->show();
+        });
+    }
+    m_stallWatchdog->start();
+}
 
-        PackageInfo pkg;
-        pkg.name    = fields.value(0).trimmed();
-        pkg.version = fields.value(1).trimmed();
-        pkg.arch    = fields.value(2).trimmed();
-        // Minimal validation: if these are missing it's not a real package entry
-        if (pkg.name.isEmpty() || pkg.version.isEmpty() || pkg.arch.isEmpty()) {
-#ifdef QT_DEBUG
-            dbg << "Skipping line with empty mandatory fields at index"
-                     << lineIndex << ":" << trimmed <<"\n";
-#endif
-            ++lineIndex;
-            continue;
-        }
-        // Deduplicate (dnf can sometimes output multiple rows for same NEVRA)
-        const QString key =
-            pkg.name + QLatin1Char('|') + pkg.version + QLatin1Char('|') + pkg.arch;
-        if (seenKeys.contains(key)) {
-#ifdef QT_DEBUG
-            dbg << "Skipping duplicate entry for" << key << "at line index" << lineIndex << "\n";
-#endif
-            ++lineIndex;
-            continue;
-        }
-        seenKeys.insert(key);
-
-        // INSTALLTIME comes from dnf repoquery as a preformatted string
-        // (see dnf-plugins-core repoquery.py: PackageWrapper.installtime).
-        // We keep it as-is instead of trying to parse epoch seconds.
-        const QString installField = fields.value(3).trimmed();
-        pkg.installDate = installField;
-
-        //Do not like how install date is represented, convert UTC string to local time
-        /*const QDateTime dt = QDateTime::fromString(installField, Qt::ISODate);
-        if (dt.isValid()) {
-            pkg.installDate = dt.toLocalTime().toString(QStringLiteral("yyyy-MM-dd HH:mm"));
-        }*/
-
-        pkg.group   = fields.value(4).trimmed();
-        
-        // SIZE: keep original string, but sanity-check that it's numeric
-        const QString sizeField = fields.value(5).trimmed();
-        bool okSize = false;
-        const qint64 parsedSize = sizeField.toLongLong(&okSize);
-        if (okSize) {
-            pkg.size = sizeField;
-            pkg.sizeBytes = parsedSize;
-        } else {
-            pkg.size.clear(); // treat nonsense size as "unknown"
-            pkg.sizeBytes = -1;
-        }
+void MainWindow::onViewModeChanged(int index)
+{
+    const bool available = (index == AvailableView);
+    if (available)
+        m_updatesOnlyCheck->setChecked(false);
+    m_updatesOnlyCheck->setEnabled(!available);
+    // Advisories are joined against the installed set only
+    if (available)
+        m_advisoryFilterCombo->setCurrentIndex(0);
+    m_advisoryFilterCombo->setEnabled(!available);
+
+    m_proxy->setSourceModel(available ? m_availableModel : m_model);
+
+    if (available && !m_availableLoaded)
+        loadAvailablePackages();
+}
 
-        #ifdef QT_DEBUG
-        //dbg << "Parsed dnf line" << lineIndex << "fields" << fields;
-        #endif
+PackageTableModel *MainWindow::currentModel() const
+{
+    return m_viewCombo && m_viewCombo->currentIndex() == AvailableView ? m_availableModel
+                                                                       : m_model;
+}
 
-        pkg.repo    = fields.value(6).trimmed();
-        pkg.summary = fields.value(7).trimmed();
+void MainWindow::loadAvailablePackages()
+{
+    if (m_availableLoading)
+        return;
+    m_availableLoading = true;
+    m_viewCombo->setItemText(AvailableView, tr("Available (loading...)"));
 
-        result.push_back(pkg);
-        ++lineIndex;
-    }//end of while reading lines
+    auto *worker = new AvailablePackagesWorker;
+    auto *thread = new QThread(this);
+    worker->moveToThread(thread);
 
-    return result;
-}//=== End of MainWindow::queryInstalledPackages ===
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    connect(thread, &QThread::started, worker, &AvailablePackagesWorker::load);
 
+    connect(worker, &AvailablePackagesWorker::loaded, this,
+            [this, thread](const QVector<PackageInfo> &pkgs, const QStringList &errors) {
+                thread->quit();
+                m_availableLoading = false;
+                m_availableLoaded = !pkgs.isEmpty();
+
+                m_availableModel->setPackages(pkgs);
+                m_availableModel->markInstalled(m_model->nevraKeys());
+                if (currentModel() == m_availableModel)
+                    resizeColumnsFromSamples();
+
+                m_viewCombo->setItemText(AvailableView,
+                                         tr("Available (%1 cached)").arg(pkgs.size()));
+                m_viewCombo->setItemData(AvailableView, errors.join(QLatin1Char('\n')),
+                                         Qt::ToolTipRole);
+                if (pkgs.isEmpty() && !errors.isEmpty())
+                    QMessageBox::warning(this, tr("Available packages"), errors.join(QLatin1Char('\n')));
+            },
+            Qt::QueuedConnection);
 
+    thread->start();
+}
 
-QString MainWindow::runCommand(const QString &program,
-                               const QStringList &arguments,
-                               int &exitCode,
-                               bool requireAdmin)
+void MainWindow::loadAdvisories()
 {
-    QString effectiveProgram = program;
-    QStringList effectiveArgs = arguments;
+    if (m_advisoriesLoading)
+        return;
+    m_advisoriesLoading = true;
 
-    if (requireAdmin && !m_isRunningAsRoot) {
-        if (!ensureAdminAccess()) {
-            exitCode = -1;
-            return tr("Administrative access was not granted. Command skipped.");
-        }
-        effectiveArgs.prepend(program);
-        effectiveProgram = QStringLiteral("sudo");
-        effectiveArgs.prepend(QStringLiteral("-n"));
-    }
+    auto index = std::make_shared<AdvisoryIndex>();
+    auto *worker = new AdvisoriesWorker(index);
+    auto *thread = new QThread(this);
+    worker->moveToThread(thread);
 
-    QProcess proc;
-    proc.setProcessChannelMode(QProcess::MergedChannels);
-    proc.start(effectiveProgram, effectiveArgs);
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    connect(thread, &QThread::started, worker, &AdvisoriesWorker::load);
 
-    if (!proc.waitForStarted(WaitForStartedTimeoutMs)) {
-        exitCode = -1;
-        return tr("Failed to start %1").arg(effectiveProgram);
-    }
+    connect(worker, &AdvisoriesWorker::loaded, this,
+            [this, thread, index](const QStringList &errors) {
+                thread->quit();
+                m_advisoriesLoading = false;
+
+                m_model->setAdvisories(*index);
+                QStringList tip;
+                if (index->isEmpty())
+                    tip << tr("No cached updateinfo metadata found.");
+                else
+                    tip << tr("%1 advisories, %2 installed packages affected")
+                               .arg(index->size())
+                               .arg(m_model->affectedCount());
+                tip << errors;
+                m_advisoryFilterCombo->setToolTip(tip.join(QLatin1Char('\n')));
+            },
+            Qt::QueuedConnection);
+
+    thread->start();
+}
+
+void MainWindow::onSearchTextChanged(const QString &text)
+{
+    TraceSpan span("proxy", "filter: name");
+    OperationScope scope("MainWindow::onSearchTextChanged");
+    m_proxy->setFilterFixedString(text);
+    span.arg("rows", m_proxy->rowCount());
+}
+
+
+
+
+void MainWindow::startQuery(const QString &program, const QStringList &arguments,
+                            const std::function<void(int, const QString &)> &done)
+{
+    const QByteArray traceName = (program + QLatin1Char(' ') + arguments.join(QLatin1Char(' '))).toUtf8();
+    const qint64 startNs = Trace::nowNs();
+    auto *proc = new QProcess(this);
+    proc->setProcessChannelMode(QProcess::MergedChannels);
+    auto reported = std::make_shared<bool>(false);
+    auto finish = [proc, done, reported, startNs, traceName](int exitCode, const QString &output) {
+        if (*reported)
+            return;
+        *reported = true;
+        proc->deleteLater();
+        Trace::complete("process", traceName, startNs, Trace::nowNs(),
+                        {{QStringLiteral("exitCode"), exitCode}});
+        done(exitCode, output);
+    };
 
-    if (!proc.waitForFinished(-1)) {
-        exitCode = -1;
-        return tr("Command failed to finish.");
+    // A hung rpm (a stale rpmdb lock) must not hold the answer forever
+    auto *timeout = new QTimer(proc);
+    timeout->setSingleShot(true);
+    connect(timeout, &QTimer::timeout, this, [this, proc, finish, program]() {
+        finish(-1, tr("%1 did not finish within %2 s.").arg(program).arg(QueryTimeoutMs / 1000));
+        proc->kill();
+    });
+    connect(proc, &QProcess::finished, this,
+            [this, proc, finish, program](int exitCode, QProcess::ExitStatus status) {
+                if (status != QProcess::NormalExit)
+                    finish(-1, tr("%1 crashed while running.").arg(program));
+                else
+                    finish(exitCode, QString::fromLocal8Bit(proc->readAll()));
+            });
+    connect(proc, &QProcess::errorOccurred, this,
+            [this, finish, program](QProcess::ProcessError error) {
+                if (error == QProcess::FailedToStart)
+                    finish(-1, tr("Failed to start %1").arg(program));
+            });
+    timeout->start(QueryTimeoutMs);
+    proc->start(program, arguments);
+}
+
+void MainWindow::startPrivilegedCommand(const QString &op, const QStringList &packages,
+                                        const std::function<void(int, const QString &)> &done)
+{
+    const qint64 startNs = Trace::nowNs();
+    const QByteArray traceName =
+        QStringLiteral("dnf %1 %2").arg(op, packages.join(QLatin1Char(' '))).trimmed().toUtf8();
+    auto reported = std::make_shared<bool>(false);
+    auto finish = [done, reported, startNs, traceName](int exitCode, const QString &output) {
+        if (*reported)
+            return;
+        *reported = true;
+        Trace::complete("process", traceName, startNs, Trace::nowNs(),
+                        {{QStringLiteral("exitCode"), exitCode}});
+        done(exitCode, output);
+    };
+
+    if (!m_isRunningAsRoot && m_helper && m_helper->isAlive()) {
+        const int id = m_helper->send(op, packages);
+        // Owns the connections for this one request
+        auto *context = new QObject(this);
+        auto output = std::make_shared<QByteArray>();
+        auto complete = [context, output, finish](int exitCode, const QString &extra) {
+            context->deleteLater();
+            finish(exitCode, QString::fromUtf8(*output) + extra);
+        };
+        connect(m_helper, &HelperClient::output, context,
+                [id, output](int replyId, const QByteArray &data) {
+                    if (replyId == id)
+                        *output += data;
+                });
+        connect(m_helper, &HelperClient::finished, context, [id, complete](int replyId, int code) {
+            if (replyId == id)
+                complete(code, QString());
+        });
+        connect(m_helper, &HelperClient::failed, context,
+                [id, complete](int replyId, const QString &message) {
+                    if (replyId == id || replyId == 0)
+                        complete(-1, message);
+                });
+        connect(m_helper, &HelperClient::healthChanged, context, [this, complete](bool alive) {
+            if (!alive)
+                complete(-1, tr("The privileged helper exited."));
+        });
+        return;
     }
 
-    if (proc.exitStatus() != QProcess::NormalExit) {
-        exitCode = -1;
-        return tr("%1 crashed while running.").arg(effectiveProgram);
+    // No helper: plain dnf as root, otherwise sudo on the validated timestamp
+    QString program = QStringLiteral("dnf");
+    QStringList arguments = QStringList{op, QStringLiteral("-y")} + packages;
+    if (!m_isRunningAsRoot) {
+        arguments.prepend(program);
+        arguments.prepend(QStringLiteral("-n"));
+        program = QStringLiteral("sudo");
     }
 
-    exitCode = proc.exitCode();
-    const QString output = QString::fromLocal8Bit(proc.readAll());
-    if (requireAdmin && !m_isRunningAsRoot && exitCode != 0) {
-        const bool authExpired = output.contains(QStringLiteral("password"), Qt::CaseInsensitive)
-                                 || output.contains(QStringLiteral("authentication"),
-                                                    Qt::CaseInsensitive);
-        if (authExpired) {
-            m_adminSessionActive = false;
-            updateAccessBanner();
-        }
+    auto run = [this, program, arguments, finish]() {
+        auto *proc = new QProcess(this);
+        proc->setProcessChannelMode(QProcess::MergedChannels);
+        connect(proc, &QProcess::finished, this,
+                [proc, finish](int exitCode, QProcess::ExitStatus status) {
+                    const QString output = QString::fromLocal8Bit(proc->readAll());
+                    proc->deleteLater();
+                    finish(status == QProcess::NormalExit ? exitCode : -1, output);
+                });
+        connect(proc, &QProcess::errorOccurred, this,
+                [this, proc, finish, program](QProcess::ProcessError error) {
+                    if (error != QProcess::FailedToStart)
+                        return;
+                    proc->deleteLater();
+                    finish(-1, tr("Failed to start %1").arg(program));
+                });
+        proc->start(program, arguments);
+    };
+    if (m_isRunningAsRoot) {
+        run();
+        return;
     }
-    return output;
+
+    // dnf's exit status cannot tell an expired timestamp from a failed
+    // transaction; "sudo -n -v" fails for exactly that reason and no other.
+    auto *check = new QProcess(this);
+    check->setProcessChannelMode(QProcess::MergedChannels);
+    connect(check, &QProcess::finished, this,
+            [this, check, run, finish](int exitCode, QProcess::ExitStatus status) {
+                const QString output = QString::fromLocal8Bit(check->readAll()).trimmed();
+                check->deleteLater();
+                if (status == QProcess::NormalExit && exitCode == 0) {
+                    run();
+                    return;
+                }
+                RingLog::write(RingLog::Warning, "sudo: timestamp expired: %1", output);
+                m_sudoValidated = false;
+                m_adminSessionActive = false;
+                updateAccessBanner();
+                finish(-1, tr("Administrative access has expired. Request it again.\n%1")
+                               .arg(output));
+            });
+    connect(check, &QProcess::errorOccurred, this,
+            [this, check, finish](QProcess::ProcessError error) {
+                if (error != QProcess::FailedToStart)
+                    return;
+                check->deleteLater();
+                finish(-1, tr("Failed to start sudo"));
+            });
+    check->start(QStringLiteral("sudo"), {QStringLiteral("-n"), QStringLiteral("-v")});
 }
 
 bool MainWindow::isAdminActive() const
@@ -727,7 +1163,8 @@ void MainWindow::updateAccessBanner()
                                  ? QStringLiteral(":/src/icons/lock-open.png")
                                  : QStringLiteral(":/src/icons/lock-closed.png");
 
-    if (m_accessIcon) {
+    // Decoding and scaling the pixmap waits until the window has painted once
+    if (m_accessIcon && m_startupFinished) {
         QPixmap pix(iconPath);
         m_accessIcon->setPixmap(
             pix.scaled(24, 24, Qt::KeepAspectRatio, Qt::SmoothTransformation));
@@ -736,6 +1173,9 @@ void MainWindow::updateAccessBanner()
     if (m_accessLabel) {
         if (m_isRunningAsRoot) {
             m_accessLabel->setText(tr("Administrative access active (running as root)."));
+        } else if (m_helper && m_helper->isAlive()) {
+            m_accessLabel->setText(
+                tr("Administrative access active. Commands run in the privileged helper."));
         } else if (admin) {
             m_accessLabel->setText(
                 tr("Administrative access active. Commands will run with sudo."));
@@ -786,6 +1226,36 @@ bool MainWindow::ensureAdminAccess()
     if (!ok || password.trimmed().isEmpty())
         return false;
 
+    // Preferred: one privileged helper for the whole session. Without it
+    // installed, fall back to validating a sudo timestamp for "sudo -n".
+    const QString helperProgram = HelperClient::defaultProgram();
+    if (!helperProgram.isEmpty()) {
+        if (!m_helper) {
+            m_helper = new HelperClient(this);
+            connect(m_helper, &HelperClient::healthChanged, this, [this](bool alive) {
+                if (alive || m_isRunningAsRoot)
+                    return;
+                m_adminSessionActive = false;
+                updateAccessBanner();
+            });
+        }
+        QByteArray secret = password.toUtf8();
+        password.fill(QChar(' '));
+        QString error;
+        const bool started = m_helper->start(helperProgram, secret, &error);
+        secret.fill('\0');
+        if (!started) {
+            QMessageBox::warning(this, tr("Access denied"),
+                                 tr("Could not start the privileged helper.\n%1").arg(error));
+            return false;
+        }
+        m_adminSessionActive = true;
+        updateAccessBanner();
+        return true;
+    }
+
+    TraceSpan span("process", "sudo -v");
+    OperationScope scope("sudo -v");
     QProcess proc;
     proc.setProcessChannelMode(QProcess::MergedChannels);
     proc.start(QStringLiteral("sudo"),
@@ -818,6 +1288,7 @@ bool MainWindow::ensureAdminAccess()
     }
 
     m_adminSessionActive = true;
+    m_sudoValidated = true;
     updateAccessBanner();
     return true;
 }
@@ -830,6 +1301,11 @@ void MainWindow::dropAdminAccess()
         return;
     }
 
+    if (m_helper)
+        m_helper->stop();
+
+    TraceSpan span("process", "sudo -K");
+    OperationScope scope("sudo -K");
     QProcess proc;
     proc.setProcessChannelMode(QProcess::MergedChannels);
     proc.start(QStringLiteral("sudo"), {QStringLiteral("-K")});
@@ -837,6 +1313,7 @@ void MainWindow::dropAdminAccess()
         proc.kill();
     }
     m_adminSessionActive = false;
+    m_sudoValidated = false;
     updateAccessBanner();
 }
 
@@ -851,6 +1328,7 @@ void MainWindow::onAccessToggleRequested()
 
 void MainWindow::showTextDialog(const QString &title, const QString &text) const
 {
+    OperationScope scope(QStringLiteral("showTextDialog: %1").arg(title));
     QDialog dlg(const_cast<MainWindow*>(this));
     dlg.setWindowTitle(title);
     dlg.resize(800, 600);
@@ -872,6 +1350,7 @@ void MainWindow::showTextDialog(const QString &title, const QString &text) const
 void MainWindow::showPackageInfoTable(const QString &pkgName,
                                       const InfoRows &fields) const
 {
+    OperationScope scope(QStringLiteral("showPackageInfoTable: %1").arg(pkgName));
     QDialog dlg(const_cast<MainWindow*>(this));
     dlg.setWindowTitle(tr("Details for %1").arg(pkgName));
 
@@ -1111,8 +1590,28 @@ void MainWindow::onNameCheckUpdates()
     const PackageInfo pkg = packageFromSourceIndex(m_lastContextSourceIndex);
     if (pkg.name.isEmpty())
         return;
-    QMessageBox::information(this, tr("Check updates placeholder"),
-                             tr("Would check updates for %1.").arg(pkg.name));
+
+    const UpdateSet &updates = m_model->updates();
+    if (!updates.fetchedAt().isValid()) {
+        resolveUpdatesFromCache();
+        QMessageBox::information(this, tr("Check for updates"),
+                                 tr("No update data yet. A background check has been started; "
+                                    "the \"Update available\" column fills in when it completes."));
+        return;
+    }
+
+    const QString when = updates.fetchedAt().toString(QStringLiteral("yyyy-MM-dd HH:mm"));
+    const UpdateEntry *update = updates.find(pkg.name, pkg.arch);
+    if (update) {
+        QMessageBox::information(this, tr("Update available"),
+                                 tr("%1.%2 %3 can be updated to %4 from %5.\n(as of %6)")
+                                     .arg(pkg.name, pkg.arch, pkg.version,
+                                          update->evr, update->repo, when));
+    } else {
+        QMessageBox::information(this, tr("Up to date"),
+                                 tr("%1.%2 %3 has no pending update.\n(as of %4)")
+                                     .arg(pkg.name, pkg.arch, pkg.version, when));
+    }
 }
 
 void MainWindow::onConvertSizeToKB()
@@ -1127,21 +1626,22 @@ void MainWindow::onConvertSizeToMB()
 
 PackageInfo MainWindow::packageFromSourceIndex(const QModelIndex &sourceIndex) const
 {
-    if (!sourceIndex.isValid())
+    if (!sourceIndex.isValid() || sourceIndex.model() != currentModel())
         return {};
-    return m_model->packageAt(sourceIndex.row());
+    return currentModel()->packageAt(sourceIndex.row());
 }
 
 void MainWindow::startColumnConversion(SizeUnit unit)
 {
-    const int rows = m_model->rowCount();
+    PackageTableModel *model = currentModel();
+    const int rows = model->rowCount();
     if (rows <= 0)
         return;
 
     QVector<qint64> bytes;
     bytes.reserve(rows);
     for (int i = 0; i < rows; ++i) {
-        const PackageInfo pkg = m_model->packageAt(i);
+        const PackageInfo pkg = model->packageAt(i);
         bytes.push_back(pkg.sizeBytes);
     }
 
@@ -1157,10 +1657,10 @@ void MainWindow::startColumnConversion(SizeUnit unit)
     });
 
     connect(worker, &SizeConversionWorker::conversionDone, this,
-            [this, thread](const QStringList &results) {
-                const int count = qMin(results.size(), m_model->rowCount());
+            [model, thread](const QStringList &results) {
+                const int count = qMin(results.size(), model->rowCount());
                 for (int i = 0; i < count; ++i) {
-                    m_model->updateSizeDisplay(i, results.at(i));
+                    model->updateSizeDisplay(i, results.at(i));
                 }
                 thread->quit();
             },
@@ -1169,6 +1669,19 @@ void MainWindow::startColumnConversion(SizeUnit unit)
     thread->start();
 }
 
+QVector<PackageInfo> MainWindow::selectedPackages() const
+{
+    QVector<PackageInfo> pkgs;
+    const QModelIndexList rows = m_tableView->selectionModel()->selectedRows();
+    pkgs.reserve(rows.size());
+    for (const QModelIndex &proxyIndex : rows) {
+        const QModelIndex sourceIndex = m_proxy->mapToSource(proxyIndex);
+        if (sourceIndex.isValid())
+            pkgs.append(currentModel()->packageAt(sourceIndex.row()));
+    }
+    return pkgs;
+}
+
 PackageInfo MainWindow::currentSelectedPackage() const
 {
     QModelIndex proxyIndex = m_tableView->currentIndex();
@@ -1179,100 +1692,638 @@ PackageInfo MainWindow::currentSelectedPackage() const
     if (!sourceIndex.isValid())
         return {};
 
-    return m_model->packageAt(sourceIndex.row());
+    return currentModel()->packageAt(sourceIndex.row());
 }
 
 // === Slots for actions ===
 
 void MainWindow::onDnfCheckUpdate()
 {
-    int exitCode = 0;
-    QString output = runCommand("dnf", {"check-update"}, exitCode, /*requireAdmin*/ true);
+    startUpdateCheck(/*showWhenReady*/ true);
+}
+
+void MainWindow::startUpdateCheck(bool showWhenReady)
+{
+    m_showUpdatesWhenReady = m_showUpdatesWhenReady || showWhenReady;
+    if (m_updateCheckRunning)
+        return; // the running check will deliver the result
+    m_updateCheckRunning = true;
+    m_updateCheckError.clear();
+    updateCheckStatusLabel();
+
+    // The helper refreshes the system cache as root; its output is merged,
+    // which the parser copes with (dnf's chatter never has three columns).
+    // It runs one command at a time, so a batch in flight keeps it for itself.
+    if (!m_isRunningAsRoot && m_helper && m_helper->isAlive() && !m_opQueue->isBusy()) {
+        m_helperCheckRunning = true;
+        startPrivilegedCommand(QStringLiteral("check-update"), {},
+                               [this](int exitCode, const QString &output) {
+                                   m_helperCheckRunning = false;
+                                   finishUpdateCheck(exitCode, output, output);
+                                   if (m_deferredBatch.id != 0)
+                                       onQueueBatchStarted(std::exchange(m_deferredBatch, {}));
+                               });
+        return;
+    }
 
-    QString title = tr("dnf check-update (exit %1)").arg(exitCode);
-    showTextDialog(title, output);
+    // Otherwise dnf runs as this user, or on a sudo timestamp validated by
+    // ensureAdminAccess(); a background check never prompts.
+    QString program = QStringLiteral("dnf");
+    QStringList args{QStringLiteral("check-update")};
+    if (!m_isRunningAsRoot && m_sudoValidated) {
+        args.prepend(program);
+        args.prepend(QStringLiteral("-n"));
+        program = QStringLiteral("sudo");
+    }
+
+    const qint64 startNs = Trace::isEnabled() ? Trace::nowNs() : 0;
+    auto *proc = new QProcess(this);
+    proc->setProcessChannelMode(QProcess::SeparateChannels);
+    connect(proc, &QProcess::finished, this,
+            [this, proc, startNs](int exitCode, QProcess::ExitStatus status) {
+                proc->deleteLater();
+                const QByteArray raw = proc->readAllStandardOutput();
+                if (Trace::isEnabled()) {
+                    // Asynchronous process: recorded once it has exited
+                    Trace::complete("process", QByteArrayLiteral("dnf check-update"), startNs,
+                                    Trace::nowNs(),
+                                    {{QStringLiteral("exitCode"), exitCode},
+                                     {QStringLiteral("stdoutBytes"), raw.size()}});
+                }
+                finishUpdateCheck(status == QProcess::NormalExit ? exitCode : -1,
+                                  QString::fromLocal8Bit(raw),
+                                  QString::fromLocal8Bit(proc->readAllStandardError()));
+            });
+    connect(proc, &QProcess::errorOccurred, this, [this, proc](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart)
+            return;
+        proc->deleteLater();
+        finishUpdateCheck(-1, QString(), tr("Failed to start dnf check-update."));
+    });
+    proc->start(program, args);
+}
+
+void MainWindow::resolveUpdatesFromCache()
+{
+    if (m_updatesResolving || m_updateCheckRunning)
+        return; // the running check will deliver the result
+    m_updatesResolving = true;
+    const QDateTime started = QDateTime::currentDateTime();
+
+    auto updates = std::make_shared<UpdateSet>();
+    auto *worker = new UpdateResolveWorker(m_model->packages(), updates);
+    auto *thread = new QThread(this);
+    worker->moveToThread(thread);
+
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    connect(thread, &QThread::started, worker, &UpdateResolveWorker::resolve);
+
+    connect(worker, &UpdateResolveWorker::resolved, this,
+            [this, thread, updates, started](bool ok, const QStringList &errors) {
+                thread->quit();
+                m_updatesResolving = false;
+                if (!ok) {
+                    // Nothing cached yet: dnf downloads the metadata as part of the check
+                    startUpdateCheck(false);
+                    return;
+                }
+                // A check-update that finished meanwhile saw fresher metadata
+                const QDateTime fetched = m_model->updates().fetchedAt();
+                if (fetched.isValid() && fetched > started)
+                    return;
+
+                updates->setFetchedAt(QDateTime::currentDateTime());
+                m_model->setUpdates(*updates);
+                updateCheckStatusLabel();
+                if (!errors.isEmpty())
+                    m_updateStatusLabel->setToolTip(errors.join(QLatin1Char('\n')));
+            },
+            Qt::QueuedConnection);
+
+    thread->start();
+}
+
+void MainWindow::finishUpdateCheck(int exitCode, const QString &output,
+                                   const QString &errorOutput)
+{
+    if (!m_updateCheckRunning)
+        return;
+    m_updateCheckRunning = false;
+
+    if (exitCode == 0 || exitCode == DnfCheckUpdateHasUpdates) {
+        UpdateSet updates = UpdateSet::parseCheckUpdateOutput(output);
+        updates.setFetchedAt(QDateTime::currentDateTime());
+        m_model->setUpdates(updates);
+        m_updateCheckError.clear();
+    } else {
+        m_updateCheckError =
+            tr("dnf check-update exited with %1.\n%2").arg(exitCode).arg(errorOutput.trimmed());
+    }
+
+    updateCheckStatusLabel();
+    // check-update refreshes the metadata cache, updateinfo included
+    loadAdvisories();
+
+    if (m_showUpdatesWhenReady) {
+        m_showUpdatesWhenReady = false;
+        showUpdateSummary();
+    }
+}
+
+void MainWindow::updateCheckStatusLabel()
+{
+    if (!m_updateStatusLabel)
+        return;
+
+    const UpdateSet &updates = m_model->updates();
+    QString text;
+    if (updates.fetchedAt().isValid()) {
+        text = tr("Updates: %1 (checked %2)")
+                   .arg(m_model->updateCount())
+                   .arg(updates.fetchedAt().toString(QStringLiteral("HH:mm")));
+    } else {
+        text = tr("Updates: unknown");
+    }
+    if (m_updateCheckRunning)
+        text += tr(" - checking...");
+
+    m_updateStatusLabel->setText(text);
+    m_updateStatusLabel->setToolTip(m_updateCheckError);
+}
+
+void MainWindow::showUpdateSummary()
+{
+    if (!m_updateCheckError.isEmpty()) {
+        QMessageBox::warning(this, tr("dnf check-update failed"), m_updateCheckError);
+        return;
+    }
+
+    QStringList lines;
+    const int rows = m_model->rowCount();
+    for (int row = 0; row < rows; ++row) {
+        const UpdateEntry *update = m_model->updateAt(row);
+        if (!update)
+            continue;
+        const PackageInfo pkg = m_model->packageAt(row);
+        lines << QStringLiteral("%1.%2\t%3 -> %4\t%5")
+                     .arg(pkg.name, pkg.arch, pkg.version, update->evr, update->repo);
+    }
+    lines.sort(Qt::CaseInsensitive);
+
+    const QString title = tr("dnf check-update: %n update(s)", nullptr, lines.size());
+    showTextDialog(title, lines.isEmpty() ? tr("All installed packages are up to date.")
+                                          : lines.join(QLatin1Char('\n')));
 }
 
 void MainWindow::onInstallPackage()
 {
+    // Pre-fill with the selected rows of the available view that are not installed yet
+    QStringList selected;
+    if (currentModel() == m_availableModel) {
+        for (const PackageInfo &pkg : selectedPackages()) {
+            if (!pkg.installed)
+                selected << PackageTableModel::nameArchKey(pkg);
+        }
+        selected.removeDuplicates();
+    }
+
     bool ok = false;
-    QString pkgName = QInputDialog::getText(this, tr("Install package"),
-                                            tr("Package name to install:"),
-                                            QLineEdit::Normal,
-                                            QString(), &ok);
-    if (!ok || pkgName.trimmed().isEmpty())
+    const QString text = QInputDialog::getMultiLineText(
+        this, tr("Install packages"),
+        tr("Packages to install (one per line or separated by spaces):"),
+        selected.join(QLatin1Char('\n')), &ok);
+    const QStringList names = splitPackageList(text);
+    if (!ok || names.isEmpty())
+        return;
+    if (!confirmInstall(names))
+        return;
+    if (!isAdminActive() && !ensureAdminAccess())
         return;
 
-    int exitCode = 0;
-    QString output = runCommand("dnf", {"install", "-y", pkgName.trimmed()}, exitCode,
-                                /*requireAdmin*/ true);
-
-    QString title = tr("dnf install %1 (exit %2)")
-                        .arg(pkgName.trimmed())
-                        .arg(exitCode);
-    showTextDialog(title, output);
-    if (exitCode == 0)
-        refreshPackages();
+    // One transaction for the whole request; the queue may merge it with its neighbours
+    m_opQueue->enqueue(OperationQueue::Install, names);
+    m_queueDock->show();
+    statusBar()->showMessage(tr("Queued install of %n package(s).", nullptr, names.size()),
+                             StatusMessageMs);
 }
 
 void MainWindow::onRemovePackage()
 {
+    // Pre-fill with the selected rows that are installed
+    QStringList selected;
+    const bool availableView = currentModel() == m_availableModel;
+    for (const PackageInfo &pkg : selectedPackages()) {
+        if (!availableView || pkg.installed)
+            selected << PackageTableModel::nameArchKey(pkg);
+    }
+    selected.removeDuplicates();
+
     bool ok = false;
-    QString pkgName = QInputDialog::getText(this, tr("Remove package"),
-                                            tr("Package name to remove:"),
-                                            QLineEdit::Normal,
-                                            QString(), &ok);
-    if (!ok || pkgName.trimmed().isEmpty())
+    const QString text = QInputDialog::getMultiLineText(
+        this, tr("Remove packages"),
+        tr("Packages to remove (one per line or separated by spaces):"),
+        selected.join(QLatin1Char('\n')), &ok);
+    const QStringList names = splitPackageList(text);
+    if (!ok || names.isEmpty())
         return;
 
-    int exitCode = 0;
-    QString output = runCommand("dnf", {"remove", "-y", pkgName.trimmed()}, exitCode,
-                                /*requireAdmin*/ true);
+    if (m_dependencyGraphLoading || m_dependencyGraphStale || m_removalAnalyzer.isEmpty()) {
+        // The confirmation follows once the graph is in; a newer request replaces this one
+        m_pendingRemoval = names;
+        loadDependencyGraph();
+        return;
+    }
+    queueRemoval(names);
+}
+
+void MainWindow::loadDependencyGraph()
+{
+    if (m_dependencyGraphLoading)
+        return;
+    m_dependencyGraphLoading = true;
+    // Cleared up front: a refresh landing while rpm runs marks it stale again
+    m_dependencyGraphStale = false;
+    statusBar()->showMessage(tr("Analyzing installed dependencies..."));
+
+    auto *worker = new DependencyGraphWorker;
+    auto *thread = new QThread(this);
+    worker->moveToThread(thread);
+
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    connect(thread, &QThread::started, worker, &DependencyGraphWorker::load);
+
+    connect(worker, &DependencyGraphWorker::loaded, this,
+            [this, thread](const RemovalImpactAnalyzer &analyzer, const QString &error) {
+                thread->quit();
+                m_dependencyGraphLoading = false;
+                statusBar()->clearMessage();
+                if (error.isEmpty())
+                    m_removalAnalyzer = analyzer;
+                else
+                    m_dependencyGraphStale = true;
+
+                const QStringList names = std::exchange(m_pendingRemoval, {});
+                if (!names.isEmpty())
+                    queueRemoval(names, error);
+            },
+            Qt::QueuedConnection);
 
-    QString title = tr("dnf remove %1 (exit %2)")
-                        .arg(pkgName.trimmed())
-                        .arg(exitCode);
-    showTextDialog(title, output);
-    if (exitCode == 0)
-        refreshPackages();
+    thread->start();
 }
 
-void MainWindow::handleWhatProvidesPaths(const QStringList &paths, const QString &sourceLabel)
+void MainWindow::queueRemoval(const QStringList &names, const QString &graphError)
 {
-    QStringList results;
+    QSet<QString> removedKeys;
+    if (!confirmRemoval(names, graphError, &removedKeys))
+        return;
+    if (!isAdminActive() && !ensureAdminAccess())
+        return;
 
-    for (const QString &path : paths) {
-        const QString trimmed = path.trimmed();
-        if (trimmed.isEmpty())
-            continue;
+    const int id = m_opQueue->enqueue(OperationQueue::Remove, names);
+    m_removalKeys.insert(id, removedKeys);
+    m_queueDock->show();
+    statusBar()->showMessage(tr("Queued removal of %n package(s).", nullptr, names.size()),
+                             StatusMessageMs);
+}
+
+void MainWindow::onQueueBatchStarted(const OperationQueue::Batch &batch)
+{
+    // Access may have been dropped while the item was waiting
+    if (!isAdminActive() && !ensureAdminAccess()) {
+        m_opQueue->finishBatch(batch.id, -1,
+                               tr("Administrative access was not granted. Command skipped."));
+        return;
+    }
 
-        QFileInfo info(trimmed);
-        if (!info.exists()) {
-            results << tr("%1\nNot found on disk.").arg(trimmed);
+    // The helper is busy with an update check, which starts the batch when done
+    if (m_helperCheckRunning) {
+        m_deferredBatch = batch;
+        return;
+    }
+
+    // onQueueBatchFinished() refreshes after our own transaction
+    if (m_rpmdbWatcher)
+        m_rpmdbWatcher->pause();
+    const int batchId = batch.id;
+    startPrivilegedCommand(OperationQueue::verb(batch.kind), batch.packages,
+                           [this, batchId](int exitCode, const QString &output) {
+                               m_opQueue->finishBatch(batchId, exitCode, output);
+                           });
+}
+
+void MainWindow::onQueueBatchFinished(const OperationQueue::Batch &batch, int exitCode,
+                                      const QString &output)
+{
+    QSet<QString> removedKeys;
+    for (int itemId : batch.itemIds)
+        removedKeys.unite(m_removalKeys.take(itemId));
+    const bool rpmdbMoved = m_rpmdbWatcher && m_rpmdbWatcher->resume();
+
+    const QString title = tr("dnf %1 %2 (exit %3)")
+                              .arg(OperationQueue::verb(batch.kind),
+                                   batch.packages.join(QLatin1Char(' ')))
+                              .arg(exitCode);
+    RingLog::write(exitCode != 0 ? RingLog::Warning : RingLog::Info, "queue: batch %1 exited with %2: %3",
+                   batch.id, exitCode, title);
+    if (exitCode != 0) {
+        showTextDialog(title, output);
+        if (rpmdbMoved) // a transaction can fail half-way through
+            refreshPackages();
+        return;
+    }
+    // Successful output stays available from the queue panel
+    statusBar()->showMessage(title, StatusMessageMs);
+
+    // One full query covers the requested names and whatever dnf pulled in or
+    // cleaned up; syncPackages() only touches the rows that changed.
+    m_dependencyGraphStale = true;
+    if (batch.kind != OperationQueue::Install) {
+        // Drop the rows the impact analysis predicted right away
+        m_model->removePackages(removedKeys);
+        if (m_availableLoaded)
+            m_availableModel->markInstalled(m_model->nevraKeys());
+    }
+    refreshPackages();
+}
+
+void MainWindow::buildQueueDock()
+{
+    m_opQueue = new OperationQueue(this);
+    connect(m_opQueue, &OperationQueue::batchStarted, this, &MainWindow::onQueueBatchStarted);
+    connect(m_opQueue, &OperationQueue::batchFinished, this, &MainWindow::onQueueBatchFinished);
+
+    m_queueDock = new QDockWidget(tr("Transactions"), this);
+    m_queueDock->setObjectName(QStringLiteral("operationQueueDock"));
+    auto *panel = new QWidget(m_queueDock);
+    auto *layout = new QVBoxLayout(panel);
+    layout->setContentsMargins(4, 4, 4, 4);
+
+    m_queueView = new QTableView(panel);
+    m_queueView->setObjectName(QStringLiteral("operationQueueView"));
+    m_queueView->setModel(m_opQueue);
+    m_queueView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_queueView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_queueView->verticalHeader()->hide();
+    m_queueView->horizontalHeader()->setStretchLastSection(true);
+    m_queueView->setToolTip(tr("Double-click a finished item to see the dnf output."));
+    layout->addWidget(m_queueView);
+
+    auto *buttons = new QHBoxLayout();
+    auto *cancelButton = new QPushButton(tr("Cancel selected"), panel);
+    auto *clearButton = new QPushButton(tr("Clear finished"), panel);
+    buttons->addWidget(cancelButton);
+    buttons->addWidget(clearButton);
+    buttons->addStretch();
+    layout->addLayout(buttons);
+
+    connect(cancelButton, &QPushButton::clicked, this, [this]() {
+        for (const QModelIndex &index : m_queueView->selectionModel()->selectedRows()) {
+            const int itemId = m_opQueue->itemAt(index.row()).id;
+            if (m_opQueue->cancel(itemId))
+                m_removalKeys.remove(itemId);
+        }
+    });
+    connect(clearButton, &QPushButton::clicked, m_opQueue, &OperationQueue::clearFinished);
+    connect(m_queueView, &QTableView::doubleClicked, this, [this](const QModelIndex &index) {
+        const OperationQueue::Item &item = m_opQueue->itemAt(index.row());
+        const QString output = m_opQueue->outputFor(item.id);
+        if (output.isEmpty())
+            return;
+        showTextDialog(tr("dnf %1 %2 (exit %3)")
+                           .arg(OperationQueue::verb(item.kind),
+                                item.packages.join(QLatin1Char(' ')))
+                           .arg(item.exitCode),
+                       output);
+    });
+
+    m_queueDock->setWidget(panel);
+    addDockWidget(Qt::BottomDockWidgetArea, m_queueDock);
+    m_queueDock->hide(); // shown with the first queued transaction
+}
+
+void MainWindow::buildLogDock()
+{
+    m_logDock = new QDockWidget(tr("Log"), this);
+    m_logDock->setObjectName(QStringLiteral("logDock"));
+    m_logDock->setWidget(new LogPanel(m_logDock));
+    addDockWidget(Qt::BottomDockWidgetArea, m_logDock);
+    m_logDock->hide();
+
+    m_logDock->toggleViewAction()->setToolTip(tr("Show the application log"));
+    auto *logButton = new QToolButton(this);
+    logButton->setDefaultAction(m_logDock->toggleViewAction());
+    logButton->setAutoRaise(true);
+    statusBar()->addPermanentWidget(logButton);
+}
+
+bool MainWindow::confirmInstall(const QStringList &names)
+{
+    // Resolve against the cached repository metadata when it is loaded; dnf has
+    // the final word, this is only the pre-flight summary.
+    QHash<QString, int> availableRows;
+    if (m_availableLoaded) {
+        availableRows.reserve(m_availableModel->rowCount() * 2);
+        for (int row = 0; row < m_availableModel->rowCount(); ++row) {
+            const PackageInfo pkg = m_availableModel->packageAt(row);
+            availableRows.insert(pkg.name, row);
+            availableRows.insert(PackageTableModel::nameArchKey(pkg), row);
+        }
+    }
+    QSet<QString> installedNames;
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        const PackageInfo pkg = m_model->packageAt(row);
+        installedNames.insert(pkg.name);
+        installedNames.insert(PackageTableModel::nameArchKey(pkg));
+    }
+
+    QStringList toInstall;
+    QStringList alreadyInstalled;
+    QStringList unknown;
+    qint64 totalBytes = 0;
+    for (const QString &name : names) {
+        if (installedNames.contains(name)) {
+            alreadyInstalled << name;
+            continue;
+        }
+        toInstall << name;
+        const auto it = availableRows.constFind(name);
+        if (it == availableRows.constEnd()) {
+            unknown << name;
             continue;
         }
+        totalBytes += qMax<qint64>(0, m_availableModel->sizeBytesAt(it.value()));
+    }
 
-        const QString absolutePath = info.absoluteFilePath();
-        int exitCode = 0;
-        QString output = runCommand("rpm", {"-qf", absolutePath}, exitCode);
-        QString formattedOutput = output.trimmed();
-        if (formattedOutput.isEmpty())
-            formattedOutput = output;
+    QString summary = tr("Installing %n package(s) in one transaction.", nullptr,
+                         toInstall.size());
+    if (m_availableLoaded) {
+        summary += QLatin1Char('\n');
+        summary += tr("Installed size (excluding dependencies): %1")
+                       .arg(formatSizeValue(totalBytes, SizeUnit::Megabytes));
+    }
+    if (!alreadyInstalled.isEmpty()) {
+        summary += QLatin1Char('\n');
+        summary += tr("%n package(s) already installed.", nullptr, alreadyInstalled.size());
+    }
+
+    QStringList details;
+    details << tr("Requested:") << toInstall;
+    if (!alreadyInstalled.isEmpty())
+        details << QString() << tr("Already installed:") << alreadyInstalled;
+    if (m_availableLoaded && !unknown.isEmpty())
+        details << QString() << tr("Not found in cached metadata:") << unknown;
+
+    QMessageBox box(QMessageBox::Question, tr("Confirm install"), summary,
+                    QMessageBox::Yes | QMessageBox::No, this);
+    box.setInformativeText(tr("Proceed with dnf install?"));
+    box.setDetailedText(details.join(QLatin1Char('\n')));
+    box.setDefaultButton(QMessageBox::Yes);
+    return box.exec() == QMessageBox::Yes;
+}
 
-        results << tr("rpm -qf %1 (exit %2)\n%3")
-                   .arg(absolutePath)
-                   .arg(exitCode)
-                   .arg(formattedOutput);
+bool MainWindow::confirmRemoval(const QStringList &names, const QString &graphError,
+                                QSet<QString> *removedKeys)
+{
+    if (!graphError.isEmpty()) {
+        // Without the graph we can still let dnf decide, but say so.
+        const auto answer = QMessageBox::question(
+            this, tr("Removal impact unavailable"),
+            tr("Could not load the installed dependency graph:\n%1\n\nRemove anyway?")
+                .arg(graphError));
+        return answer == QMessageBox::Yes;
     }
 
-    if (results.isEmpty()) {
+    const RemovalImpact impact = m_removalAnalyzer.analyze(names);
+
+    if (impact.targets.isEmpty()) {
+        QMessageBox::information(this, tr("Nothing to remove"),
+                                 tr("None of these packages are installed:\n%1")
+                                     .arg(impact.notInstalled.join(QLatin1Char('\n'))));
+        return false;
+    }
+
+    QString summary = tr("Removing %n package(s) will also remove %1 dependent package(s).",
+                         nullptr, impact.targets.size())
+                          .arg(impact.dependents.size());
+    summary += QLatin1Char('\n');
+    summary += tr("Reclaimable space: %1").arg(formatSizeValue(impact.reclaimableBytes,
+                                                               SizeUnit::Megabytes));
+    if (!impact.orphans.isEmpty()) {
+        summary += QLatin1Char('\n');
+        summary += tr("%1 dependency package(s) would be left orphaned (%2 more).")
+                       .arg(impact.orphans.size())
+                       .arg(formatSizeValue(impact.orphanBytes, SizeUnit::Megabytes));
+    }
+
+    QStringList details;
+    details << tr("Requested:") << impact.targets;
+    if (!impact.notInstalled.isEmpty())
+        details << QString() << tr("Not installed:") << impact.notInstalled;
+    if (!impact.dependents.isEmpty())
+        details << QString() << tr("Would lose their dependencies and be removed:")
+                << impact.dependents;
+    if (!impact.orphans.isEmpty())
+        details << QString() << tr("Would become orphaned (not removed by this transaction):")
+                << impact.orphans;
+    details << QString()
+            << tr("Analyzed %1 installed packages in %2 ms.")
+                   .arg(m_removalAnalyzer.packageCount())
+                   .arg(impact.elapsedUs / 1000.0, 0, 'f', 1);
+
+    QMessageBox box(QMessageBox::Warning, tr("Confirm removal"), summary,
+                    QMessageBox::Yes | QMessageBox::No, this);
+    box.setInformativeText(tr("Proceed with dnf remove?"));
+    box.setDetailedText(details.join(QLatin1Char('\n')));
+    box.setDefaultButton(QMessageBox::No);
+    if (box.exec() != QMessageBox::Yes)
+        return false;
+
+    if (removedKeys) {
+        for (const QString &label : std::as_const(impact.targets))
+            removedKeys->insert(label);
+        for (const QString &label : std::as_const(impact.dependents))
+            removedKeys->insert(label);
+    }
+    return true;
+}
+
+void MainWindow::handleDroppedPaths(const QStringList &paths, const QString &sourceLabel)
+{
+    QStringList others;
+    const QStringList packages = RpmFilesDialog::packageFiles(paths, &others);
+    if (!packages.isEmpty())
+        showPackageFiles(packages);
+    if (!others.isEmpty() || packages.isEmpty())
+        handleWhatProvidesPaths(others, sourceLabel);
+}
+
+void MainWindow::showPackageFiles(const QStringList &paths)
+{
+    if (!m_rpmFilesDialog) {
+        // Newest installed version per name.arch; install-only packages have several
+        QHash<QString, QByteArray> installedKeys;
+        for (int row = 0; row < m_model->rowCount(); ++row) {
+            const QByteArray &key = m_model->versionKeyAt(row);
+            QByteArray &newest = installedKeys[PackageTableModel::nameArchKey(m_model->packageAt(row))];
+            if (newest < key)
+                newest = key;
+        }
+        m_rpmFilesDialog = new RpmFilesDialog(installedKeys, this);
+        m_rpmFilesDialog->setAttribute(Qt::WA_DeleteOnClose);
+    }
+    m_rpmFilesDialog->addFiles(paths);
+    m_rpmFilesDialog->show();
+    m_rpmFilesDialog->raise();
+    m_rpmFilesDialog->activateWindow();
+}
+
+void MainWindow::handleWhatProvidesPaths(const QStringList &paths, const QString &sourceLabel)
+{
+    QStringList pending;
+    for (const QString &path : paths) {
+        const QString trimmed = path.trimmed();
+        if (!trimmed.isEmpty())
+            pending << trimmed;
+    }
+
+    if (pending.isEmpty()) {
         QMessageBox::information(this, tr("Nothing to query"),
                                  tr("Drop or enter at least one file or directory path."));
         return;
     }
 
-    showTextDialog(tr("What provides (%1)").arg(sourceLabel),
-                   results.join(QStringLiteral("\n\n")));
+    queryWhatProvides(pending, {}, sourceLabel);
+}
+
+void MainWindow::queryWhatProvides(QStringList pending, QStringList results, const QString &sourceLabel)
+{
+    if (pending.isEmpty()) {
+        showTextDialog(tr("What provides (%1)").arg(sourceLabel),
+                       results.join(QStringLiteral("\n\n")));
+        return;
+    }
+
+    const QFileInfo info(pending.takeFirst());
+    if (!info.exists()) {
+        results << tr("%1\nNot found on disk.").arg(info.filePath());
+        queryWhatProvides(pending, results, sourceLabel);
+        return;
+    }
+
+    const QString absolutePath = info.absoluteFilePath();
+    startQuery(QStringLiteral("rpm"), {QStringLiteral("-qf"), absolutePath},
+               [this, pending, results, sourceLabel, absolutePath](int exitCode, const QString &output) mutable {
+                   QString formattedOutput = output.trimmed();
+                   if (formattedOutput.isEmpty())
+                       formattedOutput = output;
+                   results << tr("rpm -qf %1 (exit %2)\n%3")
+                              .arg(absolutePath)
+                              .arg(exitCode)
+                              .arg(formattedOutput);
+                   queryWhatProvides(pending, results, sourceLabel);
+               });
 }
 
 void MainWindow::onShowPackageFiles()
@@ -1284,13 +2335,10 @@ void MainWindow::onShowPackageFiles()
         return;
     }
 
-    int exitCode = 0;
-    QString output = runCommand("rpm", {"-ql", pkg.name}, exitCode);
-
-    QString title = tr("Files in %1 (exit %2)")
-                        .arg(pkg.name)
-                        .arg(exitCode);
-    showTextDialog(title, output);
+    const QString name = pkg.name;
+    startQuery(QStringLiteral("rpm"), {QStringLiteral("-ql"), name}, [this, name](int exitCode, const QString &output) {
+        showTextDialog(tr("Files in %1 (exit %2)").arg(name).arg(exitCode), output);
+    });
 }
 
 void MainWindow::onShowPackageDescription()
@@ -1302,13 +2350,10 @@ void MainWindow::onShowPackageDescription()
         return;
     }
 
-    int exitCode = 0;
-    QString output = runCommand("rpm", {"-qi", pkg.name}, exitCode);
-
-    QString title = tr("Description for %1 (exit %2)")
-                        .arg(pkg.name)
-                        .arg(exitCode);
-    showTextDialog(title, output);
+    const QString name = pkg.name;
+    startQuery(QStringLiteral("rpm"), {QStringLiteral("-qi"), name}, [this, name](int exitCode, const QString &output) {
+        showTextDialog(tr("Description for %1 (exit %2)").arg(name).arg(exitCode), output);
+    });
 }
 
 void MainWindow::onWhatProvides()
@@ -1336,6 +2381,236 @@ void MainWindow::onWhatProvidesDnD()
                                 "Dropping multiple items is supported."));
 }
 
+void MainWindow::onVerifyPackages()
+{
+    if (m_viewCombo->currentIndex() != InstalledView) {
+        QMessageBox::information(this, tr("Verify files"),
+                                 tr("Switch to the installed view to verify packages."));
+        return;
+    }
+
+    QStringList specs;
+    for (const PackageInfo &pkg : selectedPackages())
+        specs << QStringLiteral("%1-%2.%3").arg(pkg.name, pkg.version, pkg.arch);
+    specs.removeDuplicates();
+
+    if (specs.isEmpty()
+        && QMessageBox::question(this, tr("Verify files"),
+                                 tr("No package is selected. Verify every installed package?\n"
+                                    "This reads every packaged file on the system."))
+               != QMessageBox::Yes)
+        return;
+
+    startVerify(specs);
+}
+
+void MainWindow::onExportSnapshot()
+{
+    if (m_model->rowCount() == 0) {
+        QMessageBox::information(this, tr("Export package snapshot"),
+                                 tr("The installed package list has not been loaded yet."));
+        return;
+    }
+
+    const QString host = QSysInfo::machineHostName();
+    const QString path = QFileDialog::getSaveFileName(
+        this, tr("Export package snapshot"),
+        QDir::home().filePath(QStringLiteral("%1.%2").arg(host, FleetSnapshot::suffix())),
+        tr("Package snapshots (*.%1)").arg(FleetSnapshot::suffix()));
+    if (path.isEmpty())
+        return;
+
+    QVector<PackageInfo> pkgs;
+    pkgs.reserve(m_model->rowCount());
+    for (int row = 0; row < m_model->rowCount(); ++row)
+        pkgs.push_back(m_model->packageAt(row));
+
+    QString error;
+    if (!FleetSnapshot::write(path, pkgs, host, QDateTime::currentMSecsSinceEpoch(), &error)) {
+        QMessageBox::warning(this, tr("Export package snapshot"),
+                             tr("Could not write %1:\n%2").arg(path, error));
+        return;
+    }
+    statusBar()->showMessage(tr("Exported %1 packages to %2").arg(pkgs.size()).arg(path),
+                             StatusMessageMs);
+}
+
+void MainWindow::onShowHistory()
+{
+    if (!m_historyDialog) {
+        m_historyDialog = new HistoryDialog(this);
+        m_historyDialog->setAttribute(Qt::WA_DeleteOnClose);
+    } else {
+        m_historyDialog->reload();
+    }
+    m_historyDialog->show();
+    m_historyDialog->raise();
+    m_historyDialog->activateWindow();
+}
+
+void MainWindow::onShowFleetView()
+{
+    if (!m_fleetDialog) {
+        m_fleetDialog = new FleetDialog(this);
+        m_fleetDialog->setAttribute(Qt::WA_DeleteOnClose);
+    }
+    m_fleetDialog->show();
+    m_fleetDialog->raise();
+    m_fleetDialog->activateWindow();
+}
+
+void MainWindow::onIndexRepository()
+{
+    if (m_repoIndexing) {
+        statusBar()->showMessage(tr("A repository is already being indexed."), StatusMessageMs);
+        return;
+    }
+    const QString directory = QFileDialog::getExistingDirectory(
+        this, tr("Index .rpm directory"), QDir::homePath());
+    if (directory.isEmpty())
+        return;
+
+    qRegisterMetaType<RepoIndexStats>();
+    m_repoIndexing = true;
+    auto indexer = std::make_shared<RepoIndexer>();
+    auto *worker = new RepoIndexWorker(directory, indexer);
+    auto *thread = new QThread(this);
+    worker->moveToThread(thread);
+
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    connect(thread, &QThread::started, worker, &RepoIndexWorker::run);
+
+    auto *poll = new QTimer(this);
+    connect(poll, &QTimer::timeout, this, [this, indexer]() {
+        statusBar()->showMessage(tr("Indexing: %1 packages read...").arg(indexer->packagesDone()));
+    });
+    poll->start(VerifyPollMs);
+
+    connect(worker, &RepoIndexWorker::finished, this,
+            [this, thread, poll, directory](const RepoIndexStats &stats, const QString &error) {
+                thread->quit();
+                poll->deleteLater();
+                m_repoIndexing = false;
+                if (!error.isEmpty()) {
+                    statusBar()->clearMessage();
+                    QMessageBox::warning(this, tr("Index .rpm directory"),
+                                         tr("Could not index %1:\n%2").arg(directory, error));
+                    return;
+                }
+                const QString summary = tr("Indexed %1 packages in %2 (%3 re-read, %4 s)")
+                                            .arg(stats.packages)
+                                            .arg(directory)
+                                            .arg(stats.parsed)
+                                            .arg(stats.elapsedMs / 1000.0, 0, 'f', 1);
+                statusBar()->showMessage(summary, StatusMessageMs);
+                if (stats.failed > 0) {
+                    QMessageBox::warning(this, tr("Index .rpm directory"),
+                                         tr("%1\n\n%n file(s) could not be read:\n", nullptr, stats.failed)
+                                                 .arg(summary)
+                                             + stats.errors.mid(0, 20).join(QLatin1Char('\n')));
+                }
+            });
+
+    thread->start();
+}
+
+void MainWindow::startVerify(const QStringList &packages)
+{
+    qRegisterMetaType<VerifyStats>();
+
+    auto *dlg = new QDialog(this);
+    dlg->setObjectName(QStringLiteral("verifyDialog"));
+    dlg->setAttribute(Qt::WA_DeleteOnClose);
+    dlg->setWindowTitle(packages.isEmpty() ? tr("Verify all installed packages")
+                        : packages.size() == 1 ? tr("Verify %1").arg(packages.first())
+                                               : tr("Verify %1 packages").arg(packages.size()));
+    dlg->resize(900, 500);
+
+    auto *layout = new QVBoxLayout(dlg);
+    auto *status = new QLabel(tr("Reading file lists from the rpm database..."), dlg);
+    layout->addWidget(status);
+
+    auto *view = new QTableView(dlg);
+    view->setObjectName(QStringLiteral("verifyResultsView"));
+    auto *model = new QStandardItemModel(view);
+    model->setHorizontalHeaderLabels({tr("Package"), tr("File"), tr("Checks"), tr("Details")});
+    view->setModel(model);
+    view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    view->setSortingEnabled(true);
+    view->verticalHeader()->hide();
+    view->horizontalHeader()->setStretchLastSection(true);
+    view->setToolTip(tr("Checks as in rpm -V: S size, M mode, 5 digest, L link target, "
+                        "T mtime, c config file"));
+    layout->addWidget(view);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, dlg);
+    QPushButton *stopButton = buttons->addButton(tr("Stop"), QDialogButtonBox::ActionRole);
+    layout->addWidget(buttons);
+
+    auto session = std::make_shared<VerifySession>();
+    auto *worker = new VerifyWorker(packages, session);
+    auto *thread = new QThread(this);
+    worker->moveToThread(thread);
+
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    connect(thread, &QThread::started, worker, &VerifyWorker::run);
+    // Not tied to the dialog: closing it early must still let the thread wind down
+    connect(worker, &VerifyWorker::finished, thread, &QThread::quit);
+
+    connect(buttons, &QDialogButtonBox::rejected, dlg, &QDialog::reject);
+    connect(stopButton, &QPushButton::clicked, dlg, [session]() { session->verifier.cancel(); });
+    connect(dlg, &QObject::destroyed, this, [session]() { session->verifier.cancel(); });
+
+    auto appendResults = [session, model]() {
+        for (const VerifyResult &result : session->take()) {
+            auto *checks = new QStandardItem(result.config ? result.flags + QStringLiteral("  c")
+                                                           : result.flags);
+            checks->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+            auto *detail = new QStandardItem(result.detail);
+            detail->setToolTip(result.detail);
+            model->appendRow({new QStandardItem(result.package), new QStandardItem(result.path),
+                              checks, detail});
+        }
+    };
+
+    auto *poll = new QTimer(dlg);
+    connect(poll, &QTimer::timeout, dlg, [session, status, model, appendResults]() {
+        appendResults();
+        const qint64 total = session->total.load();
+        if (total > 0) {
+            status->setText(tr("Checked %1 of %2 files, %3 mismatches...")
+                                .arg(session->verifier.filesChecked())
+                                .arg(total)
+                                .arg(model->rowCount()));
+        }
+    });
+    poll->start(VerifyPollMs);
+
+    connect(worker, &VerifyWorker::finished, dlg,
+            [status, stopButton, poll, view, appendResults](const VerifyStats &stats,
+                                                             const QString &error) {
+                poll->stop();
+                stopButton->setEnabled(false);
+                appendResults();
+                view->resizeColumnsToContents();
+                if (!error.isEmpty()) {
+                    status->setText(error);
+                    return;
+                }
+                const QString summary = tr("%1 files, %2 read in %3 s: %4 mismatches")
+                                            .arg(stats.files)
+                                            .arg(formatSizeValue(stats.bytesHashed, SizeUnit::Megabytes))
+                                            .arg(stats.elapsedMs / 1000.0, 0, 'f', 1)
+                                            .arg(stats.mismatches);
+                status->setText(stats.cancelled ? tr("Stopped after %1").arg(summary) : summary);
+            });
+
+    dlg->show();
+    thread->start();
+}
 
 void MainWindow::dragEnterEvent(QDragEnterEvent *event) {
     if (mimeHasLocalUrls(event->mimeData())) {
@@ -1351,14 +2626,20 @@ void MainWindow::dropEvent(QDropEvent *event) {
         return;
     }
 
-    handleWhatProvidesPaths(extractLocalPaths(event->mimeData()),
-                            tr("Drop on window"));
+    handleDroppedPaths(extractLocalPaths(event->mimeData()), tr("Drop on window"));
     event->acceptProposedAction();
 
 }
 
 bool MainWindow::eventFilter(QObject *watched, QEvent *event)
 {
+    if (!m_startupFinished && watched == m_tableView->viewport()
+        && event->type() == QEvent::Paint) {
+        StartupReport::mark("first paint");
+        // Let this paint reach the screen before the deferred work starts
+        QTimer::singleShot(0, this, &MainWindow::finishStartup);
+    }
+
     if (watched == m_dropArea) {
         switch (event->type()) {
         case QEvent::DragEnter: {
@@ -1382,8 +2663,7 @@ bool MainWindow::eventFilter(QObject *watched, QEvent *event)
         case QEvent::Drop: {
             auto *dropEvent = static_cast<QDropEvent*>(event);
             if (mimeHasLocalUrls(dropEvent->mimeData())) {
-                handleWhatProvidesPaths(extractLocalPaths(dropEvent->mimeData()),
-                                        tr("Drop zone"));
+                handleDroppedPaths(extractLocalPaths(dropEvent->mimeData()), tr("Drop zone"));
                 dropEvent->acceptProposedAction();
             } else {
                 dropEvent->ignore();
@@ -12,21 +12,36 @@
 #include <QPoint>
 #include <QVector>
 #include <QPair>
+#include <QProcess>
+#include <QHash>
+#include <QPointer>
+#include <QSet>
+
+#include <functional>
 
 class QLineEdit;
 class QTableView;
-class QSortFilterProxyModel;
 class QPushButton;
+class QCheckBox;
+class QComboBox;
+class QTimer;
 class QFrame;
 class QLabel;
 class QEvent;
+class QDockWidget;
 
+#include "operationqueue.h"
 #include "packagemodel.h"
+#include "removalimpact.h"
+#include "sizeformat.h"
 
-enum class SizeUnit {
-    Kilobytes,
-    Megabytes
-};
+class PackageFilterProxyModel;
+class HelperClient;
+class FleetDialog;
+class HistoryDialog;
+class RpmdbWatcher;
+class StallWatchdog;
+class RpmFilesDialog;
 
 class MainWindow : public QMainWindow
 {
@@ -48,8 +63,14 @@ private slots:
     void onShowPackageDescription();
     void onWhatProvides();
     void onWhatProvidesDnD();
+    void onVerifyPackages();
+    void onShowHistory();
+    void onExportSnapshot();
+    void onShowFleetView();
+    void onIndexRepository();
     void onTableContextMenu(const QPoint &pos);
     void onAccessToggleRequested();
+    void onViewModeChanged(int index);
 
     // Context menu actions
     void onNameGetMoreInfo();
@@ -58,17 +79,52 @@ private slots:
     void onConvertSizeToMB();
 
 private:
-    QVector<PackageInfo> queryInstalledPackages() const;
+    void applyInstalledPackages(const QVector<PackageInfo> &pkgs);
+    void finishStartup();
+    void buildDropArea();
+    void buildQueueDock();
+    /** RingLog panel, hidden until the status-bar Log button opens it */
+    void buildLogDock();
+    void onQueueBatchStarted(const OperationQueue::Batch &batch);
+    void onQueueBatchFinished(const OperationQueue::Batch &batch, int exitCode,
+                              const QString &output);
+    /** Non-modal results table fed by FileVerifier; empty @p packages verifies everything */
+    void startVerify(const QStringList &packages);
     void showTextDialog(const QString &title, const QString &text) const;
     void showPackageInfoTable(const QString &pkgName,
                               const QVector<QPair<QString, QString>> &fields) const;
     PackageInfo currentSelectedPackage() const;
+    QVector<PackageInfo> selectedPackages() const;
     void startColumnConversion(SizeUnit unit);
     bool ensureAdminAccess();
     void dropAdminAccess();
     void updateAccessBanner();
     bool isAdminActive() const;
+    bool confirmInstall(const QStringList &names);
+    /** @p removedKeys receives the name.arch of every row the transaction will drop */
+    bool confirmRemoval(const QStringList &names, const QString &graphError,
+                        QSet<QString> *removedKeys = nullptr);
+    /** Builds the removal graph in a worker, then confirms and queues m_pendingRemoval */
+    void loadDependencyGraph();
+    /** Confirms against the loaded graph (or @p graphError) and queues the removal */
+    void queueRemoval(const QStringList &names, const QString &graphError = {});
+    void startUpdateCheck(bool showWhenReady);
+    /** @p output is parsed on success, @p errorOutput explains a failure */
+    void finishUpdateCheck(int exitCode, const QString &output, const QString &errorOutput);
+    /** Upgrades from the cached metadata in-process; falls back to dnf when nothing is cached */
+    void resolveUpdatesFromCache();
+    void updateCheckStatusLabel();
+    void showUpdateSummary();
+    void loadAvailablePackages();
+    /** Joins the cached updateinfo advisories into the installed table */
+    void loadAdvisories();
+    PackageTableModel *currentModel() const;
+    /** Column widths from the model's longest-text samples instead of measuring every cell */
+    void resizeColumnsFromSamples();
+    /** Event-loop stall log and the status-bar worst-stall label; off with TURBORPM_STALL_MS=0 */
+    void startStallWatchdog();
 
+    QComboBox *m_viewCombo = nullptr;
     QLineEdit *m_searchEdit = nullptr;
     QTableView *m_tableView = nullptr;
     QFrame *m_accessBanner = nullptr;
@@ -76,6 +132,9 @@ private:
     QLabel *m_accessLabel = nullptr;
     QPushButton *m_accessButton = nullptr;
     QPushButton *m_btnRefresh = nullptr;
+    QCheckBox *m_updatesOnlyCheck = nullptr;
+    QComboBox *m_advisoryFilterCombo = nullptr; // items in PackageFilterProxyModel::AdvisoryFilter order
+    QLabel *m_updateStatusLabel = nullptr;
     QPushButton *m_btnCheckUpdate = nullptr;
     QPushButton *m_btnInstall = nullptr;
     QPushButton *m_btnRemove = nullptr;
@@ -83,18 +142,66 @@ private:
     QPushButton *m_btnPkgDesc = nullptr;
     QPushButton *m_btnWhatProvides = nullptr;
     QPushButton *m_btnWhatProvidesDnD  = nullptr;
+    QPushButton *m_btnVerify = nullptr;
+    QPushButton *m_btnHistory = nullptr;
+    QPushButton *m_btnFleet = nullptr;
     QFrame *m_dropArea = nullptr;
     QLabel *m_dropLabel = nullptr;
 
     PackageTableModel *m_model = nullptr;
-    QSortFilterProxyModel *m_proxy = nullptr;
+    bool m_installedLoading = false;
+    bool m_installedRefreshPending = false;
+    bool m_cacheWasFresh = false;
+    bool m_startupFinished = false;
+    PackageTableModel *m_availableModel = nullptr;
+    bool m_availableLoaded = false;
+    bool m_availableLoading = false;
+    bool m_advisoriesLoading = false;
+    PackageFilterProxyModel *m_proxy = nullptr;
+
+    QTimer *m_updateTimer = nullptr;
+    bool m_updateCheckRunning = false;
+    bool m_helperCheckRunning = false; // the update check holds the helper
+    OperationQueue::Batch m_deferredBatch; // waits for the helper; id 0 when none
+    QString m_updateCheckError;
+    bool m_showUpdatesWhenReady = false;
+    bool m_updatesResolving = false;
 
     QModelIndex m_lastContextSourceIndex;
     bool m_isRunningAsRoot = false;
     bool m_adminSessionActive = false;
+    bool m_sudoValidated = false; // ensureAdminAccess() fell back to sudo -S -v
+    HelperClient *m_helper = nullptr; // privileged helper, started on first elevation
+
+    OperationQueue *m_opQueue = nullptr;
+    QDockWidget *m_queueDock = nullptr;
+    QDockWidget *m_logDock = nullptr;
+    QTableView *m_queueView = nullptr;
+    QHash<int, QSet<QString>> m_removalKeys; // queue item id -> rows its removal drops
+    QPointer<FleetDialog> m_fleetDialog;
+    QPointer<HistoryDialog> m_historyDialog;
+    QPointer<RpmFilesDialog> m_rpmFilesDialog;
+    RpmdbWatcher *m_rpmdbWatcher = nullptr; // external rpm/dnf transactions
+    StallWatchdog *m_stallWatchdog = nullptr;
+    QLabel *m_stallLabel = nullptr; // hidden until the first stall
+    bool m_repoIndexing = false; // one RepoIndexer run at a time
+
+    RemovalImpactAnalyzer m_removalAnalyzer;
+    bool m_dependencyGraphStale = true;
+    bool m_dependencyGraphLoading = false;
+    QStringList m_pendingRemoval; // waits for the graph
 
     PackageInfo packageFromSourceIndex(const QModelIndex &sourceIndex) const;
+    /** .rpm files (and directories of them) open in the package file view, the rest go to rpm -qf */
+    void handleDroppedPaths(const QStringList &paths, const QString &sourceLabel);
     void handleWhatProvidesPaths(const QStringList &paths, const QString &sourceLabel);
-    QString runCommand(const QString &program, const QStringList &arguments, int &exitCode,
-                       bool requireAdmin = false);
+    /** rpm -qf on each of @p pending in turn, then one dialog with all @p results */
+    void queryWhatProvides(QStringList pending, QStringList results, const QString &sourceLabel);
+    void showPackageFiles(const QStringList &paths);
+    /** Runs @p program without blocking; @p done gets exit code and output, -1 after a timeout */
+    void startQuery(const QString &program, const QStringList &arguments,
+                    const std::function<void(int, const QString &)> &done);
+    /** Runs "dnf <op> -y <packages>" with admin rights without blocking; @p done gets exit code and output */
+    void startPrivilegedCommand(const QString &op, const QStringList &packages,
+                                const std::function<void(int, const QString &)> &done);
 };
@@ -0,0 +1,253 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the package transaction queue for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "operationqueue.h"
+#include "trace.h"
+
+#include <QJsonObject>
+#include <QSet>
+#include <QTimer>
+
+#include <utility>
+
+OperationQueue::OperationQueue(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+    qRegisterMetaType<OperationQueue::Batch>();
+}
+
+int OperationQueue::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_items.size();
+}
+
+int OperationQueue::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return ColumnCount;
+}
+
+QVariant OperationQueue::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_items.size())
+        return {};
+
+    const Item &item = m_items.at(index.row());
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case IdColumn:
+            return item.id;
+        case OperationColumn:
+            return verb(item.kind);
+        case PackagesColumn:
+            return item.packages.join(QLatin1Char(' '));
+        case StatusColumn:
+            switch (item.status) {
+            case Pending:
+                return tr("Pending");
+            case Running:
+                return tr("Running (batch %1)").arg(item.batchId);
+            case Succeeded:
+                return tr("Done");
+            case Failed:
+                return tr("Failed (exit %1)").arg(item.exitCode);
+            case Cancelled:
+                return tr("Cancelled");
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (role == Qt::ToolTipRole && index.column() == PackagesColumn)
+        return item.packages.join(QLatin1Char('\n'));
+
+    return {};
+}
+
+QVariant OperationQueue::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal)
+        return {};
+
+    switch (section) {
+    case IdColumn:
+        return QStringLiteral("#");
+    case OperationColumn:
+        return QStringLiteral("Operation");
+    case PackagesColumn:
+        return QStringLiteral("Packages");
+    case StatusColumn:
+        return QStringLiteral("Status");
+    default:
+        break;
+    }
+    return {};
+}
+
+QString OperationQueue::verb(Kind kind)
+{
+    return kind == Remove ? QStringLiteral("remove") : QStringLiteral("install");
+}
+
+int OperationQueue::enqueue(Kind kind, const QStringList &packages)
+{
+    Item item;
+    item.id = m_nextItemId++;
+    item.kind = kind;
+    item.packages = packages;
+
+    beginInsertRows(QModelIndex(), m_items.size(), m_items.size());
+    m_items.append(item);
+    endInsertRows();
+
+    scheduleDispatch();
+    return item.id;
+}
+
+bool OperationQueue::cancel(int itemId)
+{
+    const int row = rowOf(itemId);
+    if (row < 0 || m_items.at(row).status != Pending)
+        return false;
+    m_items[row].status = Cancelled;
+    emitRowChanged(row);
+    return true;
+}
+
+void OperationQueue::clearFinished()
+{
+    for (int row = m_items.size() - 1; row >= 0; --row) {
+        const Status status = m_items.at(row).status;
+        if (status == Pending || status == Running)
+            continue;
+        beginRemoveRows(QModelIndex(), row, row);
+        m_items.remove(row);
+        endRemoveRows();
+    }
+
+    // Outputs nobody can ask for anymore
+    QSet<int> liveBatches;
+    for (const Item &item : std::as_const(m_items))
+        liveBatches.insert(item.batchId);
+    for (auto it = m_outputs.begin(); it != m_outputs.end();) {
+        if (liveBatches.contains(it.key()))
+            ++it;
+        else
+            it = m_outputs.erase(it);
+    }
+}
+
+void OperationQueue::finishBatch(int batchId, int exitCode, const QString &output)
+{
+    if (batchId == 0 || batchId != m_running.id)
+        return;
+
+    const Batch batch = m_running;
+    m_running = Batch();
+    m_outputs.insert(batchId, output);
+
+    // dnf transactions are atomic: every coalesced item shares the outcome
+    for (int itemId : batch.itemIds) {
+        const int row = rowOf(itemId);
+        if (row < 0)
+            continue;
+        m_items[row].status = exitCode == 0 ? Succeeded : Failed;
+        m_items[row].exitCode = exitCode;
+        emitRowChanged(row);
+    }
+
+    emit batchFinished(batch, exitCode, output);
+    scheduleDispatch();
+}
+
+int OperationQueue::pendingCount() const
+{
+    int count = 0;
+    for (const Item &item : m_items) {
+        if (item.status == Pending)
+            ++count;
+    }
+    return count;
+}
+
+const OperationQueue::Item *OperationQueue::item(int itemId) const
+{
+    const int row = rowOf(itemId);
+    return row < 0 ? nullptr : &m_items.at(row);
+}
+
+QString OperationQueue::outputFor(int itemId) const
+{
+    const Item *found = item(itemId);
+    return found ? m_outputs.value(found->batchId) : QString();
+}
+
+void OperationQueue::scheduleDispatch()
+{
+    if (m_dispatchScheduled)
+        return;
+    m_dispatchScheduled = true;
+    QTimer::singleShot(0, this, &OperationQueue::dispatch);
+}
+
+void OperationQueue::dispatch()
+{
+    m_dispatchScheduled = false;
+    if (isBusy())
+        return;
+
+    int first = 0;
+    while (first < m_items.size() && m_items.at(first).status != Pending)
+        ++first;
+    if (first == m_items.size())
+        return;
+
+    Batch batch;
+    batch.id = m_nextBatchId++;
+    batch.kind = m_items.at(first).kind;
+
+    // Cancelled rows in between do not break a run; anything else pending does
+    for (int row = first; row < m_items.size(); ++row) {
+        Item &item = m_items[row];
+        if (item.status == Cancelled)
+            continue;
+        if (item.status != Pending || item.kind != batch.kind)
+            break;
+        item.status = Running;
+        item.batchId = batch.id;
+        batch.itemIds.append(item.id);
+        batch.packages += item.packages;
+        emitRowChanged(row);
+    }
+    batch.packages.removeDuplicates();
+
+    Trace::instant("queue", "OperationQueue::dispatch",
+                   {{QStringLiteral("batch"), batch.id},
+                    {QStringLiteral("items"), int(batch.itemIds.size())},
+                    {QStringLiteral("packages"), int(batch.packages.size())}});
+    m_running = batch;
+    emit batchStarted(batch);
+}
+
+int OperationQueue::rowOf(int itemId) const
+{
+    for (int row = 0; row < m_items.size(); ++row) {
+        if (m_items.at(row).id == itemId)
+            return row;
+    }
+    return -1;
+}
+
+void OperationQueue::emitRowChanged(int row)
+{
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+}
@@ -0,0 +1,112 @@
+/**
+ * @file operationqueue.h
+ * @author Nikolay Yevik
+ * @brief Queue of package transactions that coalesces adjacent compatible requests for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * Write transactions run one at a time (dnf holds the rpmdb lock anyway).
+ * When the queue becomes idle, the oldest pending item and every pending item
+ * directly behind it with the same kind become one batch. For example,
+ * install a, install b, remove c, install d runs as "install a b",
+ * "remove c", "install d". The queue only schedules: whoever handles
+ * batchStarted() runs the batch and reports back through finishBatch().
+ */
+class OperationQueue : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Kind {
+        Install = 0,
+        Remove
+    };
+
+    enum Status {
+        Pending = 0,
+        Running,
+        Succeeded,
+        Failed,
+        Cancelled
+    };
+
+    enum Column {
+        IdColumn = 0,
+        OperationColumn,
+        PackagesColumn,
+        StatusColumn,
+        ColumnCount
+    };
+
+    struct Item {
+        int id = 0; /** Stable handle returned by enqueue() */
+        Kind kind = Install; /** Which dnf verb */
+        QStringList packages; /** Specs as the user entered them */
+        Status status = Pending; /** Where the item is in its life cycle */
+        int batchId = 0; /** Batch it ran in, 0 while pending */
+        int exitCode = 0; /** dnf exit code once finished */
+    };
+
+    struct Batch {
+        int id = 0; /** Handle passed back to finishBatch() */
+        Kind kind = Install; /** Shared by every item in the batch */
+        QStringList packages; /** Union of the items' packages, in queue order */
+        QVector<int> itemIds; /** Coalesced items, oldest first */
+    };
+
+    explicit OperationQueue(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    /** Adds an item; dispatch happens from the event loop so a burst coalesces */
+    int enqueue(Kind kind, const QStringList &packages);
+    /** Only pending items can be cancelled; returns false otherwise */
+    bool cancel(int itemId);
+    /** Drops succeeded, failed and cancelled rows */
+    void clearFinished();
+
+    /** The running batch has completed; starts the next one */
+    void finishBatch(int batchId, int exitCode, const QString &output);
+
+    bool isBusy() const { return m_running.id != 0; }
+    int pendingCount() const;
+    const Item *item(int itemId) const;
+    const Item &itemAt(int row) const { return m_items.at(row); }
+    /** Output of the batch @p itemId ran in; empty until it finished */
+    QString outputFor(int itemId) const;
+
+    /** "install" / "remove", the dnf verb of @p kind */
+    static QString verb(Kind kind);
+
+signals:
+    void batchStarted(const OperationQueue::Batch &batch);
+    void batchFinished(const OperationQueue::Batch &batch, int exitCode, const QString &output);
+
+private:
+    void scheduleDispatch();
+    void dispatch();
+    int rowOf(int itemId) const;
+    void emitRowChanged(int row);
+
+    QVector<Item> m_items; // queue order, finished items stay until clearFinished()
+    QHash<int, QString> m_outputs; // batch id -> merged dnf output
+    Batch m_running; // id 0 when idle
+    int m_nextItemId = 1;
+    int m_nextBatchId = 1;
+    bool m_dispatchScheduled = false;
+};
+
+Q_DECLARE_METATYPE(OperationQueue::Batch)
@@ -0,0 +1,125 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the installed package snapshot for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "packagecache.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <utility>
+
+namespace {
+    constexpr quint32 CacheMagic {0x54525043}; // "TRPC"
+    constexpr quint32 CacheVersion {1};
+    constexpr QDataStream::Version StreamVersion {QDataStream::Qt_6_0};
+}
+
+QString PackageCache::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+           + QStringLiteral("/installed.cache");
+}
+
+QString PackageCache::rpmdbDirectory()
+{
+    // /var/lib/rpm is a symlink into /usr/lib/sysimage/rpm on newer releases; QFileInfo follows it.
+    return QStringLiteral("/var/lib/rpm");
+}
+
+QStringList PackageCache::rpmdbFiles()
+{
+    // sqlite backend (Fedora >= 33) plus its WAL, and the legacy bdb Packages file
+    return {QStringLiteral("rpmdb.sqlite"), QStringLiteral("rpmdb.sqlite-wal"),
+            QStringLiteral("Packages")};
+}
+
+QByteArray PackageCache::rpmdbStamp(const QString &directory)
+{
+    QByteArray stamp;
+    for (const QString &name : rpmdbFiles()) {
+        const QString file = directory + QLatin1Char('/') + name;
+        const QFileInfo info(file);
+        if (!info.exists())
+            continue;
+        stamp += file.toLocal8Bit();
+        stamp += ':';
+        stamp += QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+        stamp += ':';
+        stamp += QByteArray::number(info.size());
+        stamp += ';';
+    }
+    return stamp;
+}
+
+bool PackageCache::load(QVector<PackageInfo> &out, const QString &path, bool requireFresh,
+                        bool *isFresh)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(StreamVersion);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray stamp;
+    qint32 count = 0;
+    in >> magic >> version;
+    if (magic != CacheMagic || version != CacheVersion)
+        return false;
+    in >> stamp >> count;
+    if (in.status() != QDataStream::Ok || count < 0)
+        return false;
+    const bool fresh = !stamp.isEmpty() && stamp == rpmdbStamp();
+    if (requireFresh && !fresh)
+        return false;
+
+    QVector<PackageInfo> pkgs;
+    pkgs.reserve(count);
+    for (qint32 i = 0; i < count; ++i) {
+        PackageInfo pkg;
+        in >> pkg.name >> pkg.epoch >> pkg.version >> pkg.arch >> pkg.installDate
+           >> pkg.group >> pkg.size >> pkg.sizeBytes >> pkg.repo >> pkg.summary;
+        if (in.status() != QDataStream::Ok)
+            return false;
+        pkgs.append(pkg);
+    }
+
+    out = std::move(pkgs);
+    if (isFresh)
+        *isFresh = fresh;
+    return true;
+}
+
+bool PackageCache::save(const QVector<PackageInfo> &pkgs, const QByteArray &stamp, const QString &path)
+{
+    if (pkgs.isEmpty())
+        return false; // never replace a good snapshot with a failed query
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream outStream(&file);
+    outStream.setVersion(StreamVersion);
+    outStream << CacheMagic << CacheVersion << stamp << qint32(pkgs.size());
+    for (const PackageInfo &pkg : pkgs) {
+        outStream << pkg.name << pkg.epoch << pkg.version << pkg.arch << pkg.installDate
+                  << pkg.group << pkg.size << pkg.sizeBytes << pkg.repo << pkg.summary;
+    }
+    if (outStream.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
@@ -0,0 +1,45 @@
+/**
+ * @file packagecache.h
+ * @author Nikolay Yevik
+ * @brief On-disk snapshot of the installed package list for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "packagemodel.h"
+
+class PackageCache
+{
+public:
+    /** <CacheLocation>/installed.cache; depends on the application/organization name */
+    static QString defaultPath();
+
+    /** Where rpm keeps its database */
+    static QString rpmdbDirectory();
+    /** Files in rpmdbDirectory() that change with every transaction, whichever backend is in use */
+    static QStringList rpmdbFiles();
+
+    /** Identity of the rpm database (path, mtime and size of its files); empty if none found */
+    static QByteArray rpmdbStamp(const QString &directory = rpmdbDirectory());
+
+    /**
+     * Reads a snapshot written by save(). With @p requireFresh the snapshot is
+     * rejected unless its stamp still matches rpmdbStamp(); @p isFresh reports
+     * the match either way.
+     */
+    static bool load(QVector<PackageInfo> &out,
+                     const QString &path = defaultPath(),
+                     bool requireFresh = true,
+                     bool *isFresh = nullptr);
+
+    /** @p stamp must be taken before the query that produced @p pkgs */
+    static bool save(const QVector<PackageInfo> &pkgs,
+                     const QByteArray &stamp,
+                     const QString &path = defaultPath());
+};
@@ -0,0 +1,114 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the PackageFilterProxyModel for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "packagefilterproxy.h"
+#include "packagemodel.h"
+#include "trace.h"
+
+PackageFilterProxyModel::PackageFilterProxyModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+}
+
+const PackageTableModel *PackageFilterProxyModel::packageModel() const
+{
+    return qobject_cast<const PackageTableModel *>(sourceModel());
+}
+
+void PackageFilterProxyModel::setUpdatesOnly(bool enabled)
+{
+    if (m_updatesOnly == enabled)
+        return;
+    m_updatesOnly = enabled;
+    TraceSpan span("proxy", "filter: updates only");
+    invalidateRowsFilter();
+    span.arg("rows", rowCount());
+}
+
+void PackageFilterProxyModel::setAdvisoryFilter(AdvisoryFilter filter)
+{
+    if (m_advisoryFilter == filter)
+        return;
+    m_advisoryFilter = filter;
+    TraceSpan span("proxy", "filter: advisories");
+    invalidateRowsFilter();
+    span.arg("rows", rowCount());
+}
+
+void PackageFilterProxyModel::sort(int column, Qt::SortOrder order)
+{
+    TraceSpan span("proxy", "sort");
+    span.arg("column", column);
+    span.arg("rows", rowCount());
+    QSortFilterProxyModel::sort(column, order);
+}
+
+bool PackageFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (m_updatesOnly) {
+        const PackageTableModel *model = packageModel();
+        if (model && !model->updateAt(sourceRow))
+            return false;
+    }
+    if (m_advisoryFilter != AdvisoryFilter::Off) {
+        const PackageTableModel *model = packageModel();
+        if (model) {
+            const AdvisoryMatch &match = model->advisoriesAt(sourceRow);
+            switch (m_advisoryFilter) {
+            case AdvisoryFilter::Any:
+                if (match.isEmpty())
+                    return false;
+                break;
+            case AdvisoryFilter::Security:
+                if (!match.security)
+                    return false;
+                break;
+            case AdvisoryFilter::Important:
+                if (match.severity < AdvisorySeverity::Important)
+                    return false;
+                break;
+            case AdvisoryFilter::Off:
+                break;
+            }
+        }
+    }
+    return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+}
+
+bool PackageFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    const PackageTableModel *model = packageModel();
+    if (!model)
+        return QSortFilterProxyModel::lessThan(left, right);
+
+    switch (left.column()) {
+    case PackageTableModel::VersionColumn:
+        // Precomputed rpm EVR keys: one memcmp instead of re-tokenizing
+        return model->versionKeyAt(left.row()) < model->versionKeyAt(right.row());
+    case PackageTableModel::SizeColumn:
+        // Raw bytes, regardless of the current KB/MB display
+        return model->sizeBytesAt(left.row()) < model->sizeBytesAt(right.row());
+    case PackageTableModel::SeverityColumn:
+        return model->advisoriesAt(left.row()).severity < model->advisoriesAt(right.row()).severity;
+    case PackageTableModel::AdvisoriesColumn:
+        return model->advisoriesAt(left.row()).advisories.size()
+               < model->advisoriesAt(right.row()).advisories.size();
+    default:
+        break;
+    }
+
+    if (left.column() == PackageTableModel::UpdateColumn) {
+        // Rows with a pending update group together, then by offered version, then repo
+        const UpdateEntry *l = model->updateAt(left.row());
+        const UpdateEntry *r = model->updateAt(right.row());
+        if (!l || !r)
+            return !l && r;
+        if (l->evrKey != r->evrKey)
+            return l->evrKey < r->evrKey;
+        return QString::compare(l->repo, r->repo) < 0;
+    }
+    return QSortFilterProxyModel::lessThan(left, right);
+}
@@ -0,0 +1,44 @@
+/**
+ * @file packagefilterproxy.h
+ * @author Nikolay Yevik
+ * @brief Sort/filter proxy for the package table of TurboRPM Package Manager Prototype.
+ * Adds package-aware filters (e.g. "updates only") on top of the name search.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QSortFilterProxyModel>
+
+class PackageTableModel;
+
+class PackageFilterProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    explicit PackageFilterProxyModel(QObject *parent = nullptr);
+
+    void setUpdatesOnly(bool enabled);
+    bool updatesOnly() const { return m_updatesOnly; }
+
+    enum class AdvisoryFilter {
+        Off,
+        Any, /** Rows with at least one advisory */
+        Security, /** Rows with a security advisory */
+        Important /** Rows with an Important or Critical advisory */
+    };
+    void setAdvisoryFilter(AdvisoryFilter filter);
+    AdvisoryFilter advisoryFilter() const { return m_advisoryFilter; }
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+
+private:
+    const PackageTableModel *packageModel() const;
+
+    bool m_updatesOnly = false;
+    AdvisoryFilter m_advisoryFilter = AdvisoryFilter::Off;
+};
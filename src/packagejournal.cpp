@@ -0,0 +1,621 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the installed package history journal for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "packagejournal.h"
+#include "fleetsnapshot.h"
+#include "trace.h"
+#include "varint.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QObject>
+#include <QStandardPaths>
+#include <QTimeZone>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <zlib.h>
+#include <zstd.h>
+
+namespace {
+    constexpr quint32 JournalMagic {0x5452504A}; // "TRPJ"
+    constexpr quint32 JournalVersion {1};
+    constexpr QDataStream::Version StreamVersion {QDataStream::Qt_6_0};
+    constexpr qint64 FileHeaderBytes {8}; // magic + version
+    constexpr qint64 RecordHeaderBytes {21}; // type, time, raw size, stored size, crc32
+    constexpr int CompressionLevel {9};
+    constexpr quint32 MaxBodyBytes {256u * 1024 * 1024};
+    constexpr int LockTimeoutMs {5000};
+
+    constexpr quint8 CheckpointRecord {1};
+    constexpr quint8 DeltaRecord {2};
+}
+
+namespace {
+
+using Entry = PackageJournal::Entry;
+using State = PackageJournal::State;
+
+bool entryLess(const Entry &a, const Entry &b)
+{
+    return a.key != b.key ? a.key < b.key : a.evr < b.evr;
+}
+
+bool entrySame(const Entry &a, const Entry &b)
+{
+    return a.key == b.key && a.evr == b.evr && a.installTime == b.installTime;
+}
+
+void setError(QString *error, const QString &message)
+{
+    if (error)
+        *error = message;
+}
+
+/** Prefix-coded keys, length-prefixed EVRs, install times as deltas of the previous one */
+void encodeEntries(QByteArray &out, const QVector<Entry> &entries, bool withInstallTime)
+{
+    Varint::append(out, quint64(entries.size()));
+    const QByteArray *previous = nullptr;
+    qint64 previousTime = 0;
+    for (const Entry &entry : entries) {
+        qsizetype shared = 0;
+        if (previous) {
+            const qsizetype limit = std::min(previous->size(), entry.key.size());
+            while (shared < limit && previous->at(shared) == entry.key.at(shared))
+                ++shared;
+        }
+        Varint::append(out, quint64(shared));
+        Varint::append(out, quint64(entry.key.size() - shared));
+        out.append(entry.key.constData() + shared, entry.key.size() - shared);
+        Varint::append(out, quint64(entry.evr.size()));
+        out.append(entry.evr);
+        if (withInstallTime) {
+            Varint::appendSigned(out, entry.installTime - previousTime);
+            previousTime = entry.installTime;
+        }
+        previous = &entry.key;
+    }
+}
+
+bool decodeEntries(const char *&pos, const char *end, QVector<Entry> &entries, bool withInstallTime)
+{
+    quint64 count = 0;
+    if (!Varint::read(pos, end, count) || count > quint64(end - pos))
+        return false;
+    entries.clear();
+    entries.reserve(qsizetype(count));
+    QByteArray key;
+    qint64 previousTime = 0;
+    for (quint64 i = 0; i < count; ++i) {
+        quint64 shared = 0;
+        quint64 suffix = 0;
+        quint64 evrLength = 0;
+        if (!Varint::read(pos, end, shared) || !Varint::read(pos, end, suffix)
+            || shared > quint64(key.size()) || suffix > quint64(end - pos))
+            return false;
+        key.truncate(qsizetype(shared));
+        key.append(pos, qsizetype(suffix));
+        pos += suffix;
+        if (!Varint::read(pos, end, evrLength) || evrLength > quint64(end - pos))
+            return false;
+        Entry entry;
+        entry.key = key;
+        entry.evr = QByteArray(pos, qsizetype(evrLength));
+        pos += evrLength;
+        if (withInstallTime) {
+            qint64 delta = 0;
+            if (!Varint::readSigned(pos, end, delta))
+                return false;
+            previousTime += delta;
+            entry.installTime = previousTime;
+        }
+        entries.append(std::move(entry));
+    }
+    return true;
+}
+
+/** Removed entries only carry key and EVR; they are matched on those */
+State applyDelta(const State &state, const QVector<Entry> &removed, const QVector<Entry> &added)
+{
+    State kept;
+    kept.reserve(state.size());
+    qsizetype r = 0;
+    for (const Entry &entry : state) {
+        while (r < removed.size() && entryLess(removed.at(r), entry))
+            ++r;
+        if (r < removed.size() && !entryLess(entry, removed.at(r))) {
+            ++r;
+            continue;
+        }
+        kept.append(entry);
+    }
+
+    State merged;
+    merged.reserve(kept.size() + added.size());
+    std::merge(kept.cbegin(), kept.cend(), added.cbegin(), added.cend(), std::back_inserter(merged),
+               entryLess);
+    return merged;
+}
+
+/** Pairs removed/added entries of the same name.arch into changes */
+PackageJournal::Diff pairChanges(const QVector<Entry> &removed, const QVector<Entry> &added)
+{
+    PackageJournal::Diff diff;
+    qsizetype r = 0;
+    qsizetype a = 0;
+    while (r < removed.size() || a < added.size()) {
+        if (a == added.size() || (r < removed.size() && removed.at(r).key < added.at(a).key)) {
+            diff.removed.append(removed.at(r++));
+        } else if (r == removed.size() || added.at(a).key < removed.at(r).key) {
+            diff.added.append(added.at(a++));
+        } else {
+            diff.changed.append({removed.at(r++), added.at(a++)});
+        }
+    }
+    return diff;
+}
+
+QByteArray compress(const QByteArray &raw)
+{
+    QByteArray stored(qsizetype(ZSTD_compressBound(size_t(raw.size()))), Qt::Uninitialized);
+    const size_t written = ZSTD_compress(stored.data(), size_t(stored.size()), raw.constData(),
+                                         size_t(raw.size()), CompressionLevel);
+    if (ZSTD_isError(written))
+        return {};
+    stored.truncate(qsizetype(written));
+    return stored;
+}
+
+QByteArray recordHeader(quint8 type, qint64 timestampMs, quint32 rawSize, const QByteArray &stored)
+{
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream.setVersion(StreamVersion);
+    stream << type << timestampMs << rawSize << quint32(stored.size())
+           << quint32(crc32(0L, reinterpret_cast<const Bytef *>(stored.constData()),
+                            uInt(stored.size())));
+    return header;
+}
+
+struct ParsedRecord {
+    quint8 type = 0;
+    qint64 timestampMs = 0;
+    QByteArray body; // decompressed
+    qint64 bytes = 0; // header + stored body
+};
+
+/** Parses the record at the start of @p data; false if it is torn or corrupt */
+bool parseRecord(const char *data, qint64 available, ParsedRecord &out)
+{
+    if (available < RecordHeaderBytes)
+        return false;
+    QDataStream stream(QByteArray::fromRawData(data, qsizetype(RecordHeaderBytes)));
+    stream.setVersion(StreamVersion);
+    quint32 rawSize = 0;
+    quint32 storedSize = 0;
+    quint32 crc = 0;
+    stream >> out.type >> out.timestampMs >> rawSize >> storedSize >> crc;
+    if (stream.status() != QDataStream::Ok || rawSize > MaxBodyBytes
+        || qint64(storedSize) > available - RecordHeaderBytes
+        || (out.type != CheckpointRecord && out.type != DeltaRecord))
+        return false;
+
+    const char *stored = data + RecordHeaderBytes;
+    if (crc32(0L, reinterpret_cast<const Bytef *>(stored), uInt(storedSize)) != crc)
+        return false;
+
+    out.body = QByteArray(qsizetype(rawSize), Qt::Uninitialized);
+    const size_t inflated = ZSTD_decompress(out.body.data(), size_t(out.body.size()), stored,
+                                            size_t(storedSize));
+    if (ZSTD_isError(inflated) || inflated != rawSize)
+        return false;
+    out.bytes = RecordHeaderBytes + storedSize;
+    return true;
+}
+
+bool decodeCheckpoint(const QByteArray &body, State &state)
+{
+    const char *pos = body.constData();
+    return decodeEntries(pos, pos + body.size(), state, true);
+}
+
+bool decodeDelta(const QByteArray &body, QVector<Entry> &removed, QVector<Entry> &added)
+{
+    const char *pos = body.constData();
+    const char *const end = pos + body.size();
+    return decodeEntries(pos, end, removed, false) && decodeEntries(pos, end, added, true);
+}
+
+} // namespace
+
+QString PackageJournal::defaultPath()
+{
+    // Not the cache location: this is history and cannot be rebuilt
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+           + QStringLiteral("/history.journal");
+}
+
+PackageJournal::State PackageJournal::stateFor(const QVector<PackageInfo> &pkgs)
+{
+    State state;
+    state.reserve(pkgs.size());
+    for (const PackageInfo &pkg : pkgs)
+        state.append({FleetSnapshot::keyFor(pkg), FleetSnapshot::evrFor(pkg),
+                      parseInstallTime(pkg.installDate)});
+    std::sort(state.begin(), state.end(), entryLess);
+    state.erase(std::unique(state.begin(), state.end(),
+                            [](const Entry &a, const Entry &b) { return !entryLess(a, b); }),
+                state.end());
+    return state;
+}
+
+qint64 PackageJournal::parseInstallTime(const QString &installDate)
+{
+    const QString text = installDate.trimmed();
+    bool isNumber = false;
+    const qint64 seconds = text.toLongLong(&isNumber);
+    if (isNumber)
+        return seconds;
+
+    // dnf repoquery prints %{installtime} in UTC without a zone
+    QDateTime parsed = QDateTime::fromString(text, QStringLiteral("yyyy-MM-dd HH:mm"));
+    if (!parsed.isValid())
+        parsed = QDateTime::fromString(text, Qt::ISODate);
+    if (!parsed.isValid())
+        return 0;
+    return QDateTime(parsed.date(), parsed.time(), QTimeZone::utc()).toSecsSinceEpoch();
+}
+
+PackageJournal::Diff PackageJournal::diff(const State &from, const State &to)
+{
+    QVector<Entry> removed;
+    QVector<Entry> added;
+    qsizetype i = 0;
+    qsizetype j = 0;
+    while (i < from.size() || j < to.size()) {
+        if (j == to.size() || (i < from.size() && entryLess(from.at(i), to.at(j)))) {
+            removed.append(from.at(i++));
+        } else if (i == from.size() || entryLess(to.at(j), from.at(i))) {
+            added.append(to.at(j++));
+        } else {
+            if (from.at(i).installTime != to.at(j).installTime) { // reinstalled
+                removed.append(from.at(i));
+                added.append(to.at(j));
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return pairChanges(removed, added);
+}
+
+PackageJournal::PackageJournal(const QString &path)
+    : m_path(path)
+{
+}
+
+bool PackageJournal::open(QString *error)
+{
+    TraceSpan span("journal", "PackageJournal::open");
+    m_records.clear();
+    m_recordBytes.clear();
+    m_installIndex.clear();
+    m_latest.clear();
+    m_validSize = 0;
+
+    QFile file(m_path);
+    if (!file.exists())
+        return true;
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(error, file.errorString());
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    if (data.size() < FileHeaderBytes)
+        return true; // torn while creating; the next append starts over
+
+    QDataStream header(data);
+    header.setVersion(StreamVersion);
+    quint32 magic = 0;
+    quint32 version = 0;
+    header >> magic >> version;
+    if (magic != JournalMagic || version != JournalVersion) {
+        setError(error, QObject::tr("%1 is not a TurboRPM history journal.").arg(m_path));
+        return false;
+    }
+
+    qint64 pos = FileHeaderBytes;
+    State state;
+    while (pos < data.size()) {
+        ParsedRecord parsed;
+        if (!parseRecord(data.constData() + pos, data.size() - pos, parsed))
+            break;
+
+        Record record;
+        record.timestampMs = parsed.timestampMs;
+        record.checkpoint = parsed.type == CheckpointRecord;
+        record.offset = pos;
+
+        QVector<Entry> removed;
+        QVector<Entry> added;
+        if (record.checkpoint) {
+            State next;
+            if (!decodeCheckpoint(parsed.body, next))
+                break;
+            const Diff changes = diff(state, next);
+            record.added = int(changes.added.size());
+            record.removed = int(changes.removed.size());
+            record.changed = int(changes.changed.size());
+            if (m_records.isEmpty())
+                m_installIndex += next;
+            state = std::move(next);
+        } else {
+            if (m_records.isEmpty() || !decodeDelta(parsed.body, removed, added))
+                break;
+            const Diff changes = pairChanges(removed, added);
+            record.added = int(changes.added.size());
+            record.removed = int(changes.removed.size());
+            record.changed = int(changes.changed.size());
+            m_installIndex += added;
+            state = applyDelta(state, removed, added);
+        }
+        record.packages = int(state.size());
+
+        m_records.append(record);
+        m_recordBytes.append(parsed.bytes);
+        pos += parsed.bytes;
+    }
+
+    m_latest = std::move(state);
+    m_validSize = pos;
+
+    m_installIndex.erase(std::remove_if(m_installIndex.begin(), m_installIndex.end(),
+                                        [](const Entry &e) { return e.installTime <= 0; }),
+                         m_installIndex.end());
+    std::stable_sort(m_installIndex.begin(), m_installIndex.end(), [](const Entry &a, const Entry &b) {
+        return a.installTime != b.installTime ? a.installTime < b.installTime : entryLess(a, b);
+    });
+    m_installIndex.erase(std::unique(m_installIndex.begin(), m_installIndex.end(), entrySame),
+                         m_installIndex.end());
+
+    span.arg("records", int(m_records.size()));
+    span.arg("bytes", m_validSize);
+    return true;
+}
+
+bool PackageJournal::append(const State &state, qint64 timestampMs, bool *appended, QString *error)
+{
+    TraceSpan span("journal", "PackageJournal::append");
+    if (appended)
+        *appended = false;
+
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    QLockFile lock(m_path + QStringLiteral(".lock"));
+    if (!lock.tryLock(LockTimeoutMs)) {
+        setError(error, QObject::tr("The history journal is locked by another process."));
+        return false;
+    }
+    // Another instance may have appended since open()
+    if (QFileInfo(m_path).size() != m_validSize && !open(error))
+        return false;
+
+    const Diff changes = diff(m_latest, state);
+    if (changes.isEmpty())
+        return true;
+
+    // Deltas hold only what changed: removed by key/EVR, added in full
+    QVector<Entry> removed;
+    QVector<Entry> added;
+    for (const Entry &entry : changes.removed)
+        removed.append(entry);
+    for (const Entry &entry : changes.added)
+        added.append(entry);
+    for (const auto &change : changes.changed) {
+        removed.append(change.first);
+        added.append(change.second);
+    }
+    std::sort(removed.begin(), removed.end(), entryLess);
+    std::sort(added.begin(), added.end(), entryLess);
+
+    QByteArray deltaBody;
+    encodeEntries(deltaBody, removed, false);
+    encodeEntries(deltaBody, added, true);
+    const QByteArray delta = compress(deltaBody);
+
+    // Checkpoint once replaying the deltas would cost more than reading one
+    int lastCheckpoint = -1;
+    for (int i = int(m_records.size()) - 1; i >= 0 && lastCheckpoint < 0; --i) {
+        if (m_records.at(i).checkpoint)
+            lastCheckpoint = i;
+    }
+    qint64 deltaBytes = RecordHeaderBytes + delta.size();
+    for (int i = lastCheckpoint + 1; i < m_records.size(); ++i)
+        deltaBytes += m_recordBytes.at(i);
+    const bool checkpoint = lastCheckpoint < 0
+                            || int(m_records.size()) - lastCheckpoint > m_maxDeltas
+                            || deltaBytes > m_recordBytes.at(lastCheckpoint);
+
+    bool ok = false;
+    if (checkpoint) {
+        QByteArray body;
+        encodeEntries(body, state, true);
+        ok = writeRecord(CheckpointRecord, timestampMs, quint32(body.size()), compress(body), error);
+    } else {
+        ok = writeRecord(DeltaRecord, timestampMs, quint32(deltaBody.size()), delta, error);
+    }
+    if (!ok)
+        return false;
+
+    Record &record = m_records.last();
+    record.checkpoint = checkpoint;
+    record.packages = int(state.size());
+    record.added = int(changes.added.size());
+    record.removed = int(changes.removed.size());
+    record.changed = int(changes.changed.size());
+
+    for (const Entry &entry : std::as_const(added)) {
+        if (entry.installTime <= 0)
+            continue;
+        const auto at = std::upper_bound(m_installIndex.begin(), m_installIndex.end(), entry,
+                                         [](const Entry &a, const Entry &b) {
+                                             return a.installTime != b.installTime
+                                                        ? a.installTime < b.installTime
+                                                        : entryLess(a, b);
+                                         });
+        m_installIndex.insert(at, entry);
+    }
+    m_latest = state;
+
+    span.arg("checkpoint", checkpoint);
+    if (appended)
+        *appended = true;
+    return true;
+}
+
+bool PackageJournal::writeRecord(quint8 type, qint64 timestampMs, quint32 rawSize,
+                                 const QByteArray &stored, QString *error)
+{
+    if (stored.isEmpty()) {
+        setError(error, QObject::tr("Could not compress the journal record."));
+        return false;
+    }
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        setError(error, file.errorString());
+        return false;
+    }
+
+    QByteArray out;
+    if (m_validSize < FileHeaderBytes) {
+        QDataStream stream(&out, QIODevice::WriteOnly);
+        stream.setVersion(StreamVersion);
+        stream << JournalMagic << JournalVersion;
+        m_validSize = 0;
+    }
+    const qint64 offset = std::max(m_validSize, FileHeaderBytes);
+    out += recordHeader(type, timestampMs, rawSize, stored);
+    out += stored;
+
+    // Drops a torn tail left by a crash, then appends after the last good record
+    if (!file.resize(m_validSize) || !file.seek(m_validSize) || file.write(out) != out.size()
+        || !file.flush()) {
+        setError(error, file.errorString());
+        return false;
+    }
+
+    Record record;
+    record.timestampMs = timestampMs;
+    record.offset = offset;
+    m_records.append(record);
+    m_recordBytes.append(RecordHeaderBytes + stored.size());
+    m_validSize = offset + RecordHeaderBytes + stored.size();
+    return true;
+}
+
+bool PackageJournal::readRecord(int record, quint8 &type, QByteArray &body, QString *error) const
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(m_records.at(record).offset)) {
+        setError(error, file.errorString());
+        return false;
+    }
+    const QByteArray data = file.read(m_recordBytes.at(record));
+    ParsedRecord parsed;
+    if (!parseRecord(data.constData(), data.size(), parsed)) {
+        setError(error, QObject::tr("History journal record %1 is corrupt.").arg(record));
+        return false;
+    }
+    type = parsed.type;
+    body = std::move(parsed.body);
+    return true;
+}
+
+bool PackageJournal::stateAt(int record, State &out, QString *error) const
+{
+    TraceSpan span("journal", "PackageJournal::stateAt");
+    if (record < 0 || record >= m_records.size()) {
+        setError(error, QObject::tr("No such history record."));
+        return false;
+    }
+    if (record == m_records.size() - 1) {
+        out = m_latest;
+        return true;
+    }
+
+    int checkpoint = record;
+    while (checkpoint > 0 && !m_records.at(checkpoint).checkpoint)
+        --checkpoint;
+    span.arg("replayed", record - checkpoint);
+
+    quint8 type = 0;
+    QByteArray body;
+    State state;
+    if (!readRecord(checkpoint, type, body, error))
+        return false;
+    if (type != CheckpointRecord || !decodeCheckpoint(body, state)) {
+        setError(error, QObject::tr("History journal record %1 is corrupt.").arg(checkpoint));
+        return false;
+    }
+    for (int i = checkpoint + 1; i <= record; ++i) {
+        QVector<Entry> removed;
+        QVector<Entry> added;
+        if (!readRecord(i, type, body, error))
+            return false;
+        if (type != DeltaRecord || !decodeDelta(body, removed, added)) {
+            setError(error, QObject::tr("History journal record %1 is corrupt.").arg(i));
+            return false;
+        }
+        state = applyDelta(state, removed, added);
+    }
+    out = std::move(state);
+    return true;
+}
+
+bool PackageJournal::changesAt(int record, Diff &out, QString *error) const
+{
+    if (record < 0 || record >= m_records.size()) {
+        setError(error, QObject::tr("No such history record."));
+        return false;
+    }
+
+    if (!m_records.at(record).checkpoint) {
+        quint8 type = 0;
+        QByteArray body;
+        QVector<Entry> removed;
+        QVector<Entry> added;
+        if (!readRecord(record, type, body, error))
+            return false;
+        if (!decodeDelta(body, removed, added)) {
+            setError(error, QObject::tr("History journal record %1 is corrupt.").arg(record));
+            return false;
+        }
+        out = pairChanges(removed, added);
+        return true;
+    }
+
+    State before;
+    State after;
+    if ((record > 0 && !stateAt(record - 1, before, error)) || !stateAt(record, after, error))
+        return false;
+    out = diff(before, after);
+    return true;
+}
+
+QVector<PackageJournal::Entry> PackageJournal::installedBetween(qint64 fromSecs, qint64 toSecs) const
+{
+    const auto byTime = [](const Entry &e, qint64 t) { return e.installTime < t; };
+    const auto first = std::lower_bound(m_installIndex.cbegin(), m_installIndex.cend(), fromSecs, byTime);
+    const auto last = std::lower_bound(first, m_installIndex.cend(), toSecs, byTime);
+    return QVector<Entry>(first, last);
+}
@@ -0,0 +1,103 @@
+/**
+ * @file packagejournal.h
+ * @author Nikolay Yevik
+ * @brief Append-only history of the installed package set for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include "packagemodel.h"
+
+/**
+ * One record per refresh that changed something: the NEVRAs added and
+ * removed since the previous record, and now and then a full checkpoint so
+ * any state is a checkpoint plus a short replay. A checkpoint is written once
+ * the deltas since the last one outweigh it, which keeps replay cost and
+ * file size both bounded by about twice the deltas themselves.
+ *
+ * File: a QDataStream header, then records of [type, time, sizes, crc32]
+ * followed by a zstd frame. A torn record at the end (crash mid-append) is
+ * ignored on open and overwritten by the next append.
+ */
+class PackageJournal
+{
+public:
+    struct Entry {
+        QByteArray key; /** name.arch */
+        QByteArray evr; /** [epoch:]version-release */
+        qint64 installTime = 0; /** Seconds since the epoch (UTC), 0 if unknown */
+    };
+    /** Sorted by key, then evr; installonly packages have one entry per version */
+    using State = QVector<Entry>;
+
+    struct Record {
+        qint64 timestampMs = 0; /** When the refresh ran */
+        bool checkpoint = false;
+        qint64 offset = 0; /** Of the record header in the file */
+        int packages = 0; /** Size of the state after this record */
+        int added = 0;
+        int removed = 0;
+        int changed = 0; /** Same name.arch, other EVR; not in added/removed */
+    };
+
+    struct Diff {
+        QVector<Entry> added;
+        QVector<Entry> removed;
+        QVector<QPair<Entry, Entry>> changed; /** (before, after) */
+        bool isEmpty() const { return added.isEmpty() && removed.isEmpty() && changed.isEmpty(); }
+    };
+
+    /** <AppLocalDataLocation>/history.journal */
+    static QString defaultPath();
+
+    static State stateFor(const QVector<PackageInfo> &pkgs);
+    /** PackageInfo::installDate ("yyyy-MM-dd HH:mm" UTC, ISO or seconds) -> seconds; 0 if unparsable */
+    static qint64 parseInstallTime(const QString &installDate);
+    static Diff diff(const State &from, const State &to);
+
+    explicit PackageJournal(const QString &path = defaultPath());
+
+    /** Reads the record index and the latest state; a missing file is an empty journal */
+    bool open(QString *error = nullptr);
+
+    /**
+     * Records @p state as of @p timestampMs. Nothing is written when it equals
+     * the latest state; @p appended tells which happened.
+     */
+    bool append(const State &state, qint64 timestampMs, bool *appended = nullptr,
+                QString *error = nullptr);
+
+    const QVector<Record> &records() const { return m_records; }
+    const State &latest() const { return m_latest; }
+    qint64 fileSize() const { return m_validSize; }
+
+    /** State right after records()[@p record]: nearest checkpoint, then its deltas */
+    bool stateAt(int record, State &out, QString *error = nullptr) const;
+    /** What records()[@p record] changed relative to the record before it */
+    bool changesAt(int record, Diff &out, QString *error = nullptr) const;
+
+    /** Every version ever recorded with an install time in [fromSecs, toSecs), oldest first */
+    QVector<Entry> installedBetween(qint64 fromSecs, qint64 toSecs) const;
+
+    /** Upper bound on deltas between checkpoints, whatever their size */
+    void setMaxDeltasPerCheckpoint(int deltas) { m_maxDeltas = deltas; }
+
+private:
+    bool readRecord(int record, quint8 &type, QByteArray &body, QString *error) const;
+    /** @p stored is the zstd frame of a @p rawSize byte body */
+    bool writeRecord(quint8 type, qint64 timestampMs, quint32 rawSize, const QByteArray &stored,
+                     QString *error);
+
+    QString m_path;
+    QVector<Record> m_records;
+    QVector<qint64> m_recordBytes; // parallel to m_records, on-disk size
+    QVector<Entry> m_installIndex; // sorted by installTime; from the first checkpoint and every delta
+    State m_latest;
+    qint64 m_validSize = 0; // end of the last intact record
+    int m_maxDeltas = 512;
+};
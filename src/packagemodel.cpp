@@ -5,6 +5,34 @@
  * @date 2025-12-6
  */
 #include "packagemodel.h"
+#include "rpmevr.h"
+#include "trace.h"
+
+#include <QHash>
+#include <QStringList>
+
+#include <algorithm>
+
+namespace {
+    /** Keeps @p widest the longest texts seen, longest first */
+    void offerWidest(QStringList &widest, const QString &text)
+    {
+        if (text.isEmpty())
+            return;
+        if (widest.size() == PackageTableModel::WidestSampleSize
+            && widest.constLast().size() >= text.size())
+            return;
+        if (widest.contains(text))
+            return;
+        const auto pos = std::upper_bound(widest.begin(), widest.end(), text,
+                                          [](const QString &l, const QString &r) {
+                                              return l.size() > r.size();
+                                          });
+        widest.insert(pos, text);
+        if (widest.size() > PackageTableModel::WidestSampleSize)
+            widest.removeLast();
+    }
+}
 
 PackageTableModel::PackageTableModel(QObject *parent)
     : QAbstractTableModel(parent)
@@ -37,32 +65,102 @@ QVariant PackageTableModel::data(const QModelIndex &index, int role) const
 
     const PackageInfo &pkg = m_pkgs[row];
 
-    if (role == Qt::DisplayRole) {
-        switch (col) {
-        case NameColumn:
-            return pkg.name;
-        case VersionColumn:
-            return pkg.version;
-        case ArchColumn:
-            return pkg.arch;
-        case InstallDateColumn:
-            return pkg.installDate;
-        case GroupColumn:
-            return pkg.group;
-        case SizeColumn:
-            return pkg.size;
-        case RepoColumn:
-            return pkg.repo;
-        case SummaryColumn:
-            return pkg.summary;
-        default:
-            break;
+    if (role == Qt::DisplayRole)
+        return displayText(row, col);
+
+    if (role == Qt::CheckStateRole && col == NameColumn && pkg.installed)
+        return Qt::Checked;
+
+    if (role == Qt::ToolTipRole && col == UpdateColumn) {
+        if (const UpdateEntry *update = m_rowUpdates.value(row, nullptr))
+            return tr("%1 from %2").arg(update->evr, update->repo);
+    }
+
+    if (role == Qt::ToolTipRole && (col == AdvisoriesColumn || col == SeverityColumn)) {
+        const AdvisoryMatch &match = advisoriesAt(row);
+        QStringList lines;
+        for (int index : match.advisories) {
+            const Advisory &advisory = m_advisories.advisory(index);
+            const QString severity = AdvisoryIndex::severityName(advisory.severity);
+            lines.append(severity.isEmpty()
+                             ? tr("%1 (%2): %3").arg(advisory.id, advisory.type, advisory.title)
+                             : tr("%1 (%2, %3): %4").arg(advisory.id, advisory.type, severity, advisory.title));
         }
+        if (!lines.isEmpty())
+            return lines.join(QLatin1Char('\n'));
     }
 
     return {};
 }
 
+QString PackageTableModel::displayText(int row, int column) const
+{
+    const PackageInfo &pkg = m_pkgs.at(row);
+    switch (column) {
+    case NameColumn:
+        return pkg.name;
+    case VersionColumn:
+        return pkg.version;
+    case UpdateColumn: {
+        const UpdateEntry *update = m_rowUpdates.value(row, nullptr);
+        return update ? update->evr : QString();
+    }
+    case AdvisoriesColumn: {
+        const AdvisoryMatch &match = advisoriesAt(row);
+        if (match.isEmpty())
+            return QString();
+        const QString first = m_advisories.advisory(match.advisories.first()).id;
+        return match.advisories.size() == 1 ? first
+                                            : tr("%1 (+%2)").arg(first).arg(match.advisories.size() - 1);
+    }
+    case SeverityColumn:
+        return AdvisoryIndex::severityName(advisoriesAt(row).severity);
+    case ArchColumn:
+        return pkg.arch;
+    case InstallDateColumn:
+        return pkg.installDate;
+    case GroupColumn:
+        return pkg.group;
+    case SizeColumn:
+        return pkg.size;
+    case RepoColumn:
+        return pkg.repo;
+    case SummaryColumn:
+        return pkg.summary;
+    default:
+        break;
+    }
+    return QString();
+}
+
+QStringList PackageTableModel::widestTexts(int column) const
+{
+    if (column < 0 || column >= ColumnCount)
+        return {};
+    if (m_widest.size() != ColumnCount)
+        m_widest.resize(ColumnCount);
+
+    const quint32 bit = 1u << column;
+    if (m_widestStale & bit) {
+        TraceSpan span("model", "PackageTableModel::widestTexts");
+        span.arg("column", column);
+        QStringList &widest = m_widest[column];
+        widest.clear();
+        for (int row = 0; row < m_pkgs.size(); ++row)
+            offerWidest(widest, displayText(row, column));
+        m_widestStale &= ~bit;
+    }
+    return m_widest.at(column);
+}
+
+void PackageTableModel::noteWidest(int row)
+{
+    for (int column = 0; column < m_widest.size(); ++column) {
+        if (!(m_widestStale & (1u << column)))
+            offerWidest(m_widest[column], displayText(row, column));
+    }
+}
+
 QVariant PackageTableModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     if (role != Qt::DisplayRole)
@@ -74,6 +172,12 @@ QVariant PackageTableModel::headerData(int section, Qt::Orientation orientation,
             return QStringLiteral("Name");
         case VersionColumn:
             return QStringLiteral("Version");
+        case UpdateColumn:
+            return QStringLiteral("Update available");
+        case AdvisoriesColumn:
+            return QStringLiteral("Advisories");
+        case SeverityColumn:
+            return QStringLiteral("Severity");
         case ArchColumn:
             return QStringLiteral("Arch");
         case InstallDateColumn:
@@ -96,8 +200,14 @@ QVariant PackageTableModel::headerData(int section, Qt::Orientation orientation,
 
 void PackageTableModel::setPackages(const QVector<PackageInfo> &pkgs)
 {
+    TraceSpan span("model", "PackageTableModel::setPackages");
+    span.arg("rows", pkgs.size());
     beginResetModel();
     m_pkgs = pkgs;
+    rebuildVersionKeys();
+    rebuildUpdateIndex();
+    rebuildAdvisoryIndex();
+    markWidestStale(~0u);
     endResetModel();
 }
 
@@ -114,6 +224,270 @@ void PackageTableModel::updateSizeDisplay(int row, const QString &displayValue)
         return;
 
     m_pkgs[row].size = displayValue;
+    markWidestStale(1u << SizeColumn); // KB -> MB shortens the column
     const QModelIndex idx = index(row, SizeColumn);
     emit dataChanged(idx, idx, {Qt::DisplayRole});
 }
+
+void PackageTableModel::setUpdates(const UpdateSet &updates)
+{
+    TraceSpan span("model", "PackageTableModel::setUpdates");
+    m_updates = updates;
+    rebuildUpdateIndex();
+    markWidestStale(1u << UpdateColumn);
+    if (!m_pkgs.isEmpty()) {
+        emit dataChanged(index(0, UpdateColumn), index(m_pkgs.size() - 1, UpdateColumn),
+                         {Qt::DisplayRole, Qt::ToolTipRole});
+    }
+}
+
+const UpdateEntry *PackageTableModel::updateAt(int row) const
+{
+    return m_rowUpdates.value(row, nullptr);
+}
+
+void PackageTableModel::rebuildUpdateIndex()
+{
+    m_rowUpdates.fill(nullptr, m_pkgs.size());
+    m_updateRows = 0;
+    if (m_updates.isEmpty())
+        return;
+
+    for (int row = 0; row < m_pkgs.size(); ++row) {
+        const UpdateEntry *update = findUpdate(row);
+        m_rowUpdates[row] = update;
+        if (update)
+            ++m_updateRows;
+    }
+}
+
+void PackageTableModel::setAdvisories(const AdvisoryIndex &advisories)
+{
+    TraceSpan span("model", "PackageTableModel::setAdvisories");
+    span.arg("advisories", advisories.size());
+    m_advisories = advisories;
+    rebuildAdvisoryIndex();
+    markWidestStale((1u << AdvisoriesColumn) | (1u << SeverityColumn));
+    span.arg("affected", m_affectedRows);
+    if (!m_pkgs.isEmpty()) {
+        emit dataChanged(index(0, AdvisoriesColumn), index(m_pkgs.size() - 1, SeverityColumn),
+                         {Qt::DisplayRole, Qt::ToolTipRole});
+    }
+}
+
+const AdvisoryMatch &PackageTableModel::advisoriesAt(int row) const
+{
+    static const AdvisoryMatch none;
+    if (row < 0 || row >= m_rowAdvisories.size())
+        return none;
+    return m_rowAdvisories.at(row);
+}
+
+void PackageTableModel::rebuildAdvisoryIndex()
+{
+    m_rowAdvisories.fill(AdvisoryMatch(), m_pkgs.size());
+    m_affectedRows = 0;
+    if (m_advisories.isEmpty())
+        return;
+    for (int row = 0; row < m_pkgs.size(); ++row)
+        matchAdvisories(row);
+}
+
+void PackageTableModel::matchAdvisories(int row)
+{
+    const bool wasAffected = !m_rowAdvisories.at(row).isEmpty();
+    const PackageInfo &pkg = m_pkgs.at(row);
+    m_rowAdvisories[row] = m_advisories.isEmpty()
+        ? AdvisoryMatch()
+        : m_advisories.match(pkg.name, pkg.arch, m_versionKeys.at(row));
+    m_affectedRows += int(!m_rowAdvisories.at(row).isEmpty()) - int(wasAffected);
+}
+
+const UpdateEntry *PackageTableModel::findUpdate(int row) const
+{
+    const PackageInfo &pkg = m_pkgs.at(row);
+    const UpdateEntry *update = m_updates.find(pkg.name, pkg.arch);
+    // Only a strictly newer EVR counts; check-update may list downgrades
+    // after a repo rollback.
+    if (update && !(m_versionKeys.at(row) < update->evrKey))
+        return nullptr;
+    return update;
+}
+
+QString PackageTableModel::nevraKey(const PackageInfo &pkg)
+{
+    return pkg.name + QLatin1Char('|') + pkg.version + QLatin1Char('|') + pkg.arch;
+}
+
+QSet<QString> PackageTableModel::nevraKeys() const
+{
+    QSet<QString> keys;
+    keys.reserve(m_pkgs.size());
+    for (const PackageInfo &pkg : m_pkgs)
+        keys.insert(nevraKey(pkg));
+    return keys;
+}
+
+void PackageTableModel::markInstalled(const QSet<QString> &installedKeys)
+{
+    TraceSpan span("model", "PackageTableModel::markInstalled");
+    for (PackageInfo &pkg : m_pkgs)
+        pkg.installed = installedKeys.contains(nevraKey(pkg));
+
+    if (!m_pkgs.isEmpty()) {
+        emit dataChanged(index(0, NameColumn), index(m_pkgs.size() - 1, NameColumn),
+                         {Qt::CheckStateRole});
+    }
+}
+
+QString PackageTableModel::nameArchKey(const PackageInfo &pkg)
+{
+    return pkg.name + QLatin1Char('.') + pkg.arch;
+}
+
+int PackageTableModel::removePackages(const QSet<QString> &keys)
+{
+    TraceSpan span("model", "PackageTableModel::removePackages");
+    const int removed = removeRowsWhere([&keys](const PackageInfo &pkg) {
+        return keys.contains(nameArchKey(pkg));
+    });
+    span.arg("rows", removed);
+    return removed;
+}
+
+void PackageTableModel::syncPackages(const QVector<PackageInfo> &pkgs)
+{
+    TraceSpan span("model", "PackageTableModel::syncPackages");
+    QSet<QString> present;
+    present.reserve(pkgs.size());
+    for (const PackageInfo &pkg : pkgs)
+        present.insert(nevraKey(pkg));
+
+    const int removed = removeRowsWhere([&present](const PackageInfo &pkg) {
+        return !present.contains(nevraKey(pkg));
+    });
+    const int before = int(m_pkgs.size());
+    upsertPackages(pkgs);
+    span.arg("removed", removed);
+    span.arg("added", int(m_pkgs.size()) - before);
+}
+
+template <typename Predicate>
+int PackageTableModel::removeRowsWhere(Predicate matches)
+{
+    int removed = 0;
+    // Walk backwards so the rows still to visit keep their numbers, and remove
+    // each contiguous run with one beginRemoveRows() instead of a model reset.
+    int row = m_pkgs.size() - 1;
+    while (row >= 0) {
+        if (!matches(m_pkgs.at(row))) {
+            --row;
+            continue;
+        }
+        const int last = row;
+        while (row > 0 && matches(m_pkgs.at(row - 1)))
+            --row;
+
+        const int count = last - row + 1;
+        beginRemoveRows(QModelIndex(), row, last);
+        for (int i = row; i <= last; ++i) {
+            if (m_rowUpdates.at(i))
+                --m_updateRows;
+            if (!m_rowAdvisories.at(i).isEmpty())
+                --m_affectedRows;
+        }
+        m_pkgs.remove(row, count);
+        m_versionKeys.remove(row, count);
+        m_rowUpdates.remove(row, count);
+        m_rowAdvisories.remove(row, count);
+        markWidestStale(~0u);
+        endRemoveRows();
+
+        removed += count;
+        --row;
+    }
+    return removed;
+}
+
+void PackageTableModel::upsertPackages(const QVector<PackageInfo> &pkgs)
+{
+    TraceSpan span("model", "PackageTableModel::upsertPackages");
+    span.arg("rows", pkgs.size());
+
+    QHash<QString, int> rowByKey;
+    rowByKey.reserve(m_pkgs.size());
+    for (int row = 0; row < m_pkgs.size(); ++row)
+        rowByKey.insert(nevraKey(m_pkgs.at(row)), row);
+
+    QVector<PackageInfo> appended;
+    for (const PackageInfo &pkg : pkgs) {
+        const auto it = rowByKey.constFind(nevraKey(pkg));
+        if (it == rowByKey.constEnd()) {
+            appended.append(pkg);
+            continue;
+        }
+
+        const int row = it.value();
+        PackageInfo &current = m_pkgs[row];
+        // The NEVRA matched; only bother the views when something shown differs
+        if (current.epoch == pkg.epoch && current.installDate == pkg.installDate
+            && current.group == pkg.group && current.sizeBytes == pkg.sizeBytes
+            && current.repo == pkg.repo && current.summary == pkg.summary)
+            continue;
+
+        const bool wasInstalled = current.installed;
+        const bool hadUpdate = m_rowUpdates.at(row) != nullptr;
+        current = pkg;
+        current.installed = wasInstalled;
+        m_versionKeys[row] = RpmEvr::sortKey(current.epoch, current.version);
+        m_rowUpdates[row] = findUpdate(row);
+        m_updateRows += int(m_rowUpdates.at(row) != nullptr) - int(hadUpdate);
+        matchAdvisories(row);
+        noteWidest(row); // the old text may linger in the sample; widths only overshoot
+        emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+    }
+
+    if (appended.isEmpty())
+        return;
+
+    const int first = m_pkgs.size();
+    beginInsertRows(QModelIndex(), first, first + appended.size() - 1);
+    m_pkgs += appended;
+    m_versionKeys.resize(m_pkgs.size());
+    m_rowUpdates.resize(m_pkgs.size());
+    m_rowAdvisories.resize(m_pkgs.size());
+    for (int row = first; row < m_pkgs.size(); ++row) {
+        const PackageInfo &pkg = m_pkgs.at(row);
+        m_versionKeys[row] = RpmEvr::sortKey(pkg.epoch, pkg.version);
+        m_rowUpdates[row] = findUpdate(row);
+        if (m_rowUpdates.at(row))
+            ++m_updateRows;
+        matchAdvisories(row);
+        noteWidest(row);
+    }
+    endInsertRows();
+}
+
+const QByteArray &PackageTableModel::versionKeyAt(int row) const
+{
+    static const QByteArray empty;
+    if (row < 0 || row >= m_versionKeys.size())
+        return empty;
+    return m_versionKeys.at(row);
+}
+
+qint64 PackageTableModel::sizeBytesAt(int row) const
+{
+    if (row < 0 || row >= m_pkgs.size())
+        return -1;
+    return m_pkgs.at(row).sizeBytes;
+}
+
+void PackageTableModel::rebuildVersionKeys()
+{
+    m_versionKeys.resize(m_pkgs.size());
+    for (int row = 0; row < m_pkgs.size(); ++row) {
+        const PackageInfo &pkg = m_pkgs.at(row);
+        m_versionKeys[row] = RpmEvr::sortKey(pkg.epoch, pkg.version);
+    }
+}
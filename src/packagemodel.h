@@ -12,11 +12,16 @@
 #pragma once
 
 #include <QAbstractTableModel>
+#include <QSet>
 #include <QString>
 #include <QVector>
 
+#include "updateinfo.h"
+#include "updateset.h"
+
 struct PackageInfo {
     QString name; /** RPM package name */
+    QString epoch; /** EPOCH, "0" when the package has none */
     QString version;  /** VERSION-RELEASE */
     QString arch; /** Architecture such as x86_64, noarch, etc. */
     QString installDate; /** Human-readable install date */
@@ -25,6 +30,7 @@ struct PackageInfo {
     qint64 sizeBytes = -1; /** Raw size in bytes for conversions */
     QString repo; /** Repository name rpm says it came from */
     QString summary; /** Package summary description */
+    bool installed = false; /** Available rows only: the same NEVRA is installed */
 };
 
 class PackageTableModel : public QAbstractTableModel
@@ -36,6 +42,9 @@ public:
     enum Column {
         NameColumn = 0,
         VersionColumn,
+        UpdateColumn,
+        AdvisoriesColumn,
+        SeverityColumn,
         ArchColumn,
         InstallDateColumn,
         GroupColumn,
@@ -52,9 +61,79 @@ public:
                         int role = Qt::DisplayRole) const override;
 
     void setPackages(const QVector<PackageInfo> &pkgs);
+    const QVector<PackageInfo> &packages() const { return m_pkgs; }
     PackageInfo packageAt(int row) const;
     void updateSizeDisplay(int row, const QString &displayValue);
 
+    /** Joins a check-update result into the table; keeps it across setPackages() */
+    void setUpdates(const UpdateSet &updates);
+    const UpdateSet &updates() const { return m_updates; }
+    const UpdateEntry *updateAt(int row) const;
+    int updateCount() const { return m_updateRows; }
+
+    /** Joins cached advisories into the table; keeps them across setPackages() */
+    void setAdvisories(const AdvisoryIndex &advisories);
+    const AdvisoryIndex &advisories() const { return m_advisories; }
+    /** Advisories with a fix newer than the row's version; empty when none */
+    const AdvisoryMatch &advisoriesAt(int row) const;
+    int affectedCount() const { return m_affectedRows; }
+
+    /**
+     * The longest display texts of @p column (by characters, longest first,
+     * at most WidestSampleSize). Views size columns by measuring these
+     * instead of every cell.
+     */
+    QStringList widestTexts(int column) const;
+    static constexpr int WidestSampleSize = 16;
+
+    /** Precomputed RpmEvr::sortKey() of the row; memcmp order == rpm order */
+    const QByteArray &versionKeyAt(int row) const;
+    qint64 sizeBytesAt(int row) const;
+
+    /** name|version-release|arch, the join key between installed and available rows */
+    static QString nevraKey(const PackageInfo &pkg);
+    QSet<QString> nevraKeys() const;
+    /** Flags rows whose NEVRA is in @p installedKeys; shown as a check mark on Name */
+    void markInstalled(const QSet<QString> &installedKeys);
+
+    /** name.arch, the spec dnf and RemovalImpactAnalyzer accept for one package */
+    static QString nameArchKey(const PackageInfo &pkg);
+    /** Drops rows whose nameArchKey() is in @p keys; returns the number removed */
+    int removePackages(const QSet<QString> &keys);
+    /** Refreshes rows with the same NEVRA in place and appends the rest */
+    void upsertPackages(const QVector<PackageInfo> &pkgs);
+    /**
+     * Makes the rows match @p pkgs with row-level signals instead of a reset:
+     * rows whose NEVRA is gone are removed, the rest go through upsertPackages().
+     * Selection, scroll position and sort survive.
+     */
+    void syncPackages(const QVector<PackageInfo> &pkgs);
+
 private:
+    /** Removes every row @p matches accepts, one beginRemoveRows() per contiguous run */
+    template <typename Predicate>
+    int removeRowsWhere(Predicate matches);
+    void rebuildUpdateIndex();
+    const UpdateEntry *findUpdate(int row) const;
+    void rebuildVersionKeys();
+    void rebuildAdvisoryIndex();
+    QString displayText(int row, int column) const;
+    /** Offers @p row to every column whose sample is current */
+    void noteWidest(int row);
+    void markWidestStale(quint32 columns) { m_widestStale |= columns; }
+    /** Recomputes one row's advisories, keeping m_affectedRows in step */
+    void matchAdvisories(int row);
+
     QVector<PackageInfo> m_pkgs;
+    QVector<QByteArray> m_versionKeys; // parallel to m_pkgs
+    UpdateSet m_updates;
+    QVector<const UpdateEntry *> m_rowUpdates; // parallel to m_pkgs, null when up to date
+    int m_updateRows = 0;
+    AdvisoryIndex m_advisories;
+    QVector<AdvisoryMatch> m_rowAdvisories; // parallel to m_pkgs
+    int m_affectedRows = 0;
+    // Longest texts per column: kept up on appends and edits, rebuilt on demand
+    // after anything that can shorten a column (resets, removals, new updates)
+    mutable QVector<QStringList> m_widest;
+    mutable quint32 m_widestStale = ~0u; // bit per column
 };
@@ -0,0 +1,241 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the InstalledPackageQuery for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "packagequery.h"
+#include "ringlog.h"
+#include "trace.h"
+
+#include <QDateTime>
+#include <QObject>
+#include <QProcess>
+#include <QSet>
+#include <QTextStream>
+#include <QTimeZone>
+
+// File-local constants go here:
+namespace {
+    constexpr int WaitForStartedTimeoutMs {5000};   // 5 s
+    constexpr int WaitForFinishedTimeoutMs {60000};  // 60 s
+
+    /** Starts @p program and waits for it; false with @p error if it never ran to completion */
+    bool runToCompletion(QProcess &proc, const QString &program, const QStringList &arguments,
+                         QString *error)
+    {
+        proc.setProcessChannelMode(QProcess::SeparateChannels); //* we want to read stdout and stderr separately */
+        proc.start(program, arguments);
+
+        /**command might not start so we set a timeout */
+        if (!proc.waitForStarted(WaitForStartedTimeoutMs)) {
+            if (error)
+                *error = QObject::tr("Failed to start %1 process.").arg(program);
+            return false;
+        }
+        /** command might be slow or hang, so we set a timeout */
+        if (!proc.waitForFinished(WaitForFinishedTimeoutMs)) { // 60 s timeout
+            proc.kill();
+            if (error)
+                *error = QObject::tr("Timed out while running %1").arg(program);
+            return false;
+        }
+        if (proc.exitStatus() != QProcess::NormalExit) {
+            if (error)
+                *error = QObject::tr("%1 crashed while running.").arg(program);
+            return false;
+        }
+        return true;
+    }
+}
+
+QString InstalledPackageQuery::queryFormat()
+{
+    //Better to use DNF to get more accurate info about installed packages
+    return QStringLiteral(
+        "%{name}\x1F" // rpm package name
+        "%{version}-%{release}\x1F"
+        "%{arch}\x1F"
+        "%{installtime}\x1F"
+        "%{group}\x1F"
+        "%{size}\x1F" //size in bytes
+        "%{from_repo}\x1F" //attempt to resolve what repo this package is coming from
+        "%{summary}\x1F"
+        "%{epoch}"); // needed for rpm EVR ordering, not displayed
+}
+
+QStringList InstalledPackageQuery::arguments()
+{
+    return {QStringLiteral("repoquery"),
+            QStringLiteral("--installed"),
+            QStringLiteral("--qf"), queryFormat()};
+}
+
+bool InstalledPackageQuery::run(QVector<PackageInfo> &out, QString *error)
+{
+    TraceSpan span("process", "dnf repoquery --installed");
+    QProcess proc; /** to run the command I need */
+    if (!runToCompletion(proc, QStringLiteral("dnf"), arguments(), error))
+        return false;
+
+    const QByteArray stdoutBytes = proc.readAllStandardOutput(); //* read stdout  into QByteArray */
+    const QByteArray err = proc.readAllStandardError();  //* read stderr into QByteArray */
+    span.arg("exitCode", proc.exitCode());
+    span.arg("stdoutBytes", stdoutBytes.size());
+    span.arg("stderrBytes", err.size());
+    Trace::counter("dnf.stdout.bytes", stdoutBytes.size());
+
+    RingLog::write(RingLog::Info, "repoquery: %1 bytes of output, %2 on stderr",
+                   stdoutBytes.size(), err.size());
+    if (!err.isEmpty())
+        RingLog::write(RingLog::Warning, "repoquery: exit %1, stderr: %2", proc.exitCode(),
+                       QString::fromLocal8Bit(err).trimmed());
+
+    out = parseRepoqueryOutput(stdoutBytes);
+    return true;
+}
+
+QStringList InstalledPackageQuery::rpmArguments()
+{
+    // Same field order as queryFormat(), so parseRepoqueryOutput() reads both
+    return {QStringLiteral("-qa"),
+            QStringLiteral("--qf"),
+            QStringLiteral("%{NAME}\x1F"
+                           "%{VERSION}-%{RELEASE}\x1F"
+                           "%{ARCH}\x1F"
+                           "%{INSTALLTIME}\x1F" // epoch seconds; formatted like dnf's below
+                           "%{GROUP}\x1F"
+                           "%{SIZE}\x1F"
+                           "\x1F" // no repo: only dnf tracks where a package came from
+                           "%{SUMMARY}\x1F"
+                           "%{EPOCH}\n")};
+}
+
+bool InstalledPackageQuery::runRpm(QVector<PackageInfo> &out, QString *error)
+{
+    TraceSpan span("process", "rpm -qa (installed)");
+    QProcess proc;
+    if (!runToCompletion(proc, QStringLiteral("rpm"), rpmArguments(), error))
+        return false;
+    if (proc.exitCode() != 0) {
+        if (error)
+            *error = QObject::tr("rpm -qa failed.\n%1")
+                         .arg(QString::fromLocal8Bit(proc.readAllStandardError()).trimmed());
+        return false;
+    }
+
+    const QByteArray stdoutBytes = proc.readAllStandardOutput();
+    span.arg("stdoutBytes", stdoutBytes.size());
+    out = parseRepoqueryOutput(stdoutBytes);
+    // dnf repoquery prints installtime as UTC "yyyy-MM-dd HH:mm"
+    for (PackageInfo &pkg : out) {
+        bool ok = false;
+        const qint64 secs = pkg.installDate.toLongLong(&ok);
+        if (ok)
+            pkg.installDate = QDateTime::fromSecsSinceEpoch(secs, QTimeZone::utc())
+                                  .toString(QStringLiteral("yyyy-MM-dd HH:mm"));
+    }
+    return true;
+}
+
+QVector<PackageInfo> InstalledPackageQuery::parseRepoqueryOutput(const QByteArray &out)
+{
+    TraceSpan span("parse", "parseRepoqueryOutput");
+    span.arg("bytes", out.size());
+    QVector<PackageInfo> result;
+
+    static constexpr QChar kFieldSep(u'\x1F'); // unit separator to avoid clashing with tabs/spaces in fields
+
+    QString data = QString::fromLocal8Bit(out);
+    QTextStream stream(&data, QIODevice::ReadOnly);
+
+    QString line;
+    int lineIndex = 0;
+    // for deduplicating (name, version, arch)
+    QSet<QString> seenKeys;
+
+    while (stream.readLineInto(&line)) {
+        const QString trimmed = line.trimmed();
+        if (trimmed.isEmpty()) {
+            RingLog::write(RingLog::Debug, "repoquery: line %1 is empty", lineIndex);
+            ++lineIndex;
+            continue;
+        }
+        // Filter known dnf informational noise printed to stdout
+        if (trimmed.startsWith(
+                QStringLiteral("Not root, Subscription Management repositories not updated"))) {
+            RingLog::write(RingLog::Debug, "repoquery: line %1 is dnf noise: %2", lineIndex, trimmed);
+            ++lineIndex;
+            continue;
+        }
+        const QStringList fields = trimmed.split(kFieldSep, Qt::KeepEmptyParts);
+        // Allow partially filled records, but require at least:
+        //   0: name, 1: version-release, 2: arch
+        if (fields.size() < 3) {
+            RingLog::write(RingLog::Warning, "repoquery: line %1 has %2 fields, skipped: %3",
+                           lineIndex, fields.size(), trimmed);
+            ++lineIndex;
+            continue;
+        }
+
+        PackageInfo pkg;
+        pkg.name    = fields.value(0).trimmed();
+        pkg.version = fields.value(1).trimmed();
+        pkg.arch    = fields.value(2).trimmed();
+        // Minimal validation: if these are missing it's not a real package entry
+        if (pkg.name.isEmpty() || pkg.version.isEmpty() || pkg.arch.isEmpty()) {
+            RingLog::write(RingLog::Warning, "repoquery: line %1 lacks name, version or arch, skipped: %2",
+                           lineIndex, trimmed);
+            ++lineIndex;
+            continue;
+        }
+        // Deduplicate (dnf can sometimes output multiple rows for same NEVRA)
+        const QString key =
+            pkg.name + QLatin1Char('|') + pkg.version + QLatin1Char('|') + pkg.arch;
+        if (seenKeys.contains(key)) {
+            RingLog::write(RingLog::Info, "repoquery: line %1 repeats %2", lineIndex, key);
+            ++lineIndex;
+            continue;
+        }
+        seenKeys.insert(key);
+
+        // INSTALLTIME comes from dnf repoquery as a preformatted string
+        // (see dnf-plugins-core repoquery.py: PackageWrapper.installtime).
+        // We keep it as-is instead of trying to parse epoch seconds.
+        const QString installField = fields.value(3).trimmed();
+        pkg.installDate = installField;
+
+        //Do not like how install date is represented, convert UTC string to local time
+        /*const QDateTime dt = QDateTime::fromString(installField, Qt::ISODate);
+        if (dt.isValid()) {
+            pkg.installDate = dt.toLocalTime().toString(QStringLiteral("yyyy-MM-dd HH:mm"));
+        }*/
+
+        pkg.group   = fields.value(4).trimmed();
+        
+        // SIZE: keep original string, but sanity-check that it's numeric
+        const QString sizeField = fields.value(5).trimmed();
+        bool okSize = false;
+        const qint64 parsedSize = sizeField.toLongLong(&okSize);
+        if (okSize) {
+            pkg.size = sizeField;
+            pkg.sizeBytes = parsedSize;
+        } else {
+            pkg.size.clear(); // treat nonsense size as "unknown"
+            pkg.sizeBytes = -1;
+        }
+
+        pkg.repo    = fields.value(6).trimmed();
+        pkg.summary = fields.value(7).trimmed();
+        pkg.epoch   = fields.value(8).trimmed();
+        if (pkg.epoch.isEmpty() || pkg.epoch == QLatin1String("(none)"))
+            pkg.epoch = QStringLiteral("0");
+
+        result.push_back(pkg);
+        ++lineIndex;
+    }//end of while reading lines
+
+    span.arg("packages", result.size());
+    RingLog::write(RingLog::Info, "repoquery: %1 packages from %2 lines", result.size(), lineIndex);
+    return result;
+}
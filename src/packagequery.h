@@ -0,0 +1,34 @@
+/**
+ * @file packagequery.h
+ * @author Nikolay Yevik
+ * @brief Installed package query (dnf repoquery) shared by the GUI and the headless CLI.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "packagemodel.h"
+
+class InstalledPackageQuery
+{
+public:
+    /** dnf repoquery --qf format; fields are separated by \x1F */
+    static QString queryFormat();
+    static QStringList arguments();
+
+    /** Parses repoquery output, skipping dnf noise, malformed and duplicate lines */
+    static QVector<PackageInfo> parseRepoqueryOutput(const QByteArray &out);
+
+    /** Runs dnf synchronously; returns false and fills @p error on failure */
+    static bool run(QVector<PackageInfo> &out, QString *error = nullptr);
+
+    /** rpm -qa with the queryFormat() field layout; rpm knows no repo, so that field is empty */
+    static QStringList rpmArguments();
+    /** Like run() through rpm -qa: several times faster than dnf, but every repo is empty */
+    static bool runRpm(QVector<PackageInfo> &out, QString *error = nullptr);
+};
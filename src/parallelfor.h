@@ -0,0 +1,36 @@
+/**
+ * @file parallelfor.h
+ * @author Nikolay Yevik
+ * @brief Index-parallel loop on a private thread pool for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+/** Runs @p body(i) for i in [0, count) on a private pool; @p threads <= 0 means one per core */
+inline void parallelFor(int count, int threads, const std::function<void(int)> &body)
+{
+    if (count <= 0)
+        return;
+    if (threads <= 0)
+        threads = QThread::idealThreadCount();
+    threads = std::max(1, std::min(threads, count));
+
+    std::atomic<int> next{0};
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (int t = 0; t < threads; ++t) {
+        pool.start([&]() {
+            for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+                body(i);
+        });
+    }
+    pool.waitForDone();
+}
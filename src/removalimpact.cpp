@@ -0,0 +1,302 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the RemovalImpactAnalyzer for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "removalimpact.h"
+#include "trace.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QProcess>
+#include <QSet>
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    constexpr int WaitForStartedTimeoutMs {5000};   // 5 s
+    constexpr int WaitForFinishedTimeoutMs {60000};  // 60 s
+
+    constexpr char kRecordMarker = '@';
+    constexpr char kProvideMarker = 'P';
+    constexpr char kRequireMarker = 'R';
+    constexpr char kFileMarker = 'F';
+    constexpr char kFieldSep = '\x1F';
+
+    bool isIgnoredRequirement(const QByteArray &cap)
+    {
+        // rpmlib() features are satisfied by rpm itself, not by a package
+        return cap.startsWith("rpmlib(") || cap == "(none)";
+    }
+}
+
+QStringList RemovalImpactAnalyzer::dependencyQueryArguments()
+{
+    // One record line per package followed by one line per provide/require/file.
+    // The file list is what satisfies file requires such as /bin/sh.
+    return {QStringLiteral("-qa"),
+            QStringLiteral("--qf"),
+            QStringLiteral("@%{NAME}\x1F%{ARCH}\x1F%{SIZE}\n"
+                           "[P%{PROVIDENAME}\n]"
+                           "[R%{REQUIRENAME}\n]"
+                           "[F%{FILENAMES}\n]")};
+}
+
+QVector<PackageDependencies> RemovalImpactAnalyzer::parseDependencyDump(const QByteArray &output)
+{
+    TraceSpan span("parse", "parseDependencyDump");
+    span.arg("bytes", output.size());
+    QVector<PackageDependencies> result;
+    PackageDependencies *current = nullptr;
+    // Files stay views into @p output until we know which paths are required;
+    // most of the hundreds of thousands of them never are.
+    QVector<std::pair<int, QByteArrayView>> files;
+    QSet<QByteArrayView> fileRequires;
+
+    qsizetype pos = 0;
+    const qsizetype total = output.size();
+    while (pos < total) {
+        qsizetype eol = output.indexOf('\n', pos);
+        if (eol < 0)
+            eol = total;
+        const QByteArrayView raw(output.constData() + pos, eol - pos);
+        pos = eol + 1;
+
+        if (raw.size() < 2)
+            continue;
+        if (raw.at(0) == kFileMarker) {
+            if (current)
+                files.append({int(result.size() - 1), raw.sliced(1)});
+            continue;
+        }
+
+        const QByteArray line = raw.toByteArray().trimmed();
+        if (line.size() < 2)
+            continue;
+
+        const char marker = line.at(0);
+        if (marker == kRecordMarker) {
+            const QList<QByteArray> fields = line.mid(1).split(kFieldSep);
+            if (fields.size() < 3 || fields.at(0).isEmpty()) {
+                current = nullptr;
+                continue;
+            }
+            PackageDependencies pkg;
+            pkg.name = QString::fromUtf8(fields.at(0));
+            pkg.arch = QString::fromUtf8(fields.at(1));
+            bool ok = false;
+            const qint64 size = fields.at(2).toLongLong(&ok);
+            pkg.sizeBytes = ok ? size : -1;
+            pkg.provides.append(pkg.name);
+            result.push_back(std::move(pkg));
+            current = &result.last();
+            continue;
+        }
+
+        if (!current)
+            continue;
+
+        const QByteArray cap = line.mid(1);
+        if (marker == kProvideMarker) {
+            if (cap != "(none)")
+                current->provides.append(QString::fromUtf8(cap));
+        } else if (marker == kRequireMarker) {
+            if (isIgnoredRequirement(cap))
+                continue;
+            current->requirements.append(QString::fromUtf8(cap));
+            if (cap.startsWith('/'))
+                fileRequires.insert(raw.sliced(1));
+        }
+    }
+
+    // rpm satisfies a file require with any package owning that path
+    for (const auto &[pkg, path] : std::as_const(files)) {
+        if (fileRequires.contains(path))
+            result[pkg].provides.append(QString::fromUtf8(path));
+    }
+    span.arg("files", files.size());
+    span.arg("fileRequires", fileRequires.size());
+
+    return result;
+}
+
+bool RemovalImpactAnalyzer::queryInstalled(QVector<PackageDependencies> &out, QString *error)
+{
+    TraceSpan span("process", "rpm -qa (dependencies)");
+    QProcess proc;
+    proc.setProcessChannelMode(QProcess::SeparateChannels);
+    proc.start(QStringLiteral("rpm"), dependencyQueryArguments());
+
+    if (!proc.waitForStarted(WaitForStartedTimeoutMs)) {
+        if (error)
+            *error = QObject::tr("Failed to start rpm -qa.");
+        return false;
+    }
+    if (!proc.waitForFinished(WaitForFinishedTimeoutMs)) {
+        proc.kill();
+        if (error)
+            *error = QObject::tr("Timed out while running rpm -qa.");
+        return false;
+    }
+    if (proc.exitStatus() != QProcess::NormalExit || proc.exitCode() != 0) {
+        if (error)
+            *error = QObject::tr("rpm -qa failed.\n%1")
+                         .arg(QString::fromLocal8Bit(proc.readAllStandardError()).trimmed());
+        return false;
+    }
+
+    const QByteArray dump = proc.readAllStandardOutput();
+    span.arg("exitCode", proc.exitCode());
+    span.arg("stdoutBytes", dump.size());
+    out = parseDependencyDump(dump);
+    return true;
+}
+
+void RemovalImpactAnalyzer::setPackages(const QVector<PackageDependencies> &pkgs)
+{
+    m_pkgs = pkgs;
+    const int count = m_pkgs.size();
+
+    m_byName.clear();
+    m_byName.reserve(count * 2);
+
+    QHash<QString, QVector<int>> providers;
+    providers.reserve(count * 8);
+
+    for (int i = 0; i < count; ++i) {
+        const PackageDependencies &pkg = m_pkgs.at(i);
+        m_byName[pkg.name].append(i);
+        m_byName[pkg.name + QLatin1Char('.') + pkg.arch].append(i);
+        for (const QString &cap : pkg.provides) {
+            QVector<int> &list = providers[cap];
+            if (list.isEmpty() || list.last() != i)
+                list.append(i);
+        }
+    }
+
+    m_requirementProviders = QVector<QVector<QVector<int>>>(count);
+    m_requiredBy = QVector<QVector<int>>(count);
+    m_dependsOn = QVector<QVector<int>>(count);
+
+    for (int i = 0; i < count; ++i) {
+        const PackageDependencies &pkg = m_pkgs.at(i);
+        QVector<QVector<int>> &resolved = m_requirementProviders[i];
+        resolved.reserve(pkg.requirements.size());
+
+        for (const QString &cap : pkg.requirements) {
+            const auto it = providers.constFind(cap);
+            // Nothing installed satisfies it: already broken, or a rich
+            // (boolean) dependency this graph does not model.
+            if (it == providers.constEnd())
+                continue;
+            // A package satisfying its own requirement never breaks on removal of others.
+            if (it->contains(i))
+                continue;
+            resolved.append(*it);
+            for (int provider : *it) {
+                m_dependsOn[i].append(provider);
+                m_requiredBy[provider].append(i);
+            }
+        }
+    }
+
+    auto dedupe = [](QVector<int> &v) {
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+    };
+    for (int i = 0; i < count; ++i) {
+        dedupe(m_requiredBy[i]);
+        dedupe(m_dependsOn[i]);
+    }
+}
+
+QString RemovalImpactAnalyzer::labelFor(int idx) const
+{
+    const PackageDependencies &pkg = m_pkgs.at(idx);
+    return pkg.name + QLatin1Char('.') + pkg.arch;
+}
+
+RemovalImpact RemovalImpactAnalyzer::analyze(const QStringList &names) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    RemovalImpact impact;
+    const int count = m_pkgs.size();
+
+    QVector<char> removed(count, 0);
+    QVector<int> worklist;
+
+    for (const QString &raw : names) {
+        const QString name = raw.trimmed();
+        if (name.isEmpty())
+            continue;
+        const auto it = m_byName.constFind(name);
+        if (it == m_byName.constEnd()) {
+            impact.notInstalled.append(name);
+            continue;
+        }
+        for (int idx : *it) {
+            if (removed[idx])
+                continue;
+            removed[idx] = 1;
+            worklist.append(idx);
+            impact.targets.append(labelFor(idx));
+            impact.reclaimableBytes += qMax<qint64>(0, m_pkgs.at(idx).sizeBytes);
+        }
+    }
+
+    // Reverse closure: a dependent breaks once every provider of one of its
+    // requirements is gone; dnf removes it as part of the same transaction.
+    while (!worklist.isEmpty()) {
+        const int gone = worklist.takeLast();
+        for (int dependent : m_requiredBy.at(gone)) {
+            if (removed[dependent])
+                continue;
+            const auto &requirements = m_requirementProviders.at(dependent);
+            const bool broken = std::any_of(requirements.cbegin(), requirements.cend(),
+                                            [&removed](const QVector<int> &provs) {
+                                                return std::all_of(provs.cbegin(), provs.cend(),
+                                                                   [&removed](int p) { return removed[p] != 0; });
+                                            });
+            if (!broken)
+                continue;
+            removed[dependent] = 1;
+            worklist.append(dependent);
+            impact.dependents.append(labelFor(dependent));
+            impact.reclaimableBytes += qMax<qint64>(0, m_pkgs.at(dependent).sizeBytes);
+        }
+    }
+
+    // Orphans: dependencies of the removed set whose every requirer is gone.
+    QVector<char> orphaned(count, 0);
+    for (int i = 0; i < count; ++i) {
+        if (removed[i])
+            worklist.append(i);
+    }
+    while (!worklist.isEmpty()) {
+        const int gone = worklist.takeLast();
+        for (int dep : m_dependsOn.at(gone)) {
+            if (removed[dep] || orphaned[dep])
+                continue;
+            const auto &requirers = m_requiredBy.at(dep);
+            const bool stillNeeded = std::any_of(requirers.cbegin(), requirers.cend(),
+                                                 [&removed, &orphaned](int r) {
+                                                     return !removed[r] && !orphaned[r];
+                                                 });
+            if (stillNeeded)
+                continue;
+            orphaned[dep] = 1;
+            worklist.append(dep);
+            impact.orphans.append(labelFor(dep));
+            impact.orphanBytes += qMax<qint64>(0, m_pkgs.at(dep).sizeBytes);
+        }
+    }
+
+    impact.dependents.sort();
+    impact.orphans.sort();
+    impact.elapsedUs = timer.nsecsElapsed() / 1000;
+    return impact;
+}
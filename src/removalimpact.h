@@ -0,0 +1,59 @@
+/**
+ * @file removalimpact.h
+ * @author Nikolay Yevik
+ * @brief In-memory removal impact analysis for TurboRPM Package Manager Prototype.
+ * Builds a requires/provides graph of the installed package set once and answers
+ * "what happens if I remove these packages" without a dnf dry run.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+struct PackageDependencies {
+    QString name; /** RPM package name */
+    QString arch; /** Architecture such as x86_64, noarch, etc. */
+    qint64 sizeBytes = -1; /** Installed size in bytes */
+    QStringList provides; /** Capability names the package provides, plus owned files something requires */
+    QStringList requirements; /** Capability names the package requires */
+};
+
+struct RemovalImpact {
+    QStringList targets; /** Installed packages matched by the request (name.arch) */
+    QStringList notInstalled; /** Requested names that matched nothing installed */
+    QStringList dependents; /** Packages left with unsatisfied requires, removed along */
+    QStringList orphans; /** Dependencies no remaining package needs anymore */
+    qint64 reclaimableBytes = 0; /** Size of targets + dependents */
+    qint64 orphanBytes = 0; /** Additional size of the orphaned leaves */
+    qint64 elapsedUs = 0; /** Time spent in analyze() */
+};
+
+class RemovalImpactAnalyzer
+{
+public:
+    void setPackages(const QVector<PackageDependencies> &pkgs);
+    bool isEmpty() const { return m_pkgs.isEmpty(); }
+    int packageCount() const { return m_pkgs.size(); }
+
+    RemovalImpact analyze(const QStringList &names) const;
+
+    /** rpm -qa arguments producing the dump consumed by parseDependencyDump() */
+    static QStringList dependencyQueryArguments();
+    static QVector<PackageDependencies> parseDependencyDump(const QByteArray &output);
+    /** Runs rpm synchronously, so not on the GUI thread; returns false and fills @p error on failure */
+    static bool queryInstalled(QVector<PackageDependencies> &out, QString *error = nullptr);
+
+private:
+    QString labelFor(int idx) const;
+
+    QVector<PackageDependencies> m_pkgs;
+    QHash<QString, QVector<int>> m_byName; // name and name.arch -> package indexes
+    QVector<QVector<QVector<int>>> m_requirementProviders; // per package, per resolved requirement
+    QVector<QVector<int>> m_requiredBy; // package -> packages that require something it provides
+    QVector<QVector<int>> m_dependsOn; // package -> packages providing its requirements
+};
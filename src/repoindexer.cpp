@@ -0,0 +1,664 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the local repository indexer for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "repoindexer.h"
+#include "fileverifier.h"
+#include "parallelfor.h"
+#include "ringlog.h"
+#include "rpmevr.h"
+#include "sha256.h"
+#include "trace.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QSaveFile>
+#include <QSemaphore>
+#include <QSet>
+#include <QThread>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr quint32 CacheMagic {0x54525049}; // "TRPI"
+    constexpr quint32 CacheVersion {1};
+    constexpr QDataStream::Version StreamVersion {QDataStream::Qt_6_0};
+    constexpr int HashAlgoSha256 {8}; // PGPHASHALGO_SHA256, for FileVerifier::fileDigest()
+    constexpr int ReadChunkBytes {256 * 1024};
+    const QString StagingName {QStringLiteral(".repodata.turborpm")};
+    const QString RetiredName {QStringLiteral(".repodata.old")};
+    const QString CacheName {QStringLiteral(".turborpm-index")};
+}
+
+namespace {
+
+void setError(QString *error, const QString &message)
+{
+    if (error)
+        *error = message;
+}
+
+/** Appends @p text as XML character data; control characters XML 1.0 cannot carry are dropped */
+void appendEscaped(QByteArray &out, QStringView text)
+{
+    const QByteArray utf8 = text.toUtf8();
+    for (const char c : utf8) {
+        switch (c) {
+        case '&':
+            out += "&amp;";
+            break;
+        case '<':
+            out += "&lt;";
+            break;
+        case '>':
+            out += "&gt;";
+            break;
+        case '"':
+            out += "&quot;";
+            break;
+        case '\t':
+        case '\n':
+        case '\r':
+            out += c;
+            break;
+        default:
+            if (uchar(c) >= 0x20)
+                out += c;
+            break;
+        }
+    }
+}
+
+void appendAttribute(QByteArray &out, const char *name, QStringView value)
+{
+    out += ' ';
+    out += name;
+    out += "=\"";
+    appendEscaped(out, value);
+    out += '"';
+}
+
+void appendElement(QByteArray &out, const char *indent, const char *tag, QStringView text)
+{
+    out += indent;
+    out += '<';
+    out += tag;
+    if (text.isEmpty()) {
+        out += "/>\n";
+        return;
+    }
+    out += '>';
+    appendEscaped(out, text);
+    out += "</";
+    out += tag;
+    out += ">\n";
+}
+
+/** epoch="0" ver="..." rel="..." as every metadata file writes the package version */
+void appendVersion(QByteArray &out, const RpmPackageFile &pkg)
+{
+    appendAttribute(out, "epoch", pkg.epoch.isEmpty() ? QStringLiteral("0") : pkg.epoch);
+    appendAttribute(out, "ver", pkg.version);
+    appendAttribute(out, "rel", pkg.release);
+}
+
+void appendDependencies(QByteArray &out, const char *tag, const QVector<RpmDependency> &deps,
+                        bool requires)
+{
+    QSet<QString> seen;
+    QByteArray entries;
+    for (const RpmDependency &dep : deps) {
+        // rpm satisfies rpmlib() itself; the solver never looks for a package
+        if (requires && dep.isRpmlib())
+            continue;
+        if (seen.contains(dep.toString()))
+            continue;
+        seen.insert(dep.toString());
+
+        entries += "      <rpm:entry";
+        appendAttribute(entries, "name", dep.name);
+        const QString comparison = dep.comparison();
+        if (!comparison.isEmpty()) {
+            QStringView epoch, version, release;
+            RpmEvr::split(dep.version, epoch, version, release);
+            appendAttribute(entries, "flags", comparison);
+            appendAttribute(entries, "epoch", epoch.isEmpty() ? QStringView(u"0") : epoch);
+            appendAttribute(entries, "ver", version);
+            if (!release.isEmpty())
+                appendAttribute(entries, "rel", release);
+        }
+        if (requires && dep.isPrerequisite())
+            entries += " pre=\"1\"";
+        entries += "/>\n";
+    }
+    if (entries.isEmpty())
+        return;
+    out += "    <";
+    out += tag;
+    out += ">\n";
+    out += entries;
+    out += "    </";
+    out += tag;
+    out += ">\n";
+}
+
+/** The files yum and dnf expect in primary.xml so common file requires resolve without filelists */
+bool isPrimaryFile(const QString &path)
+{
+    return path.startsWith(QLatin1String("/etc/")) || path.contains(QLatin1String("bin/"))
+           || path == QLatin1String("/usr/lib/sendmail");
+}
+
+void appendFile(QByteArray &out, const char *indent, const RpmFileEntry &file)
+{
+    out += indent;
+    out += "<file";
+    if (file.isDirectory())
+        out += " type=\"dir\"";
+    else if (file.isGhost())
+        out += " type=\"ghost\"";
+    out += '>';
+    appendEscaped(out, file.path);
+    out += "</file>\n";
+}
+
+int openForReading(const QByteArray &path)
+{
+    // Indexing must not rewrite the atime of every package; O_NOATIME needs ownership or root
+    int fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC | O_NOATIME);
+    if (fd < 0 && errno == EPERM)
+        fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+    return fd;
+}
+
+qint64 mtimeNs(const struct stat &st)
+{
+    return qint64(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+/** Opens @p path once: header decoded, then the whole file hashed in chunks for the pkgid */
+bool indexPackage(const QString &path, const QString &location, RepoIndexer::Fragment &out,
+                  QSemaphore &readGate, qint64 *bytesHashed, QString *error)
+{
+    const int fd = openForReading(QFile::encodeName(path));
+    if (fd < 0) {
+        setError(error, QString::fromLocal8Bit(std::strerror(errno)));
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        setError(error, QObject::tr("Not an RPM package file."));
+        return false;
+    }
+
+    // Read, not mapped: a package truncated underneath a mapping raises SIGBUS
+    RpmPackageFile pkg;
+    pkg.path = path;
+    QByteArray pkgid;
+    bool ok = false;
+    {
+        // One sequential reader per spinning disk; the header pages come first anyway
+        readGate.acquire();
+        const QSemaphoreReleaser release(&readGate);
+        ok = RpmHeaderReader::read(fd, pkg, error, RpmHeaderReader::Full);
+        if (ok) {
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            thread_local QByteArray buffer(ReadChunkBytes, Qt::Uninitialized);
+            Sha256 sha;
+            qint64 hashed = 0;
+            for (;;) {
+                const ssize_t n = ::read(fd, buffer.data(), size_t(buffer.size()));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0) {
+                    setError(error, QString::fromLocal8Bit(std::strerror(errno)));
+                    ok = false;
+                    break;
+                }
+                if (n == 0)
+                    break;
+                sha.update(buffer.constData(), size_t(n));
+                hashed += n;
+            }
+            // The pkgid must cover the file the header and size came from
+            if (ok && hashed != qint64(st.st_size)) {
+                setError(error, QObject::tr("The package changed while it was read."));
+                ok = false;
+            }
+            if (ok) {
+                pkgid = sha.finalize().toHex();
+                *bytesHashed += hashed;
+            }
+        }
+    }
+    ::close(fd);
+    if (!ok)
+        return false;
+
+    RepoIndexer::render(pkg, location, pkgid, qint64(st.st_mtim.tv_sec), out);
+    out.path = location;
+    out.size = qint64(st.st_size);
+    out.mtimeNs = mtimeNs(st);
+    out.inode = quint64(st.st_ino);
+    return true;
+}
+
+/** One entry of repomd.xml */
+struct MetadataFile {
+    QString type;
+    QString href; /** repodata/<checksum>-<type>.xml.gz */
+    QByteArray checksum; /** Of the compressed file */
+    QByteArray openChecksum; /** Of the XML inside */
+    qint64 size = 0;
+    qint64 openSize = 0;
+};
+
+/** Streams header, every fragment and footer through the compressor into @p staging */
+bool writeMetadata(const QString &staging, const QString &type, const QByteArray &header,
+                   const QVector<RepoIndexer::Fragment> &fragments,
+                   QByteArray RepoIndexer::Fragment::*member, const QByteArray &footer,
+                   StreamCompressor::Format format, MetadataFile &out, QString *error)
+{
+    TraceSpan span("repoindex", QStringLiteral("write %1").arg(type));
+    const QString suffix = QStringLiteral(".xml") + StreamCompressor::suffix(format);
+    const QString tempPath = staging + QLatin1Char('/') + type + suffix;
+
+    QFile file(tempPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        setError(error, file.errorString());
+        return false;
+    }
+    StreamCompressor compressor(&file, format);
+    Sha256 open;
+    auto write = [&](const QByteArray &data) {
+        open.update(data.constData(), size_t(data.size()));
+        return compressor.write(data);
+    };
+    bool ok = write(header);
+    for (const RepoIndexer::Fragment &fragment : fragments) {
+        if (!ok)
+            break;
+        ok = write(fragment.*member);
+    }
+    ok = ok && write(footer) && compressor.finish();
+    file.close();
+    if (!ok) {
+        setError(error, compressor.errorString());
+        return false;
+    }
+
+    out.type = type;
+    out.openChecksum = open.finalize().toHex();
+    out.openSize = compressor.bytesIn();
+    out.size = compressor.bytesOut();
+    out.checksum = FileVerifier::fileDigest(tempPath, HashAlgoSha256, nullptr, error);
+    if (out.checksum.isEmpty())
+        return false;
+
+    // Content-addressed names: a client mid-download never mixes two generations
+    const QString name = QString::fromLatin1(out.checksum) + QLatin1Char('-') + type + suffix;
+    if (!QFile::rename(tempPath, staging + QLatin1Char('/') + name)) {
+        setError(error, QObject::tr("Cannot rename %1.").arg(tempPath));
+        return false;
+    }
+    out.href = QStringLiteral("repodata/") + name;
+    return true;
+}
+
+QByteArray repomdXml(const QVector<MetadataFile> &files, qint64 revision)
+{
+    QByteArray xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                     "<repomd xmlns=\"http://linux.duke.edu/metadata/repo\" "
+                     "xmlns:rpm=\"http://linux.duke.edu/metadata/rpm\">\n";
+    xml += "  <revision>" + QByteArray::number(revision) + "</revision>\n";
+    for (const MetadataFile &file : files) {
+        xml += "  <data type=\"" + file.type.toUtf8() + "\">\n";
+        xml += "    <checksum type=\"sha256\">" + file.checksum + "</checksum>\n";
+        xml += "    <open-checksum type=\"sha256\">" + file.openChecksum + "</open-checksum>\n";
+        xml += "    <location href=\"" + file.href.toUtf8() + "\"/>\n";
+        xml += "    <timestamp>" + QByteArray::number(revision) + "</timestamp>\n";
+        xml += "    <size>" + QByteArray::number(file.size) + "</size>\n";
+        xml += "    <open-size>" + QByteArray::number(file.openSize) + "</open-size>\n";
+        xml += "  </data>\n";
+    }
+    xml += "</repomd>\n";
+    return xml;
+}
+
+} // namespace
+
+void RepoIndexer::render(const RpmPackageFile &pkg, const QString &location, const QByteArray &pkgid,
+                         qint64 mtime, Fragment &out)
+{
+    const QString id = QString::fromLatin1(pkgid);
+
+    QByteArray &primary = out.primary;
+    primary.clear();
+    primary += "<package type=\"rpm\">\n";
+    appendElement(primary, "  ", "name", pkg.name);
+    appendElement(primary, "  ", "arch", pkg.arch);
+    primary += "  <version";
+    appendVersion(primary, pkg);
+    primary += "/>\n";
+    primary += "  <checksum type=\"sha256\" pkgid=\"YES\">" + pkgid + "</checksum>\n";
+    appendElement(primary, "  ", "summary", pkg.summary);
+    appendElement(primary, "  ", "description", pkg.description);
+    appendElement(primary, "  ", "packager", pkg.packager);
+    appendElement(primary, "  ", "url", pkg.url);
+    primary += "  <time file=\"" + QByteArray::number(mtime) + "\" build=\""
+               + QByteArray::number(pkg.buildTime) + "\"/>\n";
+    primary += "  <size package=\"" + QByteArray::number(pkg.fileSize) + "\" installed=\""
+               + QByteArray::number(pkg.installedSize) + "\" archive=\""
+               + QByteArray::number(pkg.archiveSize) + "\"/>\n";
+    primary += "  <location";
+    appendAttribute(primary, "href", location);
+    primary += "/>\n";
+    primary += "  <format>\n";
+    appendElement(primary, "    ", "rpm:license", pkg.license);
+    appendElement(primary, "    ", "rpm:vendor", pkg.vendor);
+    appendElement(primary, "    ", "rpm:group", pkg.group);
+    appendElement(primary, "    ", "rpm:buildhost", pkg.buildHost);
+    appendElement(primary, "    ", "rpm:sourcerpm", pkg.sourceRpm);
+    primary += "    <rpm:header-range start=\"" + QByteArray::number(pkg.headerStart) + "\" end=\""
+               + QByteArray::number(pkg.headerEnd) + "\"/>\n";
+    appendDependencies(primary, "rpm:provides", pkg.provides, false);
+    appendDependencies(primary, "rpm:requires", pkg.requires, true);
+    appendDependencies(primary, "rpm:conflicts", pkg.conflicts, false);
+    appendDependencies(primary, "rpm:obsoletes", pkg.obsoletes, false);
+    for (const RpmFileEntry &file : pkg.files) {
+        if (isPrimaryFile(file.path))
+            appendFile(primary, "    ", file);
+    }
+    primary += "  </format>\n</package>\n";
+
+    QByteArray packageStart = "<package";
+    appendAttribute(packageStart, "pkgid", id);
+    appendAttribute(packageStart, "name", pkg.name);
+    appendAttribute(packageStart, "arch", pkg.arch);
+    packageStart += ">\n  <version";
+    appendVersion(packageStart, pkg);
+    packageStart += "/>\n";
+
+    QByteArray &filelists = out.filelists;
+    filelists = packageStart;
+    for (const RpmFileEntry &file : pkg.files)
+        appendFile(filelists, "  ", file);
+    filelists += "</package>\n";
+
+    QByteArray &other = out.other;
+    other = packageStart;
+    for (const RpmChangelogEntry &entry : pkg.changelog) {
+        other += "  <changelog";
+        appendAttribute(other, "author", entry.author);
+        other += " date=\"" + QByteArray::number(entry.time) + "\">";
+        appendEscaped(other, entry.text);
+        other += "</changelog>\n";
+    }
+    other += "</package>\n";
+}
+
+bool RepoIndexer::loadCache(const QString &path, QHash<QString, Fragment> &out)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream header(&file);
+    header.setVersion(StreamVersion);
+    quint32 magic = 0;
+    quint32 version = 0;
+    header >> magic >> version;
+    if (header.status() != QDataStream::Ok || magic != CacheMagic || version != CacheVersion)
+        return false;
+
+    QByteArray body;
+    StreamDecompressor input(&file, StreamDecompressor::Format::Zstd);
+    QByteArray chunk(256 * 1024, Qt::Uninitialized);
+    for (;;) {
+        const qint64 n = input.read(chunk.data(), chunk.size());
+        if (n < 0)
+            return false;
+        if (n == 0)
+            break;
+        body.append(chunk.constData(), n);
+    }
+
+    QDataStream stream(body);
+    stream.setVersion(StreamVersion);
+    quint32 count = 0;
+    stream >> count;
+    QHash<QString, Fragment> fragments;
+    fragments.reserve(qMin<quint32>(count, 1u << 20));
+    for (quint32 i = 0; i < count; ++i) {
+        Fragment fragment;
+        stream >> fragment.path >> fragment.size >> fragment.mtimeNs >> fragment.inode
+            >> fragment.primary >> fragment.filelists >> fragment.other;
+        if (stream.status() != QDataStream::Ok)
+            return false;
+        fragments.insert(fragment.path, std::move(fragment));
+    }
+    out = std::move(fragments);
+    return true;
+}
+
+bool RepoIndexer::saveCache(const QString &path, const QVector<Fragment> &fragments, QString *error)
+{
+    QByteArray body;
+    {
+        QDataStream stream(&body, QIODevice::WriteOnly);
+        stream.setVersion(StreamVersion);
+        stream << quint32(fragments.size());
+        for (const Fragment &fragment : fragments) {
+            stream << fragment.path << fragment.size << fragment.mtimeNs << fragment.inode
+                   << fragment.primary << fragment.filelists << fragment.other;
+        }
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        setError(error, file.errorString());
+        return false;
+    }
+    {
+        QDataStream header(&file);
+        header.setVersion(StreamVersion);
+        header << CacheMagic << CacheVersion;
+    }
+    // Fast level: the fragments are rewritten on every run
+    StreamCompressor compressor(&file, StreamCompressor::Format::Zstd, 3);
+    if (!compressor.write(body) || !compressor.finish()) {
+        setError(error, compressor.errorString());
+        file.cancelWriting();
+        return false;
+    }
+    if (!file.commit()) {
+        setError(error, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool RepoIndexer::index(const QString &directory, RepoIndexStats *stats, QString *error)
+{
+    TraceSpan span("repoindex", "RepoIndexer::index");
+    QElapsedTimer timer;
+    timer.start();
+    m_cancelled.store(false);
+    m_done.store(0);
+
+    const QDir root(QFileInfo(directory).absoluteFilePath());
+    if (!root.exists()) {
+        setError(error, QObject::tr("%1 does not exist.").arg(directory));
+        return false;
+    }
+    const QString repodata = root.filePath(QStringLiteral("repodata"));
+    const QString cachePath = m_options.cachePath.isEmpty()
+        ? repodata + QLatin1Char('/') + CacheName : m_options.cachePath;
+
+    QStringList locations;
+    {
+        TraceSpan walk("repoindex", "walk");
+        QDirIterator it(root.path(), {QStringLiteral("*.rpm")}, QDir::Files,
+                        QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+        while (it.hasNext()) {
+            const QString location = root.relativeFilePath(it.next());
+            // Our own staging directories, and hidden ones in general
+            if (location.startsWith(QLatin1Char('.')) || location.contains(QLatin1String("/.")))
+                continue;
+            locations.append(location);
+        }
+        std::sort(locations.begin(), locations.end());
+        walk.arg("packages", locations.size());
+    }
+
+    QHash<QString, Fragment> cache;
+    if (m_options.useCache)
+        loadCache(cachePath, cache);
+
+    const int threads = m_options.threads > 0 ? m_options.threads : QThread::idealThreadCount();
+    bool rotational = false;
+    struct stat rootStat;
+    if (::stat(QFile::encodeName(root.path()).constData(), &rootStat) == 0)
+        FileVerifier::diskKey(quint64(rootStat.st_dev), &rotational);
+    QSemaphore readGate(rotational ? std::max(1, m_options.rotationalConcurrency) : threads);
+    span.arg("threads", threads);
+    span.arg("rotational", rotational);
+
+    const int count = int(locations.size());
+    QVector<Fragment> fragments(count);
+    QVector<QString> errors(count);
+    // Raw pointers: each index is written by one thread, and nothing may detach meanwhile
+    Fragment *const results = fragments.data();
+    QString *const resultErrors = errors.data();
+    std::atomic<int> reused{0};
+    std::atomic<qint64> hashed{0};
+    parallelFor(count, threads, [&](int i) {
+        if (m_cancelled.load(std::memory_order_relaxed))
+            return;
+        const QString &location = locations.at(i);
+        const QString path = root.filePath(location);
+
+        struct stat st;
+        const auto cached = cache.constFind(location);
+        if (cached != cache.cend() && ::stat(QFile::encodeName(path).constData(), &st) == 0
+            && cached->size == qint64(st.st_size) && cached->mtimeNs == mtimeNs(st)
+            && cached->inode == quint64(st.st_ino)) {
+            results[i] = cached.value();
+            reused.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            qint64 bytes = 0;
+            if (!indexPackage(path, location, results[i], readGate, &bytes, &resultErrors[i]))
+                results[i] = Fragment();
+            hashed.fetch_add(bytes, std::memory_order_relaxed);
+        }
+        m_done.fetch_add(1, std::memory_order_relaxed);
+    });
+    if (m_cancelled.load()) {
+        setError(error, QObject::tr("Indexing was cancelled."));
+        return false;
+    }
+
+    RepoIndexStats result;
+    QVector<Fragment> indexed;
+    indexed.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        if (fragments.at(i).primary.isEmpty()) {
+            ++result.failed;
+            result.errors.append(QStringLiteral("%1: %2").arg(locations.at(i), errors.at(i)));
+            continue;
+        }
+        indexed.append(std::move(fragments[i]));
+    }
+    fragments = {};
+    result.packages = int(indexed.size());
+    result.reused = reused.load();
+    result.parsed = result.packages - result.reused;
+    result.bytesHashed = hashed.load();
+
+    // Build the new generation next to the old one, then swap with two renames
+    const QString staging = root.filePath(StagingName);
+    const QString retired = root.filePath(RetiredName);
+    QDir(staging).removeRecursively();
+    QDir(retired).removeRecursively();
+    if (!root.mkdir(StagingName)) {
+        setError(error, QObject::tr("Cannot create %1.").arg(staging));
+        return false;
+    }
+
+    const QByteArray packages = QByteArray::number(result.packages);
+    const QByteArray primaryHeader = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                                     "<metadata xmlns=\"http://linux.duke.edu/metadata/common\" "
+                                     "xmlns:rpm=\"http://linux.duke.edu/metadata/rpm\" packages=\""
+                                     + packages + "\">\n";
+    const QByteArray filelistsHeader = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                                       "<filelists xmlns=\"http://linux.duke.edu/metadata/filelists\" packages=\""
+                                       + packages + "\">\n";
+    const QByteArray otherHeader = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                                   "<otherdata xmlns=\"http://linux.duke.edu/metadata/other\" packages=\""
+                                   + packages + "\">\n";
+
+    QVector<MetadataFile> files(3);
+    const StreamCompressor::Format format = m_options.compression;
+    if (!writeMetadata(staging, QStringLiteral("primary"), primaryHeader, indexed, &Fragment::primary,
+                       "</metadata>\n", format, files[0], error)
+        || !writeMetadata(staging, QStringLiteral("filelists"), filelistsHeader, indexed,
+                          &Fragment::filelists, "</filelists>\n", format, files[1], error)
+        || !writeMetadata(staging, QStringLiteral("other"), otherHeader, indexed, &Fragment::other,
+                          "</otherdata>\n", format, files[2], error)) {
+        QDir(staging).removeRecursively();
+        return false;
+    }
+
+    QSaveFile repomd(staging + QStringLiteral("/repomd.xml"));
+    const QByteArray repomdData = repomdXml(files, QDateTime::currentSecsSinceEpoch());
+    if (!repomd.open(QIODevice::WriteOnly) || repomd.write(repomdData) != repomdData.size()
+        || !repomd.commit()) {
+        setError(error, repomd.errorString());
+        QDir(staging).removeRecursively();
+        return false;
+    }
+
+    const bool hadRepodata = QFileInfo::exists(repodata);
+    if (hadRepodata && !QFile::rename(repodata, retired)) {
+        setError(error, QObject::tr("Cannot replace %1.").arg(repodata));
+        QDir(staging).removeRecursively();
+        return false;
+    }
+    if (!QFile::rename(staging, repodata)) {
+        // Put the old generation back: a repository without repodata/ is unusable
+        if (hadRepodata && !QFile::rename(retired, repodata))
+            RingLog::write(RingLog::Error, "repoindex: cannot restore %1", repodata);
+        setError(error, QObject::tr("Cannot replace %1.").arg(repodata));
+        QDir(staging).removeRecursively();
+        return false;
+    }
+    if (hadRepodata)
+        QDir(retired).removeRecursively();
+
+    // A stale cache only costs a full re-read next time
+    QString cacheError;
+    if (!saveCache(cachePath, indexed, &cacheError))
+        RingLog::write(RingLog::Warning, "repoindex: index cache not saved: %1", cacheError);
+
+    result.elapsedMs = timer.elapsed();
+    span.arg("packages", result.packages);
+    span.arg("reused", result.reused);
+    span.arg("bytesHashed", result.bytesHashed);
+    if (stats)
+        *stats = std::move(result);
+    return true;
+}
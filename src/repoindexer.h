@@ -0,0 +1,89 @@
+/**
+ * @file repoindexer.h
+ * @author Nikolay Yevik
+ * @brief Builds repository metadata (createrepo) for a directory of .rpm
+ * files, in parallel and incrementally, for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+
+#include "decompressor.h"
+#include "rpmheader.h"
+
+struct RepoIndexStats {
+    int packages = 0; /** Packages in the written metadata */
+    int reused = 0; /** Unchanged since the last run: taken from the index cache */
+    int parsed = 0; /** Read, hashed and rendered this run */
+    int failed = 0; /** .rpm files that could not be read; listed in errors */
+    qint64 bytesHashed = 0;
+    qint64 elapsedMs = 0;
+    QStringList errors;
+};
+
+/**
+ * Walks the directory for .rpm files and writes repodata/ with
+ * primary, filelists and other metadata plus repomd.xml, like createrepo_c.
+ * Every new or changed package is opened once on a pool of threads: the
+ * header is decoded and the whole file hashed in chunks for the pkgid. Each
+ * package's three XML fragments are kept in an index cache keyed on size,
+ * mtime and inode, so a re-run only reads what changed. The new repodata/
+ * is built next to the old one and swapped in with renames; other metadata
+ * there (comps, updateinfo) is not carried over.
+ */
+class RepoIndexer
+{
+public:
+    struct Options {
+        int threads = 0; /** 0: QThread::idealThreadCount() */
+        int rotationalConcurrency = 1; /** Concurrent package readers on a spinning disk */
+        StreamCompressor::Format compression = StreamCompressor::Format::Gzip;
+        bool useCache = true; /** false: re-read every package (the cache is still written) */
+        QString cachePath; /** Empty: repodata/.turborpm-index in the directory */
+    };
+
+    /** One package's share of each metadata file, as cached between runs */
+    struct Fragment {
+        QString path; /** Relative to the indexed directory */
+        qint64 size = 0;
+        qint64 mtimeNs = 0;
+        quint64 inode = 0;
+        QByteArray primary;
+        QByteArray filelists;
+        QByteArray other;
+    };
+
+    RepoIndexer() = default;
+    explicit RepoIndexer(const Options &options) : m_options(options) {}
+
+    /** Indexes @p directory; false with @p error only when no metadata could be written */
+    bool index(const QString &directory, RepoIndexStats *stats = nullptr, QString *error = nullptr);
+
+    /** Renders @p pkg's fragments; @p location is its href, @p pkgid the SHA-256 of the file */
+    static void render(const RpmPackageFile &pkg, const QString &location, const QByteArray &pkgid,
+                       qint64 mtime, Fragment &out);
+
+    static bool loadCache(const QString &path, QHash<QString, Fragment> &out);
+    static bool saveCache(const QString &path, const QVector<Fragment> &fragments, QString *error = nullptr);
+
+    /** Safe from any thread; index() then fails without touching repodata/ */
+    void cancel() { m_cancelled.store(true); }
+    /** Packages looked at so far in the running index(), for progress reports */
+    int packagesDone() const { return m_done.load(std::memory_order_relaxed); }
+
+private:
+    Options m_options;
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<int> m_done{0};
+};
+
+Q_DECLARE_METATYPE(RepoIndexStats)
@@ -0,0 +1,401 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the cached repository metadata reader for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "repometadata.h"
+#include "decompressor.h"
+#include "trace.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QObject>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <QXmlStreamReader>
+
+#include <utility>
+
+namespace {
+    constexpr qint64 XmlChunkBytes {256 * 1024};
+
+    enum class PrimaryField {
+        None,
+        Name,
+        Arch,
+        Summary,
+        Group
+    };
+
+    /** $name and ${name}; unknown variables stay as written, as dnf leaves them */
+    QString expandVariables(const QString &text, const QHash<QString, QString> &vars)
+    {
+        if (!text.contains(QLatin1Char('$')))
+            return text;
+        static const QRegularExpression variable(QStringLiteral("\\$(?:\\{(\\w+)\\}|(\\w+))"));
+        QString result;
+        qsizetype last = 0;
+        QRegularExpressionMatchIterator it = variable.globalMatch(text);
+        while (it.hasNext()) {
+            const QRegularExpressionMatch match = it.next();
+            const QString name = match.captured(1).isEmpty() ? match.captured(2) : match.captured(1);
+            result += QStringView(text).mid(last, match.capturedStart() - last);
+            const auto value = vars.constFind(name);
+            result += value != vars.constEnd() ? *value : match.captured();
+            last = match.capturedEnd();
+        }
+        result += QStringView(text).mid(last);
+        return result;
+    }
+
+    /** The spellings libdnf accepts for a true boolean option */
+    bool isTrue(const QString &value)
+    {
+        return value == QLatin1String("1") || value.compare(QLatin1String("yes"), Qt::CaseInsensitive) == 0
+               || value.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0
+               || value.compare(QLatin1String("on"), Qt::CaseInsensitive) == 0;
+    }
+
+    /** VERSION_ID from os-release, quotes removed */
+    QString osReleaseVersion()
+    {
+        for (const QString &path : {QStringLiteral("/etc/os-release"), QStringLiteral("/usr/lib/os-release")}) {
+            QFile file(path);
+            if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+                continue;
+            while (!file.atEnd()) {
+                const QString line = QString::fromUtf8(file.readLine()).trimmed();
+                if (!line.startsWith(QLatin1String("VERSION_ID=")))
+                    continue;
+                QString value = line.mid(11);
+                if (value.size() >= 2 && (value.startsWith(QLatin1Char('"')) || value.startsWith(QLatin1Char('\''))))
+                    value = value.mid(1, value.size() - 2);
+                return value;
+            }
+        }
+        return {};
+    }
+}
+
+QStringList RepoMetadataCache::defaultCacheRoots()
+{
+    QStringList roots{QStringLiteral("/var/cache/libdnf5"), QStringLiteral("/var/cache/dnf")};
+    const QString userCache = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (!userCache.isEmpty())
+        roots << userCache + QStringLiteral("/libdnf5");
+    return roots;
+}
+
+QStringList RepoMetadataCache::defaultRepoConfigDirs()
+{
+    return {QStringLiteral("/etc/yum.repos.d"), QStringLiteral("/etc/dnf/repos.override.d")};
+}
+
+QHash<QString, QString> RepoMetadataCache::repoVariables()
+{
+    QHash<QString, QString> vars;
+    const QString arch = QSysInfo::kernelArchitecture();
+    static const QRegularExpression x86(QStringLiteral("^i[3-6]86$"));
+    QString basearch = arch;
+    if (x86.match(arch).hasMatch())
+        basearch = QStringLiteral("i386");
+    else if (arch.startsWith(QLatin1String("armv7")))
+        basearch = QStringLiteral("armhfp");
+    vars.insert(QStringLiteral("arch"), arch);
+    vars.insert(QStringLiteral("basearch"), basearch);
+
+    const QString releasever = osReleaseVersion();
+    if (!releasever.isEmpty())
+        vars.insert(QStringLiteral("releasever"), releasever);
+
+    // One file per variable, named after it; these override the detected values
+    const QFileInfoList files = QDir(QStringLiteral("/etc/dnf/vars")).entryInfoList(QDir::Files | QDir::Readable);
+    for (const QFileInfo &info : files) {
+        QFile file(info.absoluteFilePath());
+        if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+            vars.insert(info.fileName(), QString::fromUtf8(file.readLine()).trimmed());
+    }
+    return vars;
+}
+
+QSet<QString> RepoMetadataCache::enabledRepoIds(const QStringList &configDirs,
+                                                const QHash<QString, QString> &vars)
+{
+    // id -> enabled; later files win, and a glob section ("[*-testing]" in
+    // repos.override.d) applies to every id configured before it
+    QHash<QString, bool> repos;
+    for (const QString &dir : configDirs) {
+        const QFileInfoList files = QDir(dir).entryInfoList({QStringLiteral("*.repo")},
+                                                             QDir::Files | QDir::Readable, QDir::Name);
+        for (const QFileInfo &info : files) {
+            QFile file(info.absoluteFilePath());
+            if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+                continue;
+
+            QStringList section;
+            while (!file.atEnd()) {
+                const QString line = QString::fromUtf8(file.readLine()).trimmed();
+                if (line.isEmpty() || line.startsWith(QLatin1Char('#')) || line.startsWith(QLatin1Char(';')))
+                    continue;
+                if (line.startsWith(QLatin1Char('[')) && line.endsWith(QLatin1Char(']'))) {
+                    const QString id = expandVariables(line.mid(1, line.size() - 2).trimmed(), vars);
+                    section.clear();
+                    if (id.isEmpty() || id == QLatin1String("main"))
+                        continue;
+                    if (id.contains(QLatin1Char('*')) || id.contains(QLatin1Char('?'))) {
+                        const QRegularExpression glob(QRegularExpression::wildcardToRegularExpression(id));
+                        for (auto it = repos.cbegin(); it != repos.cend(); ++it) {
+                            if (glob.match(it.key()).hasMatch())
+                                section << it.key();
+                        }
+                    } else {
+                        repos.insert(id, repos.value(id, true));
+                        section << id;
+                    }
+                    continue;
+                }
+                const qsizetype equals = line.indexOf(QLatin1Char('='));
+                if (equals < 0 || QStringView(line).left(equals).trimmed() != QLatin1String("enabled"))
+                    continue;
+                const bool enabled = isTrue(line.mid(equals + 1).trimmed());
+                for (const QString &id : std::as_const(section))
+                    repos[id] = enabled;
+            }
+        }
+    }
+
+    QSet<QString> enabled;
+    for (auto it = repos.cbegin(); it != repos.cend(); ++it) {
+        if (it.value())
+            enabled.insert(it.key());
+    }
+    return enabled;
+}
+
+QString RepoMetadataCache::repoIdFromCacheDir(const QString &dirName)
+{
+    // dnf appends "-<16 hex digit hash>" of the repo configuration
+    static const QRegularExpression hashSuffix(QStringLiteral("-[0-9a-f]{16}$"));
+    QString id = dirName;
+    id.remove(hashSuffix);
+    return id;
+}
+
+QString RepoMetadataCache::locate(const QString &repoDir, const QString &type)
+{
+    QFile repomd(repoDir + QStringLiteral("/repodata/repomd.xml"));
+    if (repomd.open(QIODevice::ReadOnly)) {
+        QXmlStreamReader xml(&repomd);
+        bool inWanted = false;
+        while (!xml.atEnd()) {
+            xml.readNext();
+            if (xml.isStartElement()) {
+                if (xml.name() == QLatin1String("data"))
+                    inWanted = xml.attributes().value(QLatin1String("type")) == type;
+                else if (inWanted && xml.name() == QLatin1String("location")) {
+                    const QString href = xml.attributes().value(QLatin1String("href")).toString();
+                    const QString path = repoDir + QLatin1Char('/') + href;
+                    if (QFileInfo::exists(path))
+                        return path;
+                }
+            } else if (xml.isEndElement() && xml.name() == QLatin1String("data")) {
+                inWanted = false;
+            }
+        }
+    }
+
+    // No (readable) repomd.xml: fall back to the newest matching file
+    QDir repodata(repoDir + QStringLiteral("/repodata"));
+    const QFileInfoList candidates = repodata.entryInfoList(
+        {QStringLiteral("*-%1.xml*").arg(type), QStringLiteral("%1.xml*").arg(type)},
+        QDir::Files, QDir::Time);
+    for (const QFileInfo &info : candidates) {
+        if (!info.fileName().contains(QLatin1String(".sqlite")))
+            return info.absoluteFilePath();
+    }
+    return {};
+}
+
+QVector<RepoMetadataFile> RepoMetadataCache::find(const QString &type, const QStringList &cacheRoots,
+                                                  const QStringList &repoConfigDirs)
+{
+    QVector<RepoMetadataFile> result;
+    QHash<QString, int> byRepo;
+    // dnf keeps the cache of a repo after it is disabled
+    const QSet<QString> enabled = enabledRepoIds(repoConfigDirs);
+
+    for (const QString &root : cacheRoots) {
+        const QFileInfoList repoDirs = QDir(root).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+        for (const QFileInfo &dir : repoDirs) {
+            const QString repoId = repoIdFromCacheDir(dir.fileName());
+            if (!enabled.isEmpty() && !enabled.contains(repoId))
+                continue;
+            const QString path = locate(dir.absoluteFilePath(), type);
+            if (path.isEmpty())
+                continue;
+
+            const auto it = byRepo.constFind(repoId);
+            if (it == byRepo.constEnd()) {
+                byRepo.insert(repoId, result.size());
+                result.append(RepoMetadataFile{repoId, path});
+            } else if (QFileInfo(path).lastModified()
+                       > QFileInfo(result.at(*it).path).lastModified()) {
+                // Same repo cached twice (dnf4 + dnf5): keep the fresher copy
+                result[*it].path = path;
+            }
+        }
+    }
+    return result;
+}
+
+bool PrimaryMetadataReader::readFile(const QString &path, const QString &repoId, const Sink &sink)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_error = QObject::tr("Cannot open %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    return read(&file, repoId, sink);
+}
+
+bool PrimaryMetadataReader::read(QIODevice *device, const QString &repoId, const Sink &sink)
+{
+    m_error.clear();
+    m_packagesRead = 0;
+
+    TraceSpan span("parse", QStringLiteral("primary.xml %1").arg(repoId));
+    StreamDecompressor input(device);
+    QXmlStreamReader xml;
+    QByteArray chunk(XmlChunkBytes, Qt::Uninitialized);
+
+    int depth = 0;
+    int packageDepth = -1;
+    PrimaryField field = PrimaryField::None;
+    QString text;
+    RepoPackage current;
+    bool sawEndDocument = false;
+
+    for (;;) {
+        const qint64 n = input.read(chunk.data(), chunk.size());
+        if (n < 0) {
+            m_error = input.errorString();
+            return false;
+        }
+        if (n > 0)
+            xml.addData(QByteArray(chunk.constData(), n));
+
+        while (!xml.atEnd()) {
+            switch (xml.readNext()) {
+            case QXmlStreamReader::StartElement: {
+                ++depth;
+                const QStringView name = xml.name();
+                if (packageDepth < 0) {
+                    if (name == QLatin1String("package")) {
+                        packageDepth = depth;
+                        current = RepoPackage();
+                        current.info.epoch = QStringLiteral("0");
+                        current.info.repo = repoId;
+                    }
+                    break;
+                }
+
+                const int level = depth - packageDepth;
+                if (level == 1) {
+                    if (name == QLatin1String("name"))
+                        field = PrimaryField::Name;
+                    else if (name == QLatin1String("arch"))
+                        field = PrimaryField::Arch;
+                    else if (name == QLatin1String("summary"))
+                        field = PrimaryField::Summary;
+                    else if (name == QLatin1String("version")) {
+                        const QXmlStreamAttributes attrs = xml.attributes();
+                        const QStringView epoch = attrs.value(QLatin1String("epoch"));
+                        if (!epoch.isEmpty())
+                            current.info.epoch = epoch.toString();
+                        current.info.version = attrs.value(QLatin1String("ver")).toString()
+                                               + QLatin1Char('-')
+                                               + attrs.value(QLatin1String("rel")).toString();
+                    } else if (name == QLatin1String("size")) {
+                        const QString installed = xml.attributes().value(QLatin1String("installed")).toString();
+                        bool ok = false;
+                        const qint64 bytes = installed.toLongLong(&ok);
+                        if (ok) {
+                            current.info.size = installed;
+                            current.info.sizeBytes = bytes;
+                        }
+                    } else if (name == QLatin1String("location")) {
+                        current.location = xml.attributes().value(QLatin1String("href")).toString();
+                    }
+                } else if (level == 2 && name == QLatin1String("group")) {
+                    field = PrimaryField::Group;
+                }
+                if (field != PrimaryField::None)
+                    text.clear();
+                break;
+            }
+            case QXmlStreamReader::Characters:
+                if (field != PrimaryField::None)
+                    text += xml.text();
+                break;
+            case QXmlStreamReader::EndElement: {
+                if (packageDepth >= 0) {
+                    switch (field) {
+                    case PrimaryField::Name:
+                        current.info.name = text.trimmed();
+                        break;
+                    case PrimaryField::Arch:
+                        current.info.arch = text.trimmed();
+                        break;
+                    case PrimaryField::Summary:
+                        current.info.summary = text.trimmed();
+                        break;
+                    case PrimaryField::Group:
+                        current.info.group = text.trimmed();
+                        break;
+                    case PrimaryField::None:
+                        break;
+                    }
+                    field = PrimaryField::None;
+
+                    if (depth == packageDepth) {
+                        packageDepth = -1;
+                        if (!current.info.name.isEmpty() && !current.info.arch.isEmpty()) {
+                            ++m_packagesRead;
+                            sink(current);
+                        }
+                    }
+                }
+                --depth;
+                break;
+            }
+            case QXmlStreamReader::EndDocument:
+                sawEndDocument = true;
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (xml.hasError() && xml.error() != QXmlStreamReader::PrematureEndOfDocumentError) {
+            m_error = QObject::tr("Malformed metadata at line %1: %2")
+                          .arg(xml.lineNumber())
+                          .arg(xml.errorString());
+            return false;
+        }
+
+        if (n == 0)
+            break;
+    }
+
+    span.arg("compressedBytes", input.compressedBytesRead());
+    span.arg("packages", m_packagesRead);
+    if (!sawEndDocument) {
+        m_error = QObject::tr("Metadata ended prematurely.");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file repometadata.h
+ * @author Nikolay Yevik
+ * @brief Streaming reader for locally cached repository metadata (primary.xml)
+ * for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+#include "packagemodel.h"
+
+class QIODevice;
+
+struct RepoPackage {
+    PackageInfo info; /** Same fields as an installed row; installDate stays empty */
+    QString location; /** Package location relative to the repository base URL */
+};
+
+struct RepoMetadataFile {
+    QString repoId; /** Repository id derived from the cache directory */
+    QString path; /** Absolute path of the (possibly compressed) metadata file */
+};
+
+class RepoMetadataCache
+{
+public:
+    /** libdnf5 and dnf4 system caches plus the per-user libdnf5 cache */
+    static QStringList defaultCacheRoots();
+    /** /etc/yum.repos.d, then dnf5's /etc/dnf/repos.override.d, in the order dnf reads them */
+    static QStringList defaultRepoConfigDirs();
+    /** $releasever (os-release VERSION_ID), $arch, $basearch and /etc/dnf/vars */
+    static QHash<QString, QString> repoVariables();
+    /**
+     * Ids of the repositories the *.repo files under @p configDirs leave
+     * enabled (no "enabled=" means enabled), with @p vars expanded in the ids.
+     * Empty when no repository is configured there at all.
+     */
+    static QSet<QString> enabledRepoIds(const QStringList &configDirs = defaultRepoConfigDirs(),
+                                        const QHash<QString, QString> &vars = repoVariables());
+    /** "fedora-2c4e1f0f5a1c3d8e" -> "fedora" */
+    static QString repoIdFromCacheDir(const QString &dirName);
+    /**
+     * Finds one metadata file of @p type ("primary", "updateinfo", ...) per
+     * cached repo that is enabled under @p repoConfigDirs. Disabled repos keep
+     * their cache; without any repo configuration every cached repo counts.
+     */
+    static QVector<RepoMetadataFile> find(const QString &type,
+                                          const QStringList &cacheRoots = defaultCacheRoots(),
+                                          const QStringList &repoConfigDirs = defaultRepoConfigDirs());
+    /** Resolves @p type through repodata/repomd.xml of one cached repo directory */
+    static QString locate(const QString &repoDir, const QString &type);
+};
+
+class PrimaryMetadataReader
+{
+public:
+    using Sink = std::function<void(const RepoPackage &pkg)>;
+
+    /** Streams @p device (gz/xz/zstd/plain) and calls @p sink once per package */
+    bool read(QIODevice *device, const QString &repoId, const Sink &sink);
+    bool readFile(const QString &path, const QString &repoId, const Sink &sink);
+
+    QString errorString() const { return m_error; }
+    qint64 packagesRead() const { return m_packagesRead; }
+
+private:
+    QString m_error;
+    qint64 m_packagesRead = 0;
+};
@@ -0,0 +1,388 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the ring-buffer log for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "ringlog.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr int MaxRings {256}; // threads logging at the same time
+constexpr int FlushIntervalMs {250};
+constexpr qint64 DefaultMaxFileBytes {4 * 1024 * 1024};
+
+struct Record {
+    qint64 timeNs; // LogState::clock
+    const char *format;
+    qint64 a;
+    qint64 b;
+    quint32 thread;
+    quint8 level;
+    quint8 textArg; // placeholder number the text goes to
+    quint8 textSize;
+    bool truncated;
+    char text[RingLog::TextCapacity];
+};
+static_assert(sizeof(Record) == 128, "records are two cache lines");
+
+/** Single producer (the owning thread), single consumer (whoever holds flushMutex) */
+struct Ring {
+    explicit Ring(quint32 number) : number(number) {}
+
+    const quint32 number;
+    std::atomic<bool> owned {true};
+    alignas(64) std::atomic<quint64> head {0}; // next slot to write
+    alignas(64) std::atomic<quint64> tail {0}; // next slot to read
+    Record records[RingLog::RingCapacity];
+};
+
+struct LogState {
+    LogState()
+        : wallBaseMs(QDateTime::currentMSecsSinceEpoch())
+    {
+        clock.start();
+    }
+
+    QElapsedTimer clock;
+    const qint64 wallBaseMs; // wall clock when clock started
+
+    QMutex ringsMutex; // guards rings
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::atomic<quint64> dropped {0};
+
+    QMutex flushMutex; // one consumer at a time; guards everything below
+    QString path;
+    qint64 maxFileBytes = DefaultMaxFileBytes;
+    quint64 reportedDropped = 0;
+
+    QMutex historyMutex;
+    std::deque<RingLog::Entry> history;
+    quint64 nextSeq = 1;
+
+    QMutex wakeMutex;
+    QWaitCondition wake;
+    bool stopping = false;
+    QThread *flusher = nullptr;
+};
+
+LogState &state()
+{
+    // Never destroyed: threads still running at exit may log
+    static LogState *s = new LogState;
+    return *s;
+}
+
+Ring *claimRing()
+{
+    LogState &s = state();
+    QMutexLocker lock(&s.ringsMutex);
+    for (const auto &ring : s.rings) {
+        if (ring->owned.load(std::memory_order_acquire))
+            continue;
+        // Only once the flusher has read what the previous thread left
+        if (ring->head.load(std::memory_order_acquire) != ring->tail.load(std::memory_order_acquire))
+            continue;
+        ring->owned.store(true, std::memory_order_relaxed);
+        return ring.get();
+    }
+    if (int(s.rings.size()) >= MaxRings)
+        return nullptr;
+    s.rings.push_back(std::make_unique<Ring>(quint32(s.rings.size() + 1)));
+    return s.rings.back().get();
+}
+
+/** Hands the ring back when its thread exits */
+struct RingOwner {
+    Ring *ring = nullptr;
+    bool exhausted = false;
+
+    ~RingOwner()
+    {
+        if (ring)
+            ring->owned.store(false, std::memory_order_release);
+    }
+};
+
+QString formatMessage(const Record &record)
+{
+    QString message = QString::fromUtf8(record.format);
+    if (record.textArg > 1)
+        message.replace(QLatin1String("%1"), QString::number(record.a));
+    if (record.textArg > 2)
+        message.replace(QLatin1String("%2"), QString::number(record.b));
+    // Last, so a %1 in the text stays as it is
+    QString text = QString::fromLatin1(record.text, record.textSize);
+    if (record.truncated)
+        text += QStringLiteral("...");
+    message.replace(QLatin1Char('%') + QString::number(record.textArg), text);
+    return message;
+}
+
+bool appendLines(const QString &path, qint64 maxBytes, const QByteArray &lines)
+{
+    const QFileInfo info(path);
+    QDir().mkpath(info.absolutePath());
+    if (info.exists() && info.size() + lines.size() > maxBytes) {
+        const QString rotated = path + QStringLiteral(".1");
+        QFile::remove(rotated);
+        QFile::rename(path, rotated);
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+        return false;
+    return file.write(lines) == lines.size();
+}
+
+void push(RingLog::Level level, const char *format, qint64 a, qint64 b, quint8 textArg, QStringView text)
+{
+    thread_local RingOwner owner;
+    if (!owner.ring) {
+        if (!owner.exhausted)
+            owner.ring = claimRing();
+        if (!owner.ring) {
+            owner.exhausted = true;
+            state().dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    Ring &ring = *owner.ring;
+    const quint64 head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= quint64(RingLog::RingCapacity)) {
+        state().dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Record &record = ring.records[head % RingLog::RingCapacity];
+    record.timeNs = state().clock.nsecsElapsed();
+    record.format = format;
+    record.a = a;
+    record.b = b;
+    record.thread = ring.number;
+    record.level = level;
+    record.textArg = textArg;
+    const qsizetype size = std::min<qsizetype>(text.size(), RingLog::TextCapacity);
+    for (qsizetype i = 0; i < size; ++i) {
+        const char16_t c = text[i].unicode();
+        record.text[i] = (c >= 0x20 && c < 0x7f) ? char(c) : '?';
+    }
+    record.textSize = quint8(size);
+    record.truncated = text.size() > RingLog::TextCapacity;
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+} // namespace
+
+void RingLog::write(Level level, const char *format, qint64 a, qint64 b, QStringView text)
+{
+    push(level, format, a, b, 3, text);
+}
+
+void RingLog::write(Level level, const char *format, qint64 a, QStringView text)
+{
+    push(level, format, a, 0, 2, text);
+}
+
+void RingLog::write(Level level, const char *format, QStringView text)
+{
+    push(level, format, 0, 0, 1, text);
+}
+
+bool RingLog::start(const QString &path)
+{
+    LogState &s = state();
+    {
+        QMutexLocker lock(&s.flushMutex);
+        s.path = path;
+    }
+    const bool ok = QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QMutexLocker lock(&s.wakeMutex);
+    if (s.flusher)
+        return ok;
+    s.stopping = false;
+    s.flusher = QThread::create([]() {
+        LogState &shared = state();
+        for (;;) {
+            bool stopping = false;
+            {
+                QMutexLocker wakeLock(&shared.wakeMutex);
+                if (!shared.stopping)
+                    shared.wake.wait(&shared.wakeMutex, FlushIntervalMs);
+                stopping = shared.stopping;
+            }
+            flush();
+            if (stopping)
+                break;
+        }
+    });
+    s.flusher->setObjectName(QStringLiteral("RingLog flusher"));
+    s.flusher->start(QThread::LowPriority);
+    return ok;
+}
+
+void RingLog::stop()
+{
+    LogState &s = state();
+    QThread *flusher = nullptr;
+    {
+        QMutexLocker lock(&s.wakeMutex);
+        flusher = s.flusher;
+        s.flusher = nullptr;
+        s.stopping = true;
+        s.wake.wakeAll();
+    }
+    if (flusher) {
+        flusher->wait();
+        delete flusher;
+    }
+    flush();
+}
+
+void RingLog::flush()
+{
+    LogState &s = state();
+    QMutexLocker lock(&s.flushMutex);
+
+    std::vector<Ring *> rings;
+    {
+        QMutexLocker ringsLock(&s.ringsMutex);
+        rings.reserve(s.rings.size());
+        for (const auto &ring : s.rings)
+            rings.push_back(ring.get());
+    }
+
+    std::vector<Record> batch;
+    for (Ring *ring : rings) {
+        const quint64 tail = ring->tail.load(std::memory_order_relaxed);
+        const quint64 head = ring->head.load(std::memory_order_acquire);
+        for (quint64 i = tail; i < head; ++i)
+            batch.push_back(ring->records[i % RingCapacity]);
+        ring->tail.store(head, std::memory_order_release);
+    }
+    const quint64 dropped = s.dropped.load(std::memory_order_relaxed);
+    if (batch.empty() && dropped == s.reportedDropped)
+        return;
+
+    // Each ring is in order already; interleave the threads
+    std::stable_sort(batch.begin(), batch.end(),
+                     [](const Record &a, const Record &b) { return a.timeNs < b.timeNs; });
+
+    QVector<Entry> entries;
+    entries.reserve(qsizetype(batch.size()) + 1);
+    for (const Record &record : batch)
+        entries.append(Entry{0, QDateTime::fromMSecsSinceEpoch(s.wallBaseMs + record.timeNs / 1000000),
+                             Level(record.level), int(record.thread), formatMessage(record)});
+    if (dropped != s.reportedDropped) {
+        entries.append(Entry{0, QDateTime::currentDateTime(), Warning, 0,
+                             QStringLiteral("log: %1 records dropped, a ring was full")
+                                 .arg(dropped - s.reportedDropped)});
+        s.reportedDropped = dropped;
+    }
+
+    {
+        QMutexLocker historyLock(&s.historyMutex);
+        for (Entry &entry : entries) {
+            entry.seq = s.nextSeq++;
+            s.history.push_back(entry);
+        }
+        while (s.history.size() > size_t(HistorySize))
+            s.history.pop_front();
+    }
+
+    if (!s.path.isEmpty()) {
+        QByteArray lines;
+        for (const Entry &entry : std::as_const(entries))
+            lines += formatLine(entry).toUtf8() + '\n';
+        appendLines(s.path, s.maxFileBytes, lines);
+    }
+}
+
+void RingLog::setMaxFileBytes(qint64 bytes)
+{
+    LogState &s = state();
+    QMutexLocker lock(&s.flushMutex);
+    s.maxFileBytes = bytes;
+}
+
+QString RingLog::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+           + QStringLiteral("/turborpm.log");
+}
+
+QString RingLog::filePath()
+{
+    LogState &s = state();
+    QMutexLocker lock(&s.flushMutex);
+    return s.path;
+}
+
+QVector<RingLog::Entry> RingLog::recent(quint64 afterSeq)
+{
+    LogState &s = state();
+    QMutexLocker lock(&s.historyMutex);
+    QVector<Entry> entries;
+    if (s.history.empty() || s.history.back().seq <= afterSeq)
+        return entries;
+    // Sequence numbers are consecutive
+    const quint64 first = s.history.front().seq;
+    const size_t skip = afterSeq < first ? 0 : size_t(afterSeq - first + 1);
+    entries.reserve(qsizetype(s.history.size() - skip));
+    for (auto it = s.history.cbegin() + skip; it != s.history.cend(); ++it)
+        entries.append(*it);
+    return entries;
+}
+
+QString RingLog::formatLine(const Entry &entry)
+{
+    return QStringLiteral("%1 %2 [%3] %4")
+        .arg(entry.time.toString(Qt::ISODateWithMs), levelName(entry.level))
+        .arg(entry.thread)
+        .arg(entry.message);
+}
+
+QLatin1String RingLog::levelName(Level level)
+{
+    switch (level) {
+    case Debug:
+        return QLatin1String("DEBUG");
+    case Info:
+        return QLatin1String("INFO");
+    case Warning:
+        return QLatin1String("WARN");
+    case Error:
+        return QLatin1String("ERROR");
+    }
+    return QLatin1String("?");
+}
+
+quint64 RingLog::dropped()
+{
+    return state().dropped.load(std::memory_order_relaxed);
+}
+
+int RingLog::ringCount()
+{
+    LogState &s = state();
+    QMutexLocker lock(&s.ringsMutex);
+    return int(s.rings.size());
+}
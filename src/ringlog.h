@@ -0,0 +1,75 @@
+/**
+ * @file ringlog.h
+ * @author Nikolay Yevik
+ * @brief Always-on structured log: fixed-size records in per-thread lock-free rings,
+ * formatted and written by a background thread, for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QDateTime>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+/**
+ * write() copies its arguments into a 128-byte record in the calling
+ * thread's ring and returns: no lock, no allocation, no formatting. The
+ * format is a string literal kept by pointer. Its placeholders follow the
+ * arguments: %1 and %2 for the numbers given, then the next one for the
+ * text, which is cut to TextCapacity ASCII characters. A full ring drops the
+ * record and counts it.
+ *
+ * The flusher thread started by start() drains every ring a few times a
+ * second, formats the records in time order, appends them to a log file
+ * that rotates to "<path>.1" and keeps the last HistorySize entries for the
+ * log panel. A thread's ring is reused by a later thread once drained.
+ */
+class RingLog
+{
+public:
+    enum Level : quint8 { Debug, Info, Warning, Error };
+
+    static constexpr int TextCapacity = 88;
+    static constexpr int RingCapacity = 1024; // records per thread
+    static constexpr int HistorySize = 4000;
+
+    /** "%1 %2 %3" */
+    static void write(Level level, const char *format, qint64 a = 0, qint64 b = 0,
+                      QStringView text = {});
+    /** "%1 %2": one number, then the text */
+    static void write(Level level, const char *format, qint64 a, QStringView text);
+    /** "%1": the text alone */
+    static void write(Level level, const char *format, QStringView text);
+
+    /** Starts the flusher writing to @p path; records written before are kept */
+    static bool start(const QString &path);
+    /** Drains what is left and stops the flusher */
+    static void stop();
+    /** Drains every ring now, on the calling thread */
+    static void flush();
+    static void setMaxFileBytes(qint64 bytes);
+
+    /** AppLocalDataLocation/turborpm.log */
+    static QString defaultPath();
+    static QString filePath();
+
+    struct Entry {
+        quint64 seq = 0; // 1, 2, ... in flush order
+        QDateTime time;
+        Level level = Info;
+        int thread = 0; // ring number, stable while the thread lives
+        QString message;
+    };
+    /** Flushed entries after @p afterSeq, oldest first */
+    static QVector<Entry> recent(quint64 afterSeq = 0);
+    /** "<time> <level> [<thread>] <message>", as written to the file */
+    static QString formatLine(const Entry &entry);
+    static QLatin1String levelName(Level level);
+
+    /** Records lost to full rings since the process started */
+    static quint64 dropped();
+    /** Rings allocated so far; grows with the number of threads alive at once */
+    static int ringCount();
+};
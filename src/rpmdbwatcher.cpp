@@ -0,0 +1,134 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the rpm database watcher for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "rpmdbwatcher.h"
+#include "packagecache.h"
+#include "trace.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    constexpr int DefaultSettleMs {1500}; // rpm writes the db in bursts well under this apart
+}
+
+RpmdbWatcher::RpmdbWatcher(QObject *parent)
+    : QObject(parent)
+{
+    m_settleTimer = new QTimer(this);
+    m_settleTimer->setSingleShot(true);
+    m_settleTimer->setInterval(DefaultSettleMs);
+    connect(m_settleTimer, &QTimer::timeout, this, &RpmdbWatcher::onSettled);
+}
+
+void RpmdbWatcher::start(const QString &directory)
+{
+    stop();
+    m_directory = directory.isEmpty() ? PackageCache::rpmdbDirectory() : directory;
+    if (m_knownStamp.isEmpty())
+        m_knownStamp = PackageCache::rpmdbStamp(m_directory);
+
+    m_watcher = new QFileSystemWatcher(this);
+    // The directory catches the WAL and journal files being created and removed
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        watchFiles();
+        onPathChanged();
+    });
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &RpmdbWatcher::onPathChanged);
+    m_watcher->addPath(m_directory);
+    watchFiles();
+}
+
+void RpmdbWatcher::stop()
+{
+    m_settleTimer->stop();
+    delete m_watcher;
+    m_watcher = nullptr;
+}
+
+void RpmdbWatcher::pause()
+{
+    m_paused = true;
+    m_settleTimer->stop();
+}
+
+bool RpmdbWatcher::resume()
+{
+    m_paused = false;
+    const QByteArray stamp = PackageCache::rpmdbStamp(m_directory);
+    const bool moved = stamp != m_knownStamp;
+    m_knownStamp = stamp;
+    return moved;
+}
+
+bool RpmdbWatcher::isActive() const
+{
+    return m_watcher && !m_watcher->directories().isEmpty();
+}
+
+void RpmdbWatcher::setSettleDelay(int ms)
+{
+    m_settleTimer->setInterval(ms);
+}
+
+int RpmdbWatcher::settleDelay() const
+{
+    return m_settleTimer->interval();
+}
+
+bool RpmdbWatcher::transactionInProgress(const QString &directory)
+{
+    // rpm takes an fcntl write lock on .rpm.lock for the whole transaction
+    const QByteArray path = QFile::encodeName(directory + QStringLiteral("/.rpm.lock"));
+    const int fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct flock lock = {};
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    const bool held = ::fcntl(fd, F_GETLK, &lock) == 0 && lock.l_type != F_UNLCK;
+    ::close(fd);
+    return held;
+}
+
+void RpmdbWatcher::watchFiles()
+{
+    // A replaced or deleted file drops out of the watcher; pick it up again
+    const QStringList watched = m_watcher->files();
+    for (const QString &name : PackageCache::rpmdbFiles()) {
+        const QString path = m_directory + QLatin1Char('/') + name;
+        if (!watched.contains(path) && QFileInfo::exists(path))
+            m_watcher->addPath(path);
+    }
+}
+
+void RpmdbWatcher::onPathChanged()
+{
+    if (m_paused)
+        return;
+    m_settleTimer->start(); // restarts: only the last event of a burst counts
+}
+
+void RpmdbWatcher::onSettled()
+{
+    // Only re-armed while a transaction runs; an idle system has no timer at all
+    if (transactionInProgress(m_directory)) {
+        m_settleTimer->start();
+        return;
+    }
+
+    const QByteArray stamp = PackageCache::rpmdbStamp(m_directory);
+    if (stamp == m_knownStamp)
+        return;
+    m_knownStamp = stamp;
+    Trace::instant("rpmdb", "RpmdbWatcher::changed");
+    emit changed();
+}
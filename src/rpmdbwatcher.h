@@ -0,0 +1,64 @@
+/**
+ * @file rpmdbwatcher.h
+ * @author Nikolay Yevik
+ * @brief Notices rpm database changes made outside TurboRPM for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+
+class QFileSystemWatcher;
+class QTimer;
+
+/**
+ * Watches the rpmdb directory and files with QFileSystemWatcher (inotify on
+ * Linux), so an idle system costs nothing. A transaction writes the database
+ * many times; every event restarts a settle timer, and while rpm's
+ * transaction lock is held the timer keeps waiting. changed() fires once,
+ * after the last write, and only if the database stamp really moved.
+ */
+class RpmdbWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RpmdbWatcher(QObject *parent = nullptr);
+
+    /** @p directory defaults to PackageCache::rpmdbDirectory(); tests point it elsewhere */
+    void start(const QString &directory = QString());
+    void stop();
+    bool isActive() const;
+
+    /** Quiet time after the last event before the database counts as settled */
+    void setSettleDelay(int ms);
+    int settleDelay() const;
+
+    /** The state the caller has already loaded; changed() is not emitted for it */
+    void setKnownStamp(const QByteArray &stamp) { m_knownStamp = stamp; }
+
+    /** For the caller's own transactions: events are ignored until resume() */
+    void pause();
+    /** Adopts the current stamp as known; returns true if the database moved while paused */
+    bool resume();
+
+    /** True while another process holds rpm's transaction lock in @p directory */
+    static bool transactionInProgress(const QString &directory);
+
+signals:
+    /** The database settled in a state other than the known stamp */
+    void changed();
+
+private:
+    void onPathChanged();
+    void onSettled();
+    void watchFiles();
+
+    QFileSystemWatcher *m_watcher = nullptr;
+    QTimer *m_settleTimer = nullptr;
+    QString m_directory;
+    QByteArray m_knownStamp;
+    bool m_paused = false;
+};
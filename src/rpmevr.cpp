@@ -0,0 +1,249 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the RpmEvr comparator for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "rpmevr.h"
+
+namespace {
+    // Key token bytes, ordered the way rpmvercmp() orders what they stand for:
+    // '~' < end of string < '^' < alphabetic segment < numeric segment.
+    constexpr char KeyTilde {0x01};
+    constexpr char KeyEnd {0x02};
+    constexpr char KeyCaret {0x03};
+    constexpr char KeyAlpha {0x04};
+    constexpr char KeyNumeric {0x05};
+    constexpr char KeyAlphaTerminator {0x00};
+
+    // rpm uses its own locale-independent ASCII classification
+    inline bool isDigit(char16_t c) { return c >= u'0' && c <= u'9'; }
+    inline bool isAlpha(char16_t c) { return (c >= u'a' && c <= u'z') || (c >= u'A' && c <= u'Z'); }
+    inline bool isAlnum(char16_t c) { return isDigit(c) || isAlpha(c); }
+    inline bool isSeparator(char16_t c) { return !isAlnum(c) && c != u'~' && c != u'^'; }
+
+    QStringView stripLeadingZeros(QStringView digits)
+    {
+        qsizetype i = 0;
+        while (i < digits.size() && digits[i] == u'0')
+            ++i;
+        return digits.mid(i);
+    }
+
+    int compareNumeric(QStringView a, QStringView b)
+    {
+        a = stripLeadingZeros(a);
+        b = stripLeadingZeros(b);
+        if (a.size() != b.size())
+            return a.size() > b.size() ? 1 : -1;
+        const int rc = a.compare(b);
+        return rc < 0 ? -1 : (rc > 0 ? 1 : 0);
+    }
+
+    bool isAllDigits(QStringView s)
+    {
+        for (QChar c : s) {
+            if (!isDigit(c.unicode()))
+                return false;
+        }
+        return true;
+    }
+
+    void appendNumericKey(QByteArray &key, QStringView digits)
+    {
+        digits = stripLeadingZeros(digits);
+        // Length first: a longer number is always larger. 255+ digit runs
+        // only occur in garbage input and are clamped.
+        const qsizetype len = qMin<qsizetype>(digits.size(), 0xFF);
+        key.append(KeyNumeric);
+        key.append(char(uchar(len)));
+        for (qsizetype i = 0; i < len; ++i)
+            key.append(char(digits[i].unicode()));
+    }
+}
+
+int RpmEvr::vercmp(QStringView a, QStringView b)
+{
+    if (a == b)
+        return 0;
+
+    const qsizetype na = a.size();
+    const qsizetype nb = b.size();
+    qsizetype i = 0;
+    qsizetype j = 0;
+
+    while (i < na || j < nb) {
+        while (i < na && isSeparator(a[i].unicode()))
+            ++i;
+        while (j < nb && isSeparator(b[j].unicode()))
+            ++j;
+
+        const char16_t ca = i < na ? a[i].unicode() : u'\0';
+        const char16_t cb = j < nb ? b[j].unicode() : u'\0';
+
+        // '~' sorts before everything, even the end of the string
+        if (ca == u'~' || cb == u'~') {
+            if (ca != u'~')
+                return 1;
+            if (cb != u'~')
+                return -1;
+            ++i;
+            ++j;
+            continue;
+        }
+
+        // '^' sorts after the end of the string but before any further segment
+        if (ca == u'^' || cb == u'^') {
+            if (i >= na)
+                return -1;
+            if (j >= nb)
+                return 1;
+            if (ca != u'^')
+                return 1;
+            if (cb != u'^')
+                return -1;
+            ++i;
+            ++j;
+            continue;
+        }
+
+        if (i >= na || j >= nb)
+            break;
+
+        const qsizetype si = i;
+        const qsizetype sj = j;
+        const bool isNum = isDigit(ca);
+        if (isNum) {
+            while (i < na && isDigit(a[i].unicode()))
+                ++i;
+            while (j < nb && isDigit(b[j].unicode()))
+                ++j;
+        } else {
+            while (i < na && isAlpha(a[i].unicode()))
+                ++i;
+            while (j < nb && isAlpha(b[j].unicode()))
+                ++j;
+        }
+
+        // Segments of different types: numeric is newer than alphabetic
+        if (j == sj)
+            return isNum ? 1 : -1;
+
+        const QStringView segA = a.mid(si, i - si);
+        const QStringView segB = b.mid(sj, j - sj);
+        int rc = 0;
+        if (isNum) {
+            rc = compareNumeric(segA, segB);
+        } else {
+            rc = segA.compare(segB);
+            rc = rc < 0 ? -1 : (rc > 0 ? 1 : 0);
+        }
+        if (rc != 0)
+            return rc;
+    }
+
+    if (i >= na && j >= nb)
+        return 0;
+    // Whichever string still has segments left is newer
+    return i < na ? 1 : -1;
+}
+
+void RpmEvr::split(QStringView evr, QStringView &epoch, QStringView &version,
+                   QStringView &release)
+{
+    epoch = {};
+    const qsizetype colon = evr.indexOf(u':');
+    if (colon >= 0 && isAllDigits(evr.left(colon))) {
+        epoch = evr.left(colon);
+        evr = evr.mid(colon + 1);
+    }
+
+    const qsizetype dash = evr.lastIndexOf(u'-');
+    if (dash >= 0) {
+        version = evr.left(dash);
+        release = evr.mid(dash + 1);
+    } else {
+        version = evr;
+        release = {};
+    }
+}
+
+int RpmEvr::compare(QStringView epochA, QStringView versionA, QStringView releaseA,
+                    QStringView epochB, QStringView versionB, QStringView releaseB)
+{
+    const QStringView zero(u"0");
+    int rc = compareNumeric(epochA.isEmpty() ? zero : epochA, epochB.isEmpty() ? zero : epochB);
+    if (rc != 0)
+        return rc;
+    rc = vercmp(versionA, versionB);
+    if (rc != 0)
+        return rc;
+    return vercmp(releaseA, releaseB);
+}
+
+int RpmEvr::compare(QStringView evrA, QStringView evrB)
+{
+    QStringView ea, va, ra, eb, vb, rb;
+    split(evrA, ea, va, ra);
+    split(evrB, eb, vb, rb);
+    return compare(ea, va, ra, eb, vb, rb);
+}
+
+void RpmEvr::appendVersionKey(QByteArray &key, QStringView version)
+{
+    const qsizetype n = version.size();
+    qsizetype i = 0;
+    for (;;) {
+        while (i < n && isSeparator(version[i].unicode()))
+            ++i;
+        if (i >= n) {
+            key.append(KeyEnd);
+            return;
+        }
+
+        const char16_t c = version[i].unicode();
+        if (c == u'~') {
+            key.append(KeyTilde);
+            ++i;
+        } else if (c == u'^') {
+            key.append(KeyCaret);
+            ++i;
+        } else if (isDigit(c)) {
+            const qsizetype start = i;
+            while (i < n && isDigit(version[i].unicode()))
+                ++i;
+            appendNumericKey(key, version.mid(start, i - start));
+        } else {
+            key.append(KeyAlpha);
+            while (i < n && isAlpha(version[i].unicode()))
+                key.append(char(version[i++].unicode()));
+            key.append(KeyAlphaTerminator);
+        }
+    }
+}
+
+QByteArray RpmEvr::sortKey(QStringView evr)
+{
+    QStringView epoch, version, release;
+    split(evr, epoch, version, release);
+
+    QByteArray key;
+    key.reserve(evr.size() * 2 + 8);
+    appendNumericKey(key, epoch);
+    appendVersionKey(key, version);
+    appendVersionKey(key, release);
+    return key;
+}
+
+QByteArray RpmEvr::sortKey(QStringView epoch, QStringView versionRelease)
+{
+    QStringView ignoredEpoch, version, release;
+    split(versionRelease, ignoredEpoch, version, release);
+
+    QByteArray key;
+    key.reserve(versionRelease.size() * 2 + 8);
+    appendNumericKey(key, epoch);
+    appendVersionKey(key, version);
+    appendVersionKey(key, release);
+    return key;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file rpmevr.h
+ * @author Nikolay Yevik
+ * @brief Native rpm epoch:version-release comparison for TurboRPM Package Manager Prototype.
+ * Implements rpmvercmp() semantics (including '~' and '^') and derives byte
+ * strings whose memcmp() order equals the rpm order, so sorting and "is this
+ * newer" checks never tokenize versions more than once per row.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringView>
+
+class RpmEvr
+{
+public:
+    /** rpmvercmp(): <0, 0, >0 like strcmp */
+    static int vercmp(QStringView a, QStringView b);
+
+    /** Compares "[EPOCH:]VERSION[-RELEASE]" strings; a missing epoch is 0 */
+    static int compare(QStringView evrA, QStringView evrB);
+    static int compare(QStringView epochA, QStringView versionA, QStringView releaseA,
+                       QStringView epochB, QStringView versionB, QStringView releaseB);
+
+    /** Splits "[EPOCH:]VERSION[-RELEASE]" without allocating */
+    static void split(QStringView evr, QStringView &epoch, QStringView &version,
+                      QStringView &release);
+
+    /**
+     * Byte key with memcmp(keyA, keyB) ordered exactly like compare(). Keys
+     * are self-delimiting, so they can be concatenated and compared as a whole.
+     */
+    static QByteArray sortKey(QStringView evr);
+    static QByteArray sortKey(QStringView epoch, QStringView versionRelease);
+    static void appendVersionKey(QByteArray &key, QStringView version);
+};
@@ -0,0 +1,544 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the dropped .rpm file table for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "rpmfileview.h"
+#include "sizeformat.h"
+#include "trace.h"
+
+#include <QColor>
+#include <QDialogButtonBox>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QItemSelectionModel>
+#include <QLabel>
+#include <QMutex>
+#include <QPlainTextEdit>
+#include <QSet>
+#include <QSplitter>
+#include <QStandardItemModel>
+#include <QTabWidget>
+#include <QTableView>
+#include <QThread>
+#include <QVBoxLayout>
+
+#include <memory>
+#include <utility>
+
+namespace {
+    constexpr int FileRole {Qt::UserRole + 1}; // index into m_files
+    constexpr int ContentsFetchRows {2000}; // rows per fetchMore() of the contents view
+    const QColor NewerColor {200, 230, 201};
+    const QColor OlderColor {255, 236, 179};
+    const QColor ErrorColor {255, 205, 210};
+
+    QString dependencyLines(const QVector<RpmDependency> &deps)
+    {
+        QStringList lines;
+        lines.reserve(deps.size());
+        for (const RpmDependency &dep : deps)
+            lines.append(dep.toString());
+        return lines.join(QLatin1Char('\n'));
+    }
+
+    /** Sorts by the byte count, not the formatted text */
+    class SizeItem : public QStandardItem
+    {
+    public:
+        explicit SizeItem(qint64 bytes)
+            : QStandardItem(formatSizeValue(bytes, SizeUnit::Megabytes))
+        {
+            setData(bytes, Qt::UserRole);
+            setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        }
+
+        bool operator<(const QStandardItem &other) const override
+        {
+            return data(Qt::UserRole).toLongLong() < other.data(Qt::UserRole).toLongLong();
+        }
+    };
+}
+
+/** Runs in a QThread; reads every header into the vector it was given */
+class RpmFilesLoadWorker : public QObject
+{
+    Q_OBJECT
+public:
+    RpmFilesLoadWorker(const QStringList &paths, std::shared_ptr<QVector<RpmPackageFile>> files,
+                       QObject *parent = nullptr)
+        : QObject(parent), m_paths(paths), m_files(std::move(files)) {}
+
+signals:
+    void finished(qint64 elapsedMs);
+
+public slots:
+    void run()
+    {
+        Trace::setThreadName("RpmFilesLoadWorker");
+        QElapsedTimer timer;
+        timer.start();
+        *m_files = RpmHeaderReader::readAll(m_paths);
+        emit finished(timer.elapsed());
+    }
+
+private:
+    QStringList m_paths;
+    std::shared_ptr<QVector<RpmPackageFile>> m_files;
+};
+
+/** One payload listing: the reader runs on a worker, entries wait here for the GUI thread */
+struct RpmContentsSession {
+    RpmPayloadReader reader;
+    QMutex mutex;
+    QVector<RpmPayloadEntry> pending;
+    bool notified = false; // an entriesReady() is queued and has not been taken yet
+
+    QVector<RpmPayloadEntry> take()
+    {
+        QMutexLocker locker(&mutex);
+        notified = false;
+        return std::exchange(pending, {});
+    }
+};
+
+/**
+ * Runs in a QThread. Signals once per batch, not per entry: whatever
+ * arrives while the GUI thread is busy is picked up by the next take().
+ */
+class RpmContentsWorker : public QObject
+{
+    Q_OBJECT
+public:
+    RpmContentsWorker(const QString &path, std::shared_ptr<RpmContentsSession> session,
+                      QObject *parent = nullptr)
+        : QObject(parent), m_path(path), m_session(std::move(session)) {}
+
+signals:
+    void entriesReady();
+    void finished(bool ok, const QString &error, qint64 elapsedMs);
+
+public slots:
+    void run()
+    {
+        Trace::setThreadName("RpmContentsWorker");
+        QElapsedTimer timer;
+        timer.start();
+        RpmContentsSession *session = m_session.get();
+        const bool ok = session->reader.readFile(m_path, [this, session](const RpmPayloadEntry &entry) {
+            QMutexLocker locker(&session->mutex);
+            session->pending.push_back(entry);
+            if (!session->notified) {
+                session->notified = true;
+                emit entriesReady();
+            }
+            return true;
+        });
+        emit finished(ok, session->reader.errorString(), timer.elapsed());
+    }
+
+private:
+    QString m_path;
+    std::shared_ptr<RpmContentsSession> m_session;
+};
+
+void RpmContentsModel::appendEntries(QVector<RpmPayloadEntry> entries)
+{
+    if (entries.isEmpty())
+        return;
+    for (const RpmPayloadEntry &entry : std::as_const(entries))
+        m_totalSize += entry.size;
+    if (m_entries.isEmpty())
+        m_entries = std::move(entries);
+    else
+        m_entries.append(entries);
+    // The first screenful shows up at once; the rest waits for the view to scroll there
+    if (m_rows < ContentsFetchRows)
+        fetchMore(QModelIndex());
+}
+
+void RpmContentsModel::clear()
+{
+    beginResetModel();
+    m_entries.clear();
+    m_rows = 0;
+    m_totalSize = 0;
+    endResetModel();
+}
+
+int RpmContentsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows;
+}
+
+int RpmContentsModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant RpmContentsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows)
+        return {};
+    const RpmPayloadEntry &entry = m_entries.at(index.row());
+    if (role == Qt::TextAlignmentRole && index.column() == SizeColumn)
+        return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+    if (role != Qt::DisplayRole)
+        return {};
+    switch (index.column()) {
+    case PathColumn:
+        return entry.path;
+    case SizeColumn:
+        return entry.isDirectory() || entry.isSymlink() ? QString()
+                                                        : formatSizeValue(entry.size, SizeUnit::Kilobytes);
+    case PermissionsColumn:
+        return entry.permissions();
+    case TargetColumn:
+        return entry.linkTarget;
+    default:
+        return {};
+    }
+}
+
+QVariant RpmContentsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+    switch (section) {
+    case PathColumn:
+        return tr("Path");
+    case SizeColumn:
+        return tr("Size");
+    case PermissionsColumn:
+        return tr("Mode");
+    case TargetColumn:
+        return tr("Link target");
+    default:
+        return {};
+    }
+}
+
+bool RpmContentsModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_rows < m_entries.size();
+}
+
+void RpmContentsModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid())
+        return;
+    const int rows = qMin(ContentsFetchRows, int(m_entries.size()) - m_rows);
+    if (rows <= 0)
+        return;
+    beginInsertRows(QModelIndex(), m_rows, m_rows + rows - 1);
+    m_rows += rows;
+    endInsertRows();
+}
+
+RpmFilesDialog::RpmFilesDialog(const QHash<QString, QByteArray> &installedKeys, QWidget *parent)
+    : QDialog(parent), m_installedKeys(installedKeys)
+{
+    setObjectName(QStringLiteral("rpmFilesDialog"));
+    setWindowTitle(tr("Package files"));
+    resize(1100, 650);
+
+    auto *layout = new QVBoxLayout(this);
+    m_statusLabel = new QLabel(this);
+    layout->addWidget(m_statusLabel);
+
+    auto *splitter = new QSplitter(Qt::Vertical, this);
+    m_view = new QTableView(splitter);
+    m_view->setObjectName(QStringLiteral("rpmFilesView"));
+    m_model = new QStandardItemModel(m_view);
+    m_model->setHorizontalHeaderLabels({tr("File"), tr("Name"), tr("Version"), tr("Arch"),
+                                        tr("Installed size"), tr("Installed"), tr("Summary"),
+                                        tr("License")});
+    m_view->setModel(m_model);
+    m_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_view->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->setSortingEnabled(true);
+    m_view->verticalHeader()->hide();
+    m_view->horizontalHeader()->setStretchLastSection(true);
+
+    m_tabs = new QTabWidget(splitter);
+    m_details = new QPlainTextEdit(m_tabs);
+    m_details->setReadOnly(true);
+    m_details->setObjectName(QStringLiteral("rpmFilesDetails"));
+    m_tabs->addTab(m_details, tr("Details"));
+
+    m_contentsTab = new QWidget(m_tabs);
+    auto *contentsLayout = new QVBoxLayout(m_contentsTab);
+    contentsLayout->setContentsMargins(0, 0, 0, 0);
+    m_contentsLabel = new QLabel(m_contentsTab);
+    contentsLayout->addWidget(m_contentsLabel);
+    m_contentsView = new QTableView(m_contentsTab);
+    m_contentsView->setObjectName(QStringLiteral("rpmContentsView"));
+    m_contentsModel = new RpmContentsModel(m_contentsView);
+    m_contentsView->setModel(m_contentsModel);
+    m_contentsView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_contentsView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_contentsView->verticalHeader()->hide();
+    // Fixed row heights and column widths: nothing is measured per streamed row
+    m_contentsView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_contentsView->horizontalHeader()->resizeSection(RpmContentsModel::PathColumn, 520);
+    m_contentsView->horizontalHeader()->setStretchLastSection(true);
+    contentsLayout->addWidget(m_contentsView, /*stretch*/ 1);
+    m_tabs->addTab(m_contentsTab, tr("Contents"));
+    connect(m_tabs, &QTabWidget::currentChanged, this, &RpmFilesDialog::updateContents);
+
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 1);
+    layout->addWidget(splitter, /*stretch*/ 1);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    layout->addWidget(buttons);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(m_view->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+            &RpmFilesDialog::showSelectedFile);
+}
+
+RpmFilesDialog::~RpmFilesDialog()
+{
+    if (m_contents)
+        m_contents->reader.cancel();
+    // Workers hold only shared state, but their threads are our children
+    for (QThread *thread : findChildren<QThread *>()) {
+        thread->quit();
+        thread->wait();
+    }
+}
+
+QStringList RpmFilesDialog::packageFiles(const QStringList &paths, QStringList *others)
+{
+    QStringList packages;
+    for (const QString &path : paths) {
+        const QFileInfo info(path);
+        if (info.isFile() && path.endsWith(QLatin1String(".rpm"), Qt::CaseInsensitive)) {
+            packages.append(info.absoluteFilePath());
+            continue;
+        }
+        // A download directory is inspected; any other directory is still an rpm -qf question
+        const QStringList inside = info.isDir()
+            ? QDir(path).entryList({QStringLiteral("*.rpm")}, QDir::Files, QDir::Name)
+            : QStringList();
+        if (inside.isEmpty()) {
+            if (others)
+                others->append(path);
+            continue;
+        }
+        const QDir dir(info.absoluteFilePath());
+        for (const QString &name : inside)
+            packages.append(dir.filePath(name));
+    }
+    return packages;
+}
+
+void RpmFilesDialog::addFiles(const QStringList &paths)
+{
+    QSet<QString> known;
+    for (const RpmPackageFile &file : std::as_const(m_files))
+        known.insert(file.path);
+    for (const QString &path : std::as_const(m_queued))
+        known.insert(path);
+    for (const QString &path : paths) {
+        if (!known.contains(path)) {
+            known.insert(path);
+            m_queued.append(path);
+        }
+    }
+    if (!m_loading && !m_queued.isEmpty())
+        startLoad();
+}
+
+void RpmFilesDialog::startLoad()
+{
+    m_loading = true;
+    const QStringList paths = std::exchange(m_queued, {});
+    m_statusLabel->setText(tr("Reading %n package file(s)...", nullptr, int(paths.size())));
+
+    auto files = std::make_shared<QVector<RpmPackageFile>>();
+    auto *worker = new RpmFilesLoadWorker(paths, files);
+    auto *thread = new QThread(this);
+    worker->moveToThread(thread);
+
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    connect(thread, &QThread::started, worker, &RpmFilesLoadWorker::run);
+    connect(worker, &RpmFilesLoadWorker::finished, this, [this, thread, files](qint64 elapsedMs) {
+        thread->quit();
+        m_loading = false;
+        appendFiles(*files);
+
+        int unreadable = 0;
+        for (const RpmPackageFile &file : std::as_const(m_files))
+            unreadable += file.error.isEmpty() ? 0 : 1;
+        QString status = tr("%n package file(s)", nullptr, int(m_files.size()));
+        status += tr(", last %1 read in %2 ms").arg(files->size()).arg(elapsedMs);
+        if (unreadable)
+            status += tr("; %n could not be read", nullptr, unreadable);
+        m_statusLabel->setText(status);
+
+        if (!m_queued.isEmpty())
+            startLoad();
+    });
+
+    thread->start();
+}
+
+void RpmFilesDialog::appendFiles(const QVector<RpmPackageFile> &files)
+{
+    TraceSpan span("ui", "RpmFilesDialog::appendFiles");
+    span.arg("files", files.size());
+
+    m_view->setSortingEnabled(false);
+    for (const RpmPackageFile &file : files) {
+        const int index = int(m_files.size());
+        m_files.append(file);
+
+        auto *fileItem = new QStandardItem(QFileInfo(file.path).fileName());
+        fileItem->setData(index, FileRole);
+        fileItem->setToolTip(file.path);
+        QList<QStandardItem *> row {fileItem};
+        if (!file.error.isEmpty()) {
+            auto *errorItem = new QStandardItem(file.error);
+            errorItem->setBackground(ErrorColor);
+            row.append(errorItem);
+            m_model->appendRow(row);
+            continue;
+        }
+
+        QString installed;
+        QColor color;
+        switch (RpmHeaderReader::compare(file, m_installedKeys)) {
+        case RpmHeaderReader::Newer:
+            installed = tr("newer");
+            color = NewerColor;
+            break;
+        case RpmHeaderReader::Older:
+            installed = tr("older");
+            color = OlderColor;
+            break;
+        case RpmHeaderReader::Same:
+            installed = tr("same");
+            break;
+        case RpmHeaderReader::NotInstalled:
+            installed = file.sourcePackage ? tr("source package") : tr("not installed");
+            break;
+        }
+        auto *installedItem = new QStandardItem(installed);
+        if (color.isValid())
+            installedItem->setBackground(color);
+
+        row << new QStandardItem(file.name) << new QStandardItem(file.evr())
+            << new QStandardItem(file.arch) << new SizeItem(file.installedSize) << installedItem
+            << new QStandardItem(file.summary) << new QStandardItem(file.license);
+        m_model->appendRow(row);
+    }
+    m_view->setSortingEnabled(true);
+    m_view->resizeColumnsToContents();
+    if (!m_view->currentIndex().isValid() && m_model->rowCount() > 0)
+        m_view->setCurrentIndex(m_model->index(0, 0));
+}
+
+void RpmFilesDialog::showSelectedFile()
+{
+    const QModelIndex current = m_view->currentIndex();
+    if (!current.isValid())
+        return;
+    const int index = current.siblingAtColumn(0).data(FileRole).toInt();
+    if (index < 0 || index >= m_files.size())
+        return;
+    const RpmPackageFile &file = m_files.at(index);
+    updateContents();
+
+    QString text = file.path + QLatin1Char('\n');
+    if (!file.error.isEmpty()) {
+        m_details->setPlainText(text + file.error);
+        return;
+    }
+    text += tr("%1-%2.%3, %4 on disk\n")
+                .arg(file.name, file.evr(), file.arch,
+                     formatSizeValue(file.fileSize, SizeUnit::Megabytes));
+    text += tr("\nRequires (%1):\n").arg(file.requires.size());
+    text += dependencyLines(file.requires);
+    text += tr("\n\nProvides (%1):\n").arg(file.provides.size());
+    text += dependencyLines(file.provides);
+    m_details->setPlainText(text);
+}
+
+void RpmFilesDialog::updateContents()
+{
+    if (m_tabs->currentWidget() != m_contentsTab)
+        return;
+    const QModelIndex current = m_view->currentIndex();
+    const int index = current.isValid() ? current.siblingAtColumn(0).data(FileRole).toInt() : -1;
+    if (index < 0 || index >= m_files.size()) {
+        m_contentsLabel->clear();
+        return;
+    }
+    const RpmPackageFile &file = m_files.at(index);
+    if (file.path == m_contentsPath)
+        return;
+    if (!file.error.isEmpty()) {
+        if (m_contents)
+            m_contents->reader.cancel();
+        m_contents.reset();
+        m_contentsPath = file.path;
+        m_contentsModel->clear();
+        m_contentsLabel->setText(file.error);
+        return;
+    }
+    startContents(file.path);
+}
+
+void RpmFilesDialog::startContents(const QString &path)
+{
+    if (m_contents)
+        m_contents->reader.cancel();
+    m_contentsPath = path;
+    m_contentsModel->clear();
+    m_contentsLabel->setText(tr("Reading the payload of %1...").arg(QFileInfo(path).fileName()));
+
+    auto session = std::make_shared<RpmContentsSession>();
+    m_contents = session;
+    auto *worker = new RpmContentsWorker(path, session);
+    auto *thread = new QThread(this);
+    worker->moveToThread(thread);
+
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    connect(thread, &QThread::started, worker, &RpmContentsWorker::run);
+    connect(worker, &RpmContentsWorker::finished, thread, &QThread::quit);
+
+    // A superseded listing still winds down; only the current one reaches the model
+    connect(worker, &RpmContentsWorker::entriesReady, this, [this, session]() {
+        if (session != m_contents)
+            return;
+        m_contentsModel->appendEntries(session->take());
+        m_contentsLabel->setText(tr("%n file(s) so far...", nullptr, m_contentsModel->entryCount()));
+    });
+    connect(worker, &RpmContentsWorker::finished, this,
+            [this, session](bool ok, const QString &error, qint64 elapsedMs) {
+                if (session != m_contents)
+                    return;
+                m_contentsModel->appendEntries(session->take());
+                if (!ok) {
+                    m_contentsLabel->setText(tr("%n file(s); the payload could not be read: %1", nullptr,
+                                                m_contentsModel->entryCount())
+                                                 .arg(error));
+                    return;
+                }
+                m_contentsLabel->setText(
+                    tr("%n file(s), %1 in %2 ms", nullptr, m_contentsModel->entryCount())
+                        .arg(formatSizeValue(m_contentsModel->totalSize(), SizeUnit::Megabytes))
+                        .arg(elapsedMs));
+            });
+
+    thread->start();
+}
+
+#include "rpmfileview.moc"
@@ -0,0 +1,112 @@
+/**
+ * @file rpmfileview.h
+ * @author Nikolay Yevik
+ * @brief Table of dropped .rpm files read with RpmHeaderReader for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QDialog>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+#include <memory>
+
+#include "rpmheader.h"
+#include "rpmpayload.h"
+
+class QLabel;
+class QPlainTextEdit;
+class QStandardItemModel;
+class QTabWidget;
+class QTableView;
+struct RpmContentsSession;
+
+/**
+ * Payload entries as they stream in. Rows are handed to the view in
+ * batches through fetchMore(), so a package with 100k files costs the
+ * view no more than the rows scrolled to.
+ */
+class RpmContentsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Column {
+        PathColumn = 0,
+        SizeColumn,
+        PermissionsColumn,
+        TargetColumn,
+        ColumnCount
+    };
+
+    explicit RpmContentsModel(QObject *parent = nullptr) : QAbstractTableModel(parent) {}
+
+    void appendEntries(QVector<RpmPayloadEntry> entries);
+    void clear();
+    /** Entries received, including the ones not fetched into rows yet */
+    int entryCount() const { return int(m_entries.size()); }
+    qint64 totalSize() const { return m_totalSize; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    QVector<RpmPayloadEntry> m_entries;
+    int m_rows = 0; // entries exposed as rows so far
+    qint64 m_totalSize = 0;
+};
+
+/**
+ * One row per package file with how it relates to the installed version;
+ * the selected file's requires and provides are listed below, and its
+ * payload file list on the Contents tab. Headers are read on a worker
+ * thread, many files at once; the payload of the selected file is streamed
+ * on another and cancelled when the selection moves on.
+ */
+class RpmFilesDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    /** @p installedKeys: name.arch -> RpmEvr::sortKey() of the newest installed version */
+    explicit RpmFilesDialog(const QHash<QString, QByteArray> &installedKeys, QWidget *parent = nullptr);
+    ~RpmFilesDialog() override;
+
+    /** Reads @p paths and appends them; files already listed are skipped */
+    void addFiles(const QStringList &paths);
+
+    /** .rpm files among @p paths, plus the ones directly inside dropped directories */
+    static QStringList packageFiles(const QStringList &paths, QStringList *others = nullptr);
+
+private:
+    void startLoad();
+    void appendFiles(const QVector<RpmPackageFile> &files);
+    void showSelectedFile();
+    /** Lists the selected file's payload when the Contents tab is showing */
+    void updateContents();
+    void startContents(const QString &path);
+
+    QHash<QString, QByteArray> m_installedKeys;
+    QVector<RpmPackageFile> m_files; // in row insertion order
+    QStringList m_queued; // paths waiting for the running load
+    bool m_loading = false;
+
+    QStandardItemModel *m_model = nullptr;
+    QTableView *m_view = nullptr;
+    QPlainTextEdit *m_details = nullptr;
+    QLabel *m_statusLabel = nullptr;
+
+    QTabWidget *m_tabs = nullptr;
+    QWidget *m_contentsTab = nullptr;
+    QLabel *m_contentsLabel = nullptr;
+    QTableView *m_contentsView = nullptr;
+    RpmContentsModel *m_contentsModel = nullptr;
+    std::shared_ptr<RpmContentsSession> m_contents; // the listing on screen, possibly still running
+    QString m_contentsPath;
+};
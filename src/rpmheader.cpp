@@ -0,0 +1,544 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the .rpm header reader for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "rpmheader.h"
+#include "parallelfor.h"
+#include "rpmevr.h"
+#include "trace.h"
+
+#include <QFile>
+#include <QObject>
+#include <QtEndian>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr qint64 LeadBytes {96};
+constexpr qint64 HeaderIntroBytes {16}; // magic, reserved, index count, store size
+constexpr qint64 IndexEntryBytes {16};
+constexpr quint32 MaxIndexEntries {0xFFFF}; // same limits as rpm's headerImport()
+constexpr quint32 MaxStoreBytes {256u * 1024 * 1024};
+constexpr unsigned char LeadMagic[] {0xED, 0xAB, 0xEE, 0xDB};
+constexpr unsigned char HeaderMagic[] {0x8E, 0xAD, 0xE8, 0x01};
+constexpr quint16 LeadTypeSource {1};
+
+enum TagType : quint32 {
+    TypeInt16 = 3,
+    TypeInt32 = 4,
+    TypeInt64 = 5,
+    TypeString = 6,
+    TypeStringArray = 8,
+    TypeI18nString = 9
+};
+
+enum Tag : quint32 {
+    TagLongArchiveSize = 271, // signature and main header
+    TagName = 1000,
+    TagVersion = 1001,
+    TagRelease = 1002,
+    TagEpoch = 1003,
+    TagSummary = 1004,
+    TagDescription = 1005,
+    TagBuildTime = 1006,
+    TagBuildHost = 1007,
+    TagPayloadSize = 1007, // signature header
+    TagSize = 1009,
+    TagVendor = 1011,
+    TagLicense = 1014,
+    TagPackager = 1015,
+    TagGroup = 1016,
+    TagUrl = 1020,
+    TagArch = 1022,
+    TagOldFileNames = 1027,
+    TagFileSizes = 1028,
+    TagFileModes = 1030,
+    TagFileFlags = 1037,
+    TagSourceRpm = 1044,
+    TagArchiveSize = 1046,
+    TagProvideName = 1047,
+    TagRequireFlags = 1048,
+    TagRequireName = 1049,
+    TagRequireVersion = 1050,
+    TagConflictFlags = 1053,
+    TagConflictName = 1054,
+    TagConflictVersion = 1055,
+    TagChangelogTime = 1080,
+    TagChangelogName = 1081,
+    TagChangelogText = 1082,
+    TagObsoleteName = 1090,
+    TagFileInodes = 1096,
+    TagProvideFlags = 1112,
+    TagProvideVersion = 1113,
+    TagObsoleteFlags = 1114,
+    TagObsoleteVersion = 1115,
+    TagDirIndexes = 1116,
+    TagBaseNames = 1117,
+    TagDirNames = 1118,
+    TagPayloadCompressor = 1125,
+    TagLongFileSizes = 5008,
+    TagLongSize = 5009
+};
+
+enum Sense : quint32 {
+    SenseLess = 1 << 1,
+    SenseGreater = 1 << 2,
+    SenseEqual = 1 << 3,
+    SensePrereq = 1 << 6,
+    SenseScriptPre = 1 << 9,
+    SenseScriptPost = 1 << 10
+};
+
+void setError(QString *error, const QString &message)
+{
+    if (error)
+        *error = message;
+}
+
+quint32 be32(const char *p)
+{
+    return qFromBigEndian<quint32>(p);
+}
+
+/** Index and store of one header (signature or main); every access is bounds-checked */
+class Header
+{
+public:
+    /** Parses the header at @p offset; @p end receives the first byte after its store */
+    bool load(const char *data, qint64 size, qint64 offset, qint64 *end)
+    {
+        if (offset + HeaderIntroBytes > size
+            || std::memcmp(data + offset, HeaderMagic, sizeof(HeaderMagic)) != 0)
+            return false;
+        m_entries = be32(data + offset + 8);
+        m_storeSize = be32(data + offset + 12);
+        if (m_entries == 0 || m_entries > MaxIndexEntries || m_storeSize > MaxStoreBytes)
+            return false;
+        m_index = data + offset + HeaderIntroBytes;
+        m_store = m_index + qint64(m_entries) * IndexEntryBytes;
+        *end = offset + HeaderIntroBytes + qint64(m_entries) * IndexEntryBytes + m_storeSize;
+        return *end <= size;
+    }
+
+    QString string(quint32 tag) const
+    {
+        const QStringList values = strings(tag, 1);
+        return values.isEmpty() ? QString() : values.first();
+    }
+
+    /** STRING_ARRAY values, the first @p limit of them; STRING and I18NSTRING give their (first) value */
+    QStringList strings(quint32 tag, quint32 limit = 0xFFFFFFFFu) const
+    {
+        QStringList values;
+        quint32 type = 0, offset = 0, count = 0;
+        if (!find(tag, type, offset, count)
+            || (type != TypeString && type != TypeStringArray && type != TypeI18nString))
+            return values;
+        if (type != TypeStringArray)
+            count = 1;
+        count = qMin(count, limit);
+        values.reserve(int(qMin<quint32>(count, 4096))); // count is untrusted until walked
+        quint32 pos = offset;
+        for (quint32 i = 0; i < count; ++i) {
+            if (pos >= m_storeSize)
+                return {};
+            const void *nul = std::memchr(m_store + pos, 0, m_storeSize - pos);
+            if (!nul)
+                return {};
+            const quint32 length = quint32(static_cast<const char *>(nul) - (m_store + pos));
+            values.append(QString::fromUtf8(m_store + pos, length));
+            pos += length + 1;
+        }
+        return values;
+    }
+
+    /** INT32 or INT16 values, the first @p limit of them */
+    QVector<quint32> numbers(quint32 tag, quint32 limit = 0xFFFFFFFFu) const
+    {
+        quint32 type = 0, offset = 0, count = 0;
+        if (!find(tag, type, offset, count) || (type != TypeInt32 && type != TypeInt16))
+            return {};
+        const quint32 width = type == TypeInt32 ? 4 : 2;
+        if (quint64(offset) + quint64(count) * width > m_storeSize)
+            return {};
+        count = qMin(count, limit);
+        QVector<quint32> values(count);
+        for (quint32 i = 0; i < count; ++i) {
+            const char *p = m_store + offset + i * width;
+            values[i] = width == 4 ? be32(p) : qFromBigEndian<quint16>(p);
+        }
+        return values;
+    }
+
+    /** INT32 or INT64 values, widened */
+    QVector<qint64> sizes(quint32 tag) const
+    {
+        quint32 type = 0, offset = 0, count = 0;
+        if (!find(tag, type, offset, count) || (type != TypeInt32 && type != TypeInt64))
+            return {};
+        const quint32 width = type == TypeInt64 ? 8 : 4;
+        if (quint64(offset) + quint64(count) * width > m_storeSize)
+            return {};
+        QVector<qint64> values(count);
+        for (quint32 i = 0; i < count; ++i) {
+            const char *p = m_store + offset + i * width;
+            values[i] = width == 8 ? qint64(qFromBigEndian<quint64>(p)) : qint64(be32(p));
+        }
+        return values;
+    }
+
+    /** First INT32 or INT64 value, @p fallback when the tag is missing */
+    qint64 number(quint32 tag, qint64 fallback) const
+    {
+        quint32 type = 0, offset = 0, count = 0;
+        if (!find(tag, type, offset, count) || count == 0)
+            return fallback;
+        if (type == TypeInt32 && quint64(offset) + 4 <= m_storeSize)
+            return be32(m_store + offset);
+        if (type == TypeInt64 && quint64(offset) + 8 <= m_storeSize)
+            return qint64(qFromBigEndian<quint64>(m_store + offset));
+        return fallback;
+    }
+
+    bool contains(quint32 tag) const
+    {
+        quint32 type = 0, offset = 0, count = 0;
+        return find(tag, type, offset, count);
+    }
+
+private:
+    bool find(quint32 tag, quint32 &type, quint32 &offset, quint32 &count) const
+    {
+        // Headers have a few dozen tags; a scan beats building an index per file
+        for (quint32 i = 0; i < m_entries; ++i) {
+            const char *entry = m_index + qint64(i) * IndexEntryBytes;
+            if (be32(entry) != tag)
+                continue;
+            type = be32(entry + 4);
+            offset = be32(entry + 8);
+            count = be32(entry + 12);
+            return offset < m_storeSize && count > 0 && count <= m_storeSize;
+        }
+        return false;
+    }
+
+    const char *m_index = nullptr;
+    const char *m_store = nullptr;
+    quint32 m_entries = 0;
+    quint32 m_storeSize = 0;
+};
+
+/** pread() until @p length bytes arrived; false on error or end of file */
+bool preadFully(int fd, char *data, qint64 length, qint64 offset)
+{
+    while (length > 0) {
+        const ssize_t n = ::pread(fd, data, size_t(length), off_t(offset));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        length -= n;
+        offset += n;
+    }
+    return true;
+}
+
+/**
+ * Where the main header ends, from the two header intros alone, so only the
+ * headers are read and never the payload. Whatever is not a valid intro gives
+ * just enough bytes for parse() to name the problem.
+ */
+qint64 headersEnd(int fd, qint64 fileSize)
+{
+    auto sectionEnd = [fd, fileSize](qint64 offset) -> qint64 {
+        char intro[HeaderIntroBytes];
+        if (offset + HeaderIntroBytes > fileSize || !preadFully(fd, intro, HeaderIntroBytes, offset)
+            || std::memcmp(intro, HeaderMagic, sizeof(HeaderMagic)) != 0)
+            return 0;
+        const quint32 entries = be32(intro + 8);
+        const quint32 storeSize = be32(intro + 12);
+        if (entries > MaxIndexEntries || storeSize > MaxStoreBytes)
+            return 0;
+        return offset + HeaderIntroBytes + qint64(entries) * IndexEntryBytes + storeSize;
+    };
+    const qint64 signatureEnd = sectionEnd(LeadBytes);
+    const qint64 headerStart = (signatureEnd + 7) & ~qint64(7);
+    const qint64 end = signatureEnd > 0 ? sectionEnd(headerStart) : 0;
+    if (end > 0)
+        return qMin(end, fileSize);
+    return qMin(fileSize, (signatureEnd > 0 ? headerStart : LeadBytes) + HeaderIntroBytes);
+}
+
+QVector<RpmDependency> dependencies(const Header &header, quint32 nameTag, quint32 flagsTag,
+                                    quint32 versionTag)
+{
+    const QStringList names = header.strings(nameTag);
+    const QVector<quint32> flags = header.numbers(flagsTag);
+    const QStringList versions = header.strings(versionTag);
+    // Without matching flags and versions the names alone are still worth showing
+    const bool versioned = flags.size() == names.size() && versions.size() == names.size();
+
+    QVector<RpmDependency> deps(names.size());
+    for (qsizetype i = 0; i < names.size(); ++i) {
+        deps[i].name = names.at(i);
+        if (versioned) {
+            deps[i].flags = flags.at(i);
+            deps[i].version = versions.at(i);
+        }
+    }
+    return deps;
+}
+
+/** Full paths from the compressed dirnames/basenames/dirindexes triple, or the pre-4.0 list */
+QVector<RpmFileEntry> fileEntries(const Header &header)
+{
+    QStringList paths = header.strings(TagBaseNames);
+    if (paths.isEmpty()) {
+        paths = header.strings(TagOldFileNames);
+    } else {
+        const QStringList dirs = header.strings(TagDirNames);
+        const QVector<quint32> dirIndexes = header.numbers(TagDirIndexes);
+        if (dirIndexes.size() != paths.size())
+            return {};
+        for (qsizetype i = 0; i < paths.size(); ++i) {
+            if (dirIndexes.at(i) >= quint32(dirs.size()))
+                return {};
+            paths[i].prepend(dirs.at(dirIndexes.at(i)));
+        }
+    }
+
+    const QVector<quint32> modes = header.numbers(TagFileModes);
+    const QVector<quint32> flags = header.numbers(TagFileFlags);
+    const QVector<quint32> inodes = header.numbers(TagFileInodes);
+    QVector<qint64> sizes = header.sizes(TagLongFileSizes);
+    if (sizes.isEmpty())
+        sizes = header.sizes(TagFileSizes);
+    QVector<RpmFileEntry> files(paths.size());
+    for (qsizetype i = 0; i < paths.size(); ++i) {
+        files[i].path = paths.at(i);
+        if (modes.size() == paths.size())
+            files[i].mode = quint16(modes.at(i));
+        if (flags.size() == paths.size())
+            files[i].flags = flags.at(i);
+        if (sizes.size() == paths.size())
+            files[i].size = sizes.at(i);
+        if (inodes.size() == paths.size())
+            files[i].inode = inodes.at(i);
+    }
+    return files;
+}
+
+QVector<RpmChangelogEntry> changelog(const Header &header)
+{
+    const quint32 limit = RpmHeaderReader::ChangelogLimit;
+    const QVector<quint32> times = header.numbers(TagChangelogTime, limit);
+    const QStringList names = header.strings(TagChangelogName, limit);
+    const QStringList texts = header.strings(TagChangelogText, limit);
+    if (times.size() != names.size() || texts.size() != names.size())
+        return {};
+
+    QVector<RpmChangelogEntry> entries(times.size());
+    for (qsizetype i = 0; i < times.size(); ++i)
+        entries[i] = {times.at(i), names.at(i), texts.at(i)};
+    return entries;
+}
+
+} // namespace
+
+QString RpmDependency::toString() const
+{
+    const quint32 sense = flags & (SenseLess | SenseGreater | SenseEqual);
+    if (sense == 0 || version.isEmpty())
+        return name;
+    QString op;
+    if (sense & SenseLess)
+        op += QLatin1Char('<');
+    if (sense & SenseGreater)
+        op += QLatin1Char('>');
+    if (sense & SenseEqual)
+        op += QLatin1Char('=');
+    return name + QLatin1Char(' ') + op + QLatin1Char(' ') + version;
+}
+
+QString RpmDependency::comparison() const
+{
+    if (version.isEmpty())
+        return {};
+    switch (flags & (SenseLess | SenseGreater | SenseEqual)) {
+    case SenseLess:
+        return QStringLiteral("LT");
+    case SenseGreater:
+        return QStringLiteral("GT");
+    case SenseEqual:
+        return QStringLiteral("EQ");
+    case SenseLess | SenseEqual:
+        return QStringLiteral("LE");
+    case SenseGreater | SenseEqual:
+        return QStringLiteral("GE");
+    default:
+        return {};
+    }
+}
+
+bool RpmDependency::isPrerequisite() const
+{
+    return flags & (SensePrereq | SenseScriptPre | SenseScriptPost);
+}
+
+QString RpmPackageFile::evr() const
+{
+    return epoch.isEmpty() ? versionRelease() : epoch + QLatin1Char(':') + versionRelease();
+}
+
+bool RpmHeaderReader::parse(const char *data, qint64 size, RpmPackageFile &out, QString *error,
+                            Detail detail)
+{
+    if (size < LeadBytes || std::memcmp(data, LeadMagic, sizeof(LeadMagic)) != 0) {
+        setError(error, QObject::tr("Not an RPM package file."));
+        return false;
+    }
+    const int major = static_cast<unsigned char>(data[4]);
+    if (major < 3 || major > 4) {
+        setError(error, QObject::tr("Unsupported RPM format version %1.").arg(major));
+        return false;
+    }
+
+    Header signature;
+    qint64 signatureEnd = 0;
+    if (!signature.load(data, size, LeadBytes, &signatureEnd)) {
+        setError(error, QObject::tr("Truncated or corrupt signature header."));
+        return false;
+    }
+
+    // The main header starts on the next 8-byte boundary after the signature
+    Header header;
+    const qint64 headerStart = (signatureEnd + 7) & ~qint64(7);
+    qint64 headerEnd = 0;
+    if (!header.load(data, size, headerStart, &headerEnd)) {
+        setError(error, QObject::tr("Truncated or corrupt package header."));
+        return false;
+    }
+
+    RpmPackageFile pkg;
+    pkg.path = out.path;
+    pkg.fileSize = size;
+    pkg.name = header.string(TagName);
+    pkg.version = header.string(TagVersion);
+    pkg.release = header.string(TagRelease);
+    if (pkg.name.isEmpty() || pkg.version.isEmpty() || pkg.release.isEmpty()) {
+        setError(error, QObject::tr("Package header has no name, version or release."));
+        return false;
+    }
+    const qint64 epoch = header.number(TagEpoch, -1);
+    if (epoch >= 0)
+        pkg.epoch = QString::number(epoch);
+    pkg.summary = header.string(TagSummary);
+    pkg.license = header.string(TagLicense);
+    pkg.installedSize = header.number(TagLongSize, header.number(TagSize, 0));
+
+    // Binary packages name the source package they were built from
+    const quint16 leadType = qFromBigEndian<quint16>(data + 6);
+    pkg.sourcePackage = leadType == LeadTypeSource || !header.contains(TagSourceRpm);
+    pkg.arch = pkg.sourcePackage ? QStringLiteral("src") : header.string(TagArch);
+
+    pkg.requires = dependencies(header, TagRequireName, TagRequireFlags, TagRequireVersion);
+    pkg.provides = dependencies(header, TagProvideName, TagProvideFlags, TagProvideVersion);
+
+    if (detail == Full) {
+        pkg.conflicts = dependencies(header, TagConflictName, TagConflictFlags, TagConflictVersion);
+        pkg.obsoletes = dependencies(header, TagObsoleteName, TagObsoleteFlags, TagObsoleteVersion);
+        pkg.description = header.string(TagDescription);
+        pkg.url = header.string(TagUrl);
+        pkg.packager = header.string(TagPackager);
+        pkg.vendor = header.string(TagVendor);
+        pkg.group = header.string(TagGroup);
+        pkg.buildHost = header.string(TagBuildHost);
+        pkg.sourceRpm = header.string(TagSourceRpm);
+        pkg.payloadCompressor = header.string(TagPayloadCompressor);
+        pkg.buildTime = header.number(TagBuildTime, 0);
+        // rpm >= 4.12 keeps the payload size in the signature, older ones in the header
+        pkg.archiveSize = signature.number(TagLongArchiveSize, signature.number(TagPayloadSize, -1));
+        if (pkg.archiveSize < 0)
+            pkg.archiveSize = header.number(TagLongArchiveSize, header.number(TagArchiveSize, 0));
+        pkg.headerStart = headerStart;
+        pkg.headerEnd = headerEnd;
+        pkg.files = fileEntries(header);
+        pkg.changelog = changelog(header);
+    }
+
+    out = std::move(pkg);
+    return true;
+}
+
+bool RpmHeaderReader::read(const QString &path, RpmPackageFile &out, QString *error, Detail detail)
+{
+    out.path = path;
+    const QByteArray native = QFile::encodeName(path);
+    const int fd = ::open(native.constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        setError(error, QString::fromLocal8Bit(std::strerror(errno)));
+        return false;
+    }
+    const bool ok = read(fd, out, error, detail);
+    ::close(fd);
+    return ok;
+}
+
+bool RpmHeaderReader::read(int fd, RpmPackageFile &out, QString *error, Detail detail)
+{
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < LeadBytes) {
+        setError(error, QObject::tr("Not an RPM package file."));
+        return false;
+    }
+
+    // Read, not mapped: a file truncated underneath a mapping raises SIGBUS
+    QByteArray headers(headersEnd(fd, qint64(st.st_size)), Qt::Uninitialized);
+    errno = 0; // stays 0 when the file shrank under us
+    if (!preadFully(fd, headers.data(), headers.size(), 0)) {
+        setError(error, errno ? QString::fromLocal8Bit(std::strerror(errno))
+                              : QObject::tr("Truncated or corrupt package header."));
+        return false;
+    }
+    if (!parse(headers.constData(), headers.size(), out, error, detail))
+        return false;
+    out.fileSize = qint64(st.st_size);
+    return true;
+}
+
+QVector<RpmPackageFile> RpmHeaderReader::readAll(const QStringList &paths, int threads)
+{
+    TraceSpan span("rpmheader", "RpmHeaderReader::readAll");
+    span.arg("files", paths.size());
+
+    QVector<RpmPackageFile> files(paths.size());
+    parallelFor(int(paths.size()), threads, [&](int i) {
+        RpmPackageFile &file = files[i];
+        read(paths.at(i), file, &file.error);
+    });
+    return files;
+}
+
+RpmHeaderReader::Comparison RpmHeaderReader::compare(const RpmPackageFile &file,
+                                                     const QHash<QString, QByteArray> &installedKeys)
+{
+    if (file.sourcePackage || !file.error.isEmpty())
+        return NotInstalled;
+    const auto it = installedKeys.constFind(file.nameArch());
+    if (it == installedKeys.cend())
+        return NotInstalled;
+
+    // Sort keys compare bytewise exactly like rpmvercmp()
+    const QByteArray key = RpmEvr::sortKey(file.epoch, file.versionRelease());
+    if (key == it.value())
+        return Same;
+    return key > it.value() ? Newer : Older;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file rpmheader.h
+ * @author Nikolay Yevik
+ * @brief Native reader for the lead, signature and main header of .rpm files
+ * for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/** One requires/provides/conflicts/obsoletes entry */
+struct RpmDependency {
+    QString name;
+    QString version; /** [EPOCH:]VERSION[-RELEASE], empty when unversioned */
+    quint32 flags = 0; /** RPMSENSE_* bits */
+
+    /** "name op version" like rpm -qpR */
+    QString toString() const;
+    /** "LT", "GT", "EQ", "LE" or "GE" as repository metadata spells it; empty when unversioned */
+    QString comparison() const;
+    /** Needed by a scriptlet, so installed before the package (pre="1" in primary.xml) */
+    bool isPrerequisite() const;
+    /** rpmlib(...) features are provided by rpm itself, not by any package */
+    bool isRpmlib() const { return name.startsWith(QLatin1String("rpmlib(")); }
+};
+
+struct RpmFileEntry {
+    QString path;
+    quint16 mode = 0; /** st_mode including the file type bits */
+    quint32 flags = 0; /** RPMFILE_* bits */
+    qint64 size = 0;
+    quint32 inode = 0; /** Numbered by rpmbuild; equal for hard links of one package */
+
+    bool isDirectory() const { return (mode & 0170000) == 0040000; }
+    bool isGhost() const { return flags & (1u << 6); }
+};
+
+struct RpmChangelogEntry {
+    qint64 time = 0; /** Seconds since the epoch, day resolution by convention */
+    QString author;
+    QString text;
+};
+
+/** What rpm -qip would print for one package file */
+struct RpmPackageFile {
+    QString path; /** File the header was read from */
+    QString name;
+    QString epoch; /** Empty when the package has none */
+    QString version;
+    QString release;
+    QString arch; /** "src" for source packages */
+    QString summary;
+    QString license;
+    qint64 installedSize = 0; /** RPMTAG_LONGSIZE, or RPMTAG_SIZE on older packages */
+    qint64 fileSize = 0; /** Size of the .rpm itself */
+    bool sourcePackage = false;
+    QVector<RpmDependency> requires;
+    QVector<RpmDependency> provides;
+    QString error; /** Set instead of the fields above when the file could not be read */
+
+    /** Only filled by RpmHeaderReader::Full reads */
+    QVector<RpmDependency> conflicts;
+    QVector<RpmDependency> obsoletes;
+    QString description;
+    QString url;
+    QString packager;
+    QString vendor;
+    QString group;
+    QString buildHost;
+    QString sourceRpm;
+    QString payloadCompressor; /** "zstd", "xz", "gzip"; empty on very old packages (gzip) */
+    qint64 buildTime = 0;
+    qint64 archiveSize = 0; /** Uncompressed payload size */
+    qint64 headerStart = 0; /** Byte range of the main header in the file */
+    qint64 headerEnd = 0; /** Where the compressed cpio payload starts */
+    QVector<RpmFileEntry> files;
+    QVector<RpmChangelogEntry> changelog; /** Newest first, at most Full's changelog limit */
+
+    /** VERSION-RELEASE, the form PackageInfo::version uses */
+    QString versionRelease() const { return version + QLatin1Char('-') + release; }
+    /** [EPOCH:]VERSION-RELEASE */
+    QString evr() const;
+    /** name.arch, as PackageTableModel::nameArchKey() */
+    QString nameArch() const { return name + QLatin1Char('.') + arch; }
+};
+
+/**
+ * Reads headers straight from the file: the two header intros give their
+ * size, and only the lead and the headers are read, never the payload.
+ * Every offset and count is bounds-checked against the header store, so a
+ * truncated or hostile file yields an error, not a crash. Signatures and
+ * digests are not verified; rpm does that at install time.
+ */
+class RpmHeaderReader
+{
+public:
+    enum Comparison {
+        NotInstalled,
+        Newer, /** The file would be an upgrade */
+        Same,
+        Older /** The file would be a downgrade */
+    };
+
+    enum Detail {
+        Summary, /** What the package file view shows */
+        Full /** Everything repository metadata needs: files, changelog, all dependencies */
+    };
+
+    /** createrepo_c's default: older entries rarely matter and dominate other.xml */
+    static constexpr int ChangelogLimit = 10;
+
+    /** Fills @p out, or returns false with the reason in @p error */
+    static bool read(const QString &path, RpmPackageFile &out, QString *error = nullptr,
+                     Detail detail = Summary);
+    /** Same as read() on an open descriptor; pread() only, the file offset is left alone */
+    static bool read(int fd, RpmPackageFile &out, QString *error = nullptr, Detail detail = Summary);
+    /** Same as read() for a file already in memory */
+    static bool parse(const char *data, qint64 size, RpmPackageFile &out, QString *error = nullptr,
+                      Detail detail = Summary);
+
+    /** read() for every path on a pool of @p threads (0: one per core); order is kept */
+    static QVector<RpmPackageFile> readAll(const QStringList &paths, int threads = 0);
+
+    /**
+     * Compares @p file with the installed version of the same name.arch.
+     * @p installedKeys maps name.arch to the RpmEvr::sortKey() of the newest
+     * installed version (install-only packages can have several).
+     */
+    static Comparison compare(const RpmPackageFile &file,
+                              const QHash<QString, QByteArray> &installedKeys);
+};
@@ -0,0 +1,102 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the rpm -qi parser for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "rpminfo.h"
+#include "trace.h"
+
+#include <QStringList>
+
+InfoRows parseRpmQueryOutput(const QString &output)
+{
+    TraceSpan span("parse", "parseRpmQueryOutput");
+    InfoRows rows;
+    QString currentKey;
+    QStringList currentLines;
+    bool inDescription = false;
+    bool awaitingSignatureValue = false;
+    bool signatureStored = false;
+
+    auto commitCurrent = [&]() {
+        if (currentKey.isEmpty() || currentLines.isEmpty())
+            return;
+
+        const QString value = inDescription
+                                  ? currentLines.join(QStringLiteral("\n"))
+                                  : currentLines.join(QStringLiteral(" ")).trimmed();
+        rows.append(qMakePair(currentKey, value));
+
+        currentKey.clear();
+        currentLines.clear();
+        inDescription = false;
+        awaitingSignatureValue = false;
+    };
+
+    const QStringList lines = output.split(QLatin1Char('\n'));
+    for (const QString &rawLine : lines) {
+        const QString trimmed = rawLine.trimmed();
+
+        if (inDescription) {
+            currentLines.append(rawLine);
+            continue;
+        }
+
+        if (awaitingSignatureValue) {
+            if (!trimmed.isEmpty()) {
+                currentLines.append(trimmed);
+                commitCurrent();
+                signatureStored = true;
+            }
+            continue;
+        }
+
+        const int colonPos = rawLine.indexOf(QLatin1Char(':'));
+        if (colonPos <= 0)
+            continue;
+
+        commitCurrent();
+
+        const QString key = rawLine.left(colonPos).trimmed();
+        if (key.isEmpty())
+            continue;
+
+        const QString valuePart = rawLine.mid(colonPos + 1);
+        const QString trimmedValue = valuePart.trimmed();
+
+        if (key.compare(QStringLiteral("Description"), Qt::CaseInsensitive) == 0) {
+            currentKey = key;
+            currentLines.clear();
+            if (!trimmedValue.isEmpty())
+                currentLines.append(trimmedValue);
+            inDescription = true;
+            continue;
+        }
+
+        if (key.compare(QStringLiteral("Signature"), Qt::CaseInsensitive) == 0) {
+            if (signatureStored)
+                continue; // drop duplicates entirely
+
+            currentKey = key;
+            currentLines.clear();
+            if (!trimmedValue.isEmpty()) {
+                currentLines.append(trimmedValue);
+                commitCurrent();
+                signatureStored = true;
+            } else {
+                awaitingSignatureValue = true;
+            }
+            continue;
+        }
+
+        currentKey = key;
+        currentLines.clear();
+        if (!trimmedValue.isEmpty())
+            currentLines.append(trimmedValue);
+        commitCurrent();
+    }
+
+    commitCurrent();
+    return rows;
+}
@@ -0,0 +1,20 @@
+/**
+ * @file rpminfo.h
+ * @author Nikolay Yevik
+ * @brief Parser for "rpm -qi" output for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QMetaType>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+using InfoRow = QPair<QString, QString>;
+using InfoRows = QVector<InfoRow>;
+Q_DECLARE_METATYPE(InfoRows);
+
+/** Splits rpm -qi output into (field, value) rows; Description keeps its line breaks */
+InfoRows parseRpmQueryOutput(const QString &output);
@@ -0,0 +1,313 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the streaming .rpm payload lister for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "rpmpayload.h"
+#include "decompressor.h"
+#include "trace.h"
+
+#include <QFile>
+#include <QHash>
+#include <QObject>
+
+#include <cstring>
+
+namespace {
+    constexpr qsizetype ReadChunkBytes {64 * 1024};
+    constexpr qint64 NewcHeaderBytes {110}; // magic + 13 hex fields of 8
+    constexpr qint64 StrippedHeaderBytes {14}; // magic + the file's index in the header
+    constexpr quint32 MaxNameBytes {64 * 1024};
+    constexpr quint32 MaxLinkTargetBytes {64 * 1024};
+    const char Trailer[] {"TRAILER!!!"};
+}
+
+namespace {
+
+/** 8 hex digits of a cpio header field */
+bool parseHex(const char *p, quint32 &value)
+{
+    value = 0;
+    for (int i = 0; i < 8; ++i) {
+        const char c = p[i];
+        quint32 digit = 0;
+        if (c >= '0' && c <= '9')
+            digit = quint32(c - '0');
+        else if (c >= 'a' && c <= 'f')
+            digit = quint32(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F')
+            digit = quint32(c - 'A' + 10);
+        else
+            return false;
+        value = (value << 4) | digit;
+    }
+    return true;
+}
+
+/** Buffered, forward-only view of the decompressed archive */
+class CpioStream
+{
+public:
+    CpioStream(StreamDecompressor &input, std::atomic<qint64> &bytesRead,
+               const std::atomic<bool> &cancelled)
+        : m_input(input), m_bytesRead(bytesRead), m_cancelled(cancelled),
+          m_buffer(ReadChunkBytes, Qt::Uninitialized) {}
+
+    bool read(char *out, qint64 size)
+    {
+        while (size > 0) {
+            if (m_pos == m_end && !fill())
+                return false;
+            const qint64 n = qMin<qint64>(size, m_end - m_pos);
+            std::memcpy(out, m_buffer.constData() + m_pos, size_t(n));
+            consume(n);
+            out += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    /** File data nobody asked for: decompressed, never copied */
+    bool skip(qint64 size)
+    {
+        while (size > 0) {
+            if (m_pos == m_end && !fill())
+                return false;
+            const qint64 n = qMin<qint64>(size, m_end - m_pos);
+            consume(n);
+            size -= n;
+        }
+        return true;
+    }
+
+    /** cpio pads headers, names and data to 4 bytes from the start of the archive */
+    bool align() { return skip((4 - (m_offset & 3)) & 3); }
+
+    qint64 offset() const { return m_offset; }
+    /** Why the last read() or skip() came up short; empty at a clean end of stream */
+    QString error() const { return m_error; }
+
+private:
+    bool fill()
+    {
+        if (m_cancelled.load(std::memory_order_relaxed)) {
+            m_error = QObject::tr("Cancelled.");
+            return false;
+        }
+        const qint64 n = m_input.read(m_buffer.data(), m_buffer.size());
+        if (n < 0)
+            m_error = m_input.errorString();
+        if (n <= 0)
+            return false;
+        m_pos = 0;
+        m_end = n;
+        return true;
+    }
+
+    void consume(qint64 n)
+    {
+        m_pos += n;
+        m_offset += n;
+        m_bytesRead.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    StreamDecompressor &m_input;
+    std::atomic<qint64> &m_bytesRead;
+    const std::atomic<bool> &m_cancelled;
+    QByteArray m_buffer;
+    qint64 m_pos = 0;
+    qint64 m_end = 0;
+    qint64 m_offset = 0;
+    QString m_error;
+};
+
+/** cpio names are "./usr/bin/foo"; rpm before 4.0 wrote "usr/bin/foo" */
+QString entryPath(const QByteArray &name)
+{
+    QString path = QString::fromUtf8(name);
+    if (path.startsWith(QLatin1Char('.')))
+        path.remove(0, 1);
+    if (!path.startsWith(QLatin1Char('/')))
+        path.prepend(QLatin1Char('/'));
+    return path;
+}
+
+} // namespace
+
+QString RpmPayloadEntry::permissions() const
+{
+    QString text(10, QLatin1Char('-'));
+    switch (mode & 0170000) {
+    case 0040000:
+        text[0] = QLatin1Char('d');
+        break;
+    case 0120000:
+        text[0] = QLatin1Char('l');
+        break;
+    case 0020000:
+        text[0] = QLatin1Char('c');
+        break;
+    case 0060000:
+        text[0] = QLatin1Char('b');
+        break;
+    case 0010000:
+        text[0] = QLatin1Char('p');
+        break;
+    case 0140000:
+        text[0] = QLatin1Char('s');
+        break;
+    default:
+        break;
+    }
+    static const char Letters[] {"rwxrwxrwx"};
+    for (int i = 0; i < 9; ++i) {
+        if (mode & (0400u >> i))
+            text[i + 1] = QLatin1Char(Letters[i]);
+    }
+    // setuid, setgid and sticky replace the matching execute bit
+    if (mode & 04000)
+        text[3] = QLatin1Char(mode & 0100 ? 's' : 'S');
+    if (mode & 02000)
+        text[6] = QLatin1Char(mode & 0010 ? 's' : 'S');
+    if (mode & 01000)
+        text[9] = QLatin1Char(mode & 0001 ? 't' : 'T');
+    return text;
+}
+
+bool RpmPayloadReader::readFile(const QString &path, const Sink &sink)
+{
+    m_error.clear();
+    m_complete = false;
+
+    RpmPackageFile pkg;
+    QString error;
+    if (!RpmHeaderReader::read(path, pkg, &error, RpmHeaderReader::Full)) {
+        m_error = error;
+        return false;
+    }
+    // bzip2 and lzma payloads of old distributions
+    const StreamDecompressor::Format named = StreamDecompressor::fromName(pkg.payloadCompressor);
+    if (named == StreamDecompressor::Format::Auto) {
+        m_error = QObject::tr("Payload compression \"%1\" is not supported.").arg(pkg.payloadCompressor);
+        return false;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(pkg.headerEnd)) {
+        m_error = file.errorString();
+        return false;
+    }
+    return read(&file, pkg.files, sink);
+}
+
+bool RpmPayloadReader::read(QIODevice *device, const QVector<RpmFileEntry> &files, const Sink &sink)
+{
+    TraceSpan span("parse", "RpmPayloadReader::read");
+    m_error.clear();
+    m_complete = false;
+    m_entriesRead.store(0);
+    m_payloadBytes.store(0);
+
+    // Ghosts are in the header only. Of a set of hard links, only the last
+    // one in header order carries the data in a stripped archive.
+    qint64 expected = 0;
+    QHash<quint32, int> lastLink;
+    for (int i = 0; i < files.size(); ++i) {
+        if (files.at(i).isGhost())
+            continue;
+        ++expected;
+        if (files.at(i).inode)
+            lastLink.insert(files.at(i).inode, i);
+    }
+
+    StreamDecompressor input(device);
+    CpioStream stream(input, m_payloadBytes, m_cancelled);
+    auto fail = [this, &stream](const QString &message) {
+        m_error = stream.error().isEmpty() ? message : stream.error();
+        return false;
+    };
+
+    char header[NewcHeaderBytes];
+    QByteArray name;
+    while (!m_cancelled.load(std::memory_order_relaxed)) {
+        const qint64 entryOffset = stream.offset();
+        if (!stream.read(header, 6))
+            return fail(QObject::tr("Truncated payload: no trailer."));
+
+        RpmPayloadEntry entry;
+        qint64 dataSize = 0;
+        if (std::memcmp(header, "07070X", 6) == 0) {
+            quint32 index = 0;
+            if (!stream.read(header + 6, StrippedHeaderBytes - 6) || !parseHex(header + 6, index))
+                return fail(QObject::tr("Truncated or corrupt payload at offset %1.").arg(entryOffset));
+            if (index >= quint32(files.size()))
+                return fail(QObject::tr("Payload names file %1, the header lists %2.")
+                                .arg(index).arg(files.size()));
+            const RpmFileEntry &file = files.at(int(index));
+            entry.path = file.path;
+            entry.mode = file.mode;
+            const bool carriesData = !file.inode || lastLink.value(file.inode) == int(index);
+            dataSize = carriesData && !file.isDirectory() ? file.size : 0;
+            entry.size = dataSize;
+            if (!stream.align())
+                return fail(QObject::tr("Truncated payload at offset %1.").arg(stream.offset()));
+        } else if (std::memcmp(header, "070701", 6) == 0 || std::memcmp(header, "070702", 6) == 0) {
+            if (!stream.read(header + 6, NewcHeaderBytes - 6))
+                return fail(QObject::tr("Truncated payload at offset %1.").arg(entryOffset));
+            quint32 fields[13];
+            for (int i = 0; i < 13; ++i) {
+                if (!parseHex(header + 6 + i * 8, fields[i]))
+                    return fail(QObject::tr("Corrupt cpio header at offset %1.").arg(entryOffset));
+            }
+            const quint32 nameSize = fields[11];
+            if (nameSize == 0 || nameSize > MaxNameBytes)
+                return fail(QObject::tr("Corrupt cpio header at offset %1.").arg(entryOffset));
+            name.resize(nameSize);
+            if (!stream.read(name.data(), nameSize) || !stream.align())
+                return fail(QObject::tr("Truncated payload at offset %1.").arg(entryOffset));
+            name.chop(1); // NUL
+            if (name == Trailer) {
+                m_complete = true;
+                break;
+            }
+            entry.path = entryPath(name);
+            entry.mode = fields[1];
+            dataSize = fields[6];
+            entry.size = dataSize;
+        } else {
+            return fail(QObject::tr("Unknown cpio header at offset %1.").arg(entryOffset));
+        }
+
+        // A link's data is its target, short enough to keep; everything else is skipped
+        if (entry.isSymlink() && dataSize > 0 && dataSize <= MaxLinkTargetBytes) {
+            QByteArray target(dataSize, Qt::Uninitialized);
+            if (!stream.read(target.data(), dataSize))
+                return fail(QObject::tr("Truncated payload in %1.").arg(entry.path));
+            entry.linkTarget = QString::fromUtf8(target);
+            dataSize = 0;
+        }
+
+        const qint64 seen = m_entriesRead.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (!sink(entry)) {
+            span.arg("stoppedBySink", true);
+            break;
+        }
+        // The header said how many there are: the rest of the stream is the trailer
+        if (expected > 0 && seen == expected) {
+            m_complete = true;
+            break;
+        }
+        if (!stream.skip(dataSize) || !stream.align())
+            return fail(QObject::tr("Truncated payload in %1.").arg(entry.path));
+    }
+
+    span.arg("entries", m_entriesRead.load());
+    span.arg("payloadBytes", m_payloadBytes.load());
+    span.arg("complete", m_complete);
+    if (m_cancelled.load()) {
+        m_error = QObject::tr("Cancelled.");
+        return false;
+    }
+    return true;
+}
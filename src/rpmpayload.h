@@ -0,0 +1,75 @@
+/**
+ * @file rpmpayload.h
+ * @author Nikolay Yevik
+ * @brief Streams the cpio payload of .rpm files to list what they would
+ * install, for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+#include "rpmheader.h"
+
+class QIODevice;
+
+/** One file of the payload, as rpm -qlvp lists it */
+struct RpmPayloadEntry {
+    QString path; /** Absolute, without cpio's leading "." */
+    qint64 size = 0; /** 0 for directories and all but the last of a set of hard links */
+    quint32 mode = 0; /** st_mode including the file type bits */
+    QString linkTarget; /** Symbolic links only */
+
+    bool isDirectory() const { return (mode & 0170000) == 0040000; }
+    bool isSymlink() const { return (mode & 0170000) == 0120000; }
+    /** "drwxr-xr-x" like ls -l */
+    QString permissions() const;
+};
+
+/**
+ * Walks the payload through StreamDecompressor, one cpio entry at a time,
+ * without writing anything: file data is decompressed and thrown away in
+ * fixed-size chunks, so memory stays constant however large the package.
+ * Both the newc ("070701"/"070702") archives rpm has always written and the
+ * stripped "07070X" ones of rpm >= 4.12 (metadata only in the header) are
+ * read. Reading stops as soon as every file the header lists has been
+ * seen, without decompressing up to the trailer.
+ */
+class RpmPayloadReader
+{
+public:
+    /** Called per entry, on the reading thread; false stops the walk */
+    using Sink = std::function<bool(const RpmPayloadEntry &entry)>;
+
+    /** Reads the header of @p path, then its payload */
+    bool readFile(const QString &path, const Sink &sink);
+    /**
+     * Reads a payload from @p device, positioned at its first byte.
+     * @p files is the header's file list: it names stripped entries and
+     * tells when the listing is complete; may be empty for newc payloads.
+     */
+    bool read(QIODevice *device, const QVector<RpmFileEntry> &files, const Sink &sink);
+
+    QString errorString() const { return m_error; }
+    qint64 entriesRead() const { return m_entriesRead.load(std::memory_order_relaxed); }
+    /** Decompressed payload bytes walked, including skipped file data */
+    qint64 payloadBytesRead() const { return m_payloadBytes.load(std::memory_order_relaxed); }
+    /** True once the last file was seen, or the trailer reached */
+    bool isComplete() const { return m_complete; }
+
+    /** Safe from any thread; the running read() returns false soon after */
+    void cancel() { m_cancelled.store(true); }
+    bool isCancelled() const { return m_cancelled.load(); }
+
+private:
+    QString m_error;
+    std::atomic<qint64> m_entriesRead{0};
+    std::atomic<qint64> m_payloadBytes{0};
+    std::atomic<bool> m_cancelled{false};
+    bool m_complete = false;
+};
@@ -0,0 +1,259 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of SHA-256 for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "sha256.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define TURBORPM_SHA_NI 1
+#endif
+
+namespace {
+
+using BlockFunction = void (*)(std::uint32_t state[8], const unsigned char *data, std::size_t blocks);
+
+alignas(16) constexpr std::uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+constexpr std::uint32_t InitialState[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+inline std::uint32_t rotr(std::uint32_t x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+void blocksPortable(std::uint32_t state[8], const unsigned char *data, std::size_t blocks)
+{
+    for (; blocks; --blocks, data += 64) {
+        std::uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (std::uint32_t(data[4 * i]) << 24) | (std::uint32_t(data[4 * i + 1]) << 16)
+                   | (std::uint32_t(data[4 * i + 2]) << 8) | std::uint32_t(data[4 * i + 3]);
+        }
+        for (int i = 16; i < 64; ++i) {
+            const std::uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const std::uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            const std::uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+            const std::uint32_t ch = (e & f) ^ (~e & g);
+            const std::uint32_t t1 = h + s1 + ch + K[i] + w[i];
+            const std::uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+            const std::uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            const std::uint32_t t2 = s0 + maj;
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#ifdef TURBORPM_SHA_NI
+/**
+ * SHA-NI keeps the state as ABEF/CDGH and does two rounds per
+ * sha256rnds2; message schedule via sha256msg1/msg2 four words at a time.
+ */
+__attribute__((target("sha,sse4.1,ssse3")))
+void blocksShaNi(std::uint32_t state[8], const unsigned char *data, std::size_t blocks)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[0]));
+    __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[4]));
+    tmp = _mm_shuffle_epi32(tmp, 0xB1); // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B); // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0); // CDGH
+
+    for (; blocks; --blocks, data += 64) {
+        const __m128i abefSave = state0;
+        const __m128i cdghSave = state1;
+        __m128i msg[4];
+
+#pragma GCC unroll 16
+        for (int i = 0; i < 16; ++i) {
+            if (i < 4) {
+                msg[i] = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16 * i)), byteSwap);
+            }
+            __m128i words = _mm_add_epi32(msg[i & 3],
+                                          _mm_load_si128(reinterpret_cast<const __m128i *>(&K[4 * i])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, words);
+            if (i >= 3 && i <= 14) {
+                // Finish W[4(i+1)..] from the two previous groups
+                const __m128i shifted = _mm_alignr_epi8(msg[i & 3], msg[(i + 3) & 3], 4);
+                msg[(i + 1) & 3] = _mm_add_epi32(msg[(i + 1) & 3], shifted);
+                msg[(i + 1) & 3] = _mm_sha256msg2_epu32(msg[(i + 1) & 3], msg[i & 3]);
+            }
+            words = _mm_shuffle_epi32(words, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, words);
+            if (i >= 1 && i <= 12)
+                msg[(i + 3) & 3] = _mm_sha256msg1_epu32(msg[(i + 3) & 3], msg[i & 3]);
+        }
+
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B); // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1); // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0); // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8); // HGFE
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[4]), state1);
+}
+
+bool cpuHasShaNi()
+{
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    const bool ssse3 = ecx & (1u << 9);
+    const bool sse41 = ecx & (1u << 19);
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+    const bool sha = ebx & (1u << 29);
+    return ssse3 && sse41 && sha;
+}
+#endif
+
+BlockFunction detectBlockFunction()
+{
+#ifdef TURBORPM_SHA_NI
+    if (cpuHasShaNi())
+        return blocksShaNi;
+#endif
+    return blocksPortable;
+}
+
+std::atomic<BlockFunction> &blockFunction()
+{
+    static std::atomic<BlockFunction> function{detectBlockFunction()};
+    return function;
+}
+
+} // namespace
+
+Sha256::Sha256()
+{
+    reset();
+}
+
+void Sha256::reset()
+{
+    std::memcpy(m_state, InitialState, sizeof m_state);
+    m_buffered = 0;
+    m_length = 0;
+}
+
+void Sha256::update(const void *data, std::size_t length)
+{
+    const BlockFunction blocks = blockFunction().load(std::memory_order_relaxed);
+    auto *bytes = static_cast<const unsigned char *>(data);
+    m_length += length;
+
+    if (m_buffered) {
+        const std::size_t take = std::min(length, sizeof m_buffer - m_buffered);
+        std::memcpy(m_buffer + m_buffered, bytes, take);
+        m_buffered += take;
+        bytes += take;
+        length -= take;
+        if (m_buffered < sizeof m_buffer)
+            return;
+        blocks(m_state, m_buffer, 1);
+        m_buffered = 0;
+    }
+
+    // Whole blocks straight from the caller's memory (a read buffer, usually)
+    if (length >= 64) {
+        blocks(m_state, bytes, length / 64);
+        bytes += length & ~std::size_t(63);
+        length &= 63;
+    }
+
+    if (length) {
+        std::memcpy(m_buffer, bytes, length);
+        m_buffered = length;
+    }
+}
+
+QByteArray Sha256::finalize()
+{
+    const BlockFunction blocks = blockFunction().load(std::memory_order_relaxed);
+    const std::uint64_t bits = m_length * 8;
+
+    m_buffer[m_buffered++] = 0x80;
+    if (m_buffered > 56) {
+        std::memset(m_buffer + m_buffered, 0, sizeof m_buffer - m_buffered);
+        blocks(m_state, m_buffer, 1);
+        m_buffered = 0;
+    }
+    std::memset(m_buffer + m_buffered, 0, 56 - m_buffered);
+    for (int i = 0; i < 8; ++i)
+        m_buffer[56 + i] = static_cast<unsigned char>(bits >> (56 - 8 * i));
+    blocks(m_state, m_buffer, 1);
+    m_buffered = 0;
+
+    QByteArray digest(DigestSize, Qt::Uninitialized);
+    for (int i = 0; i < 8; ++i) {
+        digest[4 * i] = char(m_state[i] >> 24);
+        digest[4 * i + 1] = char(m_state[i] >> 16);
+        digest[4 * i + 2] = char(m_state[i] >> 8);
+        digest[4 * i + 3] = char(m_state[i]);
+    }
+    return digest;
+}
+
+QByteArray Sha256::hashHex(const void *data, std::size_t length)
+{
+    Sha256 hash;
+    hash.update(data, length);
+    return hash.finalize().toHex();
+}
+
+bool Sha256::hardwareAccelerated()
+{
+#ifdef TURBORPM_SHA_NI
+    return blockFunction().load() == blocksShaNi;
+#else
+    return false;
+#endif
+}
+
+void Sha256::setHardwareEnabled(bool enabled)
+{
+    blockFunction().store(enabled ? detectBlockFunction() : blocksPortable);
+}
@@ -0,0 +1,46 @@
+/**
+ * @file sha256.h
+ * @author Nikolay Yevik
+ * @brief Incremental SHA-256 with a hardware (x86 SHA extensions) block function
+ * for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The block function is picked once per process: the SHA-NI path where the
+ * CPU has it (Intel since Goldmont/Ice Lake, every AMD Zen), the portable one
+ * otherwise. Both produce identical digests; the test checks that.
+ */
+class Sha256
+{
+public:
+    static constexpr int DigestSize = 32;
+
+    Sha256();
+
+    void update(const void *data, std::size_t length);
+    /** Raw 32-byte digest; the object must be reset() before reuse */
+    QByteArray finalize();
+    void reset();
+
+    /** One-shot convenience, lowercase hex like rpm's FILEDIGESTS */
+    static QByteArray hashHex(const void *data, std::size_t length);
+
+    /** True when the SHA-NI block function is in use */
+    static bool hardwareAccelerated();
+    /** Forces the portable block function (tests and benchmarks); process-wide */
+    static void setHardwareEnabled(bool enabled);
+
+private:
+    std::uint32_t m_state[8];
+    unsigned char m_buffer[64];
+    std::size_t m_buffered = 0;
+    std::uint64_t m_length = 0; // bytes hashed so far
+};
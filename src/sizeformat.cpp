@@ -0,0 +1,31 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of size formatting for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "sizeformat.h"
+
+#include <QObject>
+
+QString formatSizeValue(qint64 bytes, SizeUnit unit)
+{
+    if (bytes < 0)
+        return QObject::tr("N/A");
+
+    double value = static_cast<double>(bytes);
+    QString unitLabel;
+
+    switch (unit) {
+    case SizeUnit::Kilobytes:
+        value /= 1024.0;
+        unitLabel = QObject::tr("KB");
+        break;
+    case SizeUnit::Megabytes:
+        value /= (1024.0 * 1024.0);
+        unitLabel = QObject::tr("MB");
+        break;
+    }
+
+    return QObject::tr("%1 %2").arg(value, 0, 'f', 2).arg(unitLabel);
+}
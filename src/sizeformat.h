@@ -0,0 +1,18 @@
+/**
+ * @file sizeformat.h
+ * @author Nikolay Yevik
+ * @brief Human readable package sizes for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QString>
+
+enum class SizeUnit {
+    Kilobytes,
+    Megabytes
+};
+
+/** "12.34 MB"; negative (unknown) sizes become "N/A" */
+QString formatSizeValue(qint64 bytes, SizeUnit unit);
@@ -0,0 +1,213 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the event-loop stall watchdog for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "stallwatchdog.h"
+#include "ringlog.h"
+#include "trace.h"
+
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+
+namespace {
+    constexpr int DefaultThresholdMs {250}; // about where a click starts to feel ignored
+    constexpr int MinPingIntervalMs {10};
+    constexpr int MaxPingIntervalMs {100};
+
+    /** What OperationScope writes and the watchdog thread reads */
+    struct ScopeStack {
+        std::atomic<QThread *> watched {nullptr};
+        QMutex mutex;
+        QStringList names;
+    };
+
+    ScopeStack &scopes()
+    {
+        static ScopeStack s;
+        return s;
+    }
+
+    bool pushScope(const QString &name)
+    {
+        ScopeStack &s = scopes();
+        QThread *watched = s.watched.load(std::memory_order_relaxed);
+        if (!watched || QThread::currentThread() != watched)
+            return false;
+        QMutexLocker lock(&s.mutex);
+        s.names.append(name);
+        return true;
+    }
+}
+
+QString StallRecord::blame() const
+{
+    return scopes.isEmpty() ? QStringLiteral("(no operation scope)")
+                            : scopes.join(QStringLiteral(" > "));
+}
+
+OperationScope::OperationScope(const char *name)
+    : m_pushed(scopes().watched.load(std::memory_order_relaxed) && pushScope(QString::fromUtf8(name)))
+{
+}
+
+OperationScope::OperationScope(const QString &name)
+    : m_pushed(pushScope(name))
+{
+}
+
+OperationScope::~OperationScope()
+{
+    if (!m_pushed)
+        return;
+    ScopeStack &s = scopes();
+    QMutexLocker lock(&s.mutex);
+    // Empty if the watchdog restarted under this scope
+    if (!s.names.isEmpty())
+        s.names.removeLast();
+}
+
+StallWatchdog::StallWatchdog(QObject *parent)
+    : QObject(parent)
+    , m_thresholdMs(DefaultThresholdMs)
+{
+    qRegisterMetaType<StallRecord>();
+    m_clock.start();
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    stop();
+}
+
+void StallWatchdog::setThreshold(int ms)
+{
+    m_thresholdMs = std::max(ms, 1);
+}
+
+void StallWatchdog::start()
+{
+    stop();
+    {
+        ScopeStack &s = scopes();
+        QMutexLocker lock(&s.mutex);
+        s.names.clear();
+        s.watched.store(QThread::currentThread(), std::memory_order_relaxed);
+    }
+    {
+        QMutexLocker lock(&m_mutex);
+        m_stopping = false;
+        m_worst = StallRecord();
+    }
+    m_answeredNs.store(-1, std::memory_order_relaxed);
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->start(QThread::HighPriority);
+}
+
+void StallWatchdog::stop()
+{
+    if (!m_thread)
+        return;
+    {
+        QMutexLocker lock(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeAll();
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    ScopeStack &s = scopes();
+    QMutexLocker lock(&s.mutex);
+    s.watched.store(nullptr, std::memory_order_relaxed);
+    s.names.clear();
+}
+
+bool StallWatchdog::isActive() const
+{
+    return m_thread && m_thread->isRunning();
+}
+
+StallRecord StallWatchdog::worstStall() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_worst;
+}
+
+int StallWatchdog::thresholdFromEnvironment()
+{
+    bool ok = false;
+    const int ms = qEnvironmentVariableIntValue("TURBORPM_STALL_MS", &ok);
+    return ok && ms >= 0 ? ms : DefaultThresholdMs;
+}
+
+QStringList StallWatchdog::activeScopes()
+{
+    ScopeStack &s = scopes();
+    QMutexLocker lock(&s.mutex);
+    return s.names;
+}
+
+void StallWatchdog::run()
+{
+    Trace::setThreadName("StallWatchdog");
+    const qint64 thresholdNs = qint64(m_thresholdMs) * 1000000;
+    const int intervalMs = std::clamp(m_thresholdMs / 4, MinPingIntervalMs, MaxPingIntervalMs);
+
+    qint64 sentNs = -1; // outstanding ping, -1 when none
+    bool stalled = false;
+    QStringList blamed;
+
+    QMutexLocker lock(&m_mutex);
+    while (!m_stopping) {
+        const qint64 nowNs = m_clock.nsecsElapsed();
+        if (sentNs < 0) {
+            sentNs = nowNs;
+            QMetaObject::invokeMethod(this, [this]() {
+                m_answeredNs.store(m_clock.nsecsElapsed(), std::memory_order_relaxed);
+            }, Qt::QueuedConnection);
+        } else if (const qint64 answeredNs = m_answeredNs.load(std::memory_order_relaxed);
+                   answeredNs >= sentNs) {
+            if (stalled) {
+                lock.unlock();
+                record(sentNs, answeredNs, blamed);
+                lock.relock();
+            }
+            sentNs = -1;
+            stalled = false;
+            blamed.clear();
+        } else if (nowNs - sentNs >= thresholdNs) {
+            stalled = true;
+            // The loop may be between scopes when first caught; keep looking
+            if (blamed.isEmpty())
+                blamed = activeScopes();
+        }
+        m_wake.wait(&m_mutex, intervalMs);
+    }
+}
+
+void StallWatchdog::record(qint64 sentNs, qint64 answeredNs, const QStringList &blamed)
+{
+    StallRecord stall;
+    stall.durationMs = (answeredNs - sentNs) / 1000000;
+    stall.startedAt = QDateTime::currentDateTime().addMSecs(-(m_clock.nsecsElapsed() - sentNs) / 1000000);
+    stall.scopes = blamed;
+
+    if (Trace::isEnabled()) {
+        const qint64 endNs = Trace::nowNs() - (m_clock.nsecsElapsed() - answeredNs);
+        Trace::complete("ui", "stall", endNs - (answeredNs - sentNs), endNs,
+                        QJsonObject{{QStringLiteral("blame"), stall.blame()}});
+    }
+    RingLog::write(RingLog::Warning, "stall: %1 ms during %2", stall.durationMs, stall.blame());
+
+    {
+        QMutexLocker lock(&m_mutex);
+        if (stall.durationMs > m_worst.durationMs)
+            m_worst = stall;
+    }
+    emit stallRecorded(stall);
+}
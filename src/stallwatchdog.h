@@ -0,0 +1,104 @@
+/**
+ * @file stallwatchdog.h
+ * @author Nikolay Yevik
+ * @brief Watchdog that notices when the GUI event loop stops answering and
+ * blames the operation that was running, for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMetaType>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QWaitCondition>
+
+#include <atomic>
+
+class QThread;
+
+/** One time the watched event loop did not answer within the threshold */
+struct StallRecord {
+    QDateTime startedAt; // local wall clock, when the unanswered ping was posted
+    qint64 durationMs = 0;
+    QStringList scopes; // OperationScopes open at the time, outermost first
+
+    /** "a > b > c", or a placeholder when nothing was marked */
+    QString blame() const;
+};
+Q_DECLARE_METATYPE(StallRecord)
+
+/**
+ * Names what the watched thread is doing for as long as it lives, e.g.
+ * OperationScope scope(QStringLiteral("rpm -ql bash")). Scopes nest; a
+ * stall is blamed on the whole chain. Only scopes opened on the thread a
+ * StallWatchdog watches are kept, and with no watchdog running a scope
+ * costs one atomic load.
+ */
+class OperationScope
+{
+public:
+    explicit OperationScope(const char *name);
+    explicit OperationScope(const QString &name);
+    ~OperationScope();
+    Q_DISABLE_COPY_MOVE(OperationScope)
+
+private:
+    bool m_pushed;
+};
+
+/**
+ * A thread of its own posts a ping to the thread that called start() and
+ * waits for the event loop to run it. A ping left unanswered for longer than
+ * the threshold is a stall: once the loop answers, the stall goes to RingLog
+ * with its duration and the OperationScopes open while it was stuck, and
+ * stallRecorded() is emitted. Durations are accurate to a quarter
+ * of the threshold, the ping interval. A nested event loop (a modal dialog,
+ * QEventLoop::exec) answers pings and is not a stall.
+ */
+class StallWatchdog : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StallWatchdog(QObject *parent = nullptr);
+    ~StallWatchdog() override;
+
+    /** Takes effect at the next start() */
+    void setThreshold(int ms);
+    int threshold() const { return m_thresholdMs; }
+
+    /** Watches the calling thread's event loop; one watchdog per process */
+    void start();
+    void stop();
+    bool isActive() const;
+
+    /** The longest stall since start(), durationMs 0 if none */
+    StallRecord worstStall() const;
+
+    /** TURBORPM_STALL_MS: the threshold in ms, 0 to disable; the default when unset */
+    static int thresholdFromEnvironment();
+    /** Scopes open on the watched thread right now, outermost first */
+    static QStringList activeScopes();
+
+signals:
+    /** Emitted from the watchdog thread once the stalled loop has answered */
+    void stallRecorded(const StallRecord &stall);
+
+private:
+    void run();
+    void record(qint64 sentNs, qint64 answeredNs, const QStringList &blamed);
+
+    int m_thresholdMs;
+    QElapsedTimer m_clock; // shared by both threads
+
+    QThread *m_thread = nullptr;
+    mutable QMutex m_mutex; // guards m_stopping, m_worst and the wait below
+    QWaitCondition m_wake;
+    bool m_stopping = false;
+    StallRecord m_worst;
+    std::atomic<qint64> m_answeredNs {-1}; // m_clock time the event loop last ran a ping
+};
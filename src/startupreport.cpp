@@ -0,0 +1,66 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the startup timing report for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "startupreport.h"
+
+#include <QElapsedTimer>
+#include <QPair>
+#include <QVector>
+
+#include <cstdio>
+#include <utility>
+
+namespace {
+struct StartupState {
+    QElapsedTimer clock;
+    QVector<QPair<const char *, qint64>> phases; // phase -> ns since begin()
+    bool enabled = false;
+    bool finished = false;
+};
+
+StartupState &state()
+{
+    static StartupState s;
+    return s;
+}
+} // namespace
+
+void StartupReport::begin(bool enabled)
+{
+    StartupState &s = state();
+    s.enabled = enabled;
+    s.clock.start();
+}
+
+bool StartupReport::isEnabled()
+{
+    return state().enabled;
+}
+
+void StartupReport::mark(const char *phase)
+{
+    StartupState &s = state();
+    if (!s.enabled || s.finished)
+        return;
+    s.phases.append({phase, s.clock.nsecsElapsed()});
+}
+
+void StartupReport::finish()
+{
+    StartupState &s = state();
+    if (!s.enabled || s.finished)
+        return;
+    s.finished = true;
+
+    qint64 previous = 0;
+    std::fprintf(stderr, "TurboRPM startup report (ms since main)\n");
+    for (const auto &phase : std::as_const(s.phases)) {
+        std::fprintf(stderr, "  %-24s %9.2f  (+%.2f)\n", phase.first,
+                     double(phase.second) / 1e6, double(phase.second - previous) / 1e6);
+        previous = phase.second;
+    }
+    std::fflush(stderr);
+}
@@ -0,0 +1,22 @@
+/**
+ * @file startupreport.h
+ * @author Nikolay Yevik
+ * @brief Per-phase startup timings (--startup-report) for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+class StartupReport
+{
+public:
+    /** Starts the clock; call first thing in main() */
+    static void begin(bool enabled);
+    static bool isEnabled();
+
+    /** Records @p phase at the current time; @p phase must be a string literal */
+    static void mark(const char *phase);
+
+    /** Prints the recorded phases to stderr once; later calls do nothing */
+    static void finish();
+};
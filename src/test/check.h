@@ -0,0 +1,32 @@
+/**
+ * @file check.h
+ * @author Nikolay Yevik
+ * @brief Minimal assertion harness shared by the TurboRPM test executables.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+#pragma once
+
+#include <iostream>
+
+/** Failed checks so far; tests that report their own mismatches bump it directly */
+inline int failures = 0;
+
+/** Counts and reports a failed condition, then carries on with the test */
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            ++failures;                                                          \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond \
+                      << std::endl;                                              \
+        }                                                                        \
+    } while (0)
+
+/** Prints the failure count, if any, and returns the process exit code */
+inline int checkResult()
+{
+    if (failures)
+        std::cerr << failures << " check(s) failed" << std::endl;
+    return failures ? 1 : 0;
+}
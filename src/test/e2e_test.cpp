@@ -0,0 +1,355 @@
+/**
+ * @file e2e_test.cpp
+ * @author Nikolay Yevik
+ * @brief Offscreen end-to-end test of MainWindow against stub dnf/rpm/sudo
+ * (src/test/stubs) and the unprivileged helper: latency budgets and
+ * event-loop stalls for refresh, install and what-provides.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QAbstractButton>
+#include <QAbstractItemModel>
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileDialog>
+#include <QInputDialog>
+#include <QMap>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTableView>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include "../mainwindow.h"
+#include "../operationqueue.h"
+#include "../bench/packagegen.h"
+#include "check.h"
+
+#include <functional>
+#include <iostream>
+
+namespace {
+
+int envInt(const char *name, int fallback)
+{
+    bool ok = false;
+    const int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok ? value : fallback;
+}
+
+/** Ticks every few ms on the GUI thread; the largest gap between ticks is the worst stall */
+class StallMonitor : public QObject
+{
+public:
+    StallMonitor()
+    {
+        m_timer.setTimerType(Qt::PreciseTimer);
+        m_timer.setInterval(5);
+        connect(&m_timer, &QTimer::timeout, this, [this]() {
+            const qint64 now = m_clock.elapsed();
+            m_maxGapMs = qMax(m_maxGapMs, now - m_lastTickMs);
+            m_lastTickMs = now;
+        });
+        m_clock.start();
+        m_timer.start();
+    }
+
+    void reset()
+    {
+        m_lastTickMs = m_clock.elapsed();
+        m_maxGapMs = 0;
+    }
+
+    qint64 maxGapMs() const { return m_maxGapMs; }
+
+private:
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastTickMs = 0;
+    qint64 m_maxGapMs = 0;
+};
+
+/** Answers every modal dialog MainWindow opens the way a user would */
+class ModalDriver : public QObject
+{
+public:
+    ModalDriver()
+    {
+        m_timer.setInterval(20);
+        connect(&m_timer, &QTimer::timeout, this, &ModalDriver::poll);
+        m_timer.start();
+    }
+
+    QString packageName;
+    QString path;
+    QStringList seenTitles;
+    QStringList messageBoxes;
+
+private:
+    void poll()
+    {
+        QWidget *modal = QApplication::activeModalWidget();
+        if (!modal)
+            return;
+        seenTitles << modal->windowTitle();
+
+        if (auto *files = qobject_cast<QFileDialog *>(modal)) {
+            files->reject(); // falls back to the path input dialog
+        } else if (auto *input = qobject_cast<QInputDialog *>(modal)) {
+            if (input->textEchoMode() == QLineEdit::Password)
+                input->setTextValue(QStringLiteral("stub-password"));
+            else if (input->labelText().contains(QStringLiteral("path"), Qt::CaseInsensitive))
+                input->setTextValue(path);
+            else
+                input->setTextValue(packageName);
+            input->accept();
+        } else if (auto *box = qobject_cast<QMessageBox *>(modal)) {
+            messageBoxes << box->text();
+            if (QAbstractButton *yes = box->button(QMessageBox::Yes))
+                yes->click(); // confirmation prompts
+            else
+                box->accept();
+        } else if (auto *dialog = qobject_cast<QDialog *>(modal)) {
+            dialog->accept();
+        }
+    }
+
+    QTimer m_timer;
+};
+
+bool waitFor(const std::function<bool()> &done, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!done()) {
+        if (timer.elapsed() > timeoutMs)
+            return false;
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    return true;
+}
+
+bool writeFile(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(data) == data.size();
+}
+
+QStringList readLog(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    return QString::fromUtf8(file.readAll()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+}
+
+/**
+ * Stub knobs for processes started from now on. They also go to stub.env,
+ * which the stubs source, so the long-lived helper's children see them too.
+ */
+class StubKnobs
+{
+public:
+    explicit StubKnobs(const QString &fixtures) : m_path(fixtures + QStringLiteral("/stub.env")) {}
+
+    void set(const char *name, const QByteArray &value)
+    {
+        qputenv(name, value);
+        m_values.insert(name, value);
+        write();
+    }
+
+    void unset(const char *name)
+    {
+        qunsetenv(name);
+        m_values.insert(name, QByteArray()); // "unset" in the file
+        write();
+    }
+
+private:
+    void write() const
+    {
+        QByteArray text;
+        for (auto it = m_values.cbegin(); it != m_values.cend(); ++it) {
+            if (it.value().isEmpty())
+                text += "unset " + it.key() + '\n';
+            else
+                text += "export " + it.key() + "='" + it.value() + "'\n";
+        }
+        writeFile(m_path, text);
+    }
+
+    QString m_path;
+    QMap<QByteArray, QByteArray> m_values;
+};
+
+void report(const char *scenario, qint64 elapsedMs, qint64 budgetMs, qint64 stallMs, qint64 maxStallMs)
+{
+    std::cerr << scenario << ": " << elapsedMs << " ms (budget " << budgetMs << "), worst stall "
+              << stallMs << " ms (limit " << maxStallMs << ")" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QTemporaryDir sandbox;
+    if (!sandbox.isValid()) {
+        std::cerr << "cannot create temporary directory" << std::endl;
+        return 1;
+    }
+
+    const int packageCount = envInt("TURBORPM_E2E_PACKAGES", 5000);
+    const int maxStallMs = envInt("TURBORPM_E2E_MAX_STALL_MS", 500);
+    const int refreshBudgetMs = envInt("TURBORPM_E2E_REFRESH_BUDGET_MS", 5000);
+    const int installBudgetMs = envInt("TURBORPM_E2E_INSTALL_BUDGET_MS", 5000);
+    const int providesBudgetMs = envInt("TURBORPM_E2E_PROVIDES_BUDGET_MS", 3000);
+
+    // Fixtures replayed by the stubs
+    const QString fixtures = sandbox.filePath(QStringLiteral("fixtures"));
+    QDir().mkpath(fixtures);
+    const SyntheticPackageSet set(packageCount);
+    CHECK(writeFile(fixtures + QStringLiteral("/repoquery.txt"), set.repoqueryOutput()));
+    CHECK(writeFile(fixtures + QStringLiteral("/check-update.txt"), set.checkUpdateOutput().toUtf8()));
+    CHECK(writeFile(fixtures + QStringLiteral("/install.txt"),
+                    "Dependencies resolved.\nTransaction Summary\nInstall  1 Package\n"
+                    "Running transaction\nComplete!\n"));
+    CHECK(writeFile(fixtures + QStringLiteral("/rpm-qf.txt"), "bash-5.2.26-3.fc40.x86_64\n"));
+    CHECK(writeFile(fixtures + QStringLiteral("/rpm-qi.txt"), set.rpmQiOutputs().value(0).toUtf8()));
+
+    // Stubs first on PATH, settings and caches isolated from the real user
+    const QString log = sandbox.filePath(QStringLiteral("stub.log"));
+    qputenv("PATH", QByteArray(TURBORPM_STUB_DIR ":") + qgetenv("PATH"));
+    qputenv("TURBORPM_STUB_FIXTURES", fixtures.toLocal8Bit());
+    qputenv("TURBORPM_STUB_LOG", log.toLocal8Bit());
+    qputenv("TURBORPM_STUB_NOISE", "1");
+    // Admin operations go through the real helper, running unprivileged behind the stub sudo
+    qputenv("TURBORPM_HELPER", TURBORPM_HELPER_PATH);
+    qputenv("TURBORPM_HELPER_UNPRIVILEGED", "1");
+    qputenv("XDG_CACHE_HOME", sandbox.filePath(QStringLiteral("cache")).toLocal8Bit());
+    qputenv("XDG_CONFIG_HOME", sandbox.filePath(QStringLiteral("config")).toLocal8Bit());
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("TurboRPM-e2e"));
+    QCoreApplication::setOrganizationName(QStringLiteral("YEVIK"));
+
+    StallMonitor stalls;
+    ModalDriver driver;
+    driver.packageName = QStringLiteral("stubpkg");
+    driver.path = QCoreApplication::applicationFilePath();
+
+    // --- startup + initial refresh: slow, chunked dnf -------------------------
+    StubKnobs knobs(fixtures);
+    knobs.set("TURBORPM_STUB_DELAY_MS", "300");
+    knobs.set("TURBORPM_STUB_CHUNK_BYTES", "65536");
+    knobs.set("TURBORPM_STUB_CHUNK_DELAY_MS", "20");
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    MainWindow window;
+    window.show();
+    stalls.reset(); // the constructor itself is measured by --startup-report
+
+    auto *table = window.findChild<QTableView *>(QStringLiteral("packageTableView"));
+    auto *refreshButton = window.findChild<QPushButton *>(QStringLiteral("refreshButton"));
+    CHECK(table && refreshButton);
+    if (!table || !refreshButton)
+        return 1;
+
+    const bool loaded = waitFor([&]() { return table->model()->rowCount() == packageCount; },
+                                refreshBudgetMs * 2);
+    CHECK(loaded);
+    report("startup refresh", elapsed.elapsed(), refreshBudgetMs, stalls.maxGapMs(), maxStallMs);
+    CHECK(elapsed.elapsed() <= refreshBudgetMs);
+    CHECK(stalls.maxGapMs() <= maxStallMs);
+
+    // --- explicit refresh ------------------------------------------------------
+    CHECK(waitFor([&]() { return refreshButton->isEnabled(); }, refreshBudgetMs));
+    stalls.reset();
+    elapsed.restart();
+    refreshButton->click();
+    CHECK(!refreshButton->isEnabled()); // query runs in the background
+    CHECK(waitFor([&]() { return refreshButton->isEnabled(); }, refreshBudgetMs * 2));
+    report("refresh", elapsed.elapsed(), refreshBudgetMs, stalls.maxGapMs(), maxStallMs);
+    CHECK(elapsed.elapsed() <= refreshBudgetMs);
+    CHECK(stalls.maxGapMs() <= maxStallMs);
+    CHECK(table->model()->rowCount() == packageCount);
+
+    // --- install: password prompt, queued, runs in the helper -----------------
+    knobs.set("TURBORPM_STUB_DELAY_MS", "800");
+    knobs.unset("TURBORPM_STUB_CHUNK_BYTES");
+    auto *queue = window.findChild<QTableView *>(QStringLiteral("operationQueueView"));
+    CHECK(queue);
+    if (!queue)
+        return 1;
+    auto statusOf = [queue](int row) {
+        return queue->model()->index(row, OperationQueue::StatusColumn).data().toString();
+    };
+
+    stalls.reset();
+    elapsed.restart();
+    CHECK(QMetaObject::invokeMethod(&window, "onInstallPackage"));
+    CHECK(waitFor([&]() { return statusOf(0) == QLatin1String("Done"); }, installBudgetMs * 2));
+    report("install", elapsed.elapsed(), installBudgetMs, stalls.maxGapMs(), maxStallMs);
+    CHECK(elapsed.elapsed() <= installBudgetMs);
+    CHECK(stalls.maxGapMs() <= maxStallMs);
+    CHECK(readLog(log).contains(QStringLiteral("dnf install -y stubpkg")));
+    CHECK(driver.seenTitles.contains(QStringLiteral("Confirm install")));
+
+    // --- installs queued behind a running one share its successor's transaction
+    for (const char *name : {"stubpkg-a", "stubpkg-b", "stubpkg-c"}) {
+        driver.packageName = QLatin1String(name);
+        CHECK(QMetaObject::invokeMethod(&window, "onInstallPackage"));
+    }
+    driver.packageName = QStringLiteral("stubpkg");
+    CHECK(queue->model()->rowCount() == 4);
+    CHECK(waitFor([&]() {
+        for (int row = 1; row < 4; ++row) {
+            if (statusOf(row) != QLatin1String("Done"))
+                return false;
+        }
+        return true;
+    }, installBudgetMs * 3));
+    CHECK(readLog(log).contains(QStringLiteral("dnf install -y stubpkg-a")));
+    CHECK(readLog(log).contains(QStringLiteral("dnf install -y stubpkg-b stubpkg-c")));
+
+    // --- what-provides -----------------------------------------------------------
+    knobs.set("TURBORPM_STUB_DELAY_MS", "400");
+    stalls.reset();
+    elapsed.restart();
+    CHECK(QMetaObject::invokeMethod(&window, "onWhatProvides"));
+    // rpm -qf runs in the background; its answer is a dialog
+    CHECK(waitFor([&]() {
+        return driver.seenTitles.contains(QStringLiteral("What provides (Manual selection)"));
+    }, providesBudgetMs));
+    report("what-provides", elapsed.elapsed(), providesBudgetMs, stalls.maxGapMs(), maxStallMs);
+    CHECK(elapsed.elapsed() <= providesBudgetMs);
+    CHECK(stalls.maxGapMs() <= maxStallMs);
+    CHECK(readLog(log).contains(QStringLiteral("rpm -qf ") + driver.path));
+
+    // --- failing dnf surfaces an error instead of hanging -------------------
+    knobs.set("TURBORPM_STUB_DELAY_MS", "0");
+    knobs.set("TURBORPM_STUB_EXIT_DNF_INSTALL", "1");
+    CHECK(QMetaObject::invokeMethod(&window, "onInstallPackage"));
+    CHECK(waitFor([&]() {
+        return driver.seenTitles.contains(QStringLiteral("dnf install stubpkg (exit 1)"));
+    }, installBudgetMs));
+    CHECK(statusOf(4) == QLatin1String("Failed (exit 1)"));
+    knobs.unset("TURBORPM_STUB_EXIT_DNF_INSTALL");
+
+    // Successful installs refresh in the background; let that land before teardown
+    CHECK(waitFor([&]() { return refreshButton->isEnabled(); }, refreshBudgetMs * 2));
+    CHECK(table->model()->rowCount() == packageCount);
+
+    for (const QString &text : std::as_const(driver.messageBoxes))
+        std::cerr << "message box: " << qPrintable(text) << std::endl;
+
+    window.close();
+    return checkResult();
+}
@@ -0,0 +1,227 @@
+/**
+ * @file fileverifier_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks SHA-256 (portable and SHA-NI), the rpm file-list parser and
+ * FileVerifier against a tree built from fixtures/verify/rpm-qf.txt with a
+ * known set of local modifications.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QTemporaryDir>
+
+#include "../fileverifier.h"
+#include "../sha256.h"
+#include "check.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+constexpr qint64 FixtureMtime = 1700000000;
+
+QByteArray dataBin()
+{
+    QByteArray data(3 * 1024 * 1024, Qt::Uninitialized);
+    for (qsizetype i = 0; i < data.size(); ++i)
+        data[i] = char((i * 31 + 7) & 0xff);
+    return data;
+}
+
+QVector<ExpectedFile> loadFixture()
+{
+    QFile fixture(QStringLiteral(TURBORPM_FIXTURE_DIR "/verify/rpm-qf.txt"));
+    if (!fixture.open(QIODevice::ReadOnly))
+        return {};
+    return FileVerifier::parseQueryOutput(fixture.readAll());
+}
+
+void writeFile(const QString &root, const QString &path, const QByteArray &content,
+               mode_t mode, qint64 mtime = FixtureMtime)
+{
+    QDir().mkpath(QFileInfo(root + path).path());
+    QFile file(root + path);
+    CHECK(file.open(QIODevice::WriteOnly) && file.write(content) == content.size());
+    file.close();
+    const QByteArray native = QFile::encodeName(root + path);
+    CHECK(::chmod(native.constData(), mode) == 0);
+    const struct timespec times[2] = {{mtime, 0}, {mtime, 0}};
+    CHECK(::utimensat(AT_FDCWD, native.constData(), times, 0) == 0);
+}
+
+/** The fixture's files as installed, then the local edits the test expects to find */
+void buildTree(const QString &root)
+{
+    QDir().mkpath(root + QStringLiteral("/usr/share/demo"));
+    ::chmod(QFile::encodeName(root + QStringLiteral("/usr/share/demo")).constData(), 0755);
+    writeFile(root, QStringLiteral("/etc/demo.conf"), "setting=1\n", 0644);
+    writeFile(root, QStringLiteral("/usr/bin/demo"), "#!/bin/sh\necho demo\n", 0755);
+    writeFile(root, QStringLiteral("/usr/share/demo/data.bin"), dataBin(), 0644);
+    writeFile(root, QStringLiteral("/usr/share/demo/README"), "hello\n", 0644);
+    writeFile(root, QStringLiteral("/usr/share/demo/size.txt"), "abc", 0644);
+    writeFile(root, QStringLiteral("/usr/share/demo/touched"), "touched\n", 0644);
+    writeFile(root, QStringLiteral("/usr/share/demo/empty"), QByteArray(), 0644);
+    writeFile(root, QStringLiteral("/usr/lib64/libdemo.so.1"), "ELF\n", 0755);
+    writeFile(root, QStringLiteral("/usr/share/other/file"), "other\n", 0644);
+    writeFile(root, QStringLiteral("/usr/share/other/changed"), "same\n", 0644);
+    // Not created: gone (reported), optional (missingok), demo.log (ghost), demo.mo (not installed)
+
+    // Same size, mtime restored: only the digest can tell
+    writeFile(root, QStringLiteral("/etc/demo.conf"), "setting=2\n", 0644);
+    writeFile(root, QStringLiteral("/usr/share/other/changed"), "diff\n", 0644);
+    ::chmod(QFile::encodeName(root + QStringLiteral("/usr/share/demo/README")).constData(), 0600);
+    writeFile(root, QStringLiteral("/usr/share/demo/size.txt"), "abcd", 0644);
+    writeFile(root, QStringLiteral("/usr/share/demo/touched"), "touched\n", 0644, FixtureMtime + 500);
+    CHECK(::symlink("libdemo.so.2",
+                    QFile::encodeName(root + QStringLiteral("/usr/lib64/libdemo.so")).constData()) == 0);
+}
+
+const QHash<QString, QString> &expectedMismatches()
+{
+    static const QHash<QString, QString> expected{
+        {QStringLiteral("/etc/demo.conf"), QStringLiteral("..5......")},
+        {QStringLiteral("/usr/share/demo/README"), QStringLiteral(".M.......")},
+        {QStringLiteral("/usr/share/demo/size.txt"), QStringLiteral("S.5......")},
+        {QStringLiteral("/usr/share/demo/touched"), QStringLiteral(".......T.")},
+        {QStringLiteral("/usr/share/demo/gone"), QStringLiteral("missing")},
+        {QStringLiteral("/usr/lib64/libdemo.so"), QStringLiteral("....L....")},
+        {QStringLiteral("/usr/share/other/changed"), QStringLiteral("..5......")}};
+    return expected;
+}
+
+void testSha256()
+{
+    const QByteArray million(1000000, 'a');
+    for (bool hardware : {true, false}) {
+        Sha256::setHardwareEnabled(hardware);
+        CHECK(Sha256::hashHex("", 0)
+              == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        CHECK(Sha256::hashHex("abc", 3)
+              == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        const QByteArray twoBlocks("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+        CHECK(Sha256::hashHex(twoBlocks.constData(), std::size_t(twoBlocks.size()))
+              == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+        // Odd-sized updates cross every block boundary case
+        Sha256 hash;
+        qsizetype offset = 0;
+        for (qsizetype step = 1; offset < million.size(); step = step % 131 + 7) {
+            const qsizetype n = std::min(step, million.size() - offset);
+            hash.update(million.constData() + offset, std::size_t(n));
+            offset += n;
+        }
+        CHECK(hash.finalize().toHex()
+              == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+    Sha256::setHardwareEnabled(true);
+    std::cout << "SHA-NI: " << (Sha256::hardwareAccelerated() ? "yes" : "no") << std::endl;
+}
+
+void testParse()
+{
+    const QVector<ExpectedFile> files = loadFixture();
+    CHECK(files.size() == 16); // the "not installed" line is skipped
+    if (files.isEmpty())
+        return;
+
+    const ExpectedFile &conf = files.at(1);
+    CHECK(conf.package == QLatin1String("demo-1.0-1.x86_64"));
+    CHECK(conf.path == QLatin1String("/etc/demo.conf"));
+    CHECK(conf.size == 10);
+    CHECK(conf.mode == 0100644);
+    CHECK(conf.mtime == FixtureMtime);
+    CHECK(conf.flags & FileVerifier::ConfigFile);
+    CHECK(conf.digestAlgo == 8);
+    CHECK(files.last().digestAlgo == 2);
+    CHECK(files.at(12).linkTarget == QLatin1String("libdemo.so.1"));
+
+    CHECK(FileVerifier::arguments().first() == QLatin1String("-qa"));
+    CHECK(FileVerifier::arguments({QStringLiteral("bash")}).last() == QLatin1String("bash"));
+}
+
+void testVerify(const QString &root)
+{
+    const QVector<ExpectedFile> files = loadFixture();
+
+    // Known digest, through the mmap path, both block functions
+    for (bool hardware : {true, false}) {
+        Sha256::setHardwareEnabled(hardware);
+        qint64 hashed = 0;
+        CHECK(FileVerifier::fileDigest(root + QStringLiteral("/usr/share/demo/data.bin"), 8, &hashed)
+              == "bfe74807c87a64433433238baa29cb800d0e4b5f3b8c96037ab15b620e9633c5");
+        CHECK(hashed == 3 * 1024 * 1024);
+    }
+    Sha256::setHardwareEnabled(true);
+    QString error;
+    CHECK(FileVerifier::fileDigest(root + QStringLiteral("/nope"), 8, nullptr, &error).isEmpty());
+    CHECK(!error.isEmpty());
+
+    // Same answer single-threaded, on a full pool, and with everything behind one gate
+    const QList<FileVerifier::Options> configurations{
+        {1, 1, 1, root}, {8, 1, 0, root}, {8, 1, 1, root}};
+    for (const FileVerifier::Options &options : configurations) {
+        FileVerifier verifier(options);
+        QHash<QString, VerifyResult> found;
+        const VerifyStats stats = verifier.verify(files, [&](const VerifyResult &result) {
+            CHECK(!found.contains(result.path));
+            found.insert(result.path, result);
+        });
+
+        CHECK(stats.files == files.size());
+        CHECK(stats.mismatches == expectedMismatches().size());
+        CHECK(!stats.cancelled);
+        CHECK(found.size() == expectedMismatches().size());
+        for (auto it = expectedMismatches().cbegin(); it != expectedMismatches().cend(); ++it) {
+            CHECK(found.value(it.key()).flags == it.value());
+            if (found.value(it.key()).flags != it.value())
+                std::cerr << "  " << qPrintable(it.key()) << ": "
+                          << qPrintable(found.value(it.key()).flags) << std::endl;
+        }
+        CHECK(found.value(QStringLiteral("/etc/demo.conf")).config);
+        CHECK(found.value(QStringLiteral("/usr/share/demo/gone")).missing);
+        CHECK(found.value(QStringLiteral("/usr/share/other/changed")).package
+              == QLatin1String("other-2.0-1.noarch"));
+        // size.txt is not read, the size already differs
+        CHECK(stats.bytesHashed < 3 * 1024 * 1024 + 64);
+    }
+
+    // Cancelled before it starts: nothing is checked
+    FileVerifier cancelled(FileVerifier::Options{2, 1, 0, root});
+    cancelled.cancel();
+    const VerifyStats stats = cancelled.verify(files, {});
+    CHECK(stats.cancelled);
+    CHECK(stats.files == 0);
+
+    struct stat st;
+    CHECK(::stat(QFile::encodeName(root).constData(), &st) == 0);
+    CHECK(!FileVerifier::diskKey(quint64(st.st_dev)).isEmpty());
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    testSha256();
+    testParse();
+
+    QTemporaryDir sandbox;
+    CHECK(sandbox.isValid());
+    if (sandbox.isValid()) {
+        buildTree(sandbox.path());
+        testVerify(sandbox.path());
+    }
+
+    return checkResult();
+}
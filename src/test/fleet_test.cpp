@@ -0,0 +1,237 @@
+/**
+ * @file fleet_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks the FleetSnapshot format (round trip, multi-version keys,
+ * corrupt input) and FleetMatrix loading and baseline diffs.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "../fleetmatrix.h"
+#include "../fleetsnapshot.h"
+#include "check.h"
+
+#include <algorithm>
+
+namespace {
+
+PackageInfo pkg(const QString &name, const QString &version, const QString &arch = QStringLiteral("x86_64"),
+                const QString &epoch = QStringLiteral("0"))
+{
+    PackageInfo info;
+    info.name = name;
+    info.epoch = epoch;
+    info.version = version;
+    info.arch = arch;
+    return info;
+}
+
+QVector<QPair<QByteArray, QByteArray>> decodeAll(const QByteArray &data, FleetSnapshot::Header &header,
+                                                 bool *ok)
+{
+    QVector<QPair<QByteArray, QByteArray>> entries;
+    *ok = FleetSnapshot::decode(data, header, [&](QByteArrayView key, QByteArrayView evr) {
+        entries.append({key.toByteArray(), evr.toByteArray()});
+    });
+    return entries;
+}
+
+void testRoundTrip()
+{
+    const QVector<PackageInfo> pkgs = {
+        pkg(QStringLiteral("zlib"), QStringLiteral("1.2.13-5.fc40")),
+        pkg(QStringLiteral("bash"), QStringLiteral("5.2.26-3.fc40")),
+        pkg(QStringLiteral("kernel"), QStringLiteral("6.9.4-200.fc40")),
+        pkg(QStringLiteral("kernel"), QStringLiteral("6.8.11-300.fc40")),
+        pkg(QStringLiteral("kernel"), QStringLiteral("6.10.3-200.fc40")),
+        pkg(QStringLiteral("glibc"), QStringLiteral("2.39-15.fc40"), QStringLiteral("i686")),
+        pkg(QStringLiteral("glibc"), QStringLiteral("2.39-15.fc40")),
+        pkg(QStringLiteral("shadow-utils"), QStringLiteral("4.15.1-4.fc40"), QStringLiteral("x86_64"),
+            QStringLiteral("2")),
+    };
+
+    const QByteArray data = FleetSnapshot::encode(pkgs, QStringLiteral("web-01"), 1717000000000);
+    CHECK(!data.isEmpty());
+
+    FleetSnapshot::Header header;
+    bool ok = false;
+    const auto entries = decodeAll(data, header, &ok);
+    CHECK(ok);
+    CHECK(header.host == QLatin1String("web-01"));
+    CHECK(header.capturedAtMs == 1717000000000);
+    CHECK(header.entries == 6);
+    CHECK(entries.size() == 6);
+    if (entries.size() != 6)
+        return;
+
+    // Bytewise key order, kernels folded into one entry in rpm order
+    CHECK(entries.at(0).first == "bash.x86_64");
+    CHECK(entries.at(1).first == "glibc.i686");
+    CHECK(entries.at(2).first == "glibc.x86_64");
+    CHECK(entries.at(3).first == "kernel.x86_64");
+    CHECK(entries.at(3).second == "6.8.11-300.fc40 6.9.4-200.fc40 6.10.3-200.fc40");
+    CHECK(entries.at(4).first == "shadow-utils.x86_64");
+    CHECK(entries.at(4).second == "2:4.15.1-4.fc40");
+    CHECK(entries.at(5).first == "zlib.x86_64");
+    CHECK(entries.at(5).second == "1.2.13-5.fc40");
+}
+
+void testCorruptInput()
+{
+    const QByteArray data = FleetSnapshot::encode({pkg(QStringLiteral("bash"), QStringLiteral("5.2-1"))},
+                                                  QStringLiteral("h"), 0);
+    FleetSnapshot::Header header;
+    bool ok = true;
+
+    decodeAll(QByteArray("not a snapshot"), header, &ok);
+    CHECK(!ok);
+
+    decodeAll(data.left(data.size() - 3), header, &ok);
+    CHECK(!ok);
+
+    QString error;
+    CHECK(!FleetSnapshot::read(QStringLiteral("/nonexistent/x.trpms"), header, {}, &error));
+    CHECK(!error.isEmpty());
+}
+
+void testMatrix(const QString &dir)
+{
+    const QVector<PackageInfo> base = {
+        pkg(QStringLiteral("bash"), QStringLiteral("5.2.26-3.fc40")),
+        pkg(QStringLiteral("curl"), QStringLiteral("8.6.0-8.fc40")),
+        pkg(QStringLiteral("openssl"), QStringLiteral("3.2.1-2.fc40"), QStringLiteral("x86_64"),
+            QStringLiteral("1")),
+        pkg(QStringLiteral("vim-enhanced"), QStringLiteral("9.1.393-1.fc40")),
+    };
+    QVector<PackageInfo> drifted = base;
+    drifted.removeAt(1); // curl missing
+    drifted[1].version = QStringLiteral("3.2.2-3.fc40"); // openssl changed
+    drifted.append(pkg(QStringLiteral("nginx"), QStringLiteral("1.26.1-1.fc40"))); // extra
+
+    const QString basePath = dir + QStringLiteral("/base.trpms");
+    const QString sameName = dir + QStringLiteral("/same.trpms");
+    const QString driftPath = dir + QStringLiteral("/drift.trpms");
+    const QString brokenPath = dir + QStringLiteral("/broken.trpms");
+    CHECK(FleetSnapshot::write(basePath, base, QStringLiteral("base"), 1));
+    CHECK(FleetSnapshot::write(sameName, base, QStringLiteral("same"), 2));
+    CHECK(FleetSnapshot::write(driftPath, drifted, QStringLiteral("drift"), 3));
+    QFile broken(brokenPath);
+    CHECK(broken.open(QIODevice::WriteOnly) && broken.write("garbage") == 7);
+    broken.close();
+
+    FleetMatrix matrix;
+    QStringList errors;
+    CHECK(matrix.load({basePath, sameName, brokenPath, driftPath}, &errors, 4));
+    CHECK(errors.size() == 1 && errors.first().startsWith(brokenPath));
+    CHECK(matrix.hostCount() == 3);
+    CHECK(matrix.keyCount() == 5);
+    if (matrix.hostCount() != 3 || matrix.keyCount() != 5)
+        return;
+
+    for (int k = 1; k < matrix.keyCount(); ++k)
+        CHECK(matrix.key(quint32(k - 1)) < matrix.key(quint32(k)));
+
+    auto rankOf = [&](const QByteArray &key) {
+        for (int k = 0; k < matrix.keyCount(); ++k) {
+            if (matrix.key(quint32(k)) == key)
+                return quint32(k);
+        }
+        return FleetMatrix::Absent;
+    };
+    const quint32 curl = rankOf("curl.x86_64");
+    const quint32 openssl = rankOf("openssl.x86_64");
+    const quint32 nginx = rankOf("nginx.x86_64");
+
+    CHECK(matrix.host(2).name == QLatin1String("drift"));
+    CHECK(matrix.evr(matrix.evrAt(0, openssl)) == "1:3.2.1-2.fc40");
+    CHECK(matrix.evrAt(2, curl) == FleetMatrix::Absent);
+    CHECK(matrix.evrAt(0, nginx) == FleetMatrix::Absent);
+    // Same EVR on two hosts is the same interned id
+    CHECK(matrix.evrAt(0, curl) == matrix.evrAt(1, curl));
+
+    const QVector<FleetMatrix::HostDiff> diffs = matrix.diffAll(0, 2);
+    CHECK(diffs.size() == 3);
+    CHECK(diffs.at(0).isIdentical());
+    CHECK(diffs.at(1).isIdentical());
+    CHECK(diffs.at(2).missing == QVector<quint32>{curl});
+    CHECK(diffs.at(2).extra == QVector<quint32>{nginx});
+    CHECK(diffs.at(2).changed == QVector<quint32>{openssl});
+
+    QVector<quint32> expected{curl, openssl, nginx};
+    std::sort(expected.begin(), expected.end());
+    CHECK(FleetMatrix::differingKeys(diffs) == expected);
+
+    // Against the drifted host the roles swap
+    const FleetMatrix::HostDiff reverse = matrix.diff(2, 0);
+    CHECK(reverse.missing == QVector<quint32>{nginx});
+    CHECK(reverse.extra == QVector<quint32>{curl});
+    CHECK(reverse.changed == QVector<quint32>{openssl});
+}
+
+void testParallelLoadMatchesSerial(const QString &dir)
+{
+    QStringList paths;
+    for (int h = 0; h < 40; ++h) {
+        QVector<PackageInfo> pkgs;
+        for (int p = 0; p < 300; ++p) {
+            if ((p + h) % 17 == 0)
+                continue; // a few holes per host
+            pkgs.append(pkg(QStringLiteral("pkg%1").arg(p, 4, 10, QLatin1Char('0')),
+                            QStringLiteral("1.%1-%2").arg(p % 7).arg((p * h) % 5)));
+        }
+        const QString path = dir + QStringLiteral("/host%1.trpms").arg(h);
+        CHECK(FleetSnapshot::write(path, pkgs, QStringLiteral("host%1").arg(h), h));
+        paths << path;
+    }
+
+    FleetMatrix serial;
+    FleetMatrix parallel;
+    CHECK(serial.load(paths, nullptr, 1));
+    CHECK(parallel.load(paths, nullptr, 8));
+    CHECK(serial.hostCount() == parallel.hostCount());
+    CHECK(serial.keyCount() == parallel.keyCount());
+    if (serial.hostCount() != parallel.hostCount() || serial.keyCount() != parallel.keyCount())
+        return;
+
+    // Interned ids may differ between runs; ranks and strings may not
+    for (int h = 0; h < serial.hostCount(); ++h) {
+        CHECK(serial.host(h).name == parallel.host(h).name);
+        for (int k = 0; k < serial.keyCount(); ++k) {
+            CHECK(serial.key(quint32(k)) == parallel.key(quint32(k)));
+            CHECK(serial.evr(serial.evrAt(h, quint32(k)))
+                  == parallel.evr(parallel.evrAt(h, quint32(k))));
+        }
+    }
+
+    const auto a = serial.diffAll(3, 1);
+    const auto b = parallel.diffAll(3, 8);
+    for (int h = 0; h < a.size(); ++h) {
+        CHECK(a.at(h).missing == b.at(h).missing);
+        CHECK(a.at(h).extra == b.at(h).extra);
+        CHECK(a.at(h).changed.size() == b.at(h).changed.size());
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    testRoundTrip();
+    testCorruptInput();
+
+    QTemporaryDir sandbox;
+    CHECK(sandbox.isValid());
+    if (sandbox.isValid()) {
+        testMatrix(sandbox.path());
+        testParallelLoadMatchesSerial(sandbox.path());
+    }
+
+    return checkResult();
+}
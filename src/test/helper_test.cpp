@@ -0,0 +1,255 @@
+/**
+ * @file helper_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks the turborpm-helper framing and whitelist, then drives the real
+ * helper binary as an unprivileged stand-in through the stub sudo and dnf.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include "../helperclient.h"
+#include "../helperprotocol.h"
+#include "../ringlog.h"
+#include "check.h"
+
+#include <signal.h>
+#include <unistd.h>
+#include <functional>
+#include <iostream>
+
+namespace {
+
+bool waitFor(const std::function<bool()> &done, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!done()) {
+        if (timer.elapsed() > timeoutMs)
+            return false;
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    return true;
+}
+
+void testFraming()
+{
+    const QJsonObject first{{QStringLiteral("id"), 1}, {QStringLiteral("op"), QStringLiteral("ping")}};
+    const QJsonObject second{{QStringLiteral("id"), 2}, {QStringLiteral("data"), QStringLiteral("é\n")}};
+    const QByteArray stream = HelperProtocol::encode(first) + HelperProtocol::encode(second);
+
+    // One byte at a time: frames only come out once complete
+    HelperFrameReader reader;
+    QList<QJsonObject> decoded;
+    for (char byte : stream) {
+        reader.append(QByteArray(1, byte));
+        QJsonObject message;
+        while (reader.next(message))
+            decoded << message;
+    }
+    CHECK(decoded.size() == 2);
+    CHECK(decoded.value(0) == first);
+    CHECK(decoded.value(1) == second);
+    CHECK(!reader.hasError());
+
+    HelperFrameReader oversized;
+    oversized.append(QByteArray::fromHex("7fffffff") + "{}");
+    QJsonObject message;
+    QString error;
+    CHECK(!oversized.next(message, &error));
+    CHECK(oversized.hasError() && !error.isEmpty());
+
+    HelperFrameReader garbage;
+    garbage.append(QByteArray::fromHex("00000003") + "{x}");
+    CHECK(!garbage.next(message, &error));
+    CHECK(garbage.hasError());
+}
+
+void testWhitelist()
+{
+    HelperProtocol::Command command;
+    CHECK(HelperProtocol::commandFor(QStringLiteral("install"), {QStringLiteral("bash"), QStringLiteral("zsh.x86_64")}, command));
+    CHECK(command.program == QLatin1String("dnf"));
+    CHECK(command.arguments == (QStringList{"install", "-y", "bash", "zsh.x86_64"}));
+    CHECK(HelperProtocol::commandFor(QStringLiteral("install"), {QStringLiteral("/tmp/local-1.0-1.x86_64.rpm")}, command));
+    CHECK(HelperProtocol::commandFor(QStringLiteral("upgrade"), {}, command));
+    CHECK(HelperProtocol::commandFor(QStringLiteral("makecache"), {}, command));
+    CHECK(HelperProtocol::commandFor(QStringLiteral("check-update"), {}, command));
+    CHECK(command.arguments == QStringList{QStringLiteral("check-update")});
+
+    QString error;
+    CHECK(!HelperProtocol::commandFor(QStringLiteral("shell"), {QStringLiteral("bash")}, command, &error));
+    CHECK(!error.isEmpty());
+    CHECK(!HelperProtocol::commandFor(QStringLiteral("install"), {QStringLiteral("--setopt=gpgcheck=0")}, command));
+    CHECK(!HelperProtocol::commandFor(QStringLiteral("install"), {QStringLiteral("-x")}, command));
+    CHECK(!HelperProtocol::commandFor(QStringLiteral("install"), {QStringLiteral("/etc/shadow")}, command));
+    CHECK(!HelperProtocol::commandFor(QStringLiteral("install"), {QStringLiteral("/tmp/../etc/x.rpm")}, command));
+    CHECK(!HelperProtocol::commandFor(QStringLiteral("install"), {QStringLiteral("a;rm")}, command));
+    CHECK(!HelperProtocol::commandFor(QStringLiteral("remove"), {}, command));
+    CHECK(!HelperProtocol::commandFor(QStringLiteral("makecache"), {QStringLiteral("x")}, command));
+    CHECK(!HelperProtocol::commandFor(QStringLiteral("check-update"), {QStringLiteral("bash")}, command));
+}
+
+/** What the helper answered to one request, collected from the client's signals */
+struct Reply {
+    QByteArray output;
+    int exitCode = -1;
+    QString error;
+    bool done = false;
+};
+
+Reply sendAndWait(HelperClient &client, const QString &op, const QStringList &args)
+{
+    Reply reply;
+    const int id = client.send(op, args);
+    CHECK(id > 0);
+    QObject context;
+    QObject::connect(&client, &HelperClient::output, &context, [&](int replyId, const QByteArray &data) {
+        if (replyId == id)
+            reply.output += data;
+    });
+    QObject::connect(&client, &HelperClient::finished, &context, [&](int replyId, int code) {
+        if (replyId == id) {
+            reply.exitCode = code;
+            reply.done = true;
+        }
+    });
+    QObject::connect(&client, &HelperClient::failed, &context, [&](int replyId, const QString &message) {
+        if (replyId == id) {
+            reply.error = message;
+            reply.done = true;
+        }
+    });
+    CHECK(waitFor([&]() { return reply.done; }, 10000));
+    return reply;
+}
+
+void testLiveHelper(const QString &sandbox)
+{
+    const QString fixtures = sandbox + QStringLiteral("/fixtures");
+    const QString log = sandbox + QStringLiteral("/stub.log");
+    QDir().mkpath(fixtures);
+    QFile install(fixtures + QStringLiteral("/install.txt"));
+    CHECK(install.open(QIODevice::WriteOnly) && install.write("Installing stubpkg: caf\xc3\xa9 \xe2\x9c\x93\nComplete!\n") > 0);
+    install.close();
+
+    qputenv("PATH", QByteArray(TURBORPM_STUB_DIR ":") + qgetenv("PATH"));
+    qputenv("TURBORPM_STUB_FIXTURES", fixtures.toLocal8Bit());
+    qputenv("TURBORPM_STUB_LOG", log.toLocal8Bit());
+    qputenv("TURBORPM_STUB_DELAY_MS", "300");
+    // Byte by byte, so pipe reads split the multi-byte characters
+    qputenv("TURBORPM_STUB_CHUNK_BYTES", "1");
+    qputenv("TURBORPM_STUB_CHUNK_DELAY_MS", "5");
+    qputenv("TURBORPM_HELPER_UNPRIVILEGED", "1");
+
+    HelperClient client;
+    QString error;
+    const bool started = client.start(QStringLiteral(TURBORPM_HELPER_PATH), "stub-password", &error);
+    CHECK(started);
+    if (!started) {
+        std::cerr << "helper did not start: " << qPrintable(error) << std::endl;
+        return;
+    }
+    CHECK(client.isAlive());
+    CHECK(client.helperPid() > 0);
+
+    // One operation, output streamed back, exit code preserved
+    const Reply installed = sendAndWait(client, QStringLiteral("install"), {QStringLiteral("stubpkg")});
+    CHECK(installed.exitCode == 0 && installed.error.isEmpty());
+    CHECK(installed.output.contains("Complete!"));
+    CHECK(installed.output.contains("caf\xc3\xa9 \xe2\x9c\x93\n"));
+
+    // The helper refuses what the whitelist refuses, and stays up
+    const Reply shell = sendAndWait(client, QStringLiteral("shell"), {});
+    CHECK(shell.error.contains(QStringLiteral("not allowed")) && shell.output.isEmpty());
+    const Reply option = sendAndWait(client, QStringLiteral("install"), {QStringLiteral("--nogpgcheck")});
+    CHECK(!option.error.isEmpty() && option.exitCode == -1);
+    CHECK(client.isAlive());
+
+    // A second operation while one runs is refused, the running one completes
+    const int running = client.send(QStringLiteral("install"), {QStringLiteral("stubpkg")});
+    int refusedId = -1;
+    int finishedId = -1;
+    QObject::connect(&client, &HelperClient::failed, [&](int id, const QString &) { refusedId = id; });
+    QObject::connect(&client, &HelperClient::finished, [&](int id, int) { finishedId = id; });
+    const int second = client.send(QStringLiteral("remove"), {QStringLiteral("stubpkg")});
+    CHECK(waitFor([&]() { return finishedId == running; }, 10000));
+    CHECK(refusedId == second);
+
+    QFile logFile(log);
+    CHECK(logFile.open(QIODevice::ReadOnly));
+    const QByteArray calls = logFile.readAll();
+    CHECK(calls.contains("dnf install -y stubpkg"));
+    CHECK(!calls.contains("dnf remove"));
+    CHECK(!calls.contains("nogpgcheck"));
+
+    // Losing the helper is reported, not discovered on the next command
+    bool lost = false;
+    QObject::connect(&client, &HelperClient::healthChanged, [&](bool alive) { lost = !alive; });
+    ::kill(pid_t(client.helperPid()), SIGKILL);
+    CHECK(waitFor([&]() { return lost; }, 5000));
+    CHECK(!client.isAlive());
+    CHECK(client.send(QStringLiteral("install"), {QStringLiteral("stubpkg")}) == -1);
+    RingLog::flush();
+    const QVector<RingLog::Entry> logged = RingLog::recent();
+    CHECK(!logged.isEmpty() && logged.last().level == RingLog::Error
+          && logged.last().message.startsWith(QStringLiteral("helper: pid %1 lost").arg(client.helperPid())));
+}
+
+void testRejectedHello(const QString &sandbox)
+{
+    // A stand-in that says hello and idles; needs the stub sudo on PATH
+    const QString frame = sandbox + QStringLiteral("/hello.frame");
+    const QString fake = sandbox + QStringLiteral("/fake-helper");
+    QFile script(fake);
+    CHECK(script.open(QIODevice::WriteOnly));
+    script.write("#!/bin/sh\ncat '" + frame.toLocal8Bit() + "'\nexec sleep 30\n");
+    script.close();
+    script.setPermissions(script.permissions() | QFileDevice::ExeOwner);
+
+    auto startWith = [&](int version, qint64 uid, QString *error) {
+        QFile hello(frame);
+        CHECK(hello.open(QIODevice::WriteOnly));
+        hello.write(HelperProtocol::encode({{QStringLiteral("type"), QStringLiteral("hello")},
+                                            {QStringLiteral("version"), version},
+                                            {QStringLiteral("uid"), uid},
+                                            {QStringLiteral("pid"), 1}}));
+        hello.close();
+        HelperClient client;
+        const bool started = client.start(fake, "stub-password", error, 5000);
+        CHECK(!client.isAlive());
+        return started;
+    };
+
+    QString error;
+    CHECK(!startWith(HelperProtocol::Version + 1, qint64(::geteuid()), &error));
+    CHECK(error.contains(QStringLiteral("protocol version")));
+    CHECK(!startWith(HelperProtocol::Version, qint64(::geteuid()) + 1, &error));
+    CHECK(error.contains(QStringLiteral("uid")));
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    testFraming();
+    testWhitelist();
+
+    QTemporaryDir sandbox;
+    CHECK(sandbox.isValid());
+    if (sandbox.isValid())
+        testLiveHelper(sandbox.path());
+    if (sandbox.isValid())
+        testRejectedHello(sandbox.path());
+
+    return checkResult();
+}
@@ -0,0 +1,134 @@
+/**
+ * @file operationqueue_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks OperationQueue scheduling: coalescing of adjacent compatible
+ * items, ordering across kinds, cancellation and shared batch outcomes.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QCoreApplication>
+
+#include "../operationqueue.h"
+#include "check.h"
+
+namespace {
+
+/** Records batches instead of running dnf */
+struct Recorder {
+    explicit Recorder(OperationQueue &queue)
+    {
+        QObject::connect(&queue, &OperationQueue::batchStarted,
+                         [this](const OperationQueue::Batch &batch) { started << batch; });
+        QObject::connect(&queue, &OperationQueue::batchFinished,
+                         [this](const OperationQueue::Batch &batch, int, const QString &) {
+                             finished << batch.id;
+                         });
+    }
+
+    QList<OperationQueue::Batch> started;
+    QList<int> finished;
+};
+
+void drain()
+{
+    QCoreApplication::processEvents();
+    QCoreApplication::processEvents();
+}
+
+void testBurstCoalesces()
+{
+    OperationQueue queue;
+    Recorder recorder(queue);
+
+    // Enqueued before the event loop runs: one dispatch sees all of them
+    const int a = queue.enqueue(OperationQueue::Install, {QStringLiteral("a")});
+    const int b = queue.enqueue(OperationQueue::Install, {QStringLiteral("b"), QStringLiteral("a")});
+    const int c = queue.enqueue(OperationQueue::Remove, {QStringLiteral("c")});
+    const int d = queue.enqueue(OperationQueue::Install, {QStringLiteral("d")});
+    drain();
+
+    CHECK(recorder.started.size() == 1);
+    const OperationQueue::Batch first = recorder.started.value(0);
+    CHECK(first.kind == OperationQueue::Install);
+    CHECK(first.packages == (QStringList{"a", "b"})); // union, queue order, no duplicates
+    CHECK(first.itemIds == (QVector<int>{a, b}));
+    CHECK(queue.item(a)->status == OperationQueue::Running);
+    CHECK(queue.item(c)->status == OperationQueue::Pending);
+    CHECK(queue.isBusy());
+
+    // The remove must not jump ahead of, or merge with, the later install
+    queue.finishBatch(first.id, 0, QStringLiteral("ok"));
+    drain();
+    CHECK(recorder.started.size() == 2);
+    CHECK(recorder.started.value(1).kind == OperationQueue::Remove);
+    CHECK(recorder.started.value(1).itemIds == (QVector<int>{c}));
+    CHECK(queue.item(a)->status == OperationQueue::Succeeded);
+    CHECK(queue.item(b)->status == OperationQueue::Succeeded);
+    CHECK(queue.outputFor(b) == QLatin1String("ok"));
+
+    // A failed transaction fails every item in it
+    queue.finishBatch(recorder.started.value(1).id, 1, QStringLiteral("nope"));
+    drain();
+    CHECK(queue.item(c)->status == OperationQueue::Failed);
+    CHECK(queue.item(c)->exitCode == 1);
+    CHECK(recorder.started.size() == 3);
+    CHECK(recorder.started.value(2).itemIds == (QVector<int>{d}));
+
+    queue.finishBatch(recorder.started.value(2).id, 0, QString());
+    drain();
+    CHECK(!queue.isBusy());
+    CHECK(recorder.finished.size() == 3);
+}
+
+void testQueuedBehindRunning()
+{
+    OperationQueue queue;
+    Recorder recorder(queue);
+
+    queue.enqueue(OperationQueue::Install, {QStringLiteral("first")});
+    drain();
+    CHECK(recorder.started.size() == 1);
+
+    // While "first" runs, requests pile up and go out together
+    queue.enqueue(OperationQueue::Install, {QStringLiteral("x")});
+    const int cancelled = queue.enqueue(OperationQueue::Install, {QStringLiteral("y")});
+    queue.enqueue(OperationQueue::Install, {QStringLiteral("z")});
+    drain();
+    CHECK(recorder.started.size() == 1);
+
+    CHECK(queue.cancel(cancelled));
+    CHECK(!queue.cancel(cancelled)); // only pending items
+    CHECK(!queue.cancel(recorder.started.value(0).itemIds.value(0))); // running
+
+    queue.finishBatch(recorder.started.value(0).id, 0, QString());
+    drain();
+    CHECK(recorder.started.size() == 2);
+    CHECK(recorder.started.value(1).packages == (QStringList{"x", "z"}));
+    CHECK(queue.item(cancelled)->status == OperationQueue::Cancelled);
+
+    // Stale or unknown batch ids are ignored
+    queue.finishBatch(recorder.started.value(0).id, 0, QString());
+    queue.finishBatch(12345, 0, QString());
+    CHECK(queue.isBusy());
+
+    queue.finishBatch(recorder.started.value(1).id, 0, QString());
+    drain();
+    CHECK(queue.pendingCount() == 0);
+    CHECK(queue.rowCount() == 4);
+    queue.clearFinished();
+    CHECK(queue.rowCount() == 0);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    testBurstCoalesces();
+    testQueuedBehindRunning();
+
+    return checkResult();
+}
@@ -0,0 +1,258 @@
+/**
+ * @file packagejournal_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks PackageJournal: replay of every past state, checkpoint
+ * placement, torn-tail recovery, the installtime index and file size after
+ * a year of daily refreshes.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QMap>
+#include <QTemporaryDir>
+
+#include "../packagejournal.h"
+#include "check.h"
+
+namespace {
+
+constexpr qint64 Day {24 * 3600};
+constexpr qint64 Start {1704067200}; // 2024-01-01 00:00 UTC
+
+bool sameState(const PackageJournal::State &a, const PackageJournal::State &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (qsizetype i = 0; i < a.size(); ++i) {
+        if (a.at(i).key != b.at(i).key || a.at(i).evr != b.at(i).evr
+            || a.at(i).installTime != b.at(i).installTime)
+            return false;
+    }
+    return true;
+}
+
+PackageInfo pkg(int id, int release, qint64 installTime)
+{
+    PackageInfo info;
+    info.name = QStringLiteral("package-%1").arg(id, 4, 10, QLatin1Char('0'));
+    info.epoch = QStringLiteral("0");
+    info.version = QStringLiteral("1.%1-%2.fc40").arg(id % 13).arg(release);
+    info.arch = id % 9 == 0 ? QStringLiteral("noarch") : QStringLiteral("x86_64");
+    info.installDate = QString::number(installTime);
+    return info;
+}
+
+/** One simulated machine: a few upgrades most days, an install or removal now and then */
+class Machine
+{
+public:
+    explicit Machine(int packages)
+    {
+        for (int i = 0; i < packages; ++i)
+            m_installed.insert(i, {1, Start - Day});
+        m_nextId = packages;
+    }
+
+    void advance(int day)
+    {
+        const qint64 now = Start + day * Day;
+        if (day % 7 == 6)
+            return; // quiet day: nothing changes
+        for (int n = 0; n < 3; ++n) {
+            const int id = (day * 37 + n * 101) % m_nextId;
+            if (m_installed.contains(id))
+                m_installed[id] = {m_installed[id].first + 1, now};
+        }
+        if (day % 5 == 0)
+            m_installed.insert(m_nextId++, {1, now});
+        if (day % 11 == 0)
+            m_installed.remove((day * 13) % m_nextId);
+    }
+
+    QVector<PackageInfo> packages() const
+    {
+        QVector<PackageInfo> pkgs;
+        for (auto it = m_installed.cbegin(); it != m_installed.cend(); ++it)
+            pkgs.append(pkg(it.key(), it.value().first, it.value().second));
+        return pkgs;
+    }
+
+private:
+    QMap<int, QPair<int, qint64>> m_installed; // id -> (release, install time)
+    int m_nextId = 0;
+};
+
+void testInstallTime()
+{
+    CHECK(PackageJournal::parseInstallTime(QStringLiteral("2024-01-01 00:00")) == Start);
+    CHECK(PackageJournal::parseInstallTime(QStringLiteral("2024-01-01T00:00:00Z")) == Start);
+    CHECK(PackageJournal::parseInstallTime(QStringLiteral("1704067200")) == Start);
+    CHECK(PackageJournal::parseInstallTime(QStringLiteral("soon")) == 0);
+}
+
+void testDiff()
+{
+    const PackageJournal::State before = PackageJournal::stateFor({pkg(1, 1, 10), pkg(2, 1, 10), pkg(3, 1, 10)});
+    const PackageJournal::State after = PackageJournal::stateFor({pkg(1, 1, 10), pkg(2, 2, 20), pkg(4, 1, 20)});
+    const PackageJournal::Diff diff = PackageJournal::diff(before, after);
+    CHECK(diff.added.size() == 1 && diff.added.first().key == "package-0004.x86_64");
+    CHECK(diff.removed.size() == 1 && diff.removed.first().key == "package-0003.x86_64");
+    CHECK(diff.changed.size() == 1 && diff.changed.first().first.evr == "1.2-1.fc40"
+          && diff.changed.first().second.evr == "1.2-2.fc40");
+    CHECK(PackageJournal::diff(after, after).isEmpty());
+
+    // Same NEVRA with a new install time is a reinstall
+    const PackageJournal::Diff reinstall =
+        PackageJournal::diff(PackageJournal::stateFor({pkg(1, 1, 10)}), PackageJournal::stateFor({pkg(1, 1, 30)}));
+    CHECK(reinstall.changed.size() == 1 && reinstall.added.isEmpty() && reinstall.removed.isEmpty());
+}
+
+void testYear(const QString &path)
+{
+    Machine machine(2000);
+    QVector<PackageJournal::State> expected;
+    QVector<qint64> times;
+    {
+        PackageJournal journal(path);
+        CHECK(journal.open());
+        CHECK(journal.records().isEmpty());
+        for (int day = 0; day < 365; ++day) {
+            machine.advance(day);
+            const PackageJournal::State state = PackageJournal::stateFor(machine.packages());
+            bool appended = false;
+            QString error;
+            CHECK(journal.append(state, (Start + day * Day) * 1000, &appended, &error));
+            if (appended) {
+                expected.append(state);
+                times.append((Start + day * Day) * 1000);
+            }
+        }
+        bool appended = true;
+        CHECK(journal.append(expected.last(), (Start + 365 * Day) * 1000, &appended));
+        CHECK(!appended);
+    }
+
+    PackageJournal journal(path);
+    QString error;
+    CHECK(journal.open(&error));
+    CHECK(journal.records().size() == expected.size());
+    if (journal.records().size() != expected.size())
+        return;
+
+    int checkpoints = 0;
+    for (int i = 0; i < expected.size(); ++i) {
+        const PackageJournal::Record &record = journal.records().at(i);
+        checkpoints += record.checkpoint ? 1 : 0;
+        CHECK(record.timestampMs == times.at(i));
+        CHECK(record.packages == expected.at(i).size());
+        PackageJournal::State state;
+        CHECK(journal.stateAt(i, state, &error));
+        CHECK(sameState(state, expected.at(i)));
+    }
+    CHECK(journal.records().first().checkpoint);
+    CHECK(checkpoints > 1); // replay stays short
+    CHECK(checkpoints < expected.size() / 10);
+    CHECK(sameState(journal.latest(), expected.last()));
+
+    // Every day upgrades three packages; day 5 also installs one
+    PackageJournal::Diff changes;
+    CHECK(journal.changesAt(5, changes, &error));
+    CHECK(changes.changed.size() == 3 && changes.added.size() == 1 && changes.removed.isEmpty());
+
+    // Storing every state whole would cost records x checkpoint size
+    const qint64 checkpointBytes = journal.records().at(1).offset - journal.records().at(0).offset;
+    CHECK(journal.fileSize() < checkpointBytes * expected.size() / 4);
+
+    const QVector<PackageJournal::Entry> week = journal.installedBetween(Start, Start + 7 * Day);
+    CHECK(!week.isEmpty());
+    for (qsizetype i = 0; i < week.size(); ++i) {
+        CHECK(week.at(i).installTime >= Start && week.at(i).installTime < Start + 7 * Day);
+        if (i > 0)
+            CHECK(week.at(i - 1).installTime <= week.at(i).installTime);
+    }
+    CHECK(journal.installedBetween(Start - 2 * Day, Start - Day).isEmpty());
+    // Day 0 upgraded two of the original packages and removed a third
+    CHECK(journal.installedBetween(Start - Day, Start).size() == 1997);
+}
+
+void testTornTail(const QString &path)
+{
+    Machine machine(50);
+    PackageJournal journal(path);
+    CHECK(journal.open());
+    for (int day = 0; day < 5; ++day) {
+        machine.advance(day);
+        CHECK(journal.append(PackageJournal::stateFor(machine.packages()), day * 1000));
+    }
+    const int records = int(journal.records().size());
+    const qint64 size = journal.fileSize();
+
+    // Crash halfway through the next append
+    QFile file(path);
+    CHECK(file.open(QIODevice::ReadWrite));
+    CHECK(file.resize(size + 9));
+    file.close();
+
+    PackageJournal reopened(path);
+    CHECK(reopened.open());
+    CHECK(reopened.records().size() == records);
+    CHECK(reopened.fileSize() == size);
+
+    machine.advance(5);
+    const PackageJournal::State next = PackageJournal::stateFor(machine.packages());
+    CHECK(reopened.append(next, 5000));
+
+    PackageJournal again(path);
+    CHECK(again.open());
+    CHECK(again.records().size() == records + 1);
+    CHECK(sameState(again.latest(), next));
+    CHECK(QFile(path).size() == again.fileSize());
+
+    QFile::remove(path);
+    QFile bogus(path);
+    CHECK(bogus.open(QIODevice::WriteOnly) && bogus.write("definitely not a journal") > 0);
+    bogus.close();
+    QString error;
+    CHECK(!PackageJournal(path).open(&error));
+    CHECK(!error.isEmpty());
+}
+
+void testMaxDeltas(const QString &path)
+{
+    Machine machine(200);
+    PackageJournal journal(path);
+    journal.setMaxDeltasPerCheckpoint(4);
+    CHECK(journal.open());
+    for (int day = 0; day < 30; ++day) {
+        machine.advance(day);
+        CHECK(journal.append(PackageJournal::stateFor(machine.packages()), day * 1000));
+    }
+    int sinceCheckpoint = 0;
+    for (const PackageJournal::Record &record : journal.records()) {
+        sinceCheckpoint = record.checkpoint ? 0 : sinceCheckpoint + 1;
+        CHECK(sinceCheckpoint <= 4);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    testInstallTime();
+    testDiff();
+
+    QTemporaryDir sandbox;
+    CHECK(sandbox.isValid());
+    if (sandbox.isValid()) {
+        testYear(sandbox.filePath(QStringLiteral("year.journal")));
+        testTornTail(sandbox.filePath(QStringLiteral("torn.journal")));
+        testMaxDeltas(sandbox.filePath(QStringLiteral("max.journal")));
+    }
+
+    return checkResult();
+}
@@ -0,0 +1,73 @@
+/**
+ * @file packagemodel_test.cpp
+ * @author Nikolay Yevik
+ * @brief Test of the longest-text samples PackageTableModel keeps for column sizing.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include "../packagemodel.h"
+#include "check.h"
+
+static PackageInfo pkg(const QString &name, const QString &summary)
+{
+    PackageInfo info;
+    info.name = name;
+    info.epoch = QStringLiteral("0");
+    info.version = QStringLiteral("1.0-1.fc41");
+    info.arch = QStringLiteral("x86_64");
+    info.summary = summary;
+    return info;
+}
+
+static void testSampleFollowsRows()
+{
+    QVector<PackageInfo> pkgs;
+    for (int i = 0; i < 1000; ++i)
+        pkgs.append(pkg(QStringLiteral("p%1").arg(i), QString(i % 50, QLatin1Char('s'))));
+    pkgs.append(pkg(QStringLiteral("the-longest-package-name"), QStringLiteral("short")));
+
+    PackageTableModel model;
+    model.setPackages(pkgs);
+
+    const QStringList names = model.widestTexts(PackageTableModel::NameColumn);
+    CHECK(names.size() == PackageTableModel::WidestSampleSize);
+    CHECK(names.first() == QLatin1String("the-longest-package-name"));
+    for (int i = 1; i < names.size(); ++i)
+        CHECK(names.at(i - 1).size() >= names.at(i).size());
+
+    // Duplicates count once; empty cells never make it in
+    CHECK(model.widestTexts(PackageTableModel::ArchColumn) == QStringList{QStringLiteral("x86_64")});
+    CHECK(model.widestTexts(PackageTableModel::UpdateColumn).isEmpty());
+    CHECK(model.widestTexts(PackageTableModel::SummaryColumn).first().size() == 49);
+
+    // Appends are offered to the current sample
+    model.upsertPackages({pkg(QStringLiteral("an-even-longer-package-name-arrives"), QString())});
+    CHECK(model.widestTexts(PackageTableModel::NameColumn).first()
+          == QLatin1String("an-even-longer-package-name-arrives"));
+
+    // A removal can shorten the column, so the sample is rebuilt
+    model.removePackages({QStringLiteral("an-even-longer-package-name-arrives.x86_64"),
+                          QStringLiteral("the-longest-package-name.x86_64")});
+    CHECK(!model.widestTexts(PackageTableModel::NameColumn).contains(
+        QStringLiteral("the-longest-package-name")));
+    CHECK(model.widestTexts(PackageTableModel::NameColumn).first().size() == 4);
+
+    // New update data changes what the Update column shows
+    UpdateSet updates;
+    updates.insert({QStringLiteral("p7"), QStringLiteral("x86_64"), QStringLiteral("1.0-2.fc41"), {},
+                    QStringLiteral("updates")});
+    model.setUpdates(updates);
+    CHECK(model.widestTexts(PackageTableModel::UpdateColumn) == QStringList{QStringLiteral("1.0-2.fc41")});
+
+    CHECK(model.widestTexts(-1).isEmpty());
+    CHECK(model.widestTexts(PackageTableModel::ColumnCount).isEmpty());
+}
+
+int main()
+{
+    testSampleFollowsRows();
+
+    return checkResult();
+}
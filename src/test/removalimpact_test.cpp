@@ -0,0 +1,136 @@
+/**
+ * @file removalimpact_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks RemovalImpactAnalyzer on a small recorded-style rpm -qa dump:
+ * file requires resolve through the file lists, alternatives keep dependents
+ * alive, and targets, dependents, orphans and byte counts come out right.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include "../removalimpact.h"
+#include "check.h"
+
+namespace {
+
+// Shaped like "rpm -qa --qf" with dependencyQueryArguments(): record, provides, requires, files
+const QByteArray kDump =
+    "@glibc\x1F" "x86_64\x1F" "1000\n"
+    "Pglibc\n"
+    "Plibc.so.6()(64bit)\n"
+    "Rrpmlib(PayloadIsZstd)\n"
+    "F/usr/lib64/libc.so.6\n"
+    "@bash\x1F" "x86_64\x1F" "2000\n"
+    "Pbash\n"
+    "Rlibc.so.6()(64bit)\n"
+    "F/usr/bin/bash\n"
+    "F/usr/bin/sh\n"
+    "@initscripts\x1F" "noarch\x1F" "300\n"
+    "P(none)\n"
+    "R/usr/bin/sh\n"
+    "F/etc/rc.d\n"
+    "@python3\x1F" "x86_64\x1F" "500\n"
+    "Pinterpreter\n"
+    "Rlibc.so.6()(64bit)\n"
+    "Rlibpython3.so()(64bit)\n"
+    "F/usr/bin/python3\n"
+    "@python3-libs\x1F" "x86_64\x1F" "4000\n"
+    "Plibpython3.so()(64bit)\n"
+    "Rlibc.so.6()(64bit)\n"
+    "@tool\x1F" "noarch\x1F" "100\n"
+    "R/usr/bin/python3\n"
+    "R(foo if bar)\n"
+    "@mta-a\x1F" "x86_64\x1F" "10\n"
+    "PMTA\n"
+    "@mta-b\x1F" "x86_64\x1F" "20\n"
+    "PMTA\n"
+    "@cron\x1F" "x86_64\x1F" "30\n"
+    "RMTA\n"
+    "@broken\n"
+    "Pignored-without-record\n";
+
+RemovalImpactAnalyzer analyzer()
+{
+    RemovalImpactAnalyzer result;
+    result.setPackages(RemovalImpactAnalyzer::parseDependencyDump(kDump));
+    return result;
+}
+
+void testParse()
+{
+    const QVector<PackageDependencies> deps = RemovalImpactAnalyzer::parseDependencyDump(kDump);
+    CHECK(deps.size() == 9);
+    if (deps.size() != 9)
+        return;
+
+    CHECK(deps.at(0).name == QLatin1String("glibc") && deps.at(0).sizeBytes == 1000);
+    CHECK(deps.at(0).requirements.isEmpty()); // rpmlib() is rpm's own
+    // Only the owned paths something requires become provides
+    CHECK(deps.at(1).provides == QStringList({QStringLiteral("bash"), QStringLiteral("bash"),
+                                              QStringLiteral("/usr/bin/sh")}));
+    CHECK(!deps.at(0).provides.contains(QLatin1String("/usr/lib64/libc.so.6")));
+    CHECK(deps.at(2).provides == QStringList(QStringLiteral("initscripts")));
+    CHECK(deps.at(3).provides.contains(QLatin1String("/usr/bin/python3")));
+    CHECK(deps.at(5).requirements.contains(QLatin1String("(foo if bar)")));
+    // "@broken" has too few fields; its provide has no record to attach to
+    CHECK(deps.last().name == QLatin1String("cron"));
+}
+
+void testFileRequires()
+{
+    const RemovalImpact impact = analyzer().analyze({QStringLiteral("bash")});
+    CHECK(impact.targets == QStringList(QStringLiteral("bash.x86_64")));
+    CHECK(impact.dependents == QStringList(QStringLiteral("initscripts.noarch")));
+    CHECK(impact.reclaimableBytes == 2300);
+    CHECK(impact.orphans.isEmpty()); // glibc is still needed by python3
+}
+
+void testOrphans()
+{
+    const RemovalImpact impact = analyzer().analyze({QStringLiteral("python3.x86_64")});
+    CHECK(impact.targets == QStringList(QStringLiteral("python3.x86_64")));
+    CHECK(impact.dependents == QStringList(QStringLiteral("tool.noarch")));
+    CHECK(impact.reclaimableBytes == 600);
+    CHECK(impact.orphans == QStringList(QStringLiteral("python3-libs.x86_64")));
+    CHECK(impact.orphanBytes == 4000);
+}
+
+void testAlternatives()
+{
+    const RemovalImpactAnalyzer graph = analyzer();
+    const RemovalImpact one = graph.analyze({QStringLiteral("mta-a")});
+    CHECK(one.dependents.isEmpty());
+    CHECK(one.reclaimableBytes == 10);
+
+    const RemovalImpact both = graph.analyze({QStringLiteral("mta-a"), QStringLiteral("mta-b")});
+    CHECK(both.dependents == QStringList(QStringLiteral("cron.x86_64")));
+    CHECK(both.reclaimableBytes == 60);
+}
+
+void testClosure()
+{
+    const RemovalImpact impact = analyzer().analyze(
+        {QStringLiteral(" glibc "), QStringLiteral("nosuch"), QString()});
+    CHECK(impact.targets == QStringList(QStringLiteral("glibc.x86_64")));
+    CHECK(impact.notInstalled == QStringList(QStringLiteral("nosuch")));
+    CHECK(impact.dependents
+          == QStringList({QStringLiteral("bash.x86_64"), QStringLiteral("initscripts.noarch"),
+                          QStringLiteral("python3-libs.x86_64"), QStringLiteral("python3.x86_64"),
+                          QStringLiteral("tool.noarch")}));
+    CHECK(impact.reclaimableBytes == 7900);
+    CHECK(impact.orphans.isEmpty());
+}
+
+} // namespace
+
+int main()
+{
+    testParse();
+    testFileRequires();
+    testOrphans();
+    testAlternatives();
+    testClosure();
+
+    return checkResult();
+}
@@ -0,0 +1,315 @@
+/**
+ * @file repoindexer_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks RepoIndexer on a directory of generated package files: the
+ * written repodata read back through the primary.xml parser, XML escaping,
+ * incremental re-indexing and the compression formats.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include "../decompressor.h"
+#include "../fileverifier.h"
+#include "../repoindexer.h"
+#include "../repometadata.h"
+#include "check.h"
+
+namespace {
+
+void appendBe32(QByteArray &out, quint32 value)
+{
+    char bytes[4];
+    qToBigEndian(value, bytes);
+    out.append(bytes, 4);
+}
+
+/** Same layout as rpmheader_test's builder, plus the INT16 arrays file modes use */
+class HeaderBuilder
+{
+public:
+    void addString(quint32 tag, const QByteArray &value, quint32 type = 6)
+    {
+        add(tag, type, 1, 1, value + '\0');
+    }
+
+    void addStringArray(quint32 tag, const QList<QByteArray> &values)
+    {
+        QByteArray data;
+        for (const QByteArray &value : values)
+            data += value + '\0';
+        add(tag, 8, quint32(values.size()), 1, data);
+    }
+
+    void addInt16(quint32 tag, const QList<quint16> &values)
+    {
+        QByteArray data;
+        for (quint16 value : values) {
+            char bytes[2];
+            qToBigEndian(value, bytes);
+            data.append(bytes, 2);
+        }
+        add(tag, 3, quint32(values.size()), 2, data);
+    }
+
+    void addInt32(quint32 tag, const QList<quint32> &values)
+    {
+        QByteArray data;
+        for (quint32 value : values)
+            appendBe32(data, value);
+        add(tag, 4, quint32(values.size()), 4, data);
+    }
+
+    QByteArray build() const
+    {
+        QByteArray out("\x8e\xad\xe8\x01\0\0\0\0", 8);
+        appendBe32(out, quint32(m_entries.size() / 16));
+        appendBe32(out, quint32(m_store.size()));
+        return out + m_entries + m_store;
+    }
+
+private:
+    void add(quint32 tag, quint32 type, quint32 count, int align, const QByteArray &data)
+    {
+        while (m_store.size() % align)
+            m_store.append('\0');
+        appendBe32(m_entries, tag);
+        appendBe32(m_entries, type);
+        appendBe32(m_entries, quint32(m_store.size()));
+        appendBe32(m_entries, count);
+        m_store += data;
+    }
+
+    QByteArray m_entries;
+    QByteArray m_store;
+};
+
+QByteArray buildRpm(const QByteArray &name, const QByteArray &release)
+{
+    QByteArray lead(96, '\0');
+    lead[0] = char(0xED);
+    lead[1] = char(0xAB);
+    lead[2] = char(0xEE);
+    lead[3] = char(0xDB);
+    lead[4] = 3;
+    lead[79] = 5;
+
+    HeaderBuilder signature;
+    signature.addInt32(1007, {8192});
+
+    HeaderBuilder header;
+    header.addString(1000, name);
+    header.addString(1001, "2.0");
+    header.addString(1002, release);
+    header.addString(1004, "Tools for <" + name + "> & friends", 9);
+    header.addString(1005, "Long description.", 9);
+    header.addInt32(1006, {1700000000});
+    header.addInt32(1009, {4096});
+    header.addString(1014, "MIT");
+    header.addString(1022, "x86_64");
+    header.addString(1044, name + "-2.0-" + release + ".src.rpm");
+    header.addStringArray(1047, {name});
+    header.addInt32(1048, {0, 8 | 4, 1u << 24});
+    header.addStringArray(1049, {"glibc", "libfoo", "rpmlib(PayloadIsZstd)"});
+    header.addStringArray(1050, {"", "1:1.5-2", ""});
+    header.addInt32(1112, {8});
+    header.addStringArray(1113, {"2.0-" + release});
+    header.addInt32(1080, {1700000000});
+    header.addStringArray(1081, {"Packager <packager@example.com> - 2.0-" + release});
+    header.addStringArray(1082, {"- Rebuilt"});
+    header.addInt16(1030, {040755, 0100755, 0100644});
+    header.addInt32(1037, {0, 0, 1u << 6});
+    header.addInt32(1116, {0, 1, 0});
+    header.addStringArray(1117, {name, name, "README"});
+    header.addStringArray(1118, {"/usr/share/doc/", "/usr/bin/"});
+
+    QByteArray rpm = lead + signature.build();
+    while (rpm.size() % 8)
+        rpm.append('\0');
+    return rpm + header.build() + QByteArray("\x28\xb5\x2f\xfd payload");
+}
+
+bool writeFile(const QString &path, const QByteArray &data)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(data) == data.size();
+}
+
+QByteArray readMetadata(const QString &repoDir, const QString &type)
+{
+    QFile file(RepoMetadataCache::locate(repoDir, type));
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    StreamDecompressor input(&file);
+    QByteArray out;
+    char chunk[4096];
+    qint64 n = 0;
+    while ((n = input.read(chunk, sizeof chunk)) > 0)
+        out.append(chunk, n);
+    return n < 0 ? QByteArray() : out;
+}
+
+QVector<RepoPackage> readPrimary(const QString &repoDir)
+{
+    QVector<RepoPackage> packages;
+    PrimaryMetadataReader reader;
+    reader.readFile(RepoMetadataCache::locate(repoDir, QStringLiteral("primary")), QStringLiteral("local"),
+                    [&packages](const RepoPackage &pkg) { packages.append(pkg); });
+    return packages;
+}
+
+void testIndex()
+{
+    QTemporaryDir dir;
+    CHECK(writeFile(dir.filePath(QStringLiteral("alpha-2.0-1.x86_64.rpm")), buildRpm("alpha", "1")));
+    CHECK(writeFile(dir.filePath(QStringLiteral("sub/beta-2.0-1.x86_64.rpm")), buildRpm("beta", "1")));
+    CHECK(writeFile(dir.filePath(QStringLiteral("broken.rpm")), "not a package"));
+    CHECK(writeFile(dir.filePath(QStringLiteral(".staging/hidden-2.0-1.x86_64.rpm")), buildRpm("hidden", "1")));
+
+    RepoIndexer indexer;
+    RepoIndexStats stats;
+    QString error;
+    CHECK(indexer.index(dir.path(), &stats, &error));
+    CHECK(error.isEmpty());
+    CHECK(stats.packages == 2);
+    CHECK(stats.parsed == 2);
+    CHECK(stats.reused == 0);
+    CHECK(stats.failed == 1);
+    CHECK(stats.errors.size() == 1 && stats.errors.first().startsWith(QStringLiteral("broken.rpm: ")));
+    CHECK(stats.bytesHashed > 0);
+    CHECK(indexer.packagesDone() == 3);
+
+    const QString primaryPath = RepoMetadataCache::locate(dir.path(), QStringLiteral("primary"));
+    CHECK(primaryPath.endsWith(QStringLiteral("-primary.xml.gz")));
+    // Content-addressed: the name carries the checksum of the compressed file
+    const QByteArray digest = FileVerifier::fileDigest(primaryPath, 8);
+    CHECK(!digest.isEmpty() && QFileInfo(primaryPath).fileName().startsWith(QString::fromLatin1(digest)));
+    CHECK(!QFileInfo::exists(dir.filePath(QStringLiteral(".repodata.turborpm"))));
+
+    const QVector<RepoPackage> packages = readPrimary(dir.path());
+    CHECK(packages.size() == 2);
+    if (packages.size() == 2) {
+        CHECK(packages.at(0).info.name == QStringLiteral("alpha"));
+        CHECK(packages.at(0).info.version == QStringLiteral("2.0-1"));
+        CHECK(packages.at(0).info.arch == QStringLiteral("x86_64"));
+        CHECK(packages.at(0).info.summary == QStringLiteral("Tools for <alpha> & friends"));
+        CHECK(packages.at(0).location == QStringLiteral("alpha-2.0-1.x86_64.rpm"));
+        CHECK(packages.at(1).location == QStringLiteral("sub/beta-2.0-1.x86_64.rpm"));
+    }
+
+    const QByteArray primary = readMetadata(dir.path(), QStringLiteral("primary"));
+    CHECK(primary.contains("packages=\"2\""));
+    CHECK(primary.contains("<rpm:entry name=\"libfoo\" flags=\"GE\" epoch=\"1\" ver=\"1.5\" rel=\"2\"/>"));
+    CHECK(primary.contains("<rpm:entry name=\"glibc\"/>"));
+    CHECK(!primary.contains("rpmlib("));
+    CHECK(primary.contains("<size package=\""));
+    CHECK(primary.contains("archive=\"8192\""));
+    // Only /usr/bin makes it into primary; the doc directory stays in filelists
+    CHECK(primary.contains("<file>/usr/bin/alpha</file>"));
+    CHECK(!primary.contains("/usr/share/doc/alpha"));
+
+    const QByteArray filelists = readMetadata(dir.path(), QStringLiteral("filelists"));
+    CHECK(filelists.contains("<file type=\"dir\">/usr/share/doc/alpha</file>"));
+    CHECK(filelists.contains("<file type=\"ghost\">/usr/share/doc/README</file>"));
+    CHECK(filelists.contains("<file>/usr/bin/beta</file>"));
+
+    const QByteArray other = readMetadata(dir.path(), QStringLiteral("other"));
+    CHECK(other.contains("author=\"Packager &lt;packager@example.com&gt; - 2.0-1\" date=\"1700000000\">- Rebuilt"));
+}
+
+void testIncremental()
+{
+    QTemporaryDir dir;
+    for (const QByteArray name : {"alpha", "beta", "gamma"})
+        CHECK(writeFile(dir.filePath(QString::fromLatin1(name + ".rpm")), buildRpm(name, "1")));
+
+    RepoIndexer indexer;
+    RepoIndexStats stats;
+    CHECK(indexer.index(dir.path(), &stats));
+    CHECK(stats.parsed == 3);
+    CHECK(QFileInfo::exists(dir.filePath(QStringLiteral("repodata/.turborpm-index"))));
+
+    CHECK(indexer.index(dir.path(), &stats));
+    CHECK(stats.packages == 3);
+    CHECK(stats.reused == 3);
+    CHECK(stats.parsed == 0);
+    CHECK(stats.bytesHashed == 0);
+
+    // A rebuilt package (new size and mtime) is the only one read again
+    CHECK(writeFile(dir.filePath(QStringLiteral("beta.rpm")), buildRpm("beta", "22.fc41")));
+    CHECK(QFile::remove(dir.filePath(QStringLiteral("gamma.rpm"))));
+    CHECK(indexer.index(dir.path(), &stats));
+    CHECK(stats.packages == 2);
+    CHECK(stats.reused == 1);
+    CHECK(stats.parsed == 1);
+    const QVector<RepoPackage> packages = readPrimary(dir.path());
+    CHECK(packages.size() == 2);
+    if (packages.size() == 2)
+        CHECK(packages.at(1).info.version == QStringLiteral("2.0-22.fc41"));
+
+    RepoIndexer::Options options;
+    options.useCache = false;
+    RepoIndexer uncached(options);
+    CHECK(uncached.index(dir.path(), &stats));
+    CHECK(stats.parsed == 2);
+    CHECK(stats.reused == 0);
+}
+
+void testCompression()
+{
+    for (const StreamCompressor::Format format :
+         {StreamCompressor::Format::Zstd, StreamCompressor::Format::Xz}) {
+        QTemporaryDir dir;
+        CHECK(writeFile(dir.filePath(QStringLiteral("alpha.rpm")), buildRpm("alpha", "1")));
+        RepoIndexer::Options options;
+        options.compression = format;
+        options.threads = 1;
+        RepoIndexer indexer(options);
+        CHECK(indexer.index(dir.path()));
+        CHECK(RepoMetadataCache::locate(dir.path(), QStringLiteral("other"))
+                  .endsWith(QStringLiteral(".xml") + StreamCompressor::suffix(format)));
+        CHECK(readPrimary(dir.path()).size() == 1);
+        CHECK(readMetadata(dir.path(), QStringLiteral("filelists")).contains("/usr/bin/alpha"));
+    }
+}
+
+void testRenderEscaping()
+{
+    RpmPackageFile pkg;
+    pkg.name = QStringLiteral("esc");
+    pkg.version = QStringLiteral("1");
+    pkg.release = QStringLiteral("1");
+    pkg.arch = QStringLiteral("noarch");
+    pkg.summary = QStringLiteral("a \"quoted\" <tag> & bell\x07 tab\tend");
+    RepoIndexer::Fragment fragment;
+    RepoIndexer::render(pkg, QStringLiteral("dir/esc & co.rpm"), "abc123", 42, fragment);
+    CHECK(fragment.primary.contains(
+        "<summary>a &quot;quoted&quot; &lt;tag&gt; &amp; bell tab\tend</summary>"));
+    CHECK(fragment.primary.contains("<location href=\"dir/esc &amp; co.rpm\"/>"));
+    CHECK(fragment.primary.contains("<version epoch=\"0\" ver=\"1\" rel=\"1\"/>"));
+    CHECK(fragment.primary.contains("<time file=\"42\""));
+    CHECK(fragment.filelists.startsWith("<package pkgid=\"abc123\" name=\"esc\" arch=\"noarch\">"));
+    CHECK(fragment.other.endsWith("</package>\n"));
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    testIndex();
+    testIncremental();
+    testCompression();
+    testRenderEscaping();
+
+    return checkResult();
+}
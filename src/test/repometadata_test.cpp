@@ -0,0 +1,145 @@
+/**
+ * @file repometadata_test.cpp
+ * @author Nikolay Yevik
+ * @brief Offline test of the streaming primary.xml reader against fixture metadata.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "../repometadata.h"
+#include "../packagemodel.h"
+#include "check.h"
+
+#include <iostream>
+
+static QString fixture(const QString &name)
+{
+    return QStringLiteral(TURBORPM_FIXTURE_DIR "/") + name;
+}
+
+static QVector<RepoPackage> readAll(const QString &path, bool *ok, QString *error = nullptr)
+{
+    QVector<RepoPackage> pkgs;
+    PrimaryMetadataReader reader;
+    *ok = reader.readFile(path, QStringLiteral("fixture"),
+                          [&pkgs](const RepoPackage &pkg) { pkgs.append(pkg); });
+    if (error)
+        *error = reader.errorString();
+    return pkgs;
+}
+
+static void testFormats()
+{
+    for (const char *name : {"primary.xml", "primary.xml.gz", "primary.xml.xz", "primary.xml.zst"}) {
+        bool ok = false;
+        QString error;
+        const QVector<RepoPackage> pkgs = readAll(fixture(QString::fromLatin1(name)), &ok, &error);
+        if (!ok)
+            std::cerr << name << ": " << error.toStdString() << std::endl;
+        CHECK(ok);
+        CHECK(pkgs.size() == 4);
+        if (pkgs.size() != 4)
+            continue;
+
+        const PackageInfo &bash = pkgs.at(0).info;
+        CHECK(bash.name == QLatin1String("bash"));
+        CHECK(bash.arch == QLatin1String("x86_64"));
+        CHECK(bash.version == QLatin1String("5.2.26-3.fc40"));
+        CHECK(bash.group == QLatin1String("System Environment/Shells"));
+        CHECK(bash.sizeBytes == 8321034);
+        CHECK(bash.repo == QLatin1String("fixture"));
+        CHECK(bash.summary == QLatin1String("The GNU Bourne Again shell"));
+        CHECK(pkgs.at(0).location == QLatin1String("Packages/b/bash-5.2.26-3.fc40.x86_64.rpm"));
+
+        // entities, CDATA and explicit epoch
+        CHECK(pkgs.at(1).info.name == QLatin1String("fonts-&-glyphs"));
+        CHECK(pkgs.at(1).info.summary == QLatin1String("Fonts <bundle> for testing"));
+        CHECK(pkgs.at(1).info.epoch == QLatin1String("2"));
+
+        // missing epoch defaults to 0, nonsense size stays unknown
+        CHECK(pkgs.at(3).info.epoch == QLatin1String("0"));
+        CHECK(pkgs.at(3).info.sizeBytes == -1);
+    }
+}
+
+static void testTruncated()
+{
+    QFile file(fixture(QStringLiteral("primary.xml.zst")));
+    CHECK(file.open(QIODevice::ReadOnly));
+    QByteArray half = file.readAll();
+    half.truncate(half.size() / 2);
+
+    QBuffer buffer(&half);
+    buffer.open(QIODevice::ReadOnly);
+    PrimaryMetadataReader reader;
+    int seen = 0;
+    CHECK(!reader.read(&buffer, QStringLiteral("fixture"), [&seen](const RepoPackage &) { ++seen; }));
+    CHECK(!reader.errorString().isEmpty());
+    CHECK(seen < 4);
+}
+
+static void testCacheDiscovery()
+{
+    QTemporaryDir root;
+    CHECK(root.isValid());
+    const QString repoDir = root.path() + QStringLiteral("/updates-0123456789abcdef");
+    CHECK(QDir().mkpath(repoDir + QStringLiteral("/repodata")));
+    CHECK(QFile::copy(fixture(QStringLiteral("primary.xml.gz")),
+                      repoDir + QStringLiteral("/repodata/abc-primary.xml.gz")));
+
+    QFile repomd(repoDir + QStringLiteral("/repodata/repomd.xml"));
+    CHECK(repomd.open(QIODevice::WriteOnly));
+    repomd.write("<?xml version=\"1.0\"?>\n"
+                 "<repomd xmlns=\"http://linux.duke.edu/metadata/repo\">\n"
+                 "<data type=\"filelists\"><location href=\"repodata/def-filelists.xml.gz\"/></data>\n"
+                 "<data type=\"primary\"><location href=\"repodata/abc-primary.xml.gz\"/></data>\n"
+                 "</repomd>\n");
+    repomd.close();
+
+    const QVector<RepoMetadataFile> files =
+        RepoMetadataCache::find(QStringLiteral("primary"), {root.path()}, {});
+    CHECK(files.size() == 1);
+    if (!files.isEmpty()) {
+        CHECK(files.at(0).repoId == QLatin1String("updates"));
+        CHECK(files.at(0).path.endsWith(QLatin1String("abc-primary.xml.gz")));
+    }
+}
+
+static void testInstalledJoin()
+{
+    bool ok = false;
+    const QVector<RepoPackage> repo = readAll(fixture(QStringLiteral("primary.xml")), &ok);
+    QVector<PackageInfo> available;
+    for (const RepoPackage &pkg : repo)
+        available.append(pkg.info);
+
+    PackageInfo installed;
+    installed.name = QStringLiteral("bash");
+    installed.version = QStringLiteral("5.2.26-3.fc40");
+    installed.arch = QStringLiteral("x86_64");
+
+    PackageTableModel model;
+    model.setPackages(available);
+    model.markInstalled({PackageTableModel::nevraKey(installed)});
+
+    const QModelIndex bashName = model.index(0, PackageTableModel::NameColumn);
+    const QModelIndex otherName = model.index(2, PackageTableModel::NameColumn);
+    CHECK(model.data(bashName, Qt::CheckStateRole).toInt() == Qt::Checked);
+    CHECK(!model.data(otherName, Qt::CheckStateRole).isValid());
+}
+
+int main()
+{
+    testFormats();
+    testTruncated();
+    testCacheDiscovery();
+    testInstalledJoin();
+
+    return checkResult();
+}
@@ -0,0 +1,192 @@
+/**
+ * @file ringlog_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks RingLog: records from several threads come out whole and in
+ * order, full rings drop and say so, rings are reused, the file rotates and
+ * the repoquery parser logs its skipped lines.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "../packagequery.h"
+#include "../ringlog.h"
+#include "check.h"
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/** Everything flushed since the last call */
+QVector<RingLog::Entry> flushed()
+{
+    static quint64 lastSeq = 0;
+    RingLog::flush();
+    const QVector<RingLog::Entry> entries = RingLog::recent(lastSeq);
+    if (!entries.isEmpty())
+        lastSeq = entries.last().seq;
+    return entries;
+}
+
+void testFormatting()
+{
+    flushed();
+    RingLog::write(RingLog::Warning, "parse: line %1 has %2 fields: %3", 17, 2, QStringLiteral("bash"));
+    RingLog::write(RingLog::Info, "text %1 stays", QStringLiteral("with %1 in it"));
+    RingLog::write(RingLog::Info, "cut: %1", QString(200, QLatin1Char('x')));
+    RingLog::write(RingLog::Debug, "ascii: %1", QStringLiteral("café\tok"));
+    RingLog::write(RingLog::Info, "one number %1, then %2", 7, QStringLiteral("text with %2"));
+
+    const QVector<RingLog::Entry> entries = flushed();
+    CHECK(entries.size() == 5);
+    if (entries.size() != 5)
+        return;
+    CHECK(entries.at(0).message == QLatin1String("parse: line 17 has 2 fields: bash"));
+    CHECK(entries.at(0).level == RingLog::Warning);
+    CHECK(entries.at(1).message == QLatin1String("text with %1 in it stays"));
+    CHECK(entries.at(2).message
+          == QLatin1String("cut: ") + QString(RingLog::TextCapacity, QLatin1Char('x')) + QLatin1String("..."));
+    CHECK(entries.at(3).message == QLatin1String("ascii: caf??ok"));
+    CHECK(entries.at(4).message == QLatin1String("one number 7, then text with %2"));
+    CHECK(entries.at(1).seq == entries.at(0).seq + 1);
+    CHECK(RingLog::formatLine(entries.at(0)).contains(QLatin1String(" WARN [")));
+}
+
+void testThreads()
+{
+    constexpr int Threads = 4;
+    constexpr int PerThread = 500; // under RingCapacity, so nothing drops without a flusher
+    flushed();
+    const quint64 droppedBefore = RingLog::dropped();
+
+    // std::thread: join() returns after the thread_local ring owner has let go
+    std::vector<std::thread> threads;
+    for (int t = 0; t < Threads; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < PerThread; ++i)
+                RingLog::write(RingLog::Info, "thread %1 record %2", t, i);
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+    CHECK(RingLog::dropped() == droppedBefore);
+
+    const QVector<RingLog::Entry> entries = flushed();
+    CHECK(entries.size() == Threads * PerThread);
+    QVector<int> next(Threads, 0);
+    QVector<int> ringOf(Threads, -1);
+    for (int i = 0; i < entries.size(); ++i) {
+        const RingLog::Entry &entry = entries.at(i);
+        const QStringList words = entry.message.split(QLatin1Char(' '));
+        const int t = words.value(1).toInt();
+        CHECK(words.size() == 4 && t >= 0 && t < Threads);
+        if (t < 0 || t >= Threads)
+            continue;
+        CHECK(words.value(3).toInt() == next[t]); // each thread's records in order
+        ++next[t];
+        if (ringOf[t] < 0)
+            ringOf[t] = entry.thread;
+        CHECK(entry.thread == ringOf[t]);
+        if (i > 0)
+            CHECK(entries.at(i - 1).time <= entry.time);
+    }
+
+    // Finished threads hand their drained rings to the next ones
+    const int rings = RingLog::ringCount();
+    for (int round = 0; round < 8; ++round) {
+        std::thread([]() { RingLog::write(RingLog::Info, "short-lived"); }).join();
+        flushed();
+    }
+    CHECK(RingLog::ringCount() == rings);
+}
+
+void testDrops()
+{
+    flushed();
+    const quint64 droppedBefore = RingLog::dropped();
+    for (int i = 0; i < RingLog::RingCapacity + 10; ++i)
+        RingLog::write(RingLog::Debug, "burst %1", i);
+    CHECK(RingLog::dropped() == droppedBefore + 10);
+
+    const QVector<RingLog::Entry> entries = flushed();
+    CHECK(entries.size() == RingLog::RingCapacity + 1);
+    CHECK(!entries.isEmpty() && entries.last().level == RingLog::Warning
+          && entries.last().message.contains(QLatin1String("10 records dropped")));
+}
+
+void testParserAnomalies()
+{
+    flushed();
+    const QByteArray out =
+        "bash\x1F" "5.2.32-1.fc41\x1F" "x86_64\x1F" "2025-01-01 10:00\x1F" "System\x1F" "8000\x1F"
+        "fedora\x1F" "The GNU Bourne Again shell\x1F" "0\n"
+        "broken\x1F" "1.0-1\n"
+        "bash\x1F" "5.2.32-1.fc41\x1F" "x86_64\x1F" "2025-01-01 10:00\x1F" "System\x1F" "8000\x1F"
+        "fedora\x1F" "The GNU Bourne Again shell\x1F" "0\n";
+    CHECK(InstalledPackageQuery::parseRepoqueryOutput(out).size() == 1);
+
+    QStringList messages;
+    for (const RingLog::Entry &entry : flushed())
+        messages << entry.message;
+    CHECK(messages.contains(QLatin1String("repoquery: line 1 has 2 fields, skipped: broken?1.0-1")));
+    CHECK(messages.contains(QLatin1String("repoquery: line 2 repeats bash|5.2.32-1.fc41|x86_64")));
+    CHECK(messages.contains(QLatin1String("repoquery: 1 packages from 3 lines")));
+}
+
+void testFileAndCost(const QString &dir)
+{
+    const QString path = dir + QStringLiteral("/logs/turborpm.log");
+    CHECK(RingLog::start(path));
+    CHECK(RingLog::filePath() == path);
+    RingLog::setMaxFileBytes(64 * 1024);
+
+    // Only the write is timed; the flusher drains in between
+    constexpr int Batches = 100;
+    constexpr int PerBatch = RingLog::RingCapacity / 2;
+    qint64 writeNs = 0;
+    for (int batch = 0; batch < Batches; ++batch) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < PerBatch; ++i)
+            RingLog::write(RingLog::Debug, "cost %1 %2 %3", batch, i, QStringLiteral("text"));
+        writeNs += timer.nsecsElapsed();
+        RingLog::flush();
+    }
+    RingLog::stop();
+    const double perWriteNs = double(writeNs) / (Batches * PerBatch);
+    std::cout << "write: " << perWriteNs << " ns per record" << std::endl;
+    CHECK(perWriteNs < 1000);
+
+    QFile current(path);
+    QFile rotated(path + QStringLiteral(".1"));
+    CHECK(current.exists() && rotated.exists());
+    CHECK(current.size() <= 64 * 1024);
+    if (rotated.open(QIODevice::ReadOnly)) {
+        const QByteArray first = rotated.readLine();
+        CHECK(first.contains(" DEBUG [") && first.contains("cost "));
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTemporaryDir dir;
+    CHECK(dir.isValid());
+
+    testFormatting();
+    testThreads();
+    testDrops();
+    testParserAnomalies();
+    testFileAndCost(dir.path());
+
+    return checkResult();
+}
@@ -0,0 +1,231 @@
+/**
+ * @file rpmdbwatcher_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks RpmdbWatcher against a scratch rpmdb directory: a burst of
+ * writes yields one change, a paused watcher ignores our own transaction,
+ * a held transaction lock defers a change, and syncPackages() updates the
+ * model row by row.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include "../packagemodel.h"
+#include "../rpmdbwatcher.h"
+#include "check.h"
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int SettleMs {150};
+
+void spin(int ms)
+{
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+void appendTo(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    CHECK(file.open(QIODevice::Append));
+    CHECK(file.write(data) == data.size());
+}
+
+void testBurst(const QString &dir)
+{
+    const QString db = dir + QStringLiteral("/rpmdb.sqlite");
+    appendTo(db, "header");
+
+    RpmdbWatcher watcher;
+    watcher.setSettleDelay(SettleMs);
+    int changes = 0;
+    QObject::connect(&watcher, &RpmdbWatcher::changed, [&changes]() { ++changes; });
+    watcher.start(dir);
+    CHECK(watcher.isActive());
+
+    // A transaction: the db and its WAL written many times in quick succession
+    for (int i = 0; i < 20; ++i) {
+        appendTo(db, QByteArray(512, 'x'));
+        appendTo(dir + QStringLiteral("/rpmdb.sqlite-wal"), QByteArray(64, 'w'));
+        spin(10);
+    }
+    CHECK(changes == 0);
+    spin(SettleMs * 4);
+    CHECK(changes == 1);
+
+    // sqlite deletes the WAL on checkpoint and creates a new one later
+    QFile::remove(dir + QStringLiteral("/rpmdb.sqlite-wal"));
+    spin(SettleMs * 4);
+    CHECK(changes == 2);
+    appendTo(dir + QStringLiteral("/rpmdb.sqlite-wal"), "again");
+    spin(SettleMs * 4);
+    CHECK(changes == 3);
+
+    // Touching nothing the stamp covers is not a change
+    appendTo(dir + QStringLiteral("/unrelated"), "noise");
+    spin(SettleMs * 4);
+    CHECK(changes == 3);
+
+    watcher.stop();
+    CHECK(!watcher.isActive());
+    appendTo(db, "after stop");
+    spin(SettleMs * 4);
+    CHECK(changes == 3);
+}
+
+void testPause(const QString &dir)
+{
+    const QString db = dir + QStringLiteral("/rpmdb.sqlite");
+    appendTo(db, "header");
+
+    RpmdbWatcher watcher;
+    watcher.setSettleDelay(SettleMs);
+    int changes = 0;
+    QObject::connect(&watcher, &RpmdbWatcher::changed, [&changes]() { ++changes; });
+    watcher.start(dir);
+
+    // Our own transaction: the caller refreshes, the watcher stays quiet
+    watcher.pause();
+    appendTo(db, QByteArray(512, 'x'));
+    spin(SettleMs * 4);
+    CHECK(changes == 0);
+    CHECK(watcher.resume());
+    spin(SettleMs * 4);
+    CHECK(changes == 0);
+
+    // A failed transaction that wrote nothing
+    watcher.pause();
+    CHECK(!watcher.resume());
+
+    // Changes from elsewhere are picked up again
+    appendTo(db, "external");
+    spin(SettleMs * 4);
+    CHECK(changes == 1);
+}
+
+void testTransactionLock(const QString &dir)
+{
+    const QString db = dir + QStringLiteral("/rpmdb.sqlite");
+    const QByteArray lockPath = QFile::encodeName(dir + QStringLiteral("/.rpm.lock"));
+    appendTo(db, "header");
+    CHECK(!RpmdbWatcher::transactionInProgress(dir));
+
+    int ready[2];
+    CHECK(::pipe(ready) == 0);
+    const pid_t child = ::fork();
+    if (child == 0) {
+        // Stand-in for rpm: hold the transaction lock for a while
+        const int fd = ::open(lockPath.constData(), O_RDWR | O_CREAT, 0644);
+        struct flock lock = {};
+        lock.l_type = F_WRLCK;
+        lock.l_whence = SEEK_SET;
+        const char ok = fd >= 0 && ::fcntl(fd, F_SETLK, &lock) == 0 ? '1' : '0';
+        (void)::write(ready[1], &ok, 1);
+        ::usleep(SettleMs * 6 * 1000);
+        ::_exit(0);
+    }
+    CHECK(child > 0);
+    ::close(ready[1]);
+    char ok = '0';
+    CHECK(::read(ready[0], &ok, 1) == 1 && ok == '1');
+    ::close(ready[0]);
+    CHECK(RpmdbWatcher::transactionInProgress(dir));
+
+    RpmdbWatcher watcher;
+    watcher.setSettleDelay(SettleMs);
+    int changes = 0;
+    qint64 changedAfter = -1;
+    QElapsedTimer clock;
+    clock.start();
+    QObject::connect(&watcher, &RpmdbWatcher::changed, [&]() {
+        ++changes;
+        changedAfter = clock.elapsed();
+    });
+    watcher.start(dir);
+    appendTo(db, QByteArray(128, 'x'));
+
+    // The db is quiet, but the lock says rpm is not done yet
+    spin(SettleMs * 3);
+    CHECK(changes == 0);
+
+    int status = 0;
+    CHECK(::waitpid(child, &status, 0) == child);
+    const qint64 released = clock.elapsed();
+    CHECK(!RpmdbWatcher::transactionInProgress(dir));
+    spin(SettleMs * 3);
+    CHECK(changes == 1);
+    CHECK(changedAfter >= released);
+}
+
+PackageInfo pkg(const QString &name, const QString &version)
+{
+    PackageInfo info;
+    info.name = name;
+    info.epoch = QStringLiteral("0");
+    info.version = version;
+    info.arch = QStringLiteral("x86_64");
+    return info;
+}
+
+void testSyncPackages()
+{
+    PackageTableModel model;
+    model.setPackages({pkg("alpha", "1-1"), pkg("bravo", "1-1"), pkg("charlie", "1-1"),
+                       pkg("delta", "1-1")});
+
+    int resets = 0, removed = 0, inserted = 0;
+    QObject::connect(&model, &QAbstractItemModel::modelReset, [&resets]() { ++resets; });
+    QObject::connect(&model, &QAbstractItemModel::rowsRemoved,
+                     [&removed](const QModelIndex &, int first, int last) { removed += last - first + 1; });
+    QObject::connect(&model, &QAbstractItemModel::rowsInserted,
+                     [&inserted](const QModelIndex &, int first, int last) { inserted += last - first + 1; });
+
+    // bravo upgraded, delta removed, echo installed
+    model.syncPackages({pkg("alpha", "1-1"), pkg("bravo", "2-1"), pkg("charlie", "1-1"),
+                        pkg("echo", "1-1")});
+    CHECK(resets == 0);
+    CHECK(removed == 2);
+    CHECK(inserted == 2);
+    CHECK(model.rowCount() == 4);
+    const QSet<QString> keys = model.nevraKeys();
+    CHECK(keys.size() == 4);
+    CHECK(model.index(0, 0).data().toString() == QStringLiteral("alpha"));
+
+    removed = inserted = 0;
+    model.syncPackages({pkg("alpha", "1-1"), pkg("bravo", "2-1"), pkg("charlie", "1-1"),
+                        pkg("echo", "1-1")});
+    CHECK(removed == 0 && inserted == 0 && resets == 0);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    testSyncPackages();
+
+    QTemporaryDir burst;
+    QTemporaryDir paused;
+    QTemporaryDir locked;
+    CHECK(burst.isValid() && paused.isValid() && locked.isValid());
+    if (burst.isValid() && paused.isValid() && locked.isValid()) {
+        testBurst(burst.path());
+        testPause(paused.path());
+        testTransactionLock(locked.path());
+    }
+
+    return checkResult();
+}
@@ -0,0 +1,191 @@
+/**
+ * @file rpmevr_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks RpmEvr against rpm's own rpmvercmp test vectors (tests/rpmvercmp.at)
+ * and verifies that the memcmp sort keys agree with the comparator.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include "../rpmevr.h"
+#include "check.h"
+
+#include <cstring>
+#include <iostream>
+
+struct VercmpVector {
+    const char *a;
+    const char *b;
+    int expected;
+};
+
+// Verbatim from rpm's tests/rpmvercmp.at
+static const VercmpVector kRpmVectors[] = {
+    {"1.0", "1.0", 0},
+    {"1.0", "2.0", -1},
+    {"2.0", "1.0", 1},
+    {"2.0.1", "2.0.1", 0},
+    {"2.0", "2.0.1", -1},
+    {"2.0.1", "2.0", 1},
+    {"2.0.1a", "2.0.1a", 0},
+    {"2.0.1a", "2.0.1", 1},
+    {"2.0.1", "2.0.1a", -1},
+    {"5.5p1", "5.5p1", 0},
+    {"5.5p1", "5.5p2", -1},
+    {"5.5p2", "5.5p1", 1},
+    {"5.5p10", "5.5p10", 0},
+    {"5.5p1", "5.5p10", -1},
+    {"5.5p10", "5.5p1", 1},
+    {"10xyz", "10.1xyz", -1},
+    {"10.1xyz", "10xyz", 1},
+    {"xyz10", "xyz10", 0},
+    {"xyz10", "xyz10.1", -1},
+    {"xyz10.1", "xyz10", 1},
+    {"xyz.4", "xyz.4", 0},
+    {"xyz.4", "8", -1},
+    {"8", "xyz.4", 1},
+    {"xyz.4", "2", -1},
+    {"2", "xyz.4", 1},
+    {"5.5p2", "5.6p1", -1},
+    {"5.6p1", "5.5p2", 1},
+    {"5.6p1", "6.5p1", -1},
+    {"6.5p1", "5.6p1", 1},
+    {"6.0.rc1", "6.0", 1},
+    {"6.0", "6.0.rc1", -1},
+    {"10b2", "10a1", 1},
+    {"10a2", "10b2", -1},
+    {"1.0aa", "1.0aa", 0},
+    {"1.0a", "1.0aa", -1},
+    {"1.0aa", "1.0a", 1},
+    {"10.0001", "10.0001", 0},
+    {"10.0001", "10.1", 0},
+    {"10.1", "10.0001", 0},
+    {"10.0001", "10.0039", -1},
+    {"10.0039", "10.0001", 1},
+    {"4.999.9", "5.0", -1},
+    {"5.0", "4.999.9", 1},
+    {"20101121", "20101121", 0},
+    {"20101121", "20101122", -1},
+    {"20101122", "20101121", 1},
+    {"2_0", "2_0", 0},
+    {"2.0", "2_0", 0},
+    {"2_0", "2.0", 0},
+    {"a", "a", 0},
+    {"a+", "a+", 0},
+    {"a+", "a_", 0},
+    {"a_", "a+", 0},
+    {"+a", "+a", 0},
+    {"+a", "_a", 0},
+    {"_a", "+a", 0},
+    {"+_", "+_", 0},
+    {"_+", "+_", 0},
+    {"_+", "_", 0},
+    {"+", "_", 0},
+    {"_", "+", 0},
+    {"1.0~rc1", "1.0~rc1", 0},
+    {"1.0~rc1", "1.0", -1},
+    {"1.0", "1.0~rc1", 1},
+    {"1.0~rc1", "1.0~rc2", -1},
+    {"1.0~rc2", "1.0~rc1", 1},
+    {"1.0~rc1~git123", "1.0~rc1~git123", 0},
+    {"1.0~rc1~git123", "1.0~rc1", -1},
+    {"1.0~rc1", "1.0~rc1~git123", 1},
+    {"1.0^", "1.0^", 0},
+    {"1.0^", "1.0", 1},
+    {"1.0", "1.0^", -1},
+    {"1.0^git1", "1.0^git1", 0},
+    {"1.0^git1", "1.0", 1},
+    {"1.0", "1.0^git1", -1},
+    {"1.0^git1", "1.0^git2", -1},
+    {"1.0^git2", "1.0^git1", 1},
+    {"1.0^git1", "1.01", -1},
+    {"1.01", "1.0^git1", 1},
+    {"1.0^20160101", "1.0^20160101", 0},
+    {"1.0^20160101", "1.0.1", -1},
+    {"1.0.1", "1.0^20160101", 1},
+    {"1.0^20160101^git1", "1.0^20160101^git1", 0},
+    {"1.0^20160102", "1.0^20160101^git1", 1},
+    {"1.0^20160101^git1", "1.0^20160102", -1},
+    {"1.0~rc1^git1", "1.0~rc1^git1", 0},
+    {"1.0~rc1^git1", "1.0~rc1", 1},
+    {"1.0~rc1", "1.0~rc1^git1", -1},
+    {"1.0^git1~pre", "1.0^git1~pre", 0},
+    {"1.0^git1", "1.0^git1~pre", 1},
+    {"1.0^git1~pre", "1.0^git1", -1},
+    {"1b.fc17", "1b.fc17", 0},
+    {"1b.fc17", "1.fc17", -1},
+    {"1.fc17", "1b.fc17", 1},
+    {"1g.fc17", "1g.fc17", 0},
+    {"1g.fc17", "1.fc17", 1},
+    {"1.fc17", "1g.fc17", -1},
+    {"1.1.α", "1.1.α", 0},
+};
+
+// Full EVR comparisons on top of rpmvercmp
+static const VercmpVector kEvrVectors[] = {
+    {"1.10-1", "1.9-1", 1},
+    {"1:1.0-1", "2.0-1", 1},
+    {"0:2.0-1", "2.0-1", 0},
+    {"2.0-1.fc40", "2.0-1.fc39", 1},
+    {"2.0-10", "2.0-9", 1},
+    {"5.2.26-3.fc40", "5.2.26-3.fc40", 0},
+    {"1.0~rc1-1", "1.0-0", -1},
+    {"10:1-1", "9:99-99", 1},
+};
+
+static int sign(int v)
+{
+    return v < 0 ? -1 : (v > 0 ? 1 : 0);
+}
+
+static int keyCompare(const QByteArray &a, const QByteArray &b)
+{
+    const int common = int(qMin(a.size(), b.size()));
+    const int rc = std::memcmp(a.constData(), b.constData(), size_t(common));
+    if (rc != 0)
+        return sign(rc);
+    return sign(int(a.size() - b.size()));
+}
+
+static void report(const char *what, const VercmpVector &v, int got)
+{
+    ++failures;
+    std::cerr << what << "(\"" << v.a << "\", \"" << v.b << "\") = " << got
+              << ", expected " << v.expected << std::endl;
+}
+
+int main()
+{
+    for (const VercmpVector &v : kRpmVectors) {
+        const QString a = QString::fromUtf8(v.a);
+        const QString b = QString::fromUtf8(v.b);
+
+        const int got = sign(RpmEvr::vercmp(a, b));
+        if (got != v.expected)
+            report("vercmp", v, got);
+
+        QByteArray keyA;
+        QByteArray keyB;
+        RpmEvr::appendVersionKey(keyA, a);
+        RpmEvr::appendVersionKey(keyB, b);
+        const int byKey = keyCompare(keyA, keyB);
+        if (byKey != v.expected)
+            report("versionKey", v, byKey);
+    }
+
+    for (const VercmpVector &v : kEvrVectors) {
+        const QString a = QString::fromUtf8(v.a);
+        const QString b = QString::fromUtf8(v.b);
+
+        const int got = sign(RpmEvr::compare(a, b));
+        if (got != v.expected)
+            report("compare", v, got);
+
+        const int byKey = keyCompare(RpmEvr::sortKey(a), RpmEvr::sortKey(b));
+        if (byKey != v.expected)
+            report("sortKey", v, byKey);
+    }
+
+    return checkResult();
+}
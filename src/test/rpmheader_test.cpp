@@ -0,0 +1,332 @@
+/**
+ * @file rpmheader_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks RpmHeaderReader on package files generated here byte by byte:
+ * tag decoding, source packages, truncated and corrupt headers, parallel
+ * reads and the comparison with installed versions.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include "../rpmevr.h"
+#include "../rpmheader.h"
+#include "check.h"
+
+#include <cstring>
+#include <memory>
+
+namespace {
+
+const QByteArray Payload("\x1f\x8b compressed cpio that is never read");
+
+void appendBe32(QByteArray &out, quint32 value)
+{
+    char bytes[4];
+    qToBigEndian(value, bytes);
+    out.append(bytes, 4);
+}
+
+/** Writes headers the way rpmbuild lays them out: index entries, then the aligned store */
+class HeaderBuilder
+{
+public:
+    void addString(quint32 tag, const QByteArray &value, quint32 type = 6)
+    {
+        add(tag, type, 1, 1, value + '\0');
+    }
+
+    void addStringArray(quint32 tag, const QList<QByteArray> &values)
+    {
+        QByteArray data;
+        for (const QByteArray &value : values)
+            data += value + '\0';
+        add(tag, 8, quint32(values.size()), 1, data);
+    }
+
+    void addInt32(quint32 tag, const QList<quint32> &values)
+    {
+        QByteArray data;
+        for (quint32 value : values)
+            appendBe32(data, value);
+        add(tag, 4, quint32(values.size()), 4, data);
+    }
+
+    void addInt64(quint32 tag, quint64 value)
+    {
+        char bytes[8];
+        qToBigEndian(value, bytes);
+        add(tag, 5, 1, 8, QByteArray(bytes, 8));
+    }
+
+    QByteArray build() const
+    {
+        QByteArray out("\x8e\xad\xe8\x01\0\0\0\0", 8);
+        appendBe32(out, quint32(m_entries.size() / 16));
+        appendBe32(out, quint32(m_store.size()));
+        return out + m_entries + m_store;
+    }
+
+private:
+    void add(quint32 tag, quint32 type, quint32 count, int align, const QByteArray &data)
+    {
+        while (m_store.size() % align)
+            m_store.append('\0');
+        appendBe32(m_entries, tag);
+        appendBe32(m_entries, type);
+        appendBe32(m_entries, quint32(m_store.size()));
+        appendBe32(m_entries, count);
+        m_store += data;
+    }
+
+    QByteArray m_entries;
+    QByteArray m_store;
+};
+
+struct Fixture {
+    QByteArray name = "fixture";
+    QByteArray version = "2.0";
+    QByteArray release = "3.fc40";
+    int epoch = 1; /** -1: no EPOCH tag */
+    QByteArray arch = "x86_64";
+    bool source = false;
+    bool longSize = true;
+};
+
+QByteArray buildRpm(const Fixture &fixture)
+{
+    QByteArray lead(96, '\0');
+    lead[0] = char(0xED);
+    lead[1] = char(0xAB);
+    lead[2] = char(0xEE);
+    lead[3] = char(0xDB);
+    lead[4] = 3;
+    lead[7] = fixture.source ? 1 : 0;
+    lead.replace(10, fixture.name.size(), fixture.name);
+    lead[79] = 5; // header-style signature
+
+    // An odd-sized signature store, so the main header needs padding
+    HeaderBuilder signature;
+    signature.addInt32(1000, {4096});
+    signature.addString(269, QByteArray(40, 'a'));
+
+    HeaderBuilder header;
+    header.addString(1000, fixture.name);
+    header.addString(1001, fixture.version);
+    header.addString(1002, fixture.release);
+    if (fixture.epoch >= 0)
+        header.addInt32(1003, {quint32(fixture.epoch)});
+    header.addString(1004, "Generated test package", 9);
+    header.addInt32(1009, {123456});
+    header.addString(1014, "MIT");
+    header.addString(1022, fixture.arch);
+    if (!fixture.source)
+        header.addString(1044, fixture.name + "-" + fixture.version + "-" + fixture.release + ".src.rpm");
+    header.addStringArray(1047, {fixture.name, fixture.name + "(x86-64)"});
+    header.addInt32(1048, {0, 8 | 4, (1u << 24) | 8 | 2});
+    header.addStringArray(1049, {"libfoo.so.1()(64bit)", "glibc", "rpmlib(CompressedFileNames)"});
+    header.addStringArray(1050, {"", "2.34", "3.0.4-1"});
+    header.addInt32(1112, {8, 8});
+    header.addStringArray(1113, {"1:2.0-3.fc40", "1:2.0-3.fc40"});
+    if (fixture.longSize)
+        header.addInt64(5009, 5000000000ULL);
+
+    QByteArray rpm = lead + signature.build();
+    while (rpm.size() % 8)
+        rpm.append('\0');
+    return rpm + header.build() + Payload;
+}
+
+/** Parses from an exactly sized heap copy, so an overread is a real one */
+bool parseCopy(const QByteArray &bytes, RpmPackageFile &out, QString *error = nullptr)
+{
+    std::unique_ptr<char[]> copy(new char[size_t(qMax<qsizetype>(bytes.size(), 1))]);
+    std::memcpy(copy.get(), bytes.constData(), size_t(bytes.size()));
+    return RpmHeaderReader::parse(copy.get(), bytes.size(), out, error);
+}
+
+QStringList strings(const QVector<RpmDependency> &deps)
+{
+    QStringList out;
+    for (const RpmDependency &dep : deps)
+        out.append(dep.toString());
+    return out;
+}
+
+void testDecode()
+{
+    const QByteArray rpm = buildRpm(Fixture());
+    RpmPackageFile pkg;
+    QString error;
+    CHECK(parseCopy(rpm, pkg, &error));
+    CHECK(error.isEmpty());
+    CHECK(pkg.name == QStringLiteral("fixture"));
+    CHECK(pkg.epoch == QStringLiteral("1"));
+    CHECK(pkg.version == QStringLiteral("2.0"));
+    CHECK(pkg.release == QStringLiteral("3.fc40"));
+    CHECK(pkg.evr() == QStringLiteral("1:2.0-3.fc40"));
+    CHECK(pkg.arch == QStringLiteral("x86_64"));
+    CHECK(pkg.nameArch() == QStringLiteral("fixture.x86_64"));
+    CHECK(pkg.summary == QStringLiteral("Generated test package"));
+    CHECK(pkg.license == QStringLiteral("MIT"));
+    CHECK(pkg.installedSize == 5000000000LL);
+    CHECK(pkg.fileSize == rpm.size());
+    CHECK(!pkg.sourcePackage);
+    CHECK(strings(pkg.requires) == QStringList({QStringLiteral("libfoo.so.1()(64bit)"),
+                                       QStringLiteral("glibc >= 2.34"),
+                                       QStringLiteral("rpmlib(CompressedFileNames) <= 3.0.4-1")}));
+    CHECK(strings(pkg.provides) == QStringList({QStringLiteral("fixture = 1:2.0-3.fc40"),
+                                       QStringLiteral("fixture(x86-64) = 1:2.0-3.fc40")}));
+
+    Fixture older;
+    older.epoch = -1;
+    older.longSize = false;
+    CHECK(parseCopy(buildRpm(older), pkg));
+    CHECK(pkg.epoch.isEmpty() && pkg.evr() == QStringLiteral("2.0-3.fc40"));
+    CHECK(pkg.installedSize == 123456);
+
+    Fixture source;
+    source.source = true;
+    CHECK(parseCopy(buildRpm(source), pkg));
+    CHECK(pkg.sourcePackage && pkg.arch == QStringLiteral("src"));
+}
+
+void testDamaged()
+{
+    const QByteArray rpm = buildRpm(Fixture());
+
+    // Every cut inside the headers fails cleanly; cuts in the payload do not matter
+    int accepted = 0;
+    for (qsizetype size = 0; size < rpm.size(); ++size) {
+        RpmPackageFile pkg;
+        QString error;
+        const bool ok = parseCopy(rpm.left(size), pkg, &error);
+        accepted += ok ? 1 : 0;
+        CHECK(ok || !error.isEmpty());
+    }
+    CHECK(accepted == Payload.size());
+
+    RpmPackageFile pkg;
+    QString error;
+    CHECK(!parseCopy(QByteArray("#!/bin/sh\necho not a package\n").leftJustified(200, ' '), pkg, &error));
+    CHECK(!error.isEmpty());
+
+    // Index count far beyond the file
+    QByteArray bogus = rpm;
+    bogus[96 + 8] = char(0x7F);
+    CHECK(!parseCopy(bogus, pkg));
+
+    // Every main header offset pointing past the store: the strings are gone, so is the name
+    bogus = rpm;
+    const qsizetype header = bogus.indexOf(QByteArray("\x8e\xad\xe8\x01", 4), 100);
+    CHECK(header > 0);
+    const quint32 entries = qFromBigEndian<quint32>(bogus.constData() + header + 8);
+    for (quint32 i = 0; i < entries; ++i) {
+        char bytes[4];
+        qToBigEndian<quint32>(0x7FFFFFF0u, bytes);
+        bogus.replace(header + 16 + qsizetype(i) * 16 + 8, 4, QByteArray(bytes, 4));
+    }
+    error.clear();
+    CHECK(!parseCopy(bogus, pkg, &error));
+    CHECK(!error.isEmpty());
+}
+
+void testReadAll(const QTemporaryDir &dir)
+{
+    QStringList paths;
+    for (int i = 0; i < 200; ++i) {
+        Fixture fixture;
+        fixture.name = "pkg" + QByteArray::number(i);
+        fixture.release = QByteArray::number(i) + ".fc40";
+        const QString path = dir.filePath(QStringLiteral("pkg%1.rpm").arg(i));
+        QFile file(path);
+        CHECK(file.open(QIODevice::WriteOnly));
+        file.write(buildRpm(fixture));
+        paths.append(path);
+    }
+    paths.insert(100, dir.filePath(QStringLiteral("missing.rpm")));
+
+    const QVector<RpmPackageFile> files = RpmHeaderReader::readAll(paths, 4);
+    CHECK(files.size() == paths.size());
+    for (qsizetype i = 0; i < files.size() && i < paths.size(); ++i) {
+        CHECK(files.at(i).path == paths.at(i));
+        if (i == 100) {
+            CHECK(!files.at(i).error.isEmpty());
+            continue;
+        }
+        const int n = int(i < 100 ? i : i - 1);
+        CHECK(files.at(i).error.isEmpty());
+        CHECK(files.at(i).name == QStringLiteral("pkg%1").arg(n));
+        CHECK(files.at(i).release == QStringLiteral("%1.fc40").arg(n));
+    }
+
+    RpmPackageFile pkg;
+    QString error;
+    CHECK(!RpmHeaderReader::read(dir.path(), pkg, &error)); // a directory
+    CHECK(!error.isEmpty());
+
+    // Only the headers are read, the size still covers the payload
+    const QByteArray rpm = buildRpm(Fixture());
+    const QString path = dir.filePath(QStringLiteral("sized.rpm"));
+    QFile file(path);
+    CHECK(file.open(QIODevice::WriteOnly));
+    file.write(rpm);
+    file.close();
+    CHECK(RpmHeaderReader::read(path, pkg));
+    CHECK(pkg.fileSize == rpm.size());
+    CHECK(pkg.headerEnd == rpm.size() - Payload.size());
+
+    // Cut inside the main header on disk: an error, not a read past the end
+    CHECK(file.resize(pkg.headerEnd - 8));
+    error.clear();
+    CHECK(!RpmHeaderReader::read(path, pkg, &error));
+    CHECK(!error.isEmpty());
+}
+
+void testCompare()
+{
+    RpmPackageFile pkg;
+    CHECK(parseCopy(buildRpm(Fixture()), pkg));
+
+    QHash<QString, QByteArray> installed;
+    CHECK(RpmHeaderReader::compare(pkg, installed) == RpmHeaderReader::NotInstalled);
+
+    installed.insert(QStringLiteral("fixture.x86_64"), RpmEvr::sortKey(QStringLiteral("1"), QStringLiteral("2.0-3.fc40")));
+    CHECK(RpmHeaderReader::compare(pkg, installed) == RpmHeaderReader::Same);
+    installed.insert(QStringLiteral("fixture.x86_64"), RpmEvr::sortKey(QStringLiteral("1"), QStringLiteral("2.0-3.fc40.1")));
+    CHECK(RpmHeaderReader::compare(pkg, installed) == RpmHeaderReader::Older);
+    // The epoch outranks any version
+    installed.insert(QStringLiteral("fixture.x86_64"), RpmEvr::sortKey(QStringLiteral("0"), QStringLiteral("9.9-1.fc40")));
+    CHECK(RpmHeaderReader::compare(pkg, installed) == RpmHeaderReader::Newer);
+    installed.insert(QStringLiteral("fixture.x86_64"), RpmEvr::sortKey(QStringLiteral("1"), QStringLiteral("2.0~rc1-1.fc40")));
+    CHECK(RpmHeaderReader::compare(pkg, installed) == RpmHeaderReader::Newer);
+
+    Fixture source;
+    source.source = true;
+    CHECK(parseCopy(buildRpm(source), pkg));
+    installed.insert(QStringLiteral("fixture.src"), RpmEvr::sortKey(QStringLiteral("1"), QStringLiteral("2.0-3.fc40")));
+    CHECK(RpmHeaderReader::compare(pkg, installed) == RpmHeaderReader::NotInstalled);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    testDecode();
+    testDamaged();
+    testCompare();
+
+    QTemporaryDir dir;
+    CHECK(dir.isValid());
+    if (dir.isValid())
+        testReadAll(dir);
+
+    return checkResult();
+}
@@ -0,0 +1,349 @@
+/**
+ * @file rpmpayload_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks RpmPayloadReader on cpio archives generated here: newc and
+ * stripped entries, every compression, early stop, truncation and a whole
+ * package file read from disk.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include "../decompressor.h"
+#include "../rpmpayload.h"
+#include "check.h"
+
+#include <tuple>
+
+namespace {
+
+void pad4(QByteArray &out)
+{
+    while (out.size() % 4)
+        out.append('\0');
+}
+
+/** Writes archives the way rpm's cpio.c does */
+class CpioBuilder
+{
+public:
+    void add(const QByteArray &name, quint32 mode, const QByteArray &data = {})
+    {
+        m_out += "070701";
+        const quint32 fields[13] {m_inode++, mode, 0, 0, 1, 1700000000, quint32(data.size()),
+                                  0, 0, 0, 0, quint32(name.size() + 1), 0};
+        for (quint32 field : fields)
+            m_out += QByteArray::number(field, 16).rightJustified(8, '0');
+        m_out += name + '\0';
+        pad4(m_out);
+        m_out += data;
+        pad4(m_out);
+    }
+
+    /** rpm >= 4.12 large-file archives: only the header index of the file */
+    void addStripped(quint32 index, const QByteArray &data = {})
+    {
+        m_out += "07070X" + QByteArray::number(index, 16).rightJustified(8, '0');
+        pad4(m_out);
+        m_out += data;
+        pad4(m_out);
+    }
+
+    QByteArray finish()
+    {
+        add("TRAILER!!!", 0);
+        return m_out;
+    }
+
+    QByteArray unfinished() const { return m_out; }
+
+private:
+    QByteArray m_out;
+    quint32 m_inode = 1;
+};
+
+QByteArray compress(const QByteArray &data, StreamCompressor::Format format)
+{
+    QByteArray out;
+    QBuffer buffer(&out);
+    buffer.open(QIODevice::WriteOnly);
+    StreamCompressor compressor(&buffer, format);
+    CHECK(compressor.write(data) && compressor.finish());
+    return out;
+}
+
+QVector<RpmPayloadEntry> list(RpmPayloadReader &reader, const QByteArray &payload,
+                              const QVector<RpmFileEntry> &files = {}, bool *ok = nullptr)
+{
+    QByteArray copy = payload;
+    QBuffer buffer(&copy);
+    buffer.open(QIODevice::ReadOnly);
+    QVector<RpmPayloadEntry> entries;
+    const bool result = reader.read(&buffer, files, [&entries](const RpmPayloadEntry &entry) {
+        entries.append(entry);
+        return true;
+    });
+    if (ok)
+        *ok = result;
+    return entries;
+}
+
+RpmFileEntry fileEntry(const QString &path, quint16 mode, qint64 size, quint32 inode, quint32 flags = 0)
+{
+    RpmFileEntry file;
+    file.path = path;
+    file.mode = mode;
+    file.size = size;
+    file.inode = inode;
+    file.flags = flags;
+    return file;
+}
+
+void testNewc()
+{
+    CpioBuilder cpio;
+    cpio.add("./usr/share/doc/fixture", 040755);
+    cpio.add("./usr/bin/fixture", 0104755, QByteArray(5000, 'x'));
+    cpio.add("./usr/bin/fixture-link", 0120777, "fixture");
+    cpio.add("etc/fixture.conf", 0100644, "key=value\n");
+    const QByteArray archive = cpio.finish();
+
+    for (const StreamCompressor::Format format :
+         {StreamCompressor::Format::Gzip, StreamCompressor::Format::Xz, StreamCompressor::Format::Zstd}) {
+        RpmPayloadReader reader;
+        bool ok = false;
+        const QVector<RpmPayloadEntry> entries = list(reader, compress(archive, format), {}, &ok);
+        CHECK(ok);
+        CHECK(reader.errorString().isEmpty());
+        CHECK(reader.isComplete());
+        CHECK(reader.entriesRead() == 4);
+        CHECK(reader.payloadBytesRead() == archive.size());
+        CHECK(entries.size() == 4);
+        if (entries.size() != 4)
+            continue;
+        CHECK(entries.at(0).path == QStringLiteral("/usr/share/doc/fixture"));
+        CHECK(entries.at(0).isDirectory());
+        CHECK(entries.at(0).permissions() == QStringLiteral("drwxr-xr-x"));
+        CHECK(entries.at(1).size == 5000);
+        CHECK(entries.at(1).permissions() == QStringLiteral("-rwsr-xr-x"));
+        CHECK(entries.at(2).isSymlink());
+        CHECK(entries.at(2).linkTarget == QStringLiteral("fixture"));
+        CHECK(entries.at(2).permissions() == QStringLiteral("lrwxrwxrwx"));
+        CHECK(entries.at(3).path == QStringLiteral("/etc/fixture.conf"));
+    }
+
+    // An uncompressed payload, as the oldest packages have
+    RpmPayloadReader reader;
+    bool ok = false;
+    CHECK(list(reader, archive, {}, &ok).size() == 4);
+    CHECK(ok);
+
+    RpmPayloadEntry sticky;
+    sticky.mode = 041777;
+    CHECK(sticky.permissions() == QStringLiteral("drwxrwxrwt"));
+}
+
+void testEarlyStop()
+{
+    const QVector<RpmFileEntry> files {
+        fileEntry(QStringLiteral("/usr/bin/a"), 0100755, 3, 1),
+        fileEntry(QStringLiteral("/var/log/a.log"), 0100644, 0, 2, 1u << 6), // ghost
+        fileEntry(QStringLiteral("/usr/bin/b"), 0100755, 3, 3),
+    };
+    CpioBuilder cpio;
+    cpio.add("./usr/bin/a", 0100755, "aaa");
+    cpio.add("./usr/bin/b", 0100755, QByteArray(1 << 20, 'b'));
+    // No trailer, and junk after it: the header already said there are two files
+    const QByteArray archive = cpio.unfinished() + "junk that is not cpio";
+
+    RpmPayloadReader reader;
+    bool ok = false;
+    const QVector<RpmPayloadEntry> entries = list(reader, compress(archive, StreamCompressor::Format::Zstd),
+                                                  files, &ok);
+    CHECK(ok);
+    CHECK(reader.isComplete());
+    CHECK(entries.size() == 2);
+    // The last file's megabyte was never decompressed
+    CHECK(reader.payloadBytesRead() < (1 << 20));
+
+    // The sink can stop it too
+    QByteArray payload = compress(archive, StreamCompressor::Format::Gzip);
+    QBuffer buffer(&payload);
+    buffer.open(QIODevice::ReadOnly);
+    RpmPayloadReader first;
+    int seen = 0;
+    CHECK(first.read(&buffer, files, [&seen](const RpmPayloadEntry &) { return ++seen < 1; }));
+    CHECK(seen == 1);
+    CHECK(!first.isComplete());
+}
+
+void testStripped()
+{
+    const QVector<RpmFileEntry> files {
+        fileEntry(QStringLiteral("/opt/big/data.bin"), 0100644, 6000, 10),
+        fileEntry(QStringLiteral("/opt/big/hardlink-1"), 0100644, 4, 11),
+        fileEntry(QStringLiteral("/opt/big/hardlink-2"), 0100644, 4, 11),
+        fileEntry(QStringLiteral("/opt/big/current"), 0120777, 8, 12),
+    };
+    CpioBuilder cpio;
+    cpio.addStripped(0, QByteArray(6000, 'd'));
+    cpio.addStripped(1);
+    cpio.addStripped(2, "same");
+    cpio.addStripped(3, "data.bin");
+    const QByteArray archive = cpio.finish();
+
+    RpmPayloadReader reader;
+    bool ok = false;
+    const QVector<RpmPayloadEntry> entries = list(reader, compress(archive, StreamCompressor::Format::Xz),
+                                                  files, &ok);
+    CHECK(ok);
+    CHECK(entries.size() == 4);
+    if (entries.size() == 4) {
+        CHECK(entries.at(0).path == QStringLiteral("/opt/big/data.bin"));
+        CHECK(entries.at(0).size == 6000);
+        CHECK(entries.at(1).size == 0);
+        CHECK(entries.at(2).size == 4);
+        CHECK(entries.at(3).linkTarget == QStringLiteral("data.bin"));
+    }
+
+    CpioBuilder bad;
+    bad.addStripped(7);
+    list(reader, bad.finish(), files, &ok);
+    CHECK(!ok);
+    CHECK(!reader.errorString().isEmpty());
+}
+
+void testDamaged()
+{
+    CpioBuilder cpio;
+    cpio.add("./usr/bin/a", 0100755, QByteArray(4000, 'a'));
+    cpio.add("./usr/bin/b", 0100755, "b");
+    const QByteArray archive = cpio.finish();
+
+    for (int cut = 0; cut < archive.size(); cut += 97) {
+        RpmPayloadReader reader;
+        bool ok = true;
+        list(reader, archive.left(cut), {}, &ok);
+        CHECK(!ok);
+        CHECK(!reader.errorString().isEmpty());
+    }
+
+    RpmPayloadReader reader;
+    bool ok = true;
+    list(reader, "070701zzzzzzzz" + QByteArray(200, '0'), {}, &ok);
+    CHECK(!ok);
+    list(reader, compress(archive, StreamCompressor::Format::Gzip).left(60), {}, &ok);
+    CHECK(!ok);
+}
+
+void appendBe32(QByteArray &out, quint32 value)
+{
+    char bytes[4];
+    qToBigEndian(value, bytes);
+    out.append(bytes, 4);
+}
+
+/** A header with the tags readFile() needs; entries are (tag, type, count, data) */
+QByteArray buildHeader(const QList<std::tuple<quint32, quint32, quint32, QByteArray>> &tags)
+{
+    QByteArray index;
+    QByteArray store;
+    for (const auto &[tag, type, count, data] : tags) {
+        while (type == 4 && store.size() % 4)
+            store.append('\0');
+        appendBe32(index, tag);
+        appendBe32(index, type);
+        appendBe32(index, quint32(store.size()));
+        appendBe32(index, count);
+        store += data;
+    }
+    QByteArray out("\x8e\xad\xe8\x01\0\0\0\0", 8);
+    appendBe32(out, quint32(tags.size()));
+    appendBe32(out, quint32(store.size()));
+    return out + index + store;
+}
+
+QByteArray buildRpm(const QByteArray &compressor, const QByteArray &payload)
+{
+    QByteArray lead(96, '\0');
+    lead[0] = char(0xED);
+    lead[1] = char(0xAB);
+    lead[2] = char(0xEE);
+    lead[3] = char(0xDB);
+    lead[4] = 3;
+    lead[79] = 5;
+
+    QByteArray one;
+    appendBe32(one, 1);
+    QByteArray rpm = lead + buildHeader({{1000, 4, 1, one}});
+    while (rpm.size() % 8)
+        rpm.append('\0');
+
+    QByteArray zero;
+    appendBe32(zero, 0);
+    rpm += buildHeader({
+        {1000, 6, 1, QByteArray("fixture", 8)},
+        {1001, 6, 1, QByteArray("1.0", 4)},
+        {1002, 6, 1, QByteArray("1", 2)},
+        {1022, 6, 1, QByteArray("x86_64", 7)},
+        {1044, 6, 1, QByteArray("fixture-1.0-1.src.rpm", 22)},
+        {1116, 4, 1, zero},
+        {1117, 8, 1, QByteArray("fixture", 8)},
+        {1118, 8, 1, QByteArray("/usr/bin/", 10)},
+        {1125, 6, 1, compressor + '\0'},
+    });
+    return rpm + payload;
+}
+
+void testReadFile(const QTemporaryDir &dir)
+{
+    CpioBuilder cpio;
+    cpio.add("./usr/bin/fixture", 0100755, "#!/bin/sh\n");
+    const QString path = dir.filePath(QStringLiteral("fixture-1.0-1.x86_64.rpm"));
+    QFile file(path);
+    CHECK(file.open(QIODevice::WriteOnly));
+    file.write(buildRpm("xz", compress(cpio.finish(), StreamCompressor::Format::Xz)));
+    file.close();
+
+    RpmPayloadReader reader;
+    QStringList paths;
+    CHECK(reader.readFile(path, [&paths](const RpmPayloadEntry &entry) {
+        paths.append(entry.path);
+        return true;
+    }));
+    CHECK(paths == QStringList({QStringLiteral("/usr/bin/fixture")}));
+    CHECK(reader.isComplete());
+
+    const QString bzip = dir.filePath(QStringLiteral("old.rpm"));
+    QFile old(bzip);
+    CHECK(old.open(QIODevice::WriteOnly));
+    old.write(buildRpm("bzip2", "BZh91AY&SY"));
+    old.close();
+    CHECK(!reader.readFile(bzip, [](const RpmPayloadEntry &) { return true; }));
+    CHECK(reader.errorString().contains(QStringLiteral("bzip2")));
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    testNewc();
+    testEarlyStop();
+    testStripped();
+    testDamaged();
+
+    QTemporaryDir dir;
+    CHECK(dir.isValid());
+    if (dir.isValid())
+        testReadFile(dir);
+
+    return checkResult();
+}
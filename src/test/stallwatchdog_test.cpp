@@ -0,0 +1,115 @@
+/**
+ * @file stallwatchdog_test.cpp
+ * @author Nikolay Yevik
+ * @brief Blocks the event loop under a StallWatchdog and checks the stall is
+ * reported and logged with its duration and the operation scopes that were open.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QThread>
+#include <QTimer>
+
+#include "../ringlog.h"
+#include "../stallwatchdog.h"
+#include "check.h"
+
+namespace {
+
+constexpr int ThresholdMs {100};
+
+void spin(int ms)
+{
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+QString lastLogged()
+{
+    RingLog::flush();
+    const QVector<RingLog::Entry> entries = RingLog::recent();
+    return entries.isEmpty() ? QString() : entries.last().message;
+}
+
+void testStallIsBlamed()
+{
+    StallWatchdog watchdog;
+    watchdog.setThreshold(ThresholdMs);
+    QVector<StallRecord> stalls;
+    QObject::connect(&watchdog, &StallWatchdog::stallRecorded, &watchdog,
+                     [&stalls](const StallRecord &stall) { stalls.append(stall); });
+    watchdog.start();
+    CHECK(watchdog.isActive());
+
+    // A running loop answers every ping, however long it runs
+    spin(ThresholdMs * 3);
+    CHECK(stalls.isEmpty());
+
+    // Scopes on other threads are not the event loop's
+    QThread *other = QThread::create([]() {
+        OperationScope scope("worker scope");
+        QThread::msleep(ThresholdMs * 5);
+    });
+    other->start();
+    {
+        OperationScope outer("MainWindow::onRpmQueryFiles");
+        OperationScope inner(QStringLiteral("rpm -ql bash"));
+        CHECK(StallWatchdog::activeScopes().size() == 2);
+        QThread::msleep(ThresholdMs * 4);
+    }
+    CHECK(StallWatchdog::activeScopes().isEmpty());
+    spin(ThresholdMs * 2);
+    other->wait();
+    delete other;
+
+    CHECK(stalls.size() == 1);
+    if (!stalls.isEmpty()) {
+        const StallRecord &stall = stalls.first();
+        CHECK(stall.scopes == QStringList({QStringLiteral("MainWindow::onRpmQueryFiles"),
+                                           QStringLiteral("rpm -ql bash")}));
+        // Measured from the first unanswered ping, so up to one interval short
+        CHECK(stall.durationMs >= ThresholdMs * 3);
+        CHECK(stall.durationMs < ThresholdMs * 10);
+        CHECK(watchdog.worstStall().durationMs == stall.durationMs);
+    }
+
+    RingLog::flush();
+    const QVector<RingLog::Entry> logged = RingLog::recent();
+    CHECK(logged.size() == 1);
+    if (!logged.isEmpty()) {
+        CHECK(logged.first().level == RingLog::Warning);
+        CHECK(logged.first().message.startsWith(QLatin1String("stall: ")));
+        CHECK(logged.first().message.endsWith(QLatin1String(" ms during MainWindow::onRpmQueryFiles > rpm -ql bash")));
+    }
+
+    // Unmarked work still gets logged
+    QThread::msleep(ThresholdMs * 3);
+    spin(ThresholdMs * 2);
+    CHECK(stalls.size() == 2);
+    if (stalls.size() == 2)
+        CHECK(stalls.last().scopes.isEmpty());
+    CHECK(lastLogged().endsWith(QLatin1String("(no operation scope)")));
+
+    watchdog.stop();
+    CHECK(!watchdog.isActive());
+    {
+        // Inert without a watchdog
+        OperationScope scope("unwatched");
+        CHECK(StallWatchdog::activeScopes().isEmpty());
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    testStallIsBlamed();
+
+    return checkResult();
+}
@@ -0,0 +1,59 @@
+# Shared by the dnf/rpm/sudo stand-ins that e2e_test puts first on PATH.
+# Everything is driven by the environment so one set of scripts serves
+# every scenario:
+#   TURBORPM_STUB_FIXTURES        directory with the recorded outputs (required)
+#   TURBORPM_STUB_DELAY_MS        sleep before the first byte (default 0)
+#   TURBORPM_STUB_CHUNK_BYTES     write stdout in chunks of this size (default: all at once)
+#   TURBORPM_STUB_CHUNK_DELAY_MS  sleep between chunks
+#   TURBORPM_STUB_NOISE=1         dnf prints the subscription-manager line and stderr chatter
+#   TURBORPM_STUB_EXIT_<KEY>      exit code override, e.g. TURBORPM_STUB_EXIT_DNF_INSTALL=1
+#   TURBORPM_STUB_LOG             append "<tool> <args>" for every invocation
+#
+# Long-lived children such as turborpm-helper keep the environment they were
+# started with, so $TURBORPM_STUB_FIXTURES/stub.env, when present, is sourced
+# on top and wins.
+
+if [ -n "${TURBORPM_STUB_FIXTURES:-}" ] && [ -f "$TURBORPM_STUB_FIXTURES/stub.env" ]; then
+    . "$TURBORPM_STUB_FIXTURES/stub.env"
+fi
+
+stub_sleep_ms() {
+    ms=${1:-0}
+    [ "$ms" -gt 0 ] || return 0
+    sleep "$((ms / 1000)).$(printf '%03d' $((ms % 1000)))"
+}
+
+stub_log() {
+    [ -n "${TURBORPM_STUB_LOG:-}" ] && printf '%s\n' "$*" >> "$TURBORPM_STUB_LOG"
+    return 0
+}
+
+# stub_replay <fixture> <default exit code> <override key> [noise]
+stub_replay() {
+    fixture="${TURBORPM_STUB_FIXTURES:?TURBORPM_STUB_FIXTURES is not set}/$1"
+
+    stub_sleep_ms "${TURBORPM_STUB_DELAY_MS:-0}"
+    if [ "${4:-}" = noise ] && [ "${TURBORPM_STUB_NOISE:-0}" = 1 ]; then
+        echo "Not root, Subscription Management repositories not updated"
+        echo "Updating Subscription Management repositories." >&2
+        echo "Unable to read consumer identity" >&2
+    fi
+
+    if [ -f "$fixture" ]; then
+        chunk=${TURBORPM_STUB_CHUNK_BYTES:-0}
+        if [ "$chunk" -gt 0 ]; then
+            size=$(wc -c < "$fixture")
+            i=0
+            while [ $((i * chunk)) -lt "$size" ]; do
+                dd if="$fixture" bs="$chunk" skip="$i" count=1 2>/dev/null
+                stub_sleep_ms "${TURBORPM_STUB_CHUNK_DELAY_MS:-0}"
+                i=$((i + 1))
+            done
+        else
+            cat "$fixture"
+        fi
+    fi
+
+    eval "override=\${TURBORPM_STUB_EXIT_$3:-}"
+    exit "${override:-$2}"
+}
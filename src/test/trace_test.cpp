@@ -0,0 +1,148 @@
+/**
+ * @file trace_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks that Trace writes valid Chrome trace-event JSON (spans, counters,
+ * instants, thread names from several threads) and records nothing while disabled.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include "../trace.h"
+#include "check.h"
+
+#include <thread>
+
+namespace {
+
+void recordDisabled()
+{
+    CHECK(!Trace::isEnabled());
+    TraceSpan span("test", "disabled-span");
+    CHECK(!span.isActive());
+    span.arg("ignored", 1);
+    Trace::counter("disabled-counter", 1);
+    Trace::instant("test", "disabled-instant");
+    Trace::setThreadName("disabled-thread");
+}
+
+QJsonArray readEvents(const QString &path)
+{
+    QFile file(path);
+    CHECK(file.open(QIODevice::ReadOnly));
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    CHECK(error.error == QJsonParseError::NoError);
+    CHECK(doc.isObject());
+    CHECK(doc.object().value(QStringLiteral("displayTimeUnit")).toString() == QLatin1String("ms"));
+    CHECK(doc.object().value(QStringLiteral("traceEvents")).isArray());
+    return doc.object().value(QStringLiteral("traceEvents")).toArray();
+}
+
+QJsonObject findEvent(const QJsonArray &events, const QString &name)
+{
+    for (const QJsonValue &value : events) {
+        if (value.toObject().value(QStringLiteral("name")).toString() == name)
+            return value.toObject();
+    }
+    return {};
+}
+
+void testRoundTrip(const QString &dir)
+{
+    recordDisabled();
+
+    const QString path = dir + QStringLiteral("/trace.json");
+    CHECK(Trace::start(path));
+    CHECK(Trace::isEnabled());
+    {
+        TraceSpan span("test", "outer-span");
+        CHECK(span.isActive());
+        span.arg("items", 42);
+        Trace::counter("test.counter", 7);
+        Trace::instant("test", "marker", QJsonObject{{QStringLiteral("why"), QStringLiteral("check")}});
+    }
+    std::thread([]() {
+        Trace::setThreadName("worker");
+        TraceSpan span("test", QStringLiteral("worker-span"));
+    }).join();
+    CHECK(Trace::stop());
+    CHECK(!Trace::isEnabled());
+    recordDisabled();
+
+    const QJsonArray events = readEvents(path);
+    CHECK(events.size() == 7); // process and two thread names, span, counter, instant, worker span
+
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        CHECK(event.contains(QStringLiteral("ph")) && event.contains(QStringLiteral("name"))
+              && event.contains(QStringLiteral("pid")));
+        CHECK(!event.value(QStringLiteral("name")).toString().startsWith(QLatin1String("disabled")));
+        if (event.value(QStringLiteral("ph")).toString() != QLatin1String("M"))
+            CHECK(event.value(QStringLiteral("ts")).isDouble() && event.contains(QStringLiteral("tid")));
+    }
+
+    const QJsonObject process = findEvent(events, QStringLiteral("process_name"));
+    CHECK(process.value(QStringLiteral("ph")).toString() == QLatin1String("M"));
+
+    const QJsonObject span = findEvent(events, QStringLiteral("outer-span"));
+    CHECK(span.value(QStringLiteral("ph")).toString() == QLatin1String("X"));
+    CHECK(span.value(QStringLiteral("cat")).toString() == QLatin1String("test"));
+    CHECK(span.value(QStringLiteral("dur")).toDouble(-1) >= 0);
+    CHECK(span.value(QStringLiteral("args")).toObject().value(QStringLiteral("items")).toInt() == 42);
+
+    const QJsonObject counter = findEvent(events, QStringLiteral("test.counter"));
+    CHECK(counter.value(QStringLiteral("ph")).toString() == QLatin1String("C"));
+    CHECK(counter.value(QStringLiteral("args")).toObject().value(QStringLiteral("value")).toInt() == 7);
+
+    const QJsonObject instant = findEvent(events, QStringLiteral("marker"));
+    CHECK(instant.value(QStringLiteral("ph")).toString() == QLatin1String("i"));
+    CHECK(instant.value(QStringLiteral("s")).toString() == QLatin1String("t"));
+    // The instant happened inside the span
+    CHECK(instant.value(QStringLiteral("ts")).toDouble() >= span.value(QStringLiteral("ts")).toDouble());
+
+    // The worker got its own track, named by its metadata event
+    const QJsonObject worker = findEvent(events, QStringLiteral("worker-span"));
+    CHECK(worker.value(QStringLiteral("tid")).toInt() != span.value(QStringLiteral("tid")).toInt());
+    bool named = false;
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        if (event.value(QStringLiteral("name")).toString() == QLatin1String("thread_name")
+            && event.value(QStringLiteral("tid")) == worker.value(QStringLiteral("tid")))
+            named = event.value(QStringLiteral("args")).toObject().value(QStringLiteral("name")).toString()
+                    == QLatin1String("worker");
+    }
+    CHECK(named);
+}
+
+void testNothingRecordedWhileDisabled(const QString &dir)
+{
+    // A second session starts empty: nothing from the disabled calls was kept
+    const QString path = dir + QStringLiteral("/empty.json");
+    CHECK(Trace::start(path));
+    CHECK(Trace::stop());
+    const QJsonArray events = readEvents(path);
+    // process_name and the "main" thread name start() adds, nothing else
+    CHECK(events.size() == 2);
+    for (const QJsonValue &value : events)
+        CHECK(value.toObject().value(QStringLiteral("ph")).toString() == QLatin1String("M"));
+}
+
+} // namespace
+
+int main()
+{
+    QTemporaryDir dir;
+    CHECK(dir.isValid());
+
+    testRoundTrip(dir.path());
+    testNothingRecordedWhileDisabled(dir.path());
+
+    return checkResult();
+}
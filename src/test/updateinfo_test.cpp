@@ -0,0 +1,236 @@
+/**
+ * @file updateinfo_test.cpp
+ * @author Nikolay Yevik
+ * @brief Offline test of the updateinfo.xml reader and the advisory join against fixture metadata.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include "../updateinfo.h"
+#include "../packagemodel.h"
+#include "../packagefilterproxy.h"
+#include "../rpmevr.h"
+#include "check.h"
+
+#include <iostream>
+
+static QString fixture(const QString &name)
+{
+    return QStringLiteral(TURBORPM_FIXTURE_DIR "/") + name;
+}
+
+static PackageInfo installed(const char *name, const char *epoch, const char *version, const char *arch)
+{
+    PackageInfo pkg;
+    pkg.name = QString::fromLatin1(name);
+    pkg.epoch = QString::fromLatin1(epoch);
+    pkg.version = QString::fromLatin1(version);
+    pkg.arch = QString::fromLatin1(arch);
+    return pkg;
+}
+
+static AdvisoryIndex readFixture(bool *ok)
+{
+    AdvisoryIndex index;
+    UpdateInfoReader reader;
+    *ok = reader.readFile(fixture(QStringLiteral("updateinfo.xml.zst")), QStringLiteral("updates"), index);
+    return index;
+}
+
+static void testFormats()
+{
+    for (const char *name : {"updateinfo.xml", "updateinfo.xml.gz", "updateinfo.xml.zst"}) {
+        AdvisoryIndex index;
+        UpdateInfoReader reader;
+        const bool ok = reader.readFile(fixture(QString::fromLatin1(name)), QStringLiteral("updates"), index);
+        if (!ok)
+            std::cerr << name << ": " << reader.errorString().toStdString() << std::endl;
+        CHECK(ok);
+        // The mirror copy of FEDORA-2025-0001 is read but not added twice
+        CHECK(reader.advisoriesRead() == 5);
+        CHECK(index.size() == 4);
+        // src packages are not installable and never match
+        CHECK(index.fixCount() == 8);
+        if (index.size() != 4)
+            continue;
+
+        const Advisory &openssl = index.advisory(0);
+        CHECK(openssl.id == QLatin1String("FEDORA-2025-0001"));
+        CHECK(openssl.isSecurity());
+        CHECK(openssl.severity == AdvisorySeverity::Important);
+        CHECK(openssl.title == QLatin1String("openssl-3.2.4-1.fc41"));
+        CHECK(openssl.issued == QLatin1String("2025-02-11 01:23:45"));
+        CHECK(openssl.repoId == QLatin1String("updates"));
+
+        CHECK(index.advisory(1).type == QLatin1String("bugfix"));
+        CHECK(index.advisory(1).severity == AdvisorySeverity::None);
+        CHECK(index.advisory(2).severity == AdvisorySeverity::Critical); // lower-case in the file
+        CHECK(index.advisory(3).severity == AdvisorySeverity::Low);
+    }
+}
+
+static void testTruncated()
+{
+    QFile file(fixture(QStringLiteral("updateinfo.xml")));
+    CHECK(file.open(QIODevice::ReadOnly));
+    QByteArray half = file.readAll();
+    half.truncate(half.size() / 2);
+
+    QBuffer buffer(&half);
+    buffer.open(QIODevice::ReadOnly);
+    AdvisoryIndex index;
+    UpdateInfoReader reader;
+    CHECK(!reader.read(&buffer, QStringLiteral("updates"), index));
+    CHECK(!reader.errorString().isEmpty());
+}
+
+static void testMatch()
+{
+    bool ok = false;
+    const AdvisoryIndex index = readFixture(&ok);
+    CHECK(ok);
+
+    auto match = [&index](const PackageInfo &pkg) {
+        return index.match(pkg.name, pkg.arch, RpmEvr::sortKey(pkg.epoch, pkg.version));
+    };
+
+    // Older than both fixes: the critical one sorts first
+    const AdvisoryMatch bash = match(installed("bash", "0", "5.2.26-3.fc41", "x86_64"));
+    CHECK(bash.advisories.size() == 2);
+    CHECK(bash.severity == AdvisorySeverity::Critical);
+    CHECK(bash.security);
+    if (bash.advisories.size() == 2) {
+        CHECK(index.advisory(bash.advisories.at(0)).id == QLatin1String("FEDORA-2025-0003"));
+        CHECK(index.advisory(bash.advisories.at(1)).id == QLatin1String("FEDORA-2025-0002"));
+    }
+
+    // Between the two fixes: only the newer bugfix remains
+    const AdvisoryMatch newerBash = match(installed("bash", "0", "5.2.32-1.fc41", "x86_64"));
+    CHECK(newerBash.advisories.size() == 1);
+    CHECK(!newerBash.security);
+    CHECK(newerBash.severity == AdvisorySeverity::None);
+
+    CHECK(match(installed("bash", "0", "5.2.37-1.fc41", "x86_64")).isEmpty());
+    CHECK(match(installed("bash", "0", "5.2.26-3.fc41", "aarch64")).isEmpty());
+
+    // The epoch outweighs the version; the mirror copy does not duplicate the match
+    const AdvisoryMatch openssl = match(installed("openssl", "1", "3.2.2-9.fc41", "x86_64"));
+    CHECK(openssl.advisories.size() == 1);
+    CHECK(openssl.severity == AdvisorySeverity::Important);
+    CHECK(match(installed("openssl", "2", "3.0.0-1.fc41", "x86_64")).isEmpty());
+    CHECK(match(installed("openssl-libs", "1", "3.2.2-9.fc41", "i686")).advisories.size() == 1);
+
+    // noarch on either side
+    CHECK(match(installed("tzdata", "0", "2024b-1.fc41", "noarch")).advisories.size() == 1);
+    CHECK(match(installed("python3-pip", "0", "24.2-1.fc41", "noarch")).advisories.size() == 1);
+
+    CHECK(match(installed("zsh", "0", "5.9-1.fc41", "x86_64")).isEmpty());
+}
+
+static void testModel()
+{
+    bool ok = false;
+    const AdvisoryIndex index = readFixture(&ok);
+    CHECK(ok);
+
+    PackageTableModel model;
+    model.setPackages({installed("bash", "0", "5.2.26-3.fc41", "x86_64"),
+                       installed("openssl", "1", "3.2.2-9.fc41", "x86_64"),
+                       installed("python3-pip", "0", "24.2-1.fc41", "noarch"),
+                       installed("zsh", "0", "5.9-1.fc41", "x86_64")});
+    CHECK(model.affectedCount() == 0);
+    model.setAdvisories(index);
+    CHECK(model.affectedCount() == 3);
+
+    CHECK(model.index(0, PackageTableModel::AdvisoriesColumn).data().toString()
+          == QLatin1String("FEDORA-2025-0003 (+1)"));
+    CHECK(model.index(0, PackageTableModel::SeverityColumn).data().toString()
+          == QLatin1String("Critical"));
+    CHECK(model.index(1, PackageTableModel::AdvisoriesColumn).data().toString()
+          == QLatin1String("FEDORA-2025-0001"));
+    CHECK(model.index(3, PackageTableModel::AdvisoriesColumn).data().toString().isEmpty());
+    CHECK(model.index(0, PackageTableModel::AdvisoriesColumn).data(Qt::ToolTipRole).toString().contains(
+        QLatin1String("tzdata and bash")));
+
+    PackageFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.setAdvisoryFilter(PackageFilterProxyModel::AdvisoryFilter::Any);
+    CHECK(proxy.rowCount() == 3);
+    proxy.setAdvisoryFilter(PackageFilterProxyModel::AdvisoryFilter::Security);
+    CHECK(proxy.rowCount() == 2);
+    proxy.setAdvisoryFilter(PackageFilterProxyModel::AdvisoryFilter::Important);
+    CHECK(proxy.rowCount() == 2);
+    proxy.setAdvisoryFilter(PackageFilterProxyModel::AdvisoryFilter::Off);
+    CHECK(proxy.rowCount() == 4);
+
+    proxy.sort(PackageTableModel::SeverityColumn, Qt::DescendingOrder);
+    CHECK(proxy.index(0, PackageTableModel::NameColumn).data().toString() == QLatin1String("bash"));
+
+    // An upgrade past the fix clears the row; a refresh keeps the advisories
+    model.upsertPackages({installed("openssl", "1", "3.2.4-1.fc41", "x86_64")});
+    CHECK(model.affectedCount() == 2);
+    CHECK(model.advisoriesAt(1).isEmpty());
+    model.removePackages({QStringLiteral("bash.x86_64")});
+    CHECK(model.affectedCount() == 1);
+    model.setPackages({installed("bash", "0", "5.2.26-3.fc41", "x86_64")});
+    CHECK(model.affectedCount() == 1);
+}
+
+static void testLargeJoin()
+{
+    // Roughly a year of Fedora updates against a workstation install
+    constexpr int Advisories = 20000;
+    constexpr int Packages = 6000;
+
+    AdvisoryIndex index;
+    const QString arch = QStringLiteral("x86_64");
+    for (int i = 0; i < Advisories; ++i) {
+        Advisory advisory;
+        advisory.id = QStringLiteral("FEDORA-2025-%1").arg(i, 10, 16, QLatin1Char('0'));
+        advisory.type = (i % 3) ? QStringLiteral("bugfix") : QStringLiteral("security");
+        advisory.severity = AdvisorySeverity(i % 5);
+        const int added = index.addAdvisory(advisory);
+        // Three packages per advisory, spread over twice as many names as are installed
+        for (int p = 0; p < 3; ++p) {
+            const int pkg = (i * 3 + p) % (Packages * 2);
+            index.addFix(added, QStringLiteral("pkg%1").arg(pkg), arch,
+                         RpmEvr::sortKey(u"0", QStringLiteral("1.%1-1.fc41").arg(i % 50)));
+        }
+    }
+
+    QVector<PackageInfo> pkgs;
+    pkgs.reserve(Packages);
+    for (int i = 0; i < Packages; ++i) {
+        PackageInfo pkg = installed("", "0", "1.25-1.fc41", "x86_64");
+        pkg.name = QStringLiteral("pkg%1").arg(i);
+        pkgs.append(pkg);
+    }
+
+    PackageTableModel model;
+    model.setPackages(pkgs);
+    QElapsedTimer timer;
+    timer.start();
+    model.setAdvisories(index);
+    const qint64 elapsed = timer.elapsed();
+    std::cout << "advisory join: " << Advisories << " advisories x " << Packages << " packages in "
+              << elapsed << " ms, " << model.affectedCount() << " affected" << std::endl;
+    CHECK(model.affectedCount() > 0);
+    CHECK(model.affectedCount() < Packages);
+    CHECK(elapsed < 1000);
+}
+
+int main()
+{
+    testFormats();
+    testTruncated();
+    testMatch();
+    testModel();
+    testLargeJoin();
+
+    return checkResult();
+}
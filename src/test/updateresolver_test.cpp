@@ -0,0 +1,215 @@
+/**
+ * @file updateresolver_test.cpp
+ * @author Nikolay Yevik
+ * @brief Offline test of the in-process update resolver against a recorded dnf check-update.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "../updateresolver.h"
+#include "../packagequery.h"
+#include "check.h"
+
+#include <iostream>
+
+static QString fixture(const QString &name)
+{
+    return QStringLiteral(TURBORPM_FIXTURE_DIR "/resolver/") + name;
+}
+
+static QByteArray readFixture(const QString &name)
+{
+    QFile file(fixture(name));
+    CHECK(file.open(QIODevice::ReadOnly));
+    return file.readAll();
+}
+
+static PackageInfo pkg(const char *name, const char *epoch, const char *version, const char *arch,
+                       const char *repo = "updates")
+{
+    PackageInfo info;
+    info.name = QString::fromLatin1(name);
+    info.epoch = QString::fromLatin1(epoch);
+    info.version = QString::fromLatin1(version);
+    info.arch = QString::fromLatin1(arch);
+    info.repo = QString::fromLatin1(repo);
+    return info;
+}
+
+/** The fixture cache and installed list were taken together with check-update.txt */
+static void testMatchesRecordedCheckUpdate()
+{
+    UpdateResolver resolver;
+    QStringList errors;
+    CHECK(resolver.loadCache(&errors, {fixture(QStringLiteral("cache"))}, {fixture(QStringLiteral("repos.d"))}));
+    CHECK(errors.isEmpty());
+    for (const QString &error : std::as_const(errors))
+        std::cerr << error.toStdString() << std::endl;
+
+    const QVector<PackageInfo> installed =
+        InstalledPackageQuery::parseRepoqueryOutput(readFixture(QStringLiteral("installed.txt")));
+    CHECK(installed.size() == 16);
+
+    const UpdateSet resolved = resolver.resolve(installed);
+    const UpdateSet recorded = UpdateSet::parseCheckUpdateOutput(
+        QString::fromUtf8(readFixture(QStringLiteral("check-update.txt"))));
+    CHECK(recorded.size() == 10);
+    CHECK(resolved.size() == recorded.size());
+
+    for (const UpdateEntry &expected : recorded.entries()) {
+        const UpdateEntry *actual = resolved.find(expected.name, expected.arch);
+        if (!actual) {
+            std::cerr << "missing " << qPrintable(UpdateSet::keyFor(expected.name, expected.arch))
+                      << std::endl;
+            ++failures;
+            continue;
+        }
+        CHECK(actual->arch == expected.arch);
+        CHECK(actual->evr == expected.evr);
+        CHECK(actual->evrKey == expected.evrKey);
+        CHECK(actual->repo == expected.repo);
+    }
+    for (const UpdateEntry &actual : resolved.entries()) {
+        if (!recorded.find(actual.name, actual.arch)) {
+            std::cerr << "unexpected " << qPrintable(UpdateSet::keyFor(actual.name, actual.arch))
+                      << std::endl;
+            ++failures;
+        }
+    }
+}
+
+static void testDisabledRepo()
+{
+    const QSet<QString> enabled = RepoMetadataCache::enabledRepoIds({fixture(QStringLiteral("repos.d"))}, {});
+    CHECK(enabled == QSet<QString>({QStringLiteral("fedora"), QStringLiteral("updates")}));
+
+    // updates-testing is disabled but still cached, with a newer bash and tzdata
+    UpdateResolver filtered;
+    CHECK(filtered.loadCache(nullptr, {fixture(QStringLiteral("cache"))}, {fixture(QStringLiteral("repos.d"))}));
+    UpdateResolver everything;
+    CHECK(everything.loadCache(nullptr, {fixture(QStringLiteral("cache"))}, {}));
+    const QVector<PackageInfo> installed =
+        InstalledPackageQuery::parseRepoqueryOutput(readFixture(QStringLiteral("installed.txt")));
+
+    const UpdateEntry *bash = filtered.resolve(installed).find(QStringLiteral("bash"), QStringLiteral("x86_64"));
+    CHECK(bash && bash->repo == QLatin1String("updates") && bash->evr == QLatin1String("5.2.32-1.fc41"));
+    const UpdateSet unfiltered = everything.resolve(installed);
+    const UpdateEntry *testing = unfiltered.find(QStringLiteral("tzdata"), QStringLiteral("noarch"));
+    CHECK(testing && testing->repo == QLatin1String("updates-testing"));
+
+    // Ids expand dnf variables; repos.override.d globs apply to what came before
+    QTemporaryDir dir;
+    CHECK(dir.isValid());
+    QDir().mkpath(dir.path() + QStringLiteral("/repos.d"));
+    QDir().mkpath(dir.path() + QStringLiteral("/override.d"));
+    QFile copr(dir.path() + QStringLiteral("/repos.d/copr.repo"));
+    CHECK(copr.open(QIODevice::WriteOnly));
+    copr.write("[copr-f${releasever}-$basearch]\nenabled=True\n[extras-testing]\nenabled=1\n");
+    copr.close();
+    QFile setopt(dir.path() + QStringLiteral("/override.d/99-testing.repo"));
+    CHECK(setopt.open(QIODevice::WriteOnly));
+    setopt.write("# config-manager setopt *-testing.enabled=0\n[*-testing]\nenabled=0\n");
+    setopt.close();
+    const QSet<QString> expanded = RepoMetadataCache::enabledRepoIds(
+        {dir.path() + QStringLiteral("/repos.d"), dir.path() + QStringLiteral("/override.d")},
+        {{QStringLiteral("releasever"), QStringLiteral("41")}, {QStringLiteral("basearch"), QStringLiteral("x86_64")}});
+    CHECK(expanded == QSet<QString>({QStringLiteral("copr-f41-x86_64")}));
+}
+
+static void testInstallOnly()
+{
+    UpdateResolver resolver;
+    resolver.addAvailable(pkg("kernel", "0", "6.12.9-200.fc41", "x86_64"));
+    resolver.addAvailable(pkg("kernel", "0", "6.13.0-100.fc41", "noarch"));
+    CHECK(UpdateResolver::isInstallOnly(QStringLiteral("kernel-core")));
+    CHECK(!UpdateResolver::isInstallOnly(QStringLiteral("kernel-headers")));
+
+    // installonlypkgs= adds to the kernel flavors, it does not replace them
+    const QSet<QString> names = UpdateResolver::installOnlyNames(fixture(QStringLiteral("dnf.conf")));
+    for (const char *name : {"kernel-64k-core", "kernel-zfcpdump", "kernel-rt-debug-devel", "kernel-uki-virt",
+                             "kernel-custom", "zfs-kmod"})
+        CHECK(names.contains(QLatin1String(name)));
+    CHECK(!names.contains(QStringLiteral("kernel-headers")));
+    CHECK(!names.contains(QStringLiteral("not-main")));
+    const QSet<QString> defaults = UpdateResolver::installOnlyNames(fixture(QStringLiteral("nosuch.conf")));
+    CHECK(defaults.contains(QStringLiteral("kernel")) && !defaults.contains(QStringLiteral("zfs-kmod")));
+
+    // Judged by the newest installed kernel, and never moved to noarch
+    CHECK(resolver.resolve({pkg("kernel", "0", "6.12.9-200.fc41", "x86_64"),
+                            pkg("kernel", "0", "6.11.4-301.fc41", "x86_64")}).isEmpty());
+    const UpdateSet older = resolver.resolve({pkg("kernel", "0", "6.11.4-301.fc41", "x86_64")});
+    CHECK(older.size() == 1);
+    const UpdateEntry *update = older.find(QStringLiteral("kernel"), QStringLiteral("x86_64"));
+    CHECK(update && update->evr == QLatin1String("6.12.9-200.fc41"));
+}
+
+static void testCandidates()
+{
+    UpdateResolver resolver;
+    resolver.addAvailable(pkg("vim", "2", "9.1.800-1.fc41", "x86_64", "fedora"));
+    resolver.addAvailable(pkg("vim", "2", "9.1.1000-1.fc41", "x86_64", "updates"));
+    resolver.addAvailable(pkg("vim", "2", "9.1.1000-1.fc41", "x86_64", "mirror"));
+    resolver.addAvailable(pkg("vim", "2", "9.1.1000-1.fc41", "src", "updates-source"));
+    resolver.addAvailable(pkg("vim", "2", "9.1.1000-1.fc41", "noarch", "updates"));
+    // Newest per arch only, source packages dropped
+    CHECK(resolver.candidateCount() == 2);
+
+    const UpdateSet updates = resolver.resolve({pkg("vim", "1", "9.9-1.fc41", "x86_64")});
+    const UpdateEntry *update = updates.find(QStringLiteral("vim"), QStringLiteral("x86_64"));
+    CHECK(update);
+    if (update) {
+        CHECK(update->arch == QLatin1String("x86_64")); // a same-arch tie beats noarch
+        CHECK(update->evr == QLatin1String("2:9.1.1000-1.fc41"));
+        CHECK(update->repo == QLatin1String("updates")); // first repo read wins a tie
+    }
+    CHECK(UpdateResolver::formatEvr(QStringLiteral("0"), QStringLiteral("1.0-1")) == QLatin1String("1.0-1"));
+    CHECK(UpdateResolver::formatEvr(QString(), QStringLiteral("1.0-1")) == QLatin1String("1.0-1"));
+}
+
+static void testLargeResolve()
+{
+    constexpr int Available = 70000;
+    constexpr int Installed = 6000;
+
+    UpdateResolver resolver;
+    for (int i = 0; i < Available; ++i) {
+        PackageInfo info = pkg("", "0", "", (i % 7) ? "x86_64" : "noarch");
+        info.name = QStringLiteral("pkg%1").arg(i);
+        info.version = QStringLiteral("1.%1-1.fc41").arg(i % 3);
+        resolver.addAvailable(info);
+    }
+    QVector<PackageInfo> installed;
+    for (int i = 0; i < Installed; ++i) {
+        const int name = i * 11;
+        PackageInfo info = pkg("", "0", "1.1-1.fc41", (name % 7) ? "x86_64" : "noarch");
+        info.name = QStringLiteral("pkg%1").arg(name);
+        installed.append(info);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const UpdateSet updates = resolver.resolve(installed);
+    const qint64 elapsed = timer.elapsed();
+    std::cout << "resolve: " << Installed << " installed against " << Available << " available in "
+              << elapsed << " ms, " << updates.size() << " updates" << std::endl;
+    // 1.2 beats the installed 1.1, 1.0 does not
+    CHECK(updates.size() == Installed / 3);
+    CHECK(elapsed < 500);
+}
+
+int main()
+{
+    testMatchesRecordedCheckUpdate();
+    testDisabledRepo();
+    testInstallOnly();
+    testCandidates();
+    testLargeResolve();
+
+    return checkResult();
+}
@@ -0,0 +1,118 @@
+/**
+ * @file updateset_test.cpp
+ * @author Nikolay Yevik
+ * @brief Checks UpdateSet against a recorded dnf check-update (wrapped lines,
+ * the obsoletes section, the noarch fallback) and the "Update available" sort.
+ * @version 0.0.1
+ * @date 2025-12-6
+ * @copyright Copyright (c) 2025 Nikolay Yevik
+ */
+
+#include <QFile>
+
+#include "../packagefilterproxy.h"
+#include "../packagemodel.h"
+#include "../updateset.h"
+#include "check.h"
+
+static UpdateSet recorded()
+{
+    QFile file(QStringLiteral(TURBORPM_FIXTURE_DIR "/resolver/check-update.txt"));
+    CHECK(file.open(QIODevice::ReadOnly));
+    return UpdateSet::parseCheckUpdateOutput(QString::fromUtf8(file.readAll()));
+}
+
+static void testRecordedOutput()
+{
+    const UpdateSet updates = recorded();
+    CHECK(updates.size() == 10);
+
+    const UpdateEntry *bash = updates.find(QStringLiteral("bash"), QStringLiteral("x86_64"));
+    CHECK(bash && bash->evr == QLatin1String("5.2.32-1.fc41") && bash->repo == QLatin1String("updates"));
+    CHECK(bash && !bash->evrKey.isEmpty());
+
+    // "name.arch" wrapped onto a line of its own, EVR and repo on the next
+    const UpdateEntry *texlive = updates.find(QStringLiteral("texlive-collection-latexrecommended"),
+                                              QStringLiteral("noarch"));
+    CHECK(texlive && texlive->evr == QLatin1String("11:svn71526-1.fc41"));
+
+    const UpdateEntry *openssl = updates.find(QStringLiteral("openssl-libs"), QStringLiteral("x86_64"));
+    CHECK(openssl && openssl->evr == QLatin1String("1:3.2.4-1.fc41"));
+
+    // Same name, two arches
+    CHECK(updates.find(QStringLiteral("glibc"), QStringLiteral("i686")));
+    CHECK(updates.find(QStringLiteral("glibc"), QStringLiteral("x86_64")));
+
+    // Nothing after "Obsoleting Packages" is an update
+    CHECK(!updates.find(QStringLiteral("grub2-tools-efi"), QStringLiteral("x86_64")));
+}
+
+static void testNoarchFallback()
+{
+    const UpdateSet updates = recorded();
+    // An installed arch package whose update went noarch
+    const UpdateEntry *moved = updates.find(QStringLiteral("foo-data"), QStringLiteral("x86_64"));
+    CHECK(moved && moved->arch == QLatin1String("noarch"));
+    // Not the other way round
+    CHECK(!updates.find(QStringLiteral("bash"), QStringLiteral("noarch")));
+    CHECK(!updates.find(QStringLiteral("nosuch"), QStringLiteral("x86_64")));
+}
+
+static void testMalformedLines()
+{
+    const UpdateSet updates = UpdateSet::parseCheckUpdateOutput(QStringLiteral(
+        "Last metadata expiration check: 0:00:01 ago.\n"
+        "Security: kernel-core-6.12.11-200.fc41.x86_64 is an installed security update\n"
+        "noversion.x86_64   1.0   updates\n"
+        "nodot   1.0-1   updates\n"
+        "ok.x86_64   1.0-1   updates\n"));
+    CHECK(updates.size() == 1);
+    CHECK(updates.find(QStringLiteral("ok"), QStringLiteral("x86_64")));
+}
+
+static PackageInfo pkg(const char *name)
+{
+    PackageInfo info;
+    info.name = QString::fromLatin1(name);
+    info.epoch = QStringLiteral("0");
+    info.version = QStringLiteral("1.0-1.fc41");
+    info.arch = QStringLiteral("x86_64");
+    return info;
+}
+
+static void testUpdateColumnSort()
+{
+    PackageTableModel model;
+    model.setPackages({pkg("none"), pkg("b-updates"), pkg("a-mirror"), pkg("c-old")});
+
+    UpdateSet updates;
+    updates.insert({QStringLiteral("b-updates"), QStringLiteral("x86_64"), QStringLiteral("1.10-1.fc41"),
+                    {}, QStringLiteral("updates")});
+    updates.insert({QStringLiteral("a-mirror"), QStringLiteral("x86_64"), QStringLiteral("1.10-1.fc41"),
+                    {}, QStringLiteral("mirror")});
+    // Sorts after 1.9 as text, before it as a version
+    updates.insert({QStringLiteral("c-old"), QStringLiteral("x86_64"), QStringLiteral("1.9-1.fc41"),
+                    {}, QStringLiteral("aaa-first-by-repo")});
+    model.setUpdates(updates);
+
+    PackageFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.sort(PackageTableModel::UpdateColumn, Qt::AscendingOrder);
+
+    QStringList order;
+    for (int row = 0; row < proxy.rowCount(); ++row)
+        order << proxy.index(row, PackageTableModel::NameColumn).data().toString();
+    // No update first, then by offered version, repo only breaking the tie
+    CHECK(order == QStringList({QStringLiteral("none"), QStringLiteral("c-old"),
+                                QStringLiteral("a-mirror"), QStringLiteral("b-updates")}));
+}
+
+int main()
+{
+    testRecordedOutput();
+    testNoarchFallback();
+    testMalformedLines();
+    testUpdateColumnSort();
+
+    return checkResult();
+}
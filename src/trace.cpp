@@ -0,0 +1,200 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the Chrome trace-event recorder for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "trace.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+struct TraceEvent {
+    char phase; // 'X', 'C', 'i' or 'M'
+    const char *category;
+    QByteArray name;
+    qint64 startNs;
+    qint64 durationNs;
+    QJsonObject args;
+};
+
+/** One per thread so recording never contends; the lock only matters during stop() */
+struct ThreadBuffer {
+    QMutex mutex;
+    QVector<TraceEvent> events;
+    int tid = 0;
+};
+
+struct TraceState {
+    QMutex mutex; // guards buffers and path
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    QString path;
+    QElapsedTimer clock;
+    int nextTid = 1;
+};
+
+TraceState &state()
+{
+    static TraceState s;
+    return s;
+}
+
+ThreadBuffer &threadBuffer()
+{
+    // Buffers outlive their threads: workers finish long before the trace is written
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (!buffer) {
+        TraceState &s = state();
+        QMutexLocker lock(&s.mutex);
+        s.buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = s.buffers.back().get();
+        buffer->tid = s.nextTid++;
+    }
+    return *buffer;
+}
+
+void record(TraceEvent &&event)
+{
+    ThreadBuffer &buffer = threadBuffer();
+    QMutexLocker lock(&buffer.mutex);
+    buffer.events.append(std::move(event));
+}
+
+} // namespace
+
+bool Trace::start(const QString &path)
+{
+    TraceState &s = state();
+    {
+        QMutexLocker lock(&s.mutex);
+        s.path = path;
+        if (!s.clock.isValid())
+            s.clock.start();
+    }
+    s_enabled.store(true, std::memory_order_relaxed);
+    setThreadName("main");
+    return true;
+}
+
+bool Trace::startFromEnvironment(int argc, char *argv[])
+{
+    QString path;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            path = QString::fromLocal8Bit(argv[i + 1]);
+        else if (std::strncmp(argv[i], "--trace=", 8) == 0)
+            path = QString::fromLocal8Bit(argv[i] + 8);
+    }
+    if (path.isEmpty())
+        path = qEnvironmentVariable("TURBORPM_TRACE");
+    if (path.isEmpty() || path == QLatin1String("0"))
+        return false;
+    if (path == QLatin1String("1"))
+        path = QDir::temp().filePath(QStringLiteral("turborpm-trace-%1.json").arg(::getpid()));
+    return start(path);
+}
+
+bool Trace::stop()
+{
+    if (!isEnabled())
+        return true;
+    s_enabled.store(false, std::memory_order_relaxed);
+
+    TraceState &s = state();
+    QMutexLocker lock(&s.mutex);
+
+    QFile file(s.path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        std::fprintf(stderr, "turborpm: cannot write trace to %s\n", qPrintable(s.path));
+        return false;
+    }
+
+    const qint64 pid = ::getpid();
+    file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    file.write(QJsonDocument(QJsonObject{
+                                 {QStringLiteral("ph"), QStringLiteral("M")},
+                                 {QStringLiteral("name"), QStringLiteral("process_name")},
+                                 {QStringLiteral("pid"), pid},
+                                 {QStringLiteral("args"),
+                                  QJsonObject{{QStringLiteral("name"), QStringLiteral("turborpm")}}},
+                             })
+                   .toJson(QJsonDocument::Compact));
+
+    for (const auto &buffer : s.buffers) {
+        QMutexLocker bufferLock(&buffer->mutex);
+        for (const TraceEvent &event : std::as_const(buffer->events)) {
+            QJsonObject json;
+            json.insert(QStringLiteral("ph"), QString(QLatin1Char(event.phase)));
+            json.insert(QStringLiteral("name"), QString::fromUtf8(event.name));
+            if (event.category)
+                json.insert(QStringLiteral("cat"), QLatin1String(event.category));
+            json.insert(QStringLiteral("pid"), pid);
+            json.insert(QStringLiteral("tid"), buffer->tid);
+            json.insert(QStringLiteral("ts"), double(event.startNs) / 1000.0);
+            if (event.phase == 'X')
+                json.insert(QStringLiteral("dur"), double(event.durationNs) / 1000.0);
+            if (event.phase == 'i')
+                json.insert(QStringLiteral("s"), QStringLiteral("t"));
+            if (!event.args.isEmpty())
+                json.insert(QStringLiteral("args"), event.args);
+
+            file.write(",\n");
+            file.write(QJsonDocument(json).toJson(QJsonDocument::Compact));
+        }
+        buffer->events.clear();
+    }
+    file.write("\n]}\n");
+    std::fprintf(stderr, "turborpm: trace written to %s\n", qPrintable(s.path));
+    return file.error() == QFileDevice::NoError;
+}
+
+qint64 Trace::nowNs()
+{
+    return state().clock.nsecsElapsed();
+}
+
+void Trace::complete(const char *category, const QByteArray &name,
+                     qint64 startNs, qint64 endNs, const QJsonObject &args)
+{
+    if (!isEnabled())
+        return;
+    record({'X', category, name, startNs, endNs - startNs, args});
+}
+
+void Trace::counter(const char *name, qint64 value)
+{
+    if (!isEnabled())
+        return;
+    record({'C', nullptr, QByteArray(name), nowNs(), 0,
+            QJsonObject{{QStringLiteral("value"), value}}});
+}
+
+void Trace::instant(const char *category, const char *name, const QJsonObject &args)
+{
+    if (!isEnabled())
+        return;
+    record({'i', category, QByteArray(name), nowNs(), 0, args});
+}
+
+void Trace::setThreadName(const char *name)
+{
+    if (!isEnabled())
+        return;
+    record({'M', nullptr, QByteArrayLiteral("thread_name"), 0, 0,
+            QJsonObject{{QStringLiteral("name"), QLatin1String(name)}}});
+}
@@ -0,0 +1,97 @@
+/**
+ * @file trace.h
+ * @author Nikolay Yevik
+ * @brief Low-overhead Chrome trace-event recorder (loads in Perfetto / chrome://tracing)
+ * for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+
+#include <atomic>
+
+/**
+ * Always compiled in. Enabled by TURBORPM_TRACE=<file> (or =1 for a file in
+ * the temp directory) or by --trace <file>. While disabled every entry point
+ * costs one relaxed atomic load.
+ */
+class Trace
+{
+public:
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /** Starts recording; events are kept in memory until stop() */
+    static bool start(const QString &path);
+    /** Looks at TURBORPM_TRACE and --trace/--trace=<file> */
+    static bool startFromEnvironment(int argc, char *argv[]);
+    /** Writes the trace file and disables recording; returns false on I/O errors */
+    static bool stop();
+
+    static qint64 nowNs();
+
+    /** Complete ("X") event spanning [startNs, endNs] on the calling thread */
+    static void complete(const char *category, const QByteArray &name,
+                         qint64 startNs, qint64 endNs, const QJsonObject &args = {});
+    /** Counter ("C") track sample */
+    static void counter(const char *name, qint64 value);
+    /** Instant ("i") event on the calling thread */
+    static void instant(const char *category, const char *name, const QJsonObject &args = {});
+    /** Names the calling thread's track */
+    static void setThreadName(const char *name);
+
+private:
+    static inline std::atomic<bool> s_enabled {false};
+};
+
+/** Records a complete event for its scope; inert when tracing is off */
+class TraceSpan
+{
+public:
+    TraceSpan(const char *category, const char *name)
+        : m_active(Trace::isEnabled())
+    {
+        if (m_active) {
+            m_category = category;
+            m_name = QByteArray::fromRawData(name, qstrlen(name));
+            m_startNs = Trace::nowNs();
+        }
+    }
+
+    TraceSpan(const char *category, const QString &name)
+        : m_active(Trace::isEnabled())
+    {
+        if (m_active) {
+            m_category = category;
+            m_name = name.toUtf8();
+            m_startNs = Trace::nowNs();
+        }
+    }
+
+    ~TraceSpan()
+    {
+        if (m_active)
+            Trace::complete(m_category, m_name, m_startNs, Trace::nowNs(), m_args);
+    }
+
+    Q_DISABLE_COPY_MOVE(TraceSpan)
+
+    bool isActive() const { return m_active; }
+
+    void arg(const char *key, const QJsonValue &value)
+    {
+        if (m_active)
+            m_args.insert(QLatin1String(key), value);
+    }
+
+private:
+    bool m_active;
+    const char *m_category = nullptr;
+    QByteArray m_name;
+    qint64 m_startNs = 0;
+    QJsonObject m_args;
+};
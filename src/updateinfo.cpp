@@ -0,0 +1,263 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the updateinfo.xml reader and advisory index for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "updateinfo.h"
+#include "decompressor.h"
+#include "rpmevr.h"
+#include "trace.h"
+
+#include <QFile>
+#include <QObject>
+#include <QXmlStreamReader>
+
+#include <algorithm>
+
+namespace {
+    constexpr qint64 XmlChunkBytes {256 * 1024};
+
+    enum class UpdateField {
+        None,
+        Id,
+        Title,
+        Severity
+    };
+
+    /** noarch packages fix every arch, and an installed noarch one is fixed by any build */
+    bool archCompatible(const QString &fixed, const QString &installed)
+    {
+        return fixed == installed || fixed == QLatin1String("noarch")
+               || installed == QLatin1String("noarch");
+    }
+}
+
+int AdvisoryIndex::addAdvisory(const Advisory &advisory)
+{
+    const auto it = m_byId.constFind(advisory.id);
+    if (it != m_byId.constEnd())
+        return it.value();
+    const int index = int(m_advisories.size());
+    m_advisories.append(advisory);
+    m_byId.insert(advisory.id, index);
+    return index;
+}
+
+void AdvisoryIndex::addFix(int advisory, const QString &name, const QString &arch, const QByteArray &evrKey)
+{
+    m_fixes[name].append({advisory, arch, evrKey});
+    ++m_fixCount;
+}
+
+AdvisoryMatch AdvisoryIndex::match(const QString &name, const QString &arch,
+                                   const QByteArray &installedKey) const
+{
+    AdvisoryMatch result;
+    const auto it = m_fixes.constFind(name);
+    if (it == m_fixes.constEnd())
+        return result;
+
+    for (const Fix &fix : it.value()) {
+        if (!archCompatible(fix.arch, arch) || !(installedKey < fix.evrKey))
+            continue;
+        // An advisory lists a name once per arch and per collection
+        if (result.advisories.contains(fix.advisory))
+            continue;
+        result.advisories.append(fix.advisory);
+        const Advisory &advisory = m_advisories.at(fix.advisory);
+        result.severity = std::max(result.severity, advisory.severity);
+        result.security = result.security || advisory.isSecurity();
+    }
+    std::sort(result.advisories.begin(), result.advisories.end(), [this](int l, int r) {
+        const Advisory &left = m_advisories.at(l);
+        const Advisory &right = m_advisories.at(r);
+        if (left.severity != right.severity)
+            return left.severity > right.severity;
+        return left.id < right.id;
+    });
+    return result;
+}
+
+AdvisorySeverity AdvisoryIndex::severityFromName(QStringView name)
+{
+    const QStringView trimmed = name.trimmed();
+    if (trimmed.compare(QLatin1String("critical"), Qt::CaseInsensitive) == 0)
+        return AdvisorySeverity::Critical;
+    if (trimmed.compare(QLatin1String("important"), Qt::CaseInsensitive) == 0)
+        return AdvisorySeverity::Important;
+    if (trimmed.compare(QLatin1String("moderate"), Qt::CaseInsensitive) == 0)
+        return AdvisorySeverity::Moderate;
+    if (trimmed.compare(QLatin1String("low"), Qt::CaseInsensitive) == 0)
+        return AdvisorySeverity::Low;
+    return AdvisorySeverity::None;
+}
+
+QString AdvisoryIndex::severityName(AdvisorySeverity severity)
+{
+    switch (severity) {
+    case AdvisorySeverity::Critical:
+        return QStringLiteral("Critical");
+    case AdvisorySeverity::Important:
+        return QStringLiteral("Important");
+    case AdvisorySeverity::Moderate:
+        return QStringLiteral("Moderate");
+    case AdvisorySeverity::Low:
+        return QStringLiteral("Low");
+    case AdvisorySeverity::None:
+        break;
+    }
+    return {};
+}
+
+bool UpdateInfoReader::readFile(const QString &path, const QString &repoId, AdvisoryIndex &index)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_error = QObject::tr("Cannot open %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    return read(&file, repoId, index);
+}
+
+bool UpdateInfoReader::read(QIODevice *device, const QString &repoId, AdvisoryIndex &index)
+{
+    m_error.clear();
+    m_advisoriesRead = 0;
+
+    TraceSpan span("parse", QStringLiteral("updateinfo.xml %1").arg(repoId));
+    StreamDecompressor input(device);
+    QXmlStreamReader xml;
+    QByteArray chunk(XmlChunkBytes, Qt::Uninitialized);
+
+    struct PendingFix {
+        QString name;
+        QString arch;
+        QByteArray evrKey;
+    };
+
+    int depth = 0;
+    int updateDepth = -1;
+    UpdateField field = UpdateField::None;
+    QString text;
+    Advisory current;
+    QVector<PendingFix> fixes;
+    QHash<QString, QString> arches; // a handful of distinct values shared by every fix
+    bool sawEndDocument = false;
+
+    for (;;) {
+        const qint64 n = input.read(chunk.data(), chunk.size());
+        if (n < 0) {
+            m_error = input.errorString();
+            return false;
+        }
+        if (n > 0)
+            xml.addData(QByteArray(chunk.constData(), n));
+
+        while (!xml.atEnd()) {
+            switch (xml.readNext()) {
+            case QXmlStreamReader::StartElement: {
+                ++depth;
+                const QStringView name = xml.name();
+                if (updateDepth < 0) {
+                    if (name == QLatin1String("update")) {
+                        updateDepth = depth;
+                        current = Advisory();
+                        current.type = xml.attributes().value(QLatin1String("type")).toString();
+                        current.repoId = repoId;
+                        fixes.clear();
+                    }
+                    break;
+                }
+
+                if (depth - updateDepth == 1) {
+                    if (name == QLatin1String("id"))
+                        field = UpdateField::Id;
+                    else if (name == QLatin1String("title"))
+                        field = UpdateField::Title;
+                    else if (name == QLatin1String("severity"))
+                        field = UpdateField::Severity;
+                    else if (name == QLatin1String("issued"))
+                        current.issued = xml.attributes().value(QLatin1String("date")).toString();
+                } else if (name == QLatin1String("package")) {
+                    // pkglist/collection/package, however deep a vendor nests it
+                    const QXmlStreamAttributes attrs = xml.attributes();
+                    const QStringView arch = attrs.value(QLatin1String("arch"));
+                    if (arch == QLatin1String("src") || arch == QLatin1String("nosrc"))
+                        break;
+                    QString &shared = arches[arch.toString()];
+                    if (shared.isEmpty())
+                        shared = arch.toString();
+                    const QString versionRelease = attrs.value(QLatin1String("version")).toString()
+                                                   + QLatin1Char('-')
+                                                   + attrs.value(QLatin1String("release")).toString();
+                    fixes.append({attrs.value(QLatin1String("name")).toString(), shared,
+                                  RpmEvr::sortKey(attrs.value(QLatin1String("epoch")), versionRelease)});
+                }
+                if (field != UpdateField::None)
+                    text.clear();
+                break;
+            }
+            case QXmlStreamReader::Characters:
+                if (field != UpdateField::None)
+                    text += xml.text();
+                break;
+            case QXmlStreamReader::EndElement: {
+                if (updateDepth >= 0) {
+                    switch (field) {
+                    case UpdateField::Id:
+                        current.id = text.trimmed();
+                        break;
+                    case UpdateField::Title:
+                        current.title = text.trimmed();
+                        break;
+                    case UpdateField::Severity:
+                        current.severity = AdvisoryIndex::severityFromName(text);
+                        break;
+                    case UpdateField::None:
+                        break;
+                    }
+                    field = UpdateField::None;
+
+                    if (depth == updateDepth) {
+                        updateDepth = -1;
+                        if (!current.id.isEmpty()) {
+                            ++m_advisoriesRead;
+                            const int advisory = index.addAdvisory(current);
+                            for (const PendingFix &fix : std::as_const(fixes)) {
+                                if (!fix.name.isEmpty())
+                                    index.addFix(advisory, fix.name, fix.arch, fix.evrKey);
+                            }
+                        }
+                    }
+                }
+                --depth;
+                break;
+            }
+            case QXmlStreamReader::EndDocument:
+                sawEndDocument = true;
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (xml.hasError() && xml.error() != QXmlStreamReader::PrematureEndOfDocumentError) {
+            m_error = QObject::tr("Malformed metadata at line %1: %2")
+                          .arg(xml.lineNumber())
+                          .arg(xml.errorString());
+            return false;
+        }
+
+        if (n == 0)
+            break;
+    }
+
+    span.arg("compressedBytes", input.compressedBytesRead());
+    span.arg("advisories", m_advisoriesRead);
+    if (!sawEndDocument) {
+        m_error = QObject::tr("Metadata ended prematurely.");
+        return false;
+    }
+    return true;
+}
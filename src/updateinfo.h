@@ -0,0 +1,99 @@
+/**
+ * @file updateinfo.h
+ * @author Nikolay Yevik
+ * @brief Advisories from cached updateinfo.xml and their join with installed
+ * packages for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+class QIODevice;
+
+/** Ordered: a larger value is more severe */
+enum class AdvisorySeverity : quint8 {
+    None = 0,
+    Low,
+    Moderate,
+    Important,
+    Critical
+};
+
+struct Advisory {
+    QString id; /** FEDORA-2024-1a2b3c4d5e, RHSA-2024:0123, ... */
+    QString type; /** "security", "bugfix", "enhancement" or "newpackage" */
+    AdvisorySeverity severity = AdvisorySeverity::None;
+    QString title;
+    QString issued; /** Date as the metadata spells it */
+    QString repoId; /** First repository that carried it */
+
+    bool isSecurity() const { return type == QLatin1String("security"); }
+};
+
+/** Advisories that fix something in one installed package */
+struct AdvisoryMatch {
+    QVector<int> advisories; /** Indexes into AdvisoryIndex, most severe first */
+    AdvisorySeverity severity = AdvisorySeverity::None; /** Highest among them */
+    bool security = false; /** At least one is a security advisory */
+
+    bool isEmpty() const { return advisories.isEmpty(); }
+};
+
+/**
+ * Package name -> (advisory, arch, fixed EVR) for every package listed in
+ * any advisory. An installed package is affected when an advisory lists the
+ * same name and a compatible arch with a newer EVR; the comparison is a
+ * memcmp of RpmEvr::sortKey()s, like the rest of the table.
+ */
+class AdvisoryIndex
+{
+public:
+    /** Adds @p advisory or finds it by id (mirrors carry the same ones); returns its index */
+    int addAdvisory(const Advisory &advisory);
+    /** Records that @p advisory ships @p name.@p arch at the EVR with sort key @p evrKey */
+    void addFix(int advisory, const QString &name, const QString &arch, const QByteArray &evrKey);
+
+    AdvisoryMatch match(const QString &name, const QString &arch, const QByteArray &installedKey) const;
+
+    const Advisory &advisory(int index) const { return m_advisories.at(index); }
+    int size() const { return int(m_advisories.size()); }
+    bool isEmpty() const { return m_advisories.isEmpty(); }
+    int fixCount() const { return m_fixCount; }
+
+    /** "Critical", "Important", ...; case-insensitive, unknown text is None */
+    static AdvisorySeverity severityFromName(QStringView name);
+    static QString severityName(AdvisorySeverity severity);
+
+private:
+    struct Fix {
+        int advisory;
+        QString arch;
+        QByteArray evrKey;
+    };
+
+    QVector<Advisory> m_advisories;
+    QHash<QString, int> m_byId;
+    QHash<QString, QVector<Fix>> m_fixes; // package name -> fixed versions
+    int m_fixCount = 0;
+};
+
+/** Streams updateinfo.xml (plain or compressed) into an AdvisoryIndex */
+class UpdateInfoReader
+{
+public:
+    bool read(QIODevice *device, const QString &repoId, AdvisoryIndex &index);
+    bool readFile(const QString &path, const QString &repoId, AdvisoryIndex &index);
+
+    QString errorString() const { return m_error; }
+    qint64 advisoriesRead() const { return m_advisoriesRead; }
+
+private:
+    QString m_error;
+    qint64 m_advisoriesRead = 0;
+};
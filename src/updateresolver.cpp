@@ -0,0 +1,171 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the in-process update resolver for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "updateresolver.h"
+#include "rpmevr.h"
+#include "trace.h"
+
+#include <QFile>
+#include <QRegularExpression>
+#include <QSet>
+
+#include <utility>
+
+namespace {
+    const QLatin1String NoArch {"noarch"};
+
+    /**
+     * Fedora's installonlypkg(kernel) providers: every kernel flavor with its
+     * subpackages. RepoPackage carries no provides to ask.
+     */
+    const char *const KernelFlavors[] = {
+        "", "-PAE", "-debug", "-rt", "-rt-debug", "-64k", "-64k-debug", "-16k", "-16k-debug", "-zfcpdump",
+    };
+    const char *const KernelParts[] = {
+        "", "-core", "-modules", "-modules-core", "-modules-extra", "-modules-internal",
+        "-devel", "-devel-matched",
+    };
+}
+
+QSet<QString> UpdateResolver::installOnlyNames(const QString &dnfConf)
+{
+    QSet<QString> names{QStringLiteral("kernel-uki-virt")};
+    for (const char *flavor : KernelFlavors) {
+        for (const char *part : KernelParts)
+            names.insert(QStringLiteral("kernel") + QLatin1String(flavor) + QLatin1String(part));
+    }
+
+    // dnf appends installonlypkgs= to its defaults rather than replacing them
+    QFile file(dnfConf);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return names;
+    static const QRegularExpression separators(QStringLiteral("[,\\s]+"));
+    bool inMain = false;
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        if (line.startsWith(QLatin1Char('['))) {
+            inMain = line == QLatin1String("[main]");
+            continue;
+        }
+        const qsizetype equals = line.indexOf(QLatin1Char('='));
+        if (!inMain || equals < 0 || QStringView(line).left(equals).trimmed() != QLatin1String("installonlypkgs"))
+            continue;
+        const QStringList listed = line.mid(equals + 1).split(separators, Qt::SkipEmptyParts);
+        for (const QString &name : listed)
+            names.insert(name);
+    }
+    return names;
+}
+
+bool UpdateResolver::isInstallOnly(const QString &name)
+{
+    static const QSet<QString> names = installOnlyNames();
+    return names.contains(name);
+}
+
+QString UpdateResolver::formatEvr(const QString &epoch, const QString &versionRelease)
+{
+    if (epoch.isEmpty() || epoch == QLatin1String("0"))
+        return versionRelease;
+    return epoch + QLatin1Char(':') + versionRelease;
+}
+
+void UpdateResolver::addAvailable(const PackageInfo &pkg)
+{
+    if (pkg.arch == QLatin1String("src") || pkg.arch == QLatin1String("nosrc"))
+        return;
+
+    QByteArray key = RpmEvr::sortKey(pkg.epoch, pkg.version);
+    QVector<Candidate> &builds = m_available[pkg.name];
+    for (Candidate &build : builds) {
+        if (build.arch != pkg.arch)
+            continue;
+        // Equal EVRs keep the repository read first
+        if (build.evrKey < key) {
+            build.evr = formatEvr(pkg.epoch, pkg.version);
+            build.evrKey = std::move(key);
+            build.repo = pkg.repo;
+        }
+        return;
+    }
+    builds.append({pkg.arch, formatEvr(pkg.epoch, pkg.version), std::move(key), pkg.repo});
+    ++m_candidates;
+}
+
+bool UpdateResolver::loadCache(QStringList *errors, const QStringList &cacheRoots,
+                               const QStringList &repoConfigDirs)
+{
+    TraceSpan span("worker", "UpdateResolver::loadCache");
+    const QVector<RepoMetadataFile> files =
+        RepoMetadataCache::find(QStringLiteral("primary"), cacheRoots, repoConfigDirs);
+    PrimaryMetadataReader reader;
+    bool ok = !files.isEmpty();
+    for (const RepoMetadataFile &file : files) {
+        const bool read = reader.readFile(file.path, file.repoId,
+                                          [this](const RepoPackage &pkg) { addAvailable(pkg.info); });
+        if (!read) {
+            ok = false;
+            if (errors)
+                errors->append(QStringLiteral("%1: %2").arg(file.repoId, reader.errorString()));
+        }
+    }
+    span.arg("repos", files.size());
+    span.arg("candidates", m_candidates);
+    return ok;
+}
+
+UpdateSet UpdateResolver::resolve(const QVector<PackageInfo> &installed) const
+{
+    TraceSpan span("model", "UpdateResolver::resolve");
+
+    // Newest installed version per name.arch; several only for installonly packages
+    struct Newest {
+        const PackageInfo *pkg = nullptr;
+        QByteArray key;
+    };
+    QHash<QString, Newest> newest;
+    newest.reserve(installed.size());
+    for (const PackageInfo &pkg : installed) {
+        QByteArray key = RpmEvr::sortKey(pkg.epoch, pkg.version);
+        Newest &slot = newest[UpdateSet::keyFor(pkg.name, pkg.arch)];
+        if (!slot.pkg || slot.key < key)
+            slot = {&pkg, std::move(key)};
+    }
+
+    UpdateSet updates;
+    for (const Newest &current : std::as_const(newest)) {
+        const PackageInfo &pkg = *current.pkg;
+        const auto it = m_available.constFind(pkg.name);
+        if (it == m_available.constEnd())
+            continue;
+
+        // Kernels are installed next to each other, never replaced by another arch
+        const bool crossNoArch = pkg.arch != NoArch && !isInstallOnly(pkg.name);
+        const Candidate *best = nullptr;
+        for (const Candidate &build : it.value()) {
+            if (build.arch != pkg.arch && !(crossNoArch && build.arch == NoArch))
+                continue;
+            // On a tie the same-arch build wins over the noarch one
+            if (!best || best->evrKey < build.evrKey
+                || (build.arch == pkg.arch && best->evrKey == build.evrKey))
+                best = &build;
+        }
+        if (!best || !(current.key < best->evrKey))
+            continue;
+
+        UpdateEntry entry;
+        entry.name = pkg.name;
+        entry.arch = best->arch;
+        entry.evr = best->evr;
+        entry.evrKey = best->evrKey;
+        entry.repo = best->repo;
+        updates.insert(entry);
+    }
+
+    span.arg("installed", installed.size());
+    span.arg("updates", updates.size());
+    return updates;
+}
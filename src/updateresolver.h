@@ -0,0 +1,67 @@
+/**
+ * @file updateresolver.h
+ * @author Nikolay Yevik
+ * @brief Available upgrades computed from cached primary metadata, without a
+ * dnf check-update round-trip, for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "packagemodel.h"
+#include "repometadata.h"
+#include "updateset.h"
+
+/**
+ * Keeps the newest available EVR per name and arch. resolve() compares every
+ * installed name.arch (its newest version, so installonly kernels are
+ * judged by the one that booted last) against the same arch, or against a
+ * noarch build that replaced an arch-specific one, the way check-update
+ * reports them. Repository priorities, excludes and obsoletes are not
+ * applied.
+ */
+class UpdateResolver
+{
+public:
+    /** Offers @p pkg (a primary.xml row) as a candidate; src/nosrc are ignored */
+    void addAvailable(const PackageInfo &pkg);
+    /** Streams the cached primary.xml of every enabled repo; repos that fail are listed in @p errors */
+    bool loadCache(QStringList *errors = nullptr,
+                   const QStringList &cacheRoots = RepoMetadataCache::defaultCacheRoots(),
+                   const QStringList &repoConfigDirs = RepoMetadataCache::defaultRepoConfigDirs());
+
+    UpdateSet resolve(const QVector<PackageInfo> &installed) const;
+
+    bool isEmpty() const { return m_available.isEmpty(); }
+    /** Distinct name.arch pairs offered by the repositories */
+    int candidateCount() const { return m_candidates; }
+
+    /**
+     * Packages of which several versions stay installed side by side: the
+     * kernel flavors behind dnf's installonlypkg(kernel) default, plus the
+     * names listed in installonlypkgs= of @p dnfConf
+     */
+    static QSet<QString> installOnlyNames(const QString &dnfConf = QStringLiteral("/etc/dnf/dnf.conf"));
+    /** installOnlyNames() of this system, read once */
+    static bool isInstallOnly(const QString &name);
+    /** "[EPOCH:]VERSION-RELEASE" as check-update prints it, no epoch when 0 */
+    static QString formatEvr(const QString &epoch, const QString &versionRelease);
+
+private:
+    struct Candidate {
+        QString arch;
+        QString evr;
+        QByteArray evrKey;
+        QString repo;
+    };
+
+    QHash<QString, QVector<Candidate>> m_available; // name -> newest build per arch
+    int m_candidates = 0;
+};
@@ -0,0 +1,103 @@
+/**
+ * @author Nikolay Yevik
+ * @brief Implementation of the UpdateSet parser for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#include "updateset.h"
+#include "rpmevr.h"
+#include "trace.h"
+
+#include <QRegularExpression>
+#include <QStringList>
+
+QString UpdateSet::keyFor(const QString &name, const QString &arch)
+{
+    return name + QLatin1Char('.') + arch;
+}
+
+UpdateSet UpdateSet::parseCheckUpdateOutput(const QString &output)
+{
+    TraceSpan span("parse", "parseCheckUpdateOutput");
+    UpdateSet set;
+    static const QRegularExpression ws(QStringLiteral("\\s+"));
+
+    // dnf wraps long "name.arch" columns onto a line of their own; hold it
+    // until the version/repo continuation arrives.
+    QString pending;
+
+    const QStringList lines = output.split(QLatin1Char('\n'));
+    for (const QString &rawLine : lines) {
+        const QString trimmed = rawLine.trimmed();
+        if (trimmed.isEmpty())
+            continue;
+
+        // Everything after this header describes obsoleted packages, not updates.
+        if (trimmed.startsWith(QStringLiteral("Obsoleting Packages"), Qt::CaseInsensitive))
+            break;
+
+        const QString candidate = pending.isEmpty() ? trimmed
+                                                    : pending + QLatin1Char(' ') + trimmed;
+        const QStringList tokens = candidate.split(ws, Qt::SkipEmptyParts);
+
+        if (tokens.size() == 1 && pending.isEmpty()
+            && trimmed.contains(QLatin1Char('.')) && !trimmed.contains(QLatin1Char(':'))) {
+            pending = trimmed;
+            continue;
+        }
+        pending.clear();
+
+        if (tokens.size() != 3)
+            continue;
+
+        const QString &nameArch = tokens.at(0);
+        const int dot = nameArch.lastIndexOf(QLatin1Char('.'));
+        if (dot <= 0 || dot == nameArch.size() - 1)
+            continue;
+        // A real EVR always carries a release part
+        if (!tokens.at(1).contains(QLatin1Char('-')))
+            continue;
+
+        UpdateEntry entry;
+        entry.name = nameArch.left(dot);
+        entry.arch = nameArch.mid(dot + 1);
+        entry.evr = tokens.at(1);
+        entry.repo = tokens.at(2);
+        set.insert(entry);
+    }
+
+    span.arg("updates", set.size());
+    return set;
+}
+
+void UpdateSet::insert(const UpdateEntry &entry)
+{
+    UpdateEntry &stored = m_entries[keyFor(entry.name, entry.arch)];
+    stored = entry;
+    if (stored.evrKey.isEmpty())
+        stored.evrKey = RpmEvr::sortKey(stored.evr);
+}
+
+const UpdateEntry *UpdateSet::find(const QString &name, const QString &arch) const
+{
+    const auto it = m_entries.constFind(keyFor(name, arch));
+    if (it != m_entries.constEnd())
+        return &it.value();
+
+    // noarch <-> arch transitions are reported under the new arch
+    if (arch != QLatin1String("noarch")) {
+        const auto noarch = m_entries.constFind(keyFor(name, QStringLiteral("noarch")));
+        if (noarch != m_entries.constEnd())
+            return &noarch.value();
+    }
+    return nullptr;
+}
+
+QVector<UpdateEntry> UpdateSet::entries() const
+{
+    QVector<UpdateEntry> result;
+    result.reserve(m_entries.size());
+    for (const UpdateEntry &entry : m_entries)
+        result.append(entry);
+    return result;
+}
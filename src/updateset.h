@@ -0,0 +1,44 @@
+/**
+ * @file updateset.h
+ * @author Nikolay Yevik
+ * @brief Structured result of dnf check-update for TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+struct UpdateEntry {
+    QString name; /** RPM package name */
+    QString arch; /** Architecture of the update */
+    QString evr; /** Available [EPOCH:]VERSION-RELEASE */
+    QByteArray evrKey; /** RpmEvr::sortKey() of evr */
+    QString repo; /** Repository offering the update */
+};
+
+class UpdateSet
+{
+public:
+    static UpdateSet parseCheckUpdateOutput(const QString &output);
+    static QString keyFor(const QString &name, const QString &arch);
+
+    void insert(const UpdateEntry &entry);
+    const UpdateEntry *find(const QString &name, const QString &arch) const;
+    QVector<UpdateEntry> entries() const;
+
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    int size() const { return m_entries.size(); }
+
+    /** When the data was produced; invalid if never fetched */
+    QDateTime fetchedAt() const { return m_fetchedAt; }
+    void setFetchedAt(const QDateTime &when) { m_fetchedAt = when; }
+
+private:
+    QHash<QString, UpdateEntry> m_entries; // name.arch -> available update
+    QDateTime m_fetchedAt;
+};
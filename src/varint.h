@@ -0,0 +1,61 @@
+/**
+ * @file varint.h
+ * @author Nikolay Yevik
+ * @brief LEB128 varints for the compact on-disk formats of TurboRPM Package Manager Prototype.
+ * @version 0.0.1
+ * @date 2025-12-6
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QtGlobal>
+
+namespace Varint {
+
+inline void append(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out += char((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += char(value);
+}
+
+/** Advances @p pos; false on a truncated or over-long value */
+inline bool read(const char *&pos, const char *end, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+        const auto byte = quint8(*pos++);
+        value |= quint64(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+inline bool read(const char *&pos, const char *end, quint32 &value)
+{
+    quint64 wide = 0;
+    if (!read(pos, end, wide) || wide > 0xFFFFFFFFu)
+        return false;
+    value = quint32(wide);
+    return true;
+}
+
+/** Small magnitudes of either sign stay short */
+inline void appendSigned(QByteArray &out, qint64 value)
+{
+    append(out, (quint64(value) << 1) ^ quint64(value >> 63));
+}
+
+inline bool readSigned(const char *&pos, const char *end, qint64 &value)
+{
+    quint64 raw = 0;
+    if (!read(pos, end, raw))
+        return false;
+    value = qint64(raw >> 1) ^ -qint64(raw & 1);
+    return true;
+}
+
+} // namespace Varint